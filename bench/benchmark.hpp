@@ -0,0 +1,347 @@
+/**
+    @file
+
+    Minimal timing harness for the benchmark suite.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#ifndef WASHER_BENCH_BENCHMARK_HPP
+#define WASHER_BENCH_BENCHMARK_HPP
+#pragma once
+
+#include <boost/chrono/chrono.hpp> // steady_clock, duration_cast
+
+#include <algorithm> // min
+#include <cstddef> // size_t
+#include <iomanip> // setw
+#include <iostream> // cout
+#include <limits> // numeric_limits
+#include <ostream> // ostream
+#include <string>
+#include <vector>
+
+namespace washer {
+namespace bench {
+
+typedef void (*benchmark_function)();
+
+/**
+ * A named benchmark registered with WASHER_BENCHMARK.
+ */
+struct benchmark_entry
+{
+    benchmark_entry(const char* name, benchmark_function function)
+        : name(name), function(function) {}
+
+    std::string name;
+    benchmark_function function;
+};
+
+/**
+ * All benchmarks linked into the executable, in registration order.
+ */
+inline std::vector<benchmark_entry>& registry()
+{
+    static std::vector<benchmark_entry> benchmarks;
+    return benchmarks;
+}
+
+/**
+ * Adds a benchmark to the registry when constructed.
+ */
+class registration
+{
+public:
+    registration(const char* name, benchmark_function function)
+    {
+        registry().push_back(benchmark_entry(name, function));
+    }
+};
+
+/**
+ * How results are written to standard output.
+ */
+enum output_format
+{
+    text_output, ///< Aligned columns for reading
+    csv_output, ///< One row per result, for spreadsheets and scripts
+    json_output ///< An array of result objects, for regression tracking
+};
+
+namespace detail {
+
+    inline volatile unsigned char& sink()
+    {
+        static volatile unsigned char value = 0;
+        return value;
+    }
+
+    struct run_settings
+    {
+        run_settings()
+            : format(text_output),
+              max_iterations((std::numeric_limits<size_t>::max)()),
+              results(0) {}
+
+        output_format format;
+        size_t max_iterations;
+        std::string benchmark; ///< Name of the benchmark running now
+        size_t results; ///< Results written so far
+    };
+
+    inline run_settings& settings()
+    {
+        static run_settings values;
+        return values;
+    }
+
+    inline std::string csv_field(const std::string& text)
+    {
+        if (text.find_first_of(",\"\n") == std::string::npos)
+            return text;
+
+        std::string quoted = "\"";
+        for (size_t i = 0; i < text.size(); ++i)
+        {
+            if (text[i] == '"')
+                quoted += '"';
+            quoted += text[i];
+        }
+        return quoted + "\"";
+    }
+
+    inline std::string json_string(const std::string& text)
+    {
+        std::string quoted = "\"";
+        for (size_t i = 0; i < text.size(); ++i)
+        {
+            if (text[i] == '"' || text[i] == '\\')
+                quoted += '\\';
+            quoted += text[i];
+        }
+        return quoted + "\"";
+    }
+
+    /**
+     * Write one result in the chosen format.
+     *
+     * Results that aren't times have no iteration count and pass 0.
+     */
+    inline void write_result(
+        const std::string& label, size_t iterations, double value,
+        const std::string& unit)
+    {
+        run_settings& run = settings();
+        std::ostream& out = std::cout;
+
+        switch (run.format)
+        {
+        case csv_output:
+            out << csv_field(run.benchmark) << ',' << csv_field(label) << ',';
+            if (iterations)
+                out << iterations;
+            out << ',' << std::fixed << std::setprecision(3) << value << ','
+                << csv_field(unit) << std::endl;
+            break;
+
+        case json_output:
+            out << ((run.results) ? ",\n" : "")
+                << "  {\"benchmark\": " << json_string(run.benchmark)
+                << ", \"label\": " << json_string(label);
+            if (iterations)
+                out << ", \"iterations\": " << iterations;
+            out << ", \"value\": " << std::fixed << std::setprecision(3)
+                << value << ", \"unit\": " << json_string(unit) << "}";
+            break;
+
+        default:
+            out << std::left << std::setw(56) << label << std::right;
+            if (iterations)
+                out << std::setw(12) << iterations << std::setw(14);
+            else
+                out << std::setw(26);
+            out << std::fixed << std::setprecision(2) << value << " "
+                << unit << std::endl;
+        }
+
+        ++run.results;
+    }
+}
+
+/**
+ * @name  Running the suite
+ *
+ * Used by the driver to configure the run and frame the output.
+ */
+// @{
+
+inline void set_output_format(output_format format)
+{
+    detail::settings().format = format;
+}
+
+/**
+ * Limit the iterations of every measure() call.
+ *
+ * With a limit of 1, each benchmark runs just to check it still works, as
+ * the smoke test does.
+ */
+inline void set_max_iterations(size_t limit)
+{
+    detail::settings().max_iterations = limit;
+}
+
+inline void begin_output()
+{
+    switch (detail::settings().format)
+    {
+    case csv_output:
+        std::cout << "benchmark,label,iterations,value,unit" << std::endl;
+        break;
+    case json_output:
+        std::cout << "[\n";
+        break;
+    default:
+        break;
+    }
+}
+
+inline void begin_benchmark(const std::string& name)
+{
+    detail::settings().benchmark = name;
+    if (detail::settings().format == text_output)
+        std::cout << "# " << name << std::endl;
+}
+
+inline void end_output()
+{
+    if (detail::settings().format == json_output)
+        std::cout << ((detail::settings().results) ? "\n" : "") << "]"
+            << std::endl;
+}
+
+// @}
+
+/**
+ * Prevent the optimiser from discarding the computation of a value.
+ *
+ * GCC and Clang are told the value's memory escapes into an opaque
+ * assembly block.  Elsewhere its bytes are folded into a volatile, which
+ * they can't be without first being computed.
+ */
+template<typename T>
+inline void keep(const T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&value);
+    unsigned char folded = 0;
+    for (size_t i = 0; i < sizeof(T); ++i)
+    {
+        folded ^= bytes[i];
+    }
+    detail::sink() = folded;
+#endif
+}
+
+/**
+ * Hide a value from the optimiser.
+ *
+ * Stops work that only depends on values that don't change between calls
+ * being hoisted out of the timing loop.
+ */
+template<typename T>
+inline T opaque(T value)
+{
+    volatile T copy = value;
+    return copy;
+}
+
+/**
+ * Report the cost of one measurement.
+ */
+inline void report(
+    const std::string& label, size_t iterations,
+    boost::chrono::nanoseconds elapsed)
+{
+    double per_iteration =
+        static_cast<double>(elapsed.count()) / static_cast<double>(iterations);
+
+    detail::write_result(label, iterations, per_iteration, "ns/op");
+}
+
+/**
+ * Report a measurement that isn't a time, such as memory use.
+ */
+inline void report_quantity(
+    const std::string& label, double quantity, const std::string& unit)
+{
+    detail::write_result(label, 0, quantity, unit);
+}
+
+/**
+ * Time @a iterations calls of @a operation and report the cost per call.
+ *
+ * The operation is called once beforehand to warm caches and so that any
+ * lazily-initialised state doesn't count against the measurement.
+ *
+ * The iterations are capped by set_max_iterations().
+ */
+template<typename Operation>
+inline void measure(
+    const std::string& label, size_t iterations, Operation operation)
+{
+    typedef boost::chrono::steady_clock clock;
+
+    iterations = (std::min)(iterations, detail::settings().max_iterations);
+
+    operation();
+
+    clock::time_point start = clock::now();
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        operation();
+    }
+    clock::time_point end = clock::now();
+
+    report(
+        label, iterations,
+        boost::chrono::duration_cast<boost::chrono::nanoseconds>(end - start));
+}
+
+}} // namespace washer::bench
+
+/**
+ * Define a benchmark function and register it with the suite.
+ */
+#define WASHER_BENCHMARK(name) \
+    static void name(); \
+    static ::washer::bench::registration name##_registration(#name, &name); \
+    static void name()
+
+#endif
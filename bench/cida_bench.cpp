@@ -0,0 +1,199 @@
+/**
+    @file
+
+    Benchmarks of reading and writing CIDAs.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#include "benchmark.hpp"
+#include "pidl_fixtures.hpp"
+
+#include <washer/shell/cida.hpp> // cida_size, write_cida, cida_view
+#include <washer/shell/pidl.hpp> // apidl_t, cpidl_t, raw_pidl
+
+#include <cstddef> // size_t
+#include <cstring> // memcpy
+#include <vector>
+
+using washer::bench::as_pidl;
+using washer::bench::keep;
+using washer::bench::measure;
+using washer::bench::synthetic_idlist;
+using washer::shell::cida_size;
+using washer::shell::cida_view;
+using washer::shell::write_cida;
+using washer::shell::pidl::apidl_t;
+using washer::shell::pidl::cpidl_t;
+
+namespace raw_pidl = washer::shell::pidl::raw_pidl;
+
+namespace {
+
+    const size_t selection_size = 10000;
+
+    /**
+     * The way CIDAs used to be built: clone each PIDL, measure them all,
+     * then copy each one into the buffer.
+     *
+     * A vector stands in for the HGLOBAL so this runs anywhere.
+     */
+    struct hand_rolled_write
+    {
+        hand_rolled_write(
+            const apidl_t& parent,
+            const std::vector<const ITEMID_CHILD*>& children)
+            : m_parent(parent), m_children(children) {}
+
+        void operator()() const
+        {
+            std::vector<cpidl_t> clones(m_children.begin(), m_children.end());
+
+            size_t header = (clones.size() + 2) * sizeof(UINT);
+            size_t size = header + raw_pidl::size(m_parent.get());
+            for (size_t i = 0; i < clones.size(); ++i)
+            {
+                size += raw_pidl::size(clones[i].get());
+            }
+
+            std::vector<BYTE> buffer(size);
+            UINT* offsets = reinterpret_cast<UINT*>(&buffer[0]);
+            offsets[0] = static_cast<UINT>(clones.size());
+
+            size_t offset = header;
+            size_t parent_size = raw_pidl::size(m_parent.get());
+            offsets[1] = static_cast<UINT>(offset);
+            std::memcpy(&buffer[offset], m_parent.get(), parent_size);
+            offset += parent_size;
+
+            for (size_t i = 0; i < clones.size(); ++i)
+            {
+                size_t child_size = raw_pidl::size(clones[i].get());
+                offsets[i + 2] = static_cast<UINT>(offset);
+                std::memcpy(&buffer[offset], clones[i].get(), child_size);
+                offset += child_size;
+            }
+
+            keep(buffer.back());
+        }
+
+        const apidl_t& m_parent;
+        const std::vector<const ITEMID_CHILD*>& m_children;
+    };
+
+    struct direct_write
+    {
+        direct_write(
+            const apidl_t& parent,
+            const std::vector<const ITEMID_CHILD*>& children)
+            : m_parent(parent), m_children(children) {}
+
+        void operator()() const
+        {
+            std::vector<BYTE> buffer(
+                cida_size(m_parent, m_children.begin(), m_children.end()));
+            write_cida(
+                &buffer[0], buffer.size(), m_parent, m_children.begin(),
+                m_children.end());
+            keep(buffer.back());
+        }
+
+        const apidl_t& m_parent;
+        const std::vector<const ITEMID_CHILD*>& m_children;
+    };
+
+    /**
+     * Read every child out of a CIDA into its own wrapper.
+     */
+    struct copying_read
+    {
+        explicit copying_read(const std::vector<BYTE>& cida)
+            : m_cida(cida) {}
+
+        void operator()() const
+        {
+            const UINT* offsets = reinterpret_cast<const UINT*>(&m_cida[0]);
+            std::vector<cpidl_t> children(offsets[0]);
+            for (size_t i = 0; i < children.size(); ++i)
+            {
+                children[i] = reinterpret_cast<const ITEMID_CHILD*>(
+                    &m_cida[offsets[i + 2]]);
+            }
+            keep(children.back());
+        }
+
+        const std::vector<BYTE>& m_cida;
+    };
+
+    struct view_read
+    {
+        explicit view_read(const std::vector<BYTE>& cida) : m_cida(cida) {}
+
+        void operator()() const
+        {
+            cida_view cida(&m_cida[0], m_cida.size());
+            size_t bytes = 0;
+            for (cida_view::const_iterator it = cida.begin();
+                 it != cida.end(); ++it)
+            {
+                bytes += it->item_bytes();
+            }
+            keep(bytes);
+        }
+
+        const std::vector<BYTE>& m_cida;
+    };
+}
+
+/**
+ * Writing and reading a CIDA for a selection of 10,000 items.
+ */
+WASHER_BENCHMARK(cida)
+{
+    std::vector<BYTE> parent_bytes = synthetic_idlist(6, 32);
+    apidl_t parent(as_pidl<ITEMIDLIST_ABSOLUTE>(parent_bytes));
+
+    std::vector< std::vector<BYTE> > buffers(selection_size);
+    std::vector<const ITEMID_CHILD*> children(selection_size);
+    for (size_t i = 0; i < selection_size; ++i)
+    {
+        buffers[i] = synthetic_idlist(1, 48, i);
+        children[i] = as_pidl<ITEMID_CHILD>(buffers[i]);
+    }
+
+    measure(
+        "clone, measure and copy CIDA (10k)", 200,
+        hand_rolled_write(parent, children));
+    measure("write_cida (10k)", 200, direct_write(parent, children));
+
+    std::vector<BYTE> cida(
+        cida_size(parent, children.begin(), children.end()));
+    write_cida(
+        &cida[0], cida.size(), parent, children.begin(), children.end());
+
+    measure("copy children out of CIDA (10k)", 200, copying_read(cida));
+    measure("cida_view children (10k)", 200, view_read(cida));
+}
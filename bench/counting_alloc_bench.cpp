@@ -0,0 +1,178 @@
+/**
+    @file
+
+    Benchmarks for the allocation-counting PIDL allocator.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#include "benchmark.hpp"
+#include "pidl_fixtures.hpp"
+
+#include <washer/shell/counting_alloc.hpp> // counting_alloc, allocation_probe
+#include <washer/shell/pidl.hpp> // basic_pidl, newdelete_alloc
+#include <washer/shell/pidl_split.hpp> // basic_split_pidl
+
+#include <cstddef> // size_t
+#include <string>
+#include <vector>
+
+using washer::bench::as_pidl;
+using washer::bench::keep;
+using washer::bench::measure;
+using washer::bench::opaque;
+using washer::bench::report_quantity;
+using washer::bench::synthetic_idlist;
+using washer::shell::pidl::allocation_probe;
+using washer::shell::pidl::allocation_stats;
+using washer::shell::pidl::basic_pidl;
+using washer::shell::pidl::basic_split_pidl;
+using washer::shell::pidl::counting_alloc;
+using washer::shell::pidl::newdelete_alloc;
+
+namespace {
+
+    typedef newdelete_alloc<ITEMIDLIST_ABSOLUTE> plain_alloc;
+    typedef counting_alloc<ITEMIDLIST_ABSOLUTE, plain_alloc> counted_alloc;
+
+    template<typename Pidl>
+    struct copy_pidl
+    {
+        explicit copy_pidl(const Pidl& pidl) : m_pidl(pidl) {}
+
+        void operator()() const
+        {
+            Pidl copy(*opaque(&m_pidl));
+            keep(opaque(copy.size()));
+        }
+
+        const Pidl& m_pidl;
+    };
+
+    /**
+     * Report what @a operation allocates per call.
+     */
+    template<typename Operation>
+    void report_allocations(const std::string& label, Operation operation)
+    {
+        const size_t iterations = 1000;
+
+        allocation_probe probe;
+        for (size_t i = 0; i < iterations; ++i)
+        {
+            operation();
+        }
+        allocation_stats stats = probe.stats();
+
+        report_quantity(
+            label + " allocations",
+            static_cast<double>(stats.allocations) / iterations, "per call");
+        report_quantity(
+            label + " bytes",
+            static_cast<double>(stats.bytes_allocated) / iterations,
+            "per call");
+        report_quantity(
+            label + " peak",
+            static_cast<double>(stats.peak_live_bytes), "bytes");
+    }
+
+    struct join_pidls
+    {
+        typedef basic_pidl<ITEMIDLIST_ABSOLUTE, counted_alloc> pidl_type;
+
+        join_pidls(const pidl_type& lhs, const ITEMID_CHILD* rhs)
+            : m_lhs(lhs), m_rhs(rhs) {}
+
+        void operator()() const
+        {
+            pidl_type joined = *opaque(&m_lhs) + m_rhs;
+            keep(opaque(joined.size()));
+        }
+
+        const pidl_type& m_lhs;
+        const ITEMID_CHILD* m_rhs;
+    };
+
+    struct parent_and_last_item
+    {
+        typedef basic_pidl<ITEMIDLIST_ABSOLUTE, counted_alloc> pidl_type;
+
+        explicit parent_and_last_item(const pidl_type& pidl) : m_pidl(pidl) {}
+
+        void operator()() const
+        {
+            const pidl_type& pidl = *opaque(&m_pidl);
+            keep(opaque(pidl.parent().size() + pidl.last_item().size()));
+        }
+
+        const pidl_type& m_pidl;
+    };
+
+    struct owning_split
+    {
+        typedef basic_pidl<ITEMIDLIST_ABSOLUTE, counted_alloc> pidl_type;
+
+        explicit owning_split(const pidl_type& pidl) : m_pidl(pidl) {}
+
+        void operator()() const
+        {
+            basic_split_pidl<ITEMIDLIST_ABSOLUTE, counted_alloc> split(
+                *opaque(&m_pidl));
+            keep(opaque(split.allocated_bytes()));
+        }
+
+        const pidl_type& m_pidl;
+    };
+}
+
+/**
+ * Cost of counting allocations, and what common operations allocate.
+ */
+WASHER_BENCHMARK(allocation_counts)
+{
+    std::vector<BYTE> buffer = synthetic_idlist(8, 24);
+    const ITEMIDLIST_ABSOLUTE* raw = as_pidl<ITEMIDLIST_ABSOLUTE>(buffer);
+    std::vector<BYTE> child_buffer = synthetic_idlist(1, 24);
+    const ITEMID_CHILD* child = as_pidl<ITEMID_CHILD>(child_buffer);
+
+    basic_pidl<ITEMIDLIST_ABSOLUTE, plain_alloc> plain(raw);
+    basic_pidl<ITEMIDLIST_ABSOLUTE, counted_alloc> counted(raw);
+
+    const size_t iterations = 2000000;
+    measure(
+        "copy (newdelete_alloc)", iterations,
+        copy_pidl<basic_pidl<ITEMIDLIST_ABSOLUTE, plain_alloc> >(plain));
+    measure(
+        "copy (counting_alloc)", iterations,
+        copy_pidl<basic_pidl<ITEMIDLIST_ABSOLUTE, counted_alloc> >(counted));
+
+    report_allocations(
+        "copy",
+        copy_pidl<basic_pidl<ITEMIDLIST_ABSOLUTE, counted_alloc> >(counted));
+    report_allocations("operator+ child", join_pidls(counted, child));
+    report_allocations("parent() + last_item()", parent_and_last_item(counted));
+    report_allocations("split_apidl", owning_split(counted));
+}
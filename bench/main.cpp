@@ -0,0 +1,170 @@
+/**
+    @file
+
+    Benchmark suite entry point.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#include "benchmark.hpp"
+
+#include <boost/lexical_cast.hpp> // lexical_cast, bad_lexical_cast
+
+#include <cstddef> // size_t
+#include <iostream> // cout, cerr
+#include <string>
+#include <vector>
+
+using washer::bench::begin_benchmark;
+using washer::bench::begin_output;
+using washer::bench::benchmark_entry;
+using washer::bench::csv_output;
+using washer::bench::end_output;
+using washer::bench::json_output;
+using washer::bench::registry;
+using washer::bench::set_max_iterations;
+using washer::bench::set_output_format;
+using washer::bench::text_output;
+
+namespace {
+
+    const char usage[] =
+        "usage: washer-bench [--format=text|csv|json] "
+        "[--max-iterations=N] [--list] [filter]\n";
+
+    bool starts_with(const std::string& text, const std::string& prefix)
+    {
+        return text.compare(0, prefix.size(), prefix) == 0;
+    }
+
+    /**
+     * Apply one command-line option.
+     *
+     * @returns false if the option isn't recognised or its value is bad.
+     */
+    bool apply_option(const std::string& option, bool& list_only)
+    {
+        const std::string format = "--format=";
+        const std::string max_iterations = "--max-iterations=";
+
+        if (option == "--list")
+        {
+            list_only = true;
+        }
+        else if (starts_with(option, format))
+        {
+            std::string value = option.substr(format.size());
+            if (value == "text")
+                set_output_format(text_output);
+            else if (value == "csv")
+                set_output_format(csv_output);
+            else if (value == "json")
+                set_output_format(json_output);
+            else
+                return false;
+        }
+        else if (starts_with(option, max_iterations))
+        {
+            try
+            {
+                size_t limit = boost::lexical_cast<size_t>(
+                    option.substr(max_iterations.size()));
+                if (limit == 0)
+                    return false;
+                set_max_iterations(limit);
+            }
+            catch (const boost::bad_lexical_cast&)
+            {
+                return false;
+            }
+        }
+        else
+        {
+            return false;
+        }
+
+        return true;
+    }
+}
+
+/**
+ * Run every registered benchmark whose name contains the filter, or all of
+ * them if there is no filter.
+ *
+ * Options choose the output format, cap the iterations of each
+ * measurement so the whole suite can be run quickly as a smoke test, or
+ * list the benchmarks instead of running them.
+ */
+int main(int argc, char* argv[])
+{
+    std::string filter;
+    bool list_only = false;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string argument = argv[i];
+        if (starts_with(argument, "--"))
+        {
+            if (!apply_option(argument, list_only))
+            {
+                std::cerr << "unrecognised option: " << argument << "\n"
+                    << usage;
+                return 2;
+            }
+        }
+        else
+        {
+            filter = argument;
+        }
+    }
+
+    const std::vector<benchmark_entry>& benchmarks = registry();
+
+    if (!list_only)
+        begin_output();
+
+    for (std::vector<benchmark_entry>::const_iterator it = benchmarks.begin();
+         it != benchmarks.end(); ++it)
+    {
+        if (it->name.find(filter) == std::string::npos)
+            continue;
+
+        if (list_only)
+        {
+            std::cout << it->name << std::endl;
+        }
+        else
+        {
+            begin_benchmark(it->name);
+            it->function();
+        }
+    }
+
+    if (!list_only)
+        end_output();
+
+    return 0;
+}
@@ -0,0 +1,152 @@
+/**
+    @file
+
+    Benchmarks for building deep PIDLs by concatenation.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#include "benchmark.hpp"
+#include "pidl_fixtures.hpp"
+
+#include <washer/shell/pidl.hpp> // apidl_t, cpidl_t
+
+#include <boost/lexical_cast.hpp> // lexical_cast
+#include <boost/move/move.hpp> // move
+
+#include <string>
+#include <vector>
+
+using washer::bench::as_pidl;
+using washer::bench::keep;
+using washer::bench::measure;
+using washer::bench::synthetic_idlist;
+using washer::shell::pidl::apidl_t;
+using washer::shell::pidl::cpidl_t;
+
+namespace {
+
+    /**
+     * Build by joining into a new PIDL and copying it back at each level.
+     * This is what operator+= used to do.
+     */
+    struct copying_join
+    {
+        copying_join(const cpidl_t& item, size_t depth)
+            : m_item(item), m_depth(depth) {}
+
+        void operator()() const
+        {
+            apidl_t pidl;
+            for (size_t i = 0; i < m_depth; ++i)
+            {
+                apidl_t joined = pidl + m_item;
+                pidl = joined;
+            }
+            keep(pidl);
+        }
+
+        cpidl_t m_item;
+        size_t m_depth;
+    };
+
+    /**
+     * Build by joining onto the moved-from previous level.
+     */
+    struct rvalue_join
+    {
+        rvalue_join(const cpidl_t& item, size_t depth)
+            : m_item(item), m_depth(depth) {}
+
+        void operator()() const
+        {
+            apidl_t pidl;
+            for (size_t i = 0; i < m_depth; ++i)
+            {
+                pidl = boost::move(pidl) + m_item;
+            }
+            keep(pidl);
+        }
+
+        cpidl_t m_item;
+        size_t m_depth;
+    };
+
+    /**
+     * Build by appending in place.
+     */
+    struct append_join
+    {
+        append_join(const cpidl_t& item, size_t depth, bool reserve)
+            : m_item(item), m_depth(depth), m_reserve(reserve) {}
+
+        void operator()() const
+        {
+            apidl_t pidl;
+            if (m_reserve)
+                pidl.reserve(
+                    m_depth * (m_item.size() - sizeof(USHORT)) +
+                    sizeof(USHORT));
+
+            for (size_t i = 0; i < m_depth; ++i)
+            {
+                pidl += m_item;
+            }
+            keep(pidl);
+        }
+
+        cpidl_t m_item;
+        size_t m_depth;
+        bool m_reserve;
+    };
+}
+
+/**
+ * Cost of building an N-level absolute PIDL one child at a time.
+ */
+WASHER_BENCHMARK(pidl_build_by_appending)
+{
+    std::vector<BYTE> buffer = synthetic_idlist(1, 40);
+    cpidl_t item(as_pidl<ITEMID_CHILD>(buffer));
+
+    const size_t depths[] = { 4, 16, 64, 256 };
+    for (size_t d = 0; d < sizeof(depths) / sizeof(depths[0]); ++d)
+    {
+        size_t depth = depths[d];
+        size_t iterations = 2000000 / (depth * depth / 4 + 1) + 100;
+        std::string suffix =
+            " (depth " + boost::lexical_cast<std::string>(depth) + ")";
+
+        measure(
+            "copying join" + suffix, iterations, copying_join(item, depth));
+        measure("rvalue join" + suffix, iterations, rvalue_join(item, depth));
+        measure(
+            "append" + suffix, iterations, append_join(item, depth, false));
+        measure(
+            "reserve + append" + suffix, iterations,
+            append_join(item, depth, true));
+    }
+}
@@ -0,0 +1,152 @@
+/**
+    @file
+
+    Benchmarks for allocating a batch of child PIDLs from an arena.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#include "benchmark.hpp"
+
+#include <washer/shell/pidl.hpp> // cpidl_t
+#include <washer/shell/pidl_arena.hpp> // pidl_arena, arena_cpidl_t
+#include <washer/shell/pidl_array.hpp> // pidl_array
+
+#include <boost/numeric/conversion/cast.hpp> // numeric_cast
+
+#include <cstring> // memset
+#include <vector>
+
+using washer::bench::keep;
+using washer::bench::measure;
+using washer::shell::pidl::arena_alloc;
+using washer::shell::pidl::arena_cpidl_t;
+using washer::shell::pidl::cpidl_t;
+using washer::shell::pidl::pidl_arena;
+using washer::shell::pidl::pidl_array;
+
+namespace {
+
+    const size_t child_count = 100000;
+    const size_t child_size = 32;
+
+    /**
+     * Buffer of @a count separately-terminated child items, the way an
+     * enumerator would hand them out one at a time.
+     */
+    std::vector<BYTE> synthetic_children(size_t count)
+    {
+        size_t stride = child_size + sizeof(USHORT);
+        std::vector<BYTE> buffer(count * stride, 0);
+        for (size_t i = 0; i < count; ++i)
+        {
+            SHITEMID* item = reinterpret_cast<SHITEMID*>(&buffer[i * stride]);
+            item->cb = boost::numeric_cast<USHORT>(child_size);
+            std::memset(
+                item->abID, static_cast<int>(i & 0xff),
+                child_size - sizeof(USHORT));
+        }
+
+        return buffer;
+    }
+
+    const ITEMID_CHILD* child(const std::vector<BYTE>& buffer, size_t i)
+    {
+        return reinterpret_cast<const ITEMID_CHILD*>(
+            &buffer[i * (child_size + sizeof(USHORT))]);
+    }
+
+    /**
+     * Copy every child into its own COM-allocated PIDL and build an array
+     * of them.
+     */
+    struct heap_enumeration
+    {
+        explicit heap_enumeration(const std::vector<BYTE>& buffer)
+            : m_buffer(buffer) {}
+
+        void operator()() const
+        {
+            std::vector<cpidl_t> children(child_count);
+            for (size_t i = 0; i < child_count; ++i)
+            {
+                children[i] = child(m_buffer, i);
+            }
+
+            pidl_array<cpidl_t> array(children.begin(), children.end());
+            keep(array.as_array()[child_count - 1]);
+        }
+
+        const std::vector<BYTE>& m_buffer;
+    };
+
+    /**
+     * Copy every child into the arena, build an array of them and release
+     * the whole batch at once.
+     */
+    struct arena_enumeration
+    {
+        arena_enumeration(const std::vector<BYTE>& buffer, pidl_arena& arena)
+            : m_buffer(buffer), m_arena(arena) {}
+
+        void operator()() const
+        {
+            {
+                std::vector<arena_cpidl_t> children(
+                    child_count,
+                    arena_cpidl_t(arena_alloc<ITEMID_CHILD>(m_arena)));
+                for (size_t i = 0; i < child_count; ++i)
+                {
+                    children[i] = child(m_buffer, i);
+                }
+
+                pidl_array<arena_cpidl_t> array(
+                    children.begin(), children.end());
+                keep(array.as_array()[child_count - 1]);
+            }
+
+            m_arena.release();
+        }
+
+        const std::vector<BYTE>& m_buffer;
+        pidl_arena& m_arena;
+    };
+}
+
+/**
+ * Cost of enumerating 100,000 children into a pidl_array with each child
+ * allocated separately compared with carving them out of an arena.
+ */
+WASHER_BENCHMARK(pidl_arena_enumeration)
+{
+    std::vector<BYTE> buffer = synthetic_children(child_count);
+    pidl_arena arena;
+
+    measure("heap-allocated children (100k)", 20, heap_enumeration(buffer));
+    measure(
+        "arena-allocated children (100k)", 20,
+        arena_enumeration(buffer, arena));
+}
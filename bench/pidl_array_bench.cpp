@@ -0,0 +1,192 @@
+/**
+    @file
+
+    Benchmarks of PIDL arrays.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#include "benchmark.hpp"
+#include "pidl_fixtures.hpp"
+
+#include <washer/shell/pidl.hpp> // cpidl_t, raw_pidl
+#include <washer/shell/pidl_array.hpp> // pidl_array, packed_cpidl_array
+
+#include <cstddef> // size_t
+#include <vector>
+
+using washer::bench::as_pidl;
+using washer::bench::keep;
+using washer::bench::measure;
+using washer::bench::opaque;
+using washer::bench::synthetic_idlist;
+using washer::shell::pidl::cpidl_t;
+using washer::shell::pidl::packed_cpidl_array;
+using washer::shell::pidl::pidl_array;
+
+namespace raw_pidl = washer::shell::pidl::raw_pidl;
+
+namespace {
+
+    const size_t child_count = 100000;
+
+    /**
+     * Copy every child into its own wrapper and point an array at them.
+     */
+    struct build_wrapper_array
+    {
+        explicit build_wrapper_array(
+            const std::vector<const ITEMID_CHILD*>& children)
+            : m_children(children) {}
+
+        void operator()() const
+        {
+            std::vector<cpidl_t> wrapped(m_children.begin(), m_children.end());
+            pidl_array<cpidl_t> array(wrapped.begin(), wrapped.end());
+            keep(array.as_array()[child_count - 1]);
+        }
+
+        const std::vector<const ITEMID_CHILD*>& m_children;
+    };
+
+    struct build_packed_array
+    {
+        explicit build_packed_array(
+            const std::vector<const ITEMID_CHILD*>& children)
+            : m_children(children) {}
+
+        void operator()() const
+        {
+            packed_cpidl_array array(m_children.begin(), m_children.end());
+            keep(array.as_array()[child_count - 1]);
+        }
+
+        const std::vector<const ITEMID_CHILD*>& m_children;
+    };
+
+    /**
+     * Walk every PIDL in a shell-style array, as a folder handed it would.
+     */
+    struct scan_array
+    {
+        explicit scan_array(const PCUITEMID_CHILD* array) : m_array(array) {}
+
+        void operator()() const
+        {
+            const PCUITEMID_CHILD* array = opaque(m_array);
+            size_t bytes = 0;
+            for (size_t i = 0; i < child_count; ++i)
+            {
+                bytes += raw_pidl::size(array[i]);
+            }
+            keep(opaque(bytes));
+        }
+
+        const PCUITEMID_CHILD* m_array;
+    };
+
+    struct copy_wrappers
+    {
+        explicit copy_wrappers(const std::vector<cpidl_t>& wrapped)
+            : m_wrapped(wrapped) {}
+
+        void operator()() const
+        {
+            std::vector<cpidl_t> copy(m_wrapped);
+            keep(copy.back());
+        }
+
+        const std::vector<cpidl_t>& m_wrapped;
+    };
+
+    struct copy_packed
+    {
+        explicit copy_packed(const packed_cpidl_array& array)
+            : m_array(array) {}
+
+        void operator()() const
+        {
+            packed_cpidl_array copy(m_array);
+            keep(copy[child_count - 1]);
+        }
+
+        const packed_cpidl_array& m_array;
+    };
+}
+
+/**
+ * Building, scanning and copying an array of 100,000 children held as
+ * separate wrappers compared with packed into one block.
+ *
+ * To mimic a long-running process, the wrappers are allocated in a shuffled
+ * order interleaved with other allocations, so they are scattered over the
+ * heap as they would be after a while.
+ */
+WASHER_BENCHMARK(pidl_packed_array)
+{
+    std::vector< std::vector<BYTE> > buffers(child_count);
+    std::vector<const ITEMID_CHILD*> children(child_count);
+    for (size_t i = 0; i < child_count; ++i)
+    {
+        buffers[i] = synthetic_idlist(1, 32, i);
+        children[i] = as_pidl<ITEMID_CHILD>(buffers[i]);
+    }
+
+    measure(
+        "build pidl_array of cpidl_t (100k)", 20,
+        build_wrapper_array(children));
+    measure(
+        "build packed_cpidl_array (100k)", 20, build_packed_array(children));
+
+    std::vector<cpidl_t> wrapped(child_count);
+    std::vector<cpidl_t> clutter(child_count);
+    size_t state = 12345;
+    for (size_t i = 0; i < child_count; ++i)
+    {
+        state = state * 1103515245 + 12345;
+        size_t slot = (state >> 8) % child_count;
+        if (!wrapped[slot])
+            wrapped[slot] = children[slot];
+        clutter[i] = children[i];
+    }
+    for (size_t i = 0; i < child_count; ++i)
+    {
+        if (!wrapped[i])
+            wrapped[i] = children[i];
+    }
+    clutter.clear();
+
+    pidl_array<cpidl_t> array(wrapped.begin(), wrapped.end());
+    packed_cpidl_array packed(children.begin(), children.end());
+
+    measure(
+        "scan pidl_array of cpidl_t (100k)", 50,
+        scan_array(array.as_array()));
+    measure(
+        "scan packed_cpidl_array (100k)", 50, scan_array(packed.as_array()));
+    measure("copy vector of cpidl_t (100k)", 20, copy_wrappers(wrapped));
+    measure("copy packed_cpidl_array (100k)", 20, copy_packed(packed));
+}
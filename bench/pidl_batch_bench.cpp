@@ -0,0 +1,142 @@
+/**
+    @file
+
+    Benchmarks of joining a parent PIDL to many children at once.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#include "benchmark.hpp"
+#include "pidl_fixtures.hpp"
+
+#include <washer/shell/pidl.hpp> // apidl_t, cpidl_t
+#include <washer/shell/pidl_batch.hpp> // apidl_batch, join_all
+
+#include <boost/lexical_cast.hpp> // lexical_cast
+
+#include <cstddef> // size_t
+#include <string>
+#include <vector>
+
+using washer::bench::as_pidl;
+using washer::bench::keep;
+using washer::bench::measure;
+using washer::bench::synthetic_idlist;
+using washer::shell::pidl::apidl_batch;
+using washer::shell::pidl::apidl_t;
+using washer::shell::pidl::cpidl_t;
+using washer::shell::pidl::join_all;
+
+namespace {
+
+    /**
+     * Join the parent to each child with + into a vector of wrappers, as
+     * code had to before batches.
+     */
+    struct join_each
+    {
+        join_each(const apidl_t& parent, const std::vector<cpidl_t>& children)
+            : m_parent(parent), m_children(children) {}
+
+        void operator()() const
+        {
+            std::vector<apidl_t> joined;
+            joined.reserve(m_children.size());
+            for (size_t i = 0; i < m_children.size(); ++i)
+            {
+                joined.push_back(m_parent + m_children[i]);
+            }
+            keep(joined.back());
+        }
+
+        const apidl_t& m_parent;
+        const std::vector<cpidl_t>& m_children;
+    };
+
+    template<typename Children>
+    struct join_batch
+    {
+        join_batch(const apidl_t& parent, const Children& children)
+            : m_parent(parent), m_children(children) {}
+
+        void operator()() const
+        {
+            apidl_batch joined = join_all(
+                m_parent, m_children.begin(), m_children.end());
+            keep(joined[joined.size() - 1]);
+        }
+
+        const apidl_t& m_parent;
+        const Children& m_children;
+    };
+
+    template<typename Children>
+    join_batch<Children> make_join_batch(
+        const apidl_t& parent, const Children& children)
+    {
+        return join_batch<Children>(parent, children);
+    }
+}
+
+/**
+ * Joining a folder's PIDL to each of its children one at a time compared
+ * with doing it as a batch, for a folder eight items deep.
+ */
+WASHER_BENCHMARK(pidl_batch)
+{
+    std::vector<BYTE> parent_bytes = synthetic_idlist(8, 32);
+    apidl_t parent(as_pidl<ITEMIDLIST_ABSOLUTE>(parent_bytes));
+
+    const size_t counts[] = { 10, 100, 1000, 10000 };
+    for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); ++c)
+    {
+        size_t count = counts[c];
+
+        std::vector< std::vector<BYTE> > child_bytes(count);
+        std::vector<const ITEMID_CHILD*> raw_children(count);
+        std::vector<cpidl_t> children(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            child_bytes[i] = synthetic_idlist(1, 40, i);
+            raw_children[i] = as_pidl<ITEMID_CHILD>(child_bytes[i]);
+            children[i] = raw_children[i];
+        }
+
+        size_t iterations = 2000000 / count;
+        std::string suffix =
+            " (" + boost::lexical_cast<std::string>(count) + " children)";
+
+        measure(
+            "apidl_t + cpidl_t each" + suffix, iterations,
+            join_each(parent, children));
+        measure(
+            "join_all cpidl_t" + suffix, iterations,
+            make_join_batch(parent, children));
+        measure(
+            "join_all raw children" + suffix, iterations,
+            make_join_batch(parent, raw_children));
+    }
+}
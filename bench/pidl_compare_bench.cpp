@@ -0,0 +1,218 @@
+/**
+    @file
+
+    Benchmarks of PIDL equality, ordering and hashing.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#include "benchmark.hpp"
+#include "pidl_fixtures.hpp"
+
+#include <washer/shell/pidl.hpp> // apidl_t, raw_pidl
+#include <washer/shell/pidl_compare.hpp> // operator==, operator<, pidl_hash
+
+#include <boost/functional/hash.hpp> // hash_range
+#include <boost/lexical_cast.hpp> // lexical_cast
+
+#include <cstring> // memcmp
+#include <string>
+#include <vector>
+
+using washer::bench::as_pidl;
+using washer::bench::keep;
+using washer::bench::measure;
+using washer::bench::synthetic_idlist;
+using washer::shell::pidl::apidl_t;
+using washer::shell::pidl::pidl_hash;
+
+namespace raw_pidl = washer::shell::pidl::raw_pidl;
+
+namespace {
+
+    /**
+     * What we had to write before PIDLs were comparable: measure both and
+     * memcmp them.
+     */
+    struct memcmp_equal
+    {
+        memcmp_equal(const apidl_t& lhs, const apidl_t& rhs)
+            : m_lhs(lhs), m_rhs(rhs) {}
+
+        void operator()() const
+        {
+            size_t lhs_size = raw_pidl::size(m_lhs.get());
+            size_t rhs_size = raw_pidl::size(m_rhs.get());
+            bool equal = lhs_size == rhs_size &&
+                std::memcmp(m_lhs.get(), m_rhs.get(), lhs_size) == 0;
+            keep(equal);
+        }
+
+        apidl_t m_lhs;
+        apidl_t m_rhs;
+    };
+
+    struct raw_equal
+    {
+        raw_equal(const apidl_t& lhs, const apidl_t& rhs)
+            : m_lhs(lhs), m_rhs(rhs) {}
+
+        void operator()() const
+        {
+            bool equal = raw_pidl::equal(m_lhs.get(), m_rhs.get());
+            keep(equal);
+        }
+
+        apidl_t m_lhs;
+        apidl_t m_rhs;
+    };
+
+    struct wrapper_equal
+    {
+        wrapper_equal(const apidl_t& lhs, const apidl_t& rhs)
+            : m_lhs(lhs), m_rhs(rhs) {}
+
+        void operator()() const
+        {
+            bool equal = m_lhs == m_rhs;
+            keep(equal);
+        }
+
+        apidl_t m_lhs;
+        apidl_t m_rhs;
+    };
+
+    struct memcmp_less
+    {
+        memcmp_less(const apidl_t& lhs, const apidl_t& rhs)
+            : m_lhs(lhs), m_rhs(rhs) {}
+
+        void operator()() const
+        {
+            size_t lhs_size = raw_pidl::size(m_lhs.get());
+            size_t rhs_size = raw_pidl::size(m_rhs.get());
+            int result = std::memcmp(
+                m_lhs.get(), m_rhs.get(),
+                ((lhs_size < rhs_size) ? lhs_size : rhs_size) - 2);
+            bool less = result < 0 || (result == 0 && lhs_size < rhs_size);
+            keep(less);
+        }
+
+        apidl_t m_lhs;
+        apidl_t m_rhs;
+    };
+
+    struct wrapper_less
+    {
+        wrapper_less(const apidl_t& lhs, const apidl_t& rhs)
+            : m_lhs(lhs), m_rhs(rhs) {}
+
+        void operator()() const
+        {
+            bool less = m_lhs < m_rhs;
+            keep(less);
+        }
+
+        apidl_t m_lhs;
+        apidl_t m_rhs;
+    };
+
+    /**
+     * Hash a byte at a time, measuring the PIDL first.
+     */
+    struct bytewise_hash
+    {
+        explicit bytewise_hash(const apidl_t& pidl) : m_pidl(pidl) {}
+
+        void operator()() const
+        {
+            const BYTE* bytes = reinterpret_cast<const BYTE*>(m_pidl.get());
+            size_t hash = boost::hash_range(
+                bytes, bytes + raw_pidl::size(m_pidl.get()) - 2);
+            keep(hash);
+        }
+
+        apidl_t m_pidl;
+    };
+
+    struct raw_hash
+    {
+        explicit raw_hash(const apidl_t& pidl) : m_pidl(pidl) {}
+
+        void operator()() const
+        {
+            size_t hash = raw_pidl::hash(m_pidl.get());
+            keep(hash);
+        }
+
+        apidl_t m_pidl;
+    };
+
+    struct wrapper_hash
+    {
+        explicit wrapper_hash(const apidl_t& pidl) : m_pidl(pidl) {}
+
+        void operator()() const
+        {
+            size_t hash = pidl_hash()(m_pidl);
+            keep(hash);
+        }
+
+        apidl_t m_pidl;
+    };
+}
+
+/**
+ * Equality, ordering and hashing of PIDLs compared with measuring them and
+ * using memcmp or a byte-at-a-time hash.
+ *
+ * The PIDLs compared are equal but separately allocated so every byte has
+ * to be looked at.
+ */
+WASHER_BENCHMARK(pidl_compare)
+{
+    const size_t depths[] = { 1, 4, 16, 64 };
+    for (size_t d = 0; d < sizeof(depths) / sizeof(depths[0]); ++d)
+    {
+        size_t depth = depths[d];
+        std::vector<BYTE> buffer = synthetic_idlist(depth, 40);
+        apidl_t lhs(as_pidl<ITEMIDLIST_ABSOLUTE>(buffer));
+        apidl_t rhs(as_pidl<ITEMIDLIST_ABSOLUTE>(buffer));
+
+        size_t iterations = 8000000 / depth;
+        std::string suffix =
+            " (depth " + boost::lexical_cast<std::string>(depth) + ")";
+
+        measure("memcmp ==" + suffix, iterations, memcmp_equal(lhs, rhs));
+        measure("raw_pidl::equal" + suffix, iterations, raw_equal(lhs, rhs));
+        measure("apidl_t ==" + suffix, iterations, wrapper_equal(lhs, rhs));
+        measure("memcmp <" + suffix, iterations, memcmp_less(lhs, rhs));
+        measure("apidl_t <" + suffix, iterations, wrapper_less(lhs, rhs));
+        measure("bytewise hash" + suffix, iterations, bytewise_hash(lhs));
+        measure("raw_pidl::hash" + suffix, iterations, raw_hash(lhs));
+        measure("pidl_hash(apidl_t)" + suffix, iterations, wrapper_hash(lhs));
+    }
+}
@@ -0,0 +1,261 @@
+/**
+    @file
+
+    Benchmarks of the concurrent PIDL-keyed hash map under read-heavy load.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#include "benchmark.hpp"
+#include "pidl_fixtures.hpp"
+
+#include <washer/shell/pidl.hpp> // apidl_t
+#include <washer/shell/pidl_compare.hpp> // pidl_hash, pidl_equal_to
+#include <washer/shell/pidl_concurrent_map.hpp> // basic_concurrent_pidl_map
+
+#include <boost/chrono/chrono.hpp> // steady_clock, duration_cast
+#include <boost/lexical_cast.hpp> // lexical_cast
+#include <boost/thread/locks.hpp> // lock_guard, shared_lock, unique_lock
+#include <boost/thread/mutex.hpp> // mutex
+#include <boost/thread/shared_mutex.hpp> // shared_mutex
+#include <boost/optional/optional.hpp> // optional
+#include <boost/thread/thread.hpp> // thread_group
+#include <boost/unordered_map.hpp>
+
+#include <cstddef> // size_t
+#include <cstring> // memcpy
+#include <string>
+#include <utility> // make_pair
+#include <vector>
+
+using washer::bench::as_pidl;
+using washer::bench::keep;
+using washer::bench::report;
+using washer::bench::synthetic_idlist;
+using washer::shell::pidl::apidl_t;
+using washer::shell::pidl::basic_concurrent_pidl_map;
+using washer::shell::pidl::pidl_equal_to;
+using washer::shell::pidl::pidl_hash;
+
+namespace {
+
+    typedef std::vector<BYTE> buffer;
+
+    const size_t item_size = 24;
+    const size_t key_count = 10000;
+    const size_t operations_per_thread = 1000000;
+
+    /// One operation in this many replaces a value; the rest look one up.
+    const size_t write_interval = 100;
+
+    /**
+     * A six-item absolute PIDL whose last item holds @a index, as
+     * synthetic_idlist on its own only varies with the seed modulo 256.
+     */
+    buffer numbered_key(size_t index)
+    {
+        buffer key = synthetic_idlist(6, item_size, index);
+        std::memcpy(
+            &key[5 * item_size + sizeof(USHORT)], &index, sizeof(index));
+        return key;
+    }
+
+    /**
+     * The interface the workers need, over each of the caches compared.
+     */
+    class concurrent_cache
+    {
+    public:
+        typedef basic_concurrent_pidl_map<ITEMIDLIST_ABSOLUTE, size_t> map;
+
+        bool lookup(const ITEMIDLIST_ABSOLUTE* pidl, size_t& value) const
+        {
+            boost::optional<size_t> found = m_map.find(pidl);
+            if (!found)
+                return false;
+
+            value = *found;
+            return true;
+        }
+
+        void update(const ITEMIDLIST_ABSOLUTE* pidl, size_t value)
+        {
+            m_map.insert_or_assign(pidl, value);
+        }
+
+    private:
+        map m_map;
+    };
+
+    typedef boost::unordered_map<apidl_t, size_t, pidl_hash, pidl_equal_to>
+        pidl_map;
+
+    /**
+     * The usual alternative: an ordinary hash map behind one lock.
+     */
+    template<typename Mutex, typename ReadLock>
+    class locked_cache
+    {
+    public:
+        bool lookup(const ITEMIDLIST_ABSOLUTE* pidl, size_t& value) const
+        {
+            ReadLock lock(m_mutex);
+            pidl_map::const_iterator pos =
+                m_map.find(pidl, pidl_hash(), pidl_equal_to());
+            if (pos == m_map.end())
+                return false;
+
+            value = pos->second;
+            return true;
+        }
+
+        void update(const ITEMIDLIST_ABSOLUTE* pidl, size_t value)
+        {
+            boost::unique_lock<Mutex> lock(m_mutex);
+            pidl_map::iterator pos =
+                m_map.find(pidl, pidl_hash(), pidl_equal_to());
+            if (pos == m_map.end())
+                m_map.insert(std::make_pair(apidl_t(pidl), value));
+            else
+                pos->second = value;
+        }
+
+    private:
+        mutable Mutex m_mutex;
+        pidl_map m_map;
+    };
+
+    typedef locked_cache<boost::mutex, boost::lock_guard<boost::mutex> >
+        mutex_cache;
+    typedef locked_cache<
+        boost::shared_mutex, boost::shared_lock<boost::shared_mutex> >
+        shared_mutex_cache;
+
+    /**
+     * Look keys up in a pseudo-random order, replacing a value every
+     * write_interval operations, as threads sharing an attribute or icon
+     * cache would.
+     */
+    template<typename Cache>
+    class reader
+    {
+    public:
+        reader(Cache& cache, const std::vector<buffer>& keys, size_t seed)
+            : m_cache(cache), m_keys(keys), m_seed(seed) {}
+
+        void operator()() const
+        {
+            size_t state = m_seed * 2654435761U + 1;
+            size_t sum = 0;
+            for (size_t i = 0; i < operations_per_thread; ++i)
+            {
+                state = state * 1103515245U + 12345U;
+                size_t key = (state >> 8) % m_keys.size();
+                const ITEMIDLIST_ABSOLUTE* pidl =
+                    as_pidl<ITEMIDLIST_ABSOLUTE>(m_keys[key]);
+
+                if (i % write_interval == 0)
+                {
+                    m_cache.update(pidl, key);
+                }
+                else
+                {
+                    size_t value = 0;
+                    if (m_cache.lookup(pidl, value))
+                        sum += value;
+                }
+            }
+            keep(sum);
+        }
+
+    private:
+        Cache& m_cache;
+        const std::vector<buffer>& m_keys;
+        size_t m_seed;
+    };
+
+    /**
+     * Fill the cache then run a reader on each of @a threads threads and
+     * report the wall-clock time per operation across all of them.
+     */
+    template<typename Cache>
+    void measure_threads(
+        const std::string& label, const std::vector<buffer>& keys,
+        size_t threads)
+    {
+        typedef boost::chrono::steady_clock clock;
+
+        Cache cache;
+        for (size_t i = 0; i < keys.size(); ++i)
+        {
+            cache.update(as_pidl<ITEMIDLIST_ABSOLUTE>(keys[i]), i);
+        }
+
+        clock::time_point start = clock::now();
+        boost::thread_group group;
+        for (size_t t = 0; t < threads; ++t)
+        {
+            group.create_thread(reader<Cache>(cache, keys, t));
+        }
+        group.join_all();
+        clock::time_point end = clock::now();
+
+        report(
+            label, operations_per_thread * threads,
+            boost::chrono::duration_cast<boost::chrono::nanoseconds>(
+                end - start));
+    }
+}
+
+/**
+ * A cache keyed by absolute PIDL shared between threads that mostly read
+ * it: a hash map behind one mutex, the same behind one reader-writer lock
+ * and the sharded concurrent map.  Times are wall-clock per operation
+ * across all threads, so perfect scaling shows as the time falling in
+ * proportion to the thread count, which needs as many cores as threads.
+ */
+WASHER_BENCHMARK(pidl_concurrent_map)
+{
+    std::vector<buffer> keys;
+    for (size_t i = 0; i < key_count; ++i)
+    {
+        keys.push_back(numbered_key(i));
+    }
+
+    const size_t max_threads = 8;
+    for (size_t threads = 1; threads <= max_threads; threads *= 2)
+    {
+        std::string suffix =
+            " (" + boost::lexical_cast<std::string>(threads) + " threads)";
+
+        measure_threads<mutex_cache>(
+            "unordered_map, one mutex" + suffix, keys, threads);
+        measure_threads<shared_mutex_cache>(
+            "unordered_map, one shared_mutex" + suffix, keys, threads);
+        measure_threads<concurrent_cache>(
+            "concurrent_pidl_map" + suffix, keys, threads);
+    }
+}
@@ -0,0 +1,284 @@
+/**
+    @file
+
+    Benchmarks of the core PIDL operations across PIDL shapes.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#include "benchmark.hpp"
+#include "pidl_fixtures.hpp"
+
+#include <washer/shell/pidl.hpp> // apidl_t, cpidl_t, raw_pidl
+#include <washer/shell/pidl_array.hpp> // pidl_array, packed_cpidl_array
+#include <washer/shell/pidl_iterator.hpp> // pidl_iterator, raw_pidl_iterator
+
+#include <boost/lexical_cast.hpp> // lexical_cast
+
+#include <algorithm> // min, max
+#include <cstddef> // size_t
+#include <string>
+#include <vector>
+
+using washer::bench::as_pidl;
+using washer::bench::keep;
+using washer::bench::measure;
+using washer::bench::opaque;
+using washer::bench::synthetic_idlist;
+using washer::shell::pidl::apidl_t;
+using washer::shell::pidl::cpidl_t;
+using washer::shell::pidl::packed_cpidl_array;
+using washer::shell::pidl::pidl_array;
+using washer::shell::pidl::pidl_iterator;
+using washer::shell::pidl::raw_pidl_iterator;
+
+namespace raw_pidl = washer::shell::pidl::raw_pidl;
+
+namespace {
+
+    typedef apidl_t::allocator apidl_allocator;
+
+    /**
+     * Aim for each measurement to touch about this many bytes of PIDL so
+     * that small and large shapes take similar time.
+     */
+    const size_t bytes_per_measurement = 64 * 1024 * 1024;
+
+    size_t iterations_for(size_t pidl_size)
+    {
+        return (std::max)(
+            size_t(1000),
+            (std::min)(size_t(4000000), bytes_per_measurement / pidl_size));
+    }
+
+    struct raw_size
+    {
+        explicit raw_size(PCIDLIST_ABSOLUTE pidl) : m_pidl(pidl) {}
+
+        void operator()() const
+        {
+            keep(opaque(raw_pidl::size(opaque(m_pidl))));
+        }
+
+        PCIDLIST_ABSOLUTE m_pidl;
+    };
+
+    struct raw_clone
+    {
+        explicit raw_clone(PCIDLIST_ABSOLUTE pidl) : m_pidl(pidl) {}
+
+        void operator()() const
+        {
+            ITEMIDLIST_ABSOLUTE* copy =
+                raw_pidl::clone<apidl_allocator>(opaque(m_pidl));
+            keep(copy);
+            apidl_allocator::deallocate(copy);
+        }
+
+        PCIDLIST_ABSOLUTE m_pidl;
+    };
+
+    /**
+     * Join a child onto the PIDL, as happens for every item a folder
+     * enumerates.
+     */
+    struct raw_combine
+    {
+        raw_combine(PCIDLIST_ABSOLUTE pidl, PCUITEMID_CHILD child)
+            : m_pidl(pidl), m_child(child) {}
+
+        void operator()() const
+        {
+            ITEMIDLIST_ABSOLUTE* joined =
+                raw_pidl::combine<apidl_allocator>(opaque(m_pidl), m_child);
+            keep(joined);
+            apidl_allocator::deallocate(joined);
+        }
+
+        PCIDLIST_ABSOLUTE m_pidl;
+        PCUITEMID_CHILD m_child;
+    };
+
+    struct wrapper_parent
+    {
+        explicit wrapper_parent(const apidl_t& pidl) : m_pidl(pidl) {}
+
+        void operator()() const
+        {
+            apidl_t parent(m_pidl.parent());
+            keep(parent);
+        }
+
+        apidl_t m_pidl;
+    };
+
+    struct wrapper_last_item
+    {
+        explicit wrapper_last_item(const apidl_t& pidl) : m_pidl(pidl) {}
+
+        void operator()() const
+        {
+            cpidl_t item(m_pidl.last_item());
+            keep(item);
+        }
+
+        apidl_t m_pidl;
+    };
+
+    /**
+     * Visit every item, each copied into its own wrapper by the iterator.
+     */
+    struct iterate_items
+    {
+        explicit iterate_items(const apidl_t& pidl) : m_pidl(pidl) {}
+
+        void operator()() const
+        {
+            size_t bytes = 0;
+            for (pidl_iterator it(m_pidl); it != pidl_iterator(); ++it)
+            {
+                bytes += it->size();
+            }
+            keep(opaque(bytes));
+        }
+
+        apidl_t m_pidl;
+    };
+
+    /**
+     * Visit every item in place, for comparison with pidl_iterator.
+     */
+    struct iterate_raw_items
+    {
+        explicit iterate_raw_items(PCIDLIST_ABSOLUTE pidl) : m_pidl(pidl) {}
+
+        void operator()() const
+        {
+            size_t bytes = 0;
+            for (raw_pidl_iterator it(opaque(m_pidl));
+                 it != raw_pidl_iterator(); ++it)
+            {
+                bytes += (*it)->mkid.cb;
+            }
+            keep(opaque(bytes));
+        }
+
+        PCIDLIST_ABSOLUTE m_pidl;
+    };
+
+    struct build_pidl_array
+    {
+        explicit build_pidl_array(const std::vector<cpidl_t>& children)
+            : m_children(children) {}
+
+        void operator()() const
+        {
+            pidl_array<cpidl_t> array(m_children.begin(), m_children.end());
+            keep(array.as_array()[0]);
+        }
+
+        const std::vector<cpidl_t>& m_children;
+    };
+
+    struct build_packed_array
+    {
+        explicit build_packed_array(const std::vector<cpidl_t>& children)
+            : m_children(children) {}
+
+        void operator()() const
+        {
+            packed_cpidl_array array(m_children.begin(), m_children.end());
+            keep(array.as_array()[0]);
+        }
+
+        const std::vector<cpidl_t>& m_children;
+    };
+
+    void measure_shape(size_t depth, size_t item_size)
+    {
+        std::vector<BYTE> buffer = synthetic_idlist(depth, item_size);
+        std::vector<BYTE> child_buffer =
+            synthetic_idlist(1, item_size, depth);
+        PCIDLIST_ABSOLUTE raw = as_pidl<ITEMIDLIST_ABSOLUTE>(buffer);
+        PCUITEMID_CHILD child = as_pidl<ITEMID_CHILD>(child_buffer);
+        apidl_t pidl(raw);
+
+        // One child per item of the PIDL, like a folder with that many
+        // items, for the arrays
+        pidl_iterator first_item(pidl);
+        std::vector<cpidl_t> children(first_item, pidl_iterator());
+
+        size_t iterations = iterations_for(buffer.size());
+        std::string suffix =
+            " (depth " + boost::lexical_cast<std::string>(depth) + ", " +
+            boost::lexical_cast<std::string>(item_size) + "-byte items)";
+
+        measure("raw_pidl::size" + suffix, iterations, raw_size(raw));
+        measure("raw_pidl::clone" + suffix, iterations, raw_clone(raw));
+        measure(
+            "raw_pidl::combine" + suffix, iterations,
+            raw_combine(raw, child));
+        measure("apidl_t::parent" + suffix, iterations, wrapper_parent(pidl));
+        measure(
+            "apidl_t::last_item" + suffix, iterations,
+            wrapper_last_item(pidl));
+        measure(
+            "pidl_iterator traversal" + suffix, iterations,
+            iterate_items(pidl));
+        measure(
+            "raw_pidl_iterator traversal" + suffix, iterations,
+            iterate_raw_items(raw));
+        measure(
+            "pidl_array build" + suffix, iterations,
+            build_pidl_array(children));
+        measure(
+            "packed_cpidl_array build" + suffix, iterations,
+            build_packed_array(children));
+    }
+}
+
+/**
+ * The basic PIDL operations over a grid of PIDL shapes, from a single
+ * small item to deep lists of large items, as a baseline to track
+ * regressions against.  The arrays are built from one child per item.
+ *
+ * Run with --format=csv or --format=json to get results that scripts can
+ * compare between builds.
+ */
+WASHER_BENCHMARK(pidl_core)
+{
+    const size_t depths[] = { 1, 4, 16, 64 };
+    const size_t item_sizes[] = { 8, 40, 256 };
+
+    for (size_t d = 0; d < sizeof(depths) / sizeof(depths[0]); ++d)
+    {
+        for (size_t s = 0; s < sizeof(item_sizes) / sizeof(item_sizes[0]);
+             ++s)
+        {
+            measure_shape(depths[d], item_sizes[s]);
+        }
+    }
+}
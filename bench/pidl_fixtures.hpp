@@ -0,0 +1,85 @@
+/**
+    @file
+
+    Synthetic PIDLs for benchmarking.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#ifndef WASHER_BENCH_PIDL_FIXTURES_HPP
+#define WASHER_BENCH_PIDL_FIXTURES_HPP
+#pragma once
+
+#include <washer/shell/pidl.hpp> // raw PIDL types
+
+#include <boost/numeric/conversion/cast.hpp> // numeric_cast
+
+#include <cassert> // assert
+#include <cstddef> // size_t
+#include <vector>
+
+namespace washer {
+namespace bench {
+
+/**
+ * Bytes of an ITEMIDLIST made up of @a depth items of @a item_size bytes each.
+ *
+ * The item size includes the item's @c cb field.  Item contents are derived
+ * from @a seed so that lists built with different seeds compare unequal.
+ */
+inline std::vector<BYTE> synthetic_idlist(
+    size_t depth, size_t item_size, size_t seed=0)
+{
+    assert(item_size > sizeof(USHORT));
+
+    std::vector<BYTE> buffer(depth * item_size + sizeof(USHORT), 0);
+    for (size_t i = 0; i < depth; ++i)
+    {
+        BYTE* item = &buffer[i * item_size];
+        SHITEMID* id = reinterpret_cast<SHITEMID*>(item);
+        id->cb = boost::numeric_cast<USHORT>(item_size);
+
+        for (size_t b = sizeof(USHORT); b < item_size; ++b)
+        {
+            item[b] = static_cast<BYTE>(seed * 31 + i * 7 + b);
+        }
+    }
+
+    return buffer;
+}
+
+/**
+ * View a buffer created by synthetic_idlist as a raw PIDL.
+ */
+template<typename T>
+inline const T* as_pidl(const std::vector<BYTE>& buffer)
+{
+    return reinterpret_cast<const T*>(&buffer[0]);
+}
+
+}} // namespace washer::bench
+
+#endif
@@ -0,0 +1,274 @@
+/**
+    @file
+
+    Benchmarks for the sorted flat PIDL set.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#include "benchmark.hpp"
+
+#include <washer/shell/pidl.hpp> // cpidl_t
+#include <washer/shell/pidl_compare.hpp> // pidl_less, pidl_equal_to
+#include <washer/shell/pidl_flat_set.hpp> // cpidl_flat_set
+
+#include <boost/bind/bind.hpp> // bind
+
+#include <algorithm> // find_if, set_union
+#include <cstddef> // size_t
+#include <iterator> // inserter
+#include <set>
+#include <vector>
+
+using washer::bench::keep;
+using washer::bench::measure;
+using washer::bench::opaque;
+using washer::shell::pidl::cpidl_flat_set;
+using washer::shell::pidl::cpidl_t;
+using washer::shell::pidl::pidl_equal_to;
+using washer::shell::pidl::pidl_less;
+
+namespace {
+
+    typedef std::set<cpidl_t, pidl_less> cpidl_std_set;
+
+    const size_t selection_size = 100000;
+
+    /**
+     * Bytes of @a count distinct single-item PIDLs, 24 bytes per item,
+     * in no particular order.
+     */
+    std::vector< std::vector<BYTE> > distinct_items(
+        size_t count, size_t first)
+    {
+        std::vector< std::vector<BYTE> > items;
+        items.reserve(count);
+        for (size_t i = first; i < first + count; ++i)
+        {
+            std::vector<BYTE> item(24 + sizeof(USHORT), 0);
+            reinterpret_cast<SHITEMID*>(&item[0])->cb = 24;
+
+            // Scramble the index so neighbouring items aren't in order
+            size_t key = i * 2654435761u;
+            for (size_t b = 0; b < sizeof(size_t) && b < 22; ++b)
+            {
+                item[2 + b] = static_cast<BYTE>(key >> (8 * b));
+                item[2 + 21 - b] = static_cast<BYTE>(i >> (8 * b));
+            }
+            items.push_back(item);
+        }
+        return items;
+    }
+
+    std::vector<const ITEMID_CHILD*> raw_pidls(
+        const std::vector< std::vector<BYTE> >& items)
+    {
+        std::vector<const ITEMID_CHILD*> pidls;
+        for (size_t i = 0; i < items.size(); ++i)
+        {
+            pidls.push_back(
+                reinterpret_cast<const ITEMID_CHILD*>(&items[i][0]));
+        }
+        return pidls;
+    }
+
+    struct build_flat_set
+    {
+        explicit build_flat_set(const std::vector<const ITEMID_CHILD*>& pidls)
+            : m_pidls(pidls) {}
+
+        void operator()() const
+        {
+            cpidl_flat_set set(m_pidls.begin(), m_pidls.end());
+            keep(opaque(set.size()));
+        }
+
+        const std::vector<const ITEMID_CHILD*>& m_pidls;
+    };
+
+    struct build_std_set
+    {
+        explicit build_std_set(const std::vector<const ITEMID_CHILD*>& pidls)
+            : m_pidls(pidls) {}
+
+        void operator()() const
+        {
+            cpidl_std_set set;
+            for (size_t i = 0; i < m_pidls.size(); ++i)
+            {
+                set.insert(cpidl_t(m_pidls[i]));
+            }
+            keep(opaque(set.size()));
+        }
+
+        const std::vector<const ITEMID_CHILD*>& m_pidls;
+    };
+
+    /**
+     * Look up every probe in turn, half of which are in the selection.
+     */
+    template<typename Lookup>
+    struct lookups
+    {
+        lookups(const Lookup& lookup, const std::vector<cpidl_t>& probes)
+            : m_lookup(lookup), m_probes(probes), m_next(0) {}
+
+        void operator()() const
+        {
+            keep(opaque(m_lookup(m_probes[m_next])));
+            m_next = (m_next + 1) % m_probes.size();
+        }
+
+        Lookup m_lookup;
+        const std::vector<cpidl_t>& m_probes;
+        mutable size_t m_next;
+    };
+
+    struct flat_set_contains
+    {
+        explicit flat_set_contains(const cpidl_flat_set& set) : m_set(set) {}
+
+        bool operator()(const cpidl_t& pidl) const
+        {
+            return m_set.contains(pidl);
+        }
+
+        const cpidl_flat_set& m_set;
+    };
+
+    struct std_set_contains
+    {
+        explicit std_set_contains(const cpidl_std_set& set) : m_set(set) {}
+
+        bool operator()(const cpidl_t& pidl) const
+        {
+            return m_set.find(pidl) != m_set.end();
+        }
+
+        const cpidl_std_set& m_set;
+    };
+
+    /**
+     * What selection tracking does today.
+     */
+    struct vector_scan_contains
+    {
+        explicit vector_scan_contains(const std::vector<cpidl_t>& selection)
+            : m_selection(selection) {}
+
+        bool operator()(const cpidl_t& pidl) const
+        {
+            return std::find_if(
+                m_selection.begin(), m_selection.end(),
+                boost::bind(pidl_equal_to(), boost::placeholders::_1,
+                            boost::cref(pidl))) != m_selection.end();
+        }
+
+        const std::vector<cpidl_t>& m_selection;
+    };
+
+    struct flat_set_union
+    {
+        flat_set_union(const cpidl_flat_set& lhs, const cpidl_flat_set& rhs)
+            : m_lhs(lhs), m_rhs(rhs) {}
+
+        void operator()() const
+        {
+            keep(opaque(set_union(m_lhs, m_rhs).size()));
+        }
+
+        const cpidl_flat_set& m_lhs;
+        const cpidl_flat_set& m_rhs;
+    };
+
+    struct std_set_union
+    {
+        std_set_union(const cpidl_std_set& lhs, const cpidl_std_set& rhs)
+            : m_lhs(lhs), m_rhs(rhs) {}
+
+        void operator()() const
+        {
+            cpidl_std_set result;
+            std::set_union(
+                m_lhs.begin(), m_lhs.end(), m_rhs.begin(), m_rhs.end(),
+                std::inserter(result, result.end()), pidl_less());
+            keep(opaque(result.size()));
+        }
+
+        const cpidl_std_set& m_lhs;
+        const cpidl_std_set& m_rhs;
+    };
+}
+
+/**
+ * Selection membership and set operations over 100k child PIDLs.
+ */
+WASHER_BENCHMARK(pidl_flat_set)
+{
+    std::vector< std::vector<BYTE> > selected =
+        distinct_items(selection_size, 0);
+    std::vector< std::vector<BYTE> > other =
+        distinct_items(selection_size, selection_size / 2);
+    std::vector<const ITEMID_CHILD*> selected_pidls = raw_pidls(selected);
+    std::vector<const ITEMID_CHILD*> other_pidls = raw_pidls(other);
+
+    cpidl_flat_set flat(selected_pidls.begin(), selected_pidls.end());
+    cpidl_flat_set other_flat(other_pidls.begin(), other_pidls.end());
+    cpidl_std_set tree(flat.begin(), flat.end());
+    cpidl_std_set other_tree(other_flat.begin(), other_flat.end());
+    std::vector<cpidl_t> selection(
+        selected_pidls.begin(), selected_pidls.end());
+
+    // Probes overlap the selection by half
+    std::vector<cpidl_t> probes;
+    for (size_t i = 0; i < other_pidls.size(); i += 97)
+    {
+        probes.push_back(cpidl_t(other_pidls[i]));
+    }
+
+    measure(
+        "build cpidl_flat_set (100k)", 10, build_flat_set(selected_pidls));
+    measure(
+        "build std::set<cpidl_t> (100k)", 10, build_std_set(selected_pidls));
+
+    measure(
+        "cpidl_flat_set contains (100k)", 1000000,
+        lookups<flat_set_contains>(flat_set_contains(flat), probes));
+    measure(
+        "std::set<cpidl_t> find (100k)", 1000000,
+        lookups<std_set_contains>(std_set_contains(tree), probes));
+    measure(
+        "std::vector<cpidl_t> scan (100k)", 200,
+        lookups<vector_scan_contains>(
+            vector_scan_contains(selection), probes));
+
+    measure(
+        "cpidl_flat_set union (100k + 100k)", 10,
+        flat_set_union(flat, other_flat));
+    measure(
+        "std::set_union of std::sets (100k + 100k)", 10,
+        std_set_union(tree, other_tree));
+}
@@ -0,0 +1,224 @@
+/**
+    @file
+
+    Benchmarks for front-coded PIDL lists.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#include "benchmark.hpp"
+#include "pidl_fixtures.hpp"
+
+#include <washer/shell/counting_alloc.hpp> // counting_alloc, allocation_probe
+#include <washer/shell/pidl.hpp> // apidl_t, basic_pidl, newdelete_alloc
+#include <washer/shell/pidl_front_coded.hpp> // basic_front_coded_pidl_list
+
+#include <cstddef> // size_t
+#include <vector>
+
+using washer::bench::keep;
+using washer::bench::measure;
+using washer::bench::opaque;
+using washer::bench::report_quantity;
+using washer::bench::synthetic_idlist;
+using washer::shell::pidl::allocation_probe;
+using washer::shell::pidl::apidl_t;
+using washer::shell::pidl::basic_front_coded_pidl_list;
+using washer::shell::pidl::basic_pidl;
+using washer::shell::pidl::basic_pidl_view;
+using washer::shell::pidl::counting_alloc;
+using washer::shell::pidl::newdelete_alloc;
+
+namespace {
+
+    typedef counting_alloc<
+        ITEMIDLIST_ABSOLUTE, newdelete_alloc<ITEMIDLIST_ABSOLUTE> >
+        counted_alloc;
+    typedef basic_pidl<ITEMIDLIST_ABSOLUTE, counted_alloc> counted_apidl;
+    typedef basic_front_coded_pidl_list<
+        ITEMIDLIST_ABSOLUTE, counted_alloc> coded_list;
+
+    const size_t folder_count = 100;
+    const size_t files_per_folder = 1000;
+    const size_t folder_depth = 6;
+    const size_t item_size = 24;
+
+    /**
+     * Bytes of each PIDL in a listing of files grouped by folder.
+     */
+    std::vector< std::vector<BYTE> > listing()
+    {
+        std::vector< std::vector<BYTE> > pidls;
+        pidls.reserve(folder_count * files_per_folder);
+        for (size_t f = 0; f < folder_count; ++f)
+        {
+            std::vector<BYTE> parent =
+                synthetic_idlist(folder_depth, item_size, f);
+            parent.resize(parent.size() - sizeof(USHORT));
+
+            for (size_t i = 0; i < files_per_folder; ++i)
+            {
+                std::vector<BYTE> pidl(parent);
+                std::vector<BYTE> child = synthetic_idlist(1, item_size);
+                child[2] = static_cast<BYTE>(i);
+                child[3] = static_cast<BYTE>(i >> 8);
+                pidl.insert(pidl.end(), child.begin(), child.end());
+                pidls.push_back(pidl);
+            }
+        }
+        return pidls;
+    }
+
+    struct iterate_vector
+    {
+        explicit iterate_vector(const std::vector<counted_apidl>& pidls)
+            : m_pidls(pidls) {}
+
+        void operator()() const
+        {
+            size_t bytes = 0;
+            for (size_t i = 0; i < m_pidls.size(); ++i)
+            {
+                bytes += opaque(&m_pidls[i])->size();
+            }
+            keep(opaque(bytes));
+        }
+
+        const std::vector<counted_apidl>& m_pidls;
+    };
+
+    struct iterate_list
+    {
+        explicit iterate_list(const coded_list& list) : m_list(list) {}
+
+        void operator()() const
+        {
+            size_t bytes = 0;
+            for (coded_list::const_iterator it = m_list.begin();
+                 it != m_list.end(); ++it)
+            {
+                bytes += it->size();
+            }
+            keep(opaque(bytes));
+        }
+
+        const coded_list& m_list;
+    };
+
+    /**
+     * Copy out entries in a scattered order, as a view fetching the rows
+     * it scrolls to would.
+     */
+    template<typename Container>
+    struct copy_entries
+    {
+        explicit copy_entries(const Container& pidls)
+            : m_pidls(pidls), m_next(0) {}
+
+        void operator()() const
+        {
+            counted_apidl pidl(m_pidls[m_next]);
+            keep(opaque(pidl.size()));
+            m_next = (m_next + 7919) % m_pidls.size();
+        }
+
+        const Container& m_pidls;
+        mutable size_t m_next;
+    };
+
+    struct decode_entries
+    {
+        explicit decode_entries(const coded_list& list)
+            : m_list(list), m_next(0) {}
+
+        void operator()() const
+        {
+            basic_pidl_view<ITEMIDLIST_ABSOLUTE> view =
+                m_list.decode(m_next, m_buffer);
+            keep(opaque(view.size()));
+            m_next = (m_next + 7919) % m_list.size();
+        }
+
+        const coded_list& m_list;
+        mutable std::vector<BYTE> m_buffer;
+        mutable size_t m_next;
+    };
+}
+
+/**
+ * Memory and decoding cost of a front-coded listing of 100k absolute
+ * PIDLs against a vector of wrappers.
+ */
+WASHER_BENCHMARK(pidl_front_coded)
+{
+    std::vector< std::vector<BYTE> > bytes = listing();
+    size_t count = bytes.size();
+
+    std::vector<counted_apidl> pidls;
+    size_t vector_bytes = 0;
+    {
+        allocation_probe probe;
+        pidls.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            pidls.push_back(
+                counted_apidl(
+                    reinterpret_cast<const ITEMIDLIST_ABSOLUTE*>(
+                        &bytes[i][0])));
+        }
+        // Counted without the counting allocator's own overhead
+        vector_bytes =
+            probe.stats().live_bytes() + pidls.capacity() * sizeof(apidl_t);
+    }
+
+    coded_list list;
+    for (size_t i = 0; i < count; ++i)
+    {
+        list.push_back(
+            reinterpret_cast<const ITEMIDLIST_ABSOLUTE*>(&bytes[i][0]));
+    }
+
+    report_quantity(
+        "std::vector<apidl_t> memory (100k)",
+        static_cast<double>(vector_bytes) / 1024, "KiB");
+    report_quantity(
+        "front-coded list memory (100k)",
+        static_cast<double>(list.encoded_bytes()) / 1024, "KiB");
+    report_quantity(
+        "memory reduction",
+        static_cast<double>(vector_bytes) / list.encoded_bytes(), "x");
+
+    measure("iterate std::vector<apidl_t> (100k)", 20, iterate_vector(pidls));
+    measure("iterate front-coded list (100k)", 20, iterate_list(list));
+    measure(
+        "copy std::vector<apidl_t> entry", 1000000,
+        copy_entries< std::vector<counted_apidl> >(pidls));
+    measure(
+        "copy front-coded entry", 1000000,
+        copy_entries<coded_list>(list));
+    measure("decode front-coded entry to view", 1000000,
+        decode_entries(list));
+}
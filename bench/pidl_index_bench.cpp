@@ -0,0 +1,236 @@
+/**
+    @file
+
+    Benchmarks of the random-access PIDL index.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#include "benchmark.hpp"
+#include "pidl_fixtures.hpp"
+
+#include <washer/shell/pidl.hpp> // apidl_t
+#include <washer/shell/pidl_index.hpp> // apidl_index
+#include <washer/shell/pidl_iterator.hpp> // pidl_iterator, raw_pidl_iterator
+
+#include <boost/lexical_cast.hpp> // lexical_cast
+
+#include <cstddef> // size_t
+#include <string>
+#include <vector>
+
+using washer::bench::as_pidl;
+using washer::bench::keep;
+using washer::bench::measure;
+using washer::bench::opaque;
+using washer::bench::synthetic_idlist;
+using washer::shell::pidl::apidl_index;
+using washer::shell::pidl::apidl_t;
+using washer::shell::pidl::cpidl_t;
+using washer::shell::pidl::pidl_iterator;
+using washer::shell::pidl::raw_pidl_iterator;
+
+namespace {
+
+    /**
+     * Visit every item front to back with the copying iterator.
+     */
+    struct pidl_iterator_walk
+    {
+        explicit pidl_iterator_walk(const apidl_t& pidl) : m_pidl(pidl) {}
+
+        void operator()() const
+        {
+            size_t bytes = 0;
+            for (pidl_iterator it(m_pidl), end; it != end; ++it)
+            {
+                bytes += it->size();
+            }
+            keep(opaque(bytes));
+        }
+
+        apidl_t m_pidl;
+    };
+
+    struct raw_iterator_walk
+    {
+        explicit raw_iterator_walk(const apidl_t& pidl) : m_pidl(pidl) {}
+
+        void operator()() const
+        {
+            size_t bytes = 0;
+            raw_pidl_iterator it(opaque(m_pidl.get())), end;
+            for (; it != end; ++it)
+            {
+                bytes += (*it)->mkid.cb;
+            }
+            keep(opaque(bytes));
+        }
+
+        apidl_t m_pidl;
+    };
+
+    /**
+     * Index the PIDL and visit every item, so the cost of building the
+     * index is included.
+     */
+    struct index_walk
+    {
+        explicit index_walk(const apidl_t& pidl) : m_pidl(pidl) {}
+
+        void operator()() const
+        {
+            apidl_index index(opaque(m_pidl.get()));
+            size_t bytes = 0;
+            for (apidl_index::const_iterator it = index.begin();
+                 it != index.end(); ++it)
+            {
+                bytes += it->item_bytes();
+            }
+            keep(opaque(bytes));
+        }
+
+        apidl_t m_pidl;
+    };
+
+    /**
+     * Visit every item back to front.  A forward iterator has to start
+     * again from the front for each one.
+     */
+    struct raw_iterator_reverse_walk
+    {
+        explicit raw_iterator_reverse_walk(const apidl_t& pidl)
+            : m_pidl(pidl) {}
+
+        void operator()() const
+        {
+            size_t bytes = 0;
+            for (size_t i = m_pidl.item_count(); i-- > 0; )
+            {
+                raw_pidl_iterator it(opaque(m_pidl.get()));
+                for (size_t n = 0; n < i; ++n)
+                {
+                    ++it;
+                }
+                bytes += (*it)->mkid.cb;
+            }
+            keep(opaque(bytes));
+        }
+
+        apidl_t m_pidl;
+    };
+
+    struct index_reverse_walk
+    {
+        explicit index_reverse_walk(const apidl_t& pidl) : m_pidl(pidl) {}
+
+        void operator()() const
+        {
+            apidl_index index(opaque(m_pidl.get()));
+            size_t bytes = 0;
+            for (apidl_index::const_reverse_iterator it = index.rbegin();
+                 it != index.rend(); ++it)
+            {
+                bytes += it->item_bytes();
+            }
+            keep(opaque(bytes));
+        }
+
+        apidl_t m_pidl;
+    };
+
+    /**
+     * Find the middle item.
+     */
+    struct raw_iterator_middle
+    {
+        explicit raw_iterator_middle(const apidl_t& pidl) : m_pidl(pidl) {}
+
+        void operator()() const
+        {
+            raw_pidl_iterator it(opaque(m_pidl.get()));
+            for (size_t n = 0; n < m_pidl.item_count() / 2; ++n)
+            {
+                ++it;
+            }
+            keep(*it);
+        }
+
+        apidl_t m_pidl;
+    };
+
+    struct index_middle
+    {
+        explicit index_middle(const apidl_index& index) : m_index(index) {}
+
+        void operator()() const
+        {
+            keep(m_index[opaque(m_index.item_count() / 2)]);
+        }
+
+        const apidl_index& m_index;
+    };
+}
+
+/**
+ * Walking PIDLs forwards, backwards and jumping to the middle with the
+ * forward-only iterators compared with indexing the items first.
+ */
+WASHER_BENCHMARK(pidl_index)
+{
+    const size_t depths[] = { 16, 64, 256 };
+    for (size_t d = 0; d < sizeof(depths) / sizeof(depths[0]); ++d)
+    {
+        size_t depth = depths[d];
+        std::vector<BYTE> buffer = synthetic_idlist(depth, 24);
+        apidl_t pidl(as_pidl<ITEMIDLIST_ABSOLUTE>(buffer));
+        apidl_index index(pidl);
+
+        size_t iterations = 4000000 / depth;
+        std::string suffix =
+            " (depth " + boost::lexical_cast<std::string>(depth) + ")";
+
+        measure(
+            "pidl_iterator forward" + suffix, iterations / 8,
+            pidl_iterator_walk(pidl));
+        measure(
+            "raw_pidl_iterator forward" + suffix, iterations,
+            raw_iterator_walk(pidl));
+        measure("index and forward" + suffix, iterations, index_walk(pidl));
+        measure(
+            "raw_pidl_iterator backward" + suffix, iterations / depth,
+            raw_iterator_reverse_walk(pidl));
+        measure(
+            "index and backward" + suffix, iterations,
+            index_reverse_walk(pidl));
+        measure(
+            "raw_pidl_iterator to middle" + suffix, iterations,
+            raw_iterator_middle(pidl));
+        measure(
+            "indexed middle" + suffix, iterations * depth,
+            index_middle(index));
+    }
+}
@@ -0,0 +1,247 @@
+/**
+    @file
+
+    Benchmarks of PIDL interning.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#include "benchmark.hpp"
+#include "pidl_fixtures.hpp"
+
+#include <washer/shell/pidl.hpp> // apidl_t
+#include <washer/shell/pidl_compare.hpp> // operator==
+#include <washer/shell/pidl_intern.hpp> // apidl_intern_table, interned_apidl
+
+#include <cstddef> // size_t
+#include <cstring> // memcpy
+#include <vector>
+
+using washer::bench::as_pidl;
+using washer::bench::keep;
+using washer::bench::measure;
+using washer::bench::report_quantity;
+using washer::bench::synthetic_idlist;
+using washer::shell::pidl::apidl_intern_table;
+using washer::shell::pidl::apidl_t;
+using washer::shell::pidl::interned_apidl;
+
+namespace {
+
+    const size_t reference_count = 1000000;
+
+    /**
+     * One in ten references is to a PIDL not seen before; the rest are
+     * repeats, as in a cache of the same folders' items viewed many times.
+     */
+    const size_t distinct_count = reference_count / 10;
+
+    const size_t depth = 6;
+    const size_t item_size = 24;
+
+    /**
+     * The distinct PIDLs.
+     *
+     * Synthetic lists only vary with the seed modulo 256 so the index is
+     * also stamped into the last item to make every one unique.
+     */
+    std::vector< std::vector<BYTE> > distinct_pidls()
+    {
+        std::vector< std::vector<BYTE> > pidls(distinct_count);
+        for (size_t i = 0; i < distinct_count; ++i)
+        {
+            pidls[i] = synthetic_idlist(depth, item_size, i);
+            std::memcpy(
+                &pidls[i][(depth - 1) * item_size + sizeof(USHORT)], &i,
+                sizeof(i));
+        }
+
+        return pidls;
+    }
+
+    /**
+     * Which distinct PIDL each reference is to, scattered pseudo-randomly.
+     */
+    std::vector<size_t> references()
+    {
+        std::vector<size_t> refs(reference_count);
+        size_t state = 12345;
+        for (size_t i = 0; i < reference_count; ++i)
+        {
+            state = state * 1103515245 + 12345;
+            refs[i] = (state >> 8) % distinct_count;
+        }
+
+        return refs;
+    }
+
+    const ITEMIDLIST_ABSOLUTE* pidl_at(
+        const std::vector< std::vector<BYTE> >& pidls, size_t i)
+    {
+        return as_pidl<ITEMIDLIST_ABSOLUTE>(pidls[i]);
+    }
+
+    /**
+     * Copy every reference into its own wrapper.
+     */
+    struct copy_all
+    {
+        copy_all(
+            const std::vector< std::vector<BYTE> >& pidls,
+            const std::vector<size_t>& refs)
+            : m_pidls(pidls), m_refs(refs) {}
+
+        void operator()() const
+        {
+            std::vector<apidl_t> copies(m_refs.size());
+            for (size_t i = 0; i < m_refs.size(); ++i)
+            {
+                copies[i] = pidl_at(m_pidls, m_refs[i]);
+            }
+            keep(copies.back());
+        }
+
+        const std::vector< std::vector<BYTE> >& m_pidls;
+        const std::vector<size_t>& m_refs;
+    };
+
+    /**
+     * Intern every reference into a fresh table.
+     */
+    struct intern_all
+    {
+        intern_all(
+            const std::vector< std::vector<BYTE> >& pidls,
+            const std::vector<size_t>& refs)
+            : m_pidls(pidls), m_refs(refs) {}
+
+        void operator()() const
+        {
+            apidl_intern_table table;
+            std::vector<interned_apidl> handles(m_refs.size());
+            for (size_t i = 0; i < m_refs.size(); ++i)
+            {
+                handles[i] = table.intern(pidl_at(m_pidls, m_refs[i]));
+            }
+            keep(handles.back());
+        }
+
+        const std::vector< std::vector<BYTE> >& m_pidls;
+        const std::vector<size_t>& m_refs;
+    };
+
+    /**
+     * Look up PIDLs that are already in the table.
+     */
+    struct intern_hits
+    {
+        intern_hits(
+            apidl_intern_table& table,
+            const std::vector< std::vector<BYTE> >& pidls,
+            const std::vector<size_t>& refs)
+            : m_table(table), m_pidls(pidls), m_refs(refs) {}
+
+        void operator()() const
+        {
+            for (size_t i = 0; i < m_refs.size(); ++i)
+            {
+                interned_apidl handle =
+                    m_table.intern(pidl_at(m_pidls, m_refs[i]));
+                keep(handle);
+            }
+        }
+
+        apidl_intern_table& m_table;
+        const std::vector< std::vector<BYTE> >& m_pidls;
+        const std::vector<size_t>& m_refs;
+    };
+
+    template<typename Pidl>
+    struct compare_neighbours
+    {
+        explicit compare_neighbours(const std::vector<Pidl>& pidls)
+            : m_pidls(pidls) {}
+
+        void operator()() const
+        {
+            size_t equal = 0;
+            for (size_t i = 1; i < m_pidls.size(); ++i)
+            {
+                if (m_pidls[i] == m_pidls[i - 1])
+                    ++equal;
+            }
+            keep(equal);
+        }
+
+        const std::vector<Pidl>& m_pidls;
+    };
+}
+
+/**
+ * Memory and time taken to hold a million references to absolute PIDLs, a
+ * tenth of them distinct, as separate copies compared with interning them.
+ */
+WASHER_BENCHMARK(pidl_intern)
+{
+    std::vector< std::vector<BYTE> > pidls = distinct_pidls();
+    std::vector<size_t> refs = references();
+
+    measure("copy 1M apidl_t", 3, copy_all(pidls, refs));
+    measure("intern 1M into empty table", 3, intern_all(pidls, refs));
+
+    apidl_intern_table table;
+    std::vector<apidl_t> copies(reference_count);
+    std::vector<interned_apidl> handles(reference_count);
+    size_t copied_bytes = 0;
+    for (size_t i = 0; i < reference_count; ++i)
+    {
+        copies[i] = pidl_at(pidls, refs[i]);
+        handles[i] = table.intern(copies[i]);
+        copied_bytes += copies[i].size();
+    }
+
+    measure("intern 1M already in table", 3, intern_hits(table, pidls, refs));
+    measure(
+        "compare 1M apidl_t neighbours", 3,
+        compare_neighbours<apidl_t>(copies));
+    measure(
+        "compare 1M interned neighbours", 3,
+        compare_neighbours<interned_apidl>(handles));
+
+    // Allocator overhead is left out of both sides
+    double separate =
+        static_cast<double>(copied_bytes + reference_count * sizeof(apidl_t));
+    double interned = static_cast<double>(
+        table.bytes() +
+        table.size() *
+            sizeof(washer::shell::pidl::detail::interned_entry) +
+        reference_count * sizeof(interned_apidl));
+
+    report_quantity("distinct PIDLs interned", table.size(), "PIDLs");
+    report_quantity("memory as separate copies", separate / 1048576, "MiB");
+    report_quantity("memory interned", interned / 1048576, "MiB");
+    report_quantity("memory saved", 100 * (1 - interned / separate), "%");
+}
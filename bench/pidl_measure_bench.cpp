@@ -0,0 +1,188 @@
+/**
+    @file
+
+    Benchmarks for measuring and navigating wrapped PIDLs.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#include "benchmark.hpp"
+#include "pidl_fixtures.hpp"
+
+#include <washer/shell/pidl.hpp> // apidl_t, cpidl_t, raw_pidl
+
+#include <boost/lexical_cast.hpp> // lexical_cast
+
+#include <string>
+#include <vector>
+
+using washer::bench::as_pidl;
+using washer::bench::keep;
+using washer::bench::measure;
+using washer::bench::synthetic_idlist;
+using washer::shell::pidl::apidl_t;
+using washer::shell::pidl::cpidl_t;
+
+namespace raw_pidl = washer::shell::pidl::raw_pidl;
+
+namespace {
+
+    const size_t repeats = 16;
+
+    /**
+     * Ask for the size of the same PIDL repeatedly by walking its items.
+     */
+    struct walked_size
+    {
+        explicit walked_size(const apidl_t& pidl) : m_pidl(pidl) {}
+
+        void operator()() const
+        {
+            size_t total = 0;
+            for (size_t i = 0; i < repeats; ++i)
+            {
+                total += raw_pidl::size(m_pidl.get());
+            }
+            keep(total);
+        }
+
+        apidl_t m_pidl;
+    };
+
+    /**
+     * Ask the wrapper for the size of its PIDL repeatedly.
+     */
+    struct cached_size
+    {
+        explicit cached_size(const apidl_t& pidl) : m_pidl(pidl) {}
+
+        void operator()() const
+        {
+            size_t total = 0;
+            for (size_t i = 0; i < repeats; ++i)
+            {
+                total += m_pidl.size();
+            }
+            keep(total);
+        }
+
+        apidl_t m_pidl;
+    };
+
+    /**
+     * Find the last item by walking to it and copy it.
+     */
+    struct walked_last_item
+    {
+        explicit walked_last_item(const apidl_t& pidl) : m_pidl(pidl) {}
+
+        void operator()() const
+        {
+            cpidl_t item(raw_pidl::last(m_pidl.get()));
+            keep(item);
+        }
+
+        apidl_t m_pidl;
+    };
+
+    struct cached_last_item
+    {
+        explicit cached_last_item(const apidl_t& pidl) : m_pidl(pidl) {}
+
+        void operator()() const
+        {
+            cpidl_t item(m_pidl.last_item());
+            keep(item);
+        }
+
+        apidl_t m_pidl;
+    };
+
+    /**
+     * Find the parent by copying the whole PIDL, walking the copy to its
+     * last item and terminating it there.
+     */
+    struct walked_parent
+    {
+        explicit walked_parent(const apidl_t& pidl) : m_pidl(pidl) {}
+
+        void operator()() const
+        {
+            apidl_t parent(m_pidl.get());
+            const ITEMID_CHILD __unaligned* last =
+                raw_pidl::last(parent.get());
+            const_cast<ITEMID_CHILD __unaligned*>(last)->mkid.cb = 0;
+            keep(parent);
+        }
+
+        apidl_t m_pidl;
+    };
+
+    struct cached_parent
+    {
+        explicit cached_parent(const apidl_t& pidl) : m_pidl(pidl) {}
+
+        void operator()() const
+        {
+            apidl_t parent(m_pidl.parent());
+            keep(parent);
+        }
+
+        apidl_t m_pidl;
+    };
+}
+
+/**
+ * Cost of size(), last_item() and parent() on deep PIDLs using the sizes
+ * remembered by the wrapper compared with walking the item list each time.
+ */
+WASHER_BENCHMARK(pidl_measurements)
+{
+    const size_t depths[] = { 4, 16, 64, 256 };
+    for (size_t d = 0; d < sizeof(depths) / sizeof(depths[0]); ++d)
+    {
+        size_t depth = depths[d];
+        std::vector<BYTE> buffer = synthetic_idlist(depth, 40);
+        apidl_t pidl(as_pidl<ITEMIDLIST_ABSOLUTE>(buffer));
+
+        size_t iterations = 4000000 / depth;
+        std::string suffix =
+            " (depth " + boost::lexical_cast<std::string>(depth) + ")";
+
+        measure(
+            "walked size x16" + suffix, iterations, walked_size(pidl));
+        measure(
+            "cached size x16" + suffix, iterations, cached_size(pidl));
+        measure(
+            "walked last_item" + suffix, iterations, walked_last_item(pidl));
+        measure(
+            "cached last_item" + suffix, iterations, cached_last_item(pidl));
+        measure(
+            "walked parent" + suffix, iterations, walked_parent(pidl));
+        measure(
+            "cached parent" + suffix, iterations, cached_parent(pidl));
+    }
+}
@@ -0,0 +1,132 @@
+/**
+    @file
+
+    Benchmarks of parsing PIDLs from untrusted buffers.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#include "benchmark.hpp"
+#include "pidl_fixtures.hpp"
+
+#include <washer/shell/pidl.hpp> // raw_pidl
+#include <washer/shell/pidl_parse.hpp> // parse_pidl
+
+#include <boost/lexical_cast.hpp> // lexical_cast
+
+#include <cstddef> // size_t
+#include <string>
+#include <vector>
+
+using washer::bench::keep;
+using washer::bench::measure;
+using washer::bench::opaque;
+using washer::bench::synthetic_idlist;
+using washer::shell::pidl::apidl_view;
+using washer::shell::pidl::parse_ok;
+using washer::shell::pidl::parse_pidl;
+
+namespace raw_pidl = washer::shell::pidl::raw_pidl;
+
+namespace {
+
+    /**
+     * Today's trusting walk, which only finds the size.
+     */
+    struct raw_size
+    {
+        explicit raw_size(const std::vector<BYTE>& buffer)
+            : m_buffer(buffer) {}
+
+        void operator()() const
+        {
+            keep(opaque(raw_pidl::size(opaque(
+                reinterpret_cast<PCIDLIST_ABSOLUTE>(&m_buffer[0])))));
+        }
+
+        const std::vector<BYTE>& m_buffer;
+    };
+
+    /**
+     * Trusting walk that finds the same size and item count as parsing.
+     */
+    struct raw_measure
+    {
+        explicit raw_measure(const std::vector<BYTE>& buffer)
+            : m_buffer(buffer) {}
+
+        void operator()() const
+        {
+            raw_pidl::extent e = raw_pidl::measure(opaque(
+                reinterpret_cast<PCIDLIST_ABSOLUTE>(&m_buffer[0])));
+            keep(opaque(e.size + e.item_count));
+        }
+
+        const std::vector<BYTE>& m_buffer;
+    };
+
+    /**
+     * Bounds-checked walk, which also counts the items.
+     */
+    struct parse
+    {
+        explicit parse(const std::vector<BYTE>& buffer)
+            : m_buffer(buffer) {}
+
+        void operator()() const
+        {
+            apidl_view view;
+            if (parse_pidl(
+                    opaque(&m_buffer[0]), m_buffer.size(), view) == parse_ok)
+                keep(opaque(view.item_bytes() + view.item_count()));
+        }
+
+        const std::vector<BYTE>& m_buffer;
+    };
+}
+
+/**
+ * Validating a PIDL from an untrusted buffer compared with the walk that
+ * raw_pidl::size and raw_pidl::measure do without any checks.
+ */
+WASHER_BENCHMARK(pidl_parse)
+{
+    const size_t depths[] = { 1, 4, 16, 64, 256 };
+    for (size_t d = 0; d < sizeof(depths) / sizeof(depths[0]); ++d)
+    {
+        size_t depth = depths[d];
+        std::vector<BYTE> buffer = synthetic_idlist(depth, 24);
+
+        size_t iterations = 20000000 / (depth + 4);
+        std::string suffix =
+            " (depth " + boost::lexical_cast<std::string>(depth) + ")";
+
+        measure("raw_pidl::size" + suffix, iterations, raw_size(buffer));
+        measure(
+            "raw_pidl::measure" + suffix, iterations, raw_measure(buffer));
+        measure("parse_pidl" + suffix, iterations, parse(buffer));
+    }
+}
@@ -0,0 +1,184 @@
+/**
+    @file
+
+    Benchmarks of finding the common prefix of many PIDLs.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#include "benchmark.hpp"
+#include "pidl_fixtures.hpp"
+
+#include <washer/shell/pidl.hpp> // apidl_t, pidl_t
+#include <washer/shell/pidl_iterator.hpp> // pidl_iterator
+#include <washer/shell/pidl_prefix.hpp> // common_prefix, split_common_prefix
+
+#include <cstddef> // size_t
+#include <cstring> // memcpy
+#include <vector>
+
+using washer::bench::as_pidl;
+using washer::bench::keep;
+using washer::bench::measure;
+using washer::bench::synthetic_idlist;
+using washer::shell::pidl::apidl_t;
+using washer::shell::pidl::apidl_view;
+using washer::shell::pidl::common_prefix;
+using washer::shell::pidl::cpidl_t;
+using washer::shell::pidl::pidl_iterator;
+using washer::shell::pidl::pidl_t;
+using washer::shell::pidl::pidl_view;
+using washer::shell::pidl::split_common_prefix;
+
+namespace {
+
+    const size_t pidl_count = 10000;
+    const size_t shared_depth = 12;
+    const size_t unique_depth = 4;
+    const size_t item_size = 32;
+
+    /**
+     * Does @a pidl start with the items of @a prefix?  Compared an item at
+     * a time through pidl_iterator.
+     */
+    bool starts_with(const apidl_t& prefix, const apidl_t& pidl)
+    {
+        pidl_iterator p(prefix), end;
+        pidl_iterator it(pidl);
+        for (; p != end; ++p, ++it)
+        {
+            if (it == end)
+                return false;
+
+            const cpidl_t& lhs = *p;
+            const cpidl_t& rhs = *it;
+            if (lhs.size() != rhs.size() ||
+                std::memcmp(lhs.get(), rhs.get(), lhs.size()) != 0)
+                return false;
+        }
+        return true;
+    }
+
+    /**
+     * The way it used to be done: take the first PIDL and clone its parent
+     * until it is a prefix of every PIDL, then copy out what is left of
+     * each one.
+     */
+    struct clone_parents
+    {
+        explicit clone_parents(const std::vector<apidl_t>& pidls)
+            : m_pidls(pidls) {}
+
+        void operator()() const
+        {
+            apidl_t ancestor = m_pidls[0];
+            for (size_t i = 1; i < m_pidls.size(); ++i)
+            {
+                while (!starts_with(ancestor, m_pidls[i]))
+                {
+                    ancestor = ancestor.parent();
+                }
+            }
+
+            size_t skip = ancestor.item_count();
+            std::vector<pidl_t> relatives(m_pidls.size());
+            for (size_t i = 0; i < m_pidls.size(); ++i)
+            {
+                pidl_iterator it(m_pidls[i]), end;
+                for (size_t n = 0; n < skip; ++n)
+                {
+                    ++it;
+                }
+                for (; it != end; ++it)
+                {
+                    relatives[i] += *it;
+                }
+            }
+
+            keep(relatives.back());
+        }
+
+        const std::vector<apidl_t>& m_pidls;
+    };
+
+    struct prefix_only
+    {
+        explicit prefix_only(const std::vector<apidl_t>& pidls)
+            : m_pidls(pidls) {}
+
+        void operator()() const
+        {
+            apidl_view prefix = common_prefix(m_pidls.begin(), m_pidls.end());
+            keep(prefix);
+        }
+
+        const std::vector<apidl_t>& m_pidls;
+    };
+
+    struct prefix_and_relatives
+    {
+        explicit prefix_and_relatives(const std::vector<apidl_t>& pidls)
+            : m_pidls(pidls) {}
+
+        void operator()() const
+        {
+            std::vector<pidl_view> relatives(m_pidls.size());
+            apidl_view prefix = split_common_prefix(
+                m_pidls.begin(), m_pidls.end(), relatives.begin());
+            keep(prefix);
+            keep(relatives.back());
+        }
+
+        const std::vector<apidl_t>& m_pidls;
+    };
+}
+
+/**
+ * Common ancestor of, and relative paths for, a selection of 10,000
+ * PIDLs 16 items deep that share their first 12 items.
+ */
+WASHER_BENCHMARK(pidl_common_prefix)
+{
+    std::vector<BYTE> shared = synthetic_idlist(shared_depth, item_size);
+    shared.resize(shared.size() - sizeof(USHORT));
+
+    std::vector<apidl_t> pidls(pidl_count);
+    for (size_t i = 0; i < pidl_count; ++i)
+    {
+        std::vector<BYTE> bytes = shared;
+        std::vector<BYTE> tail = synthetic_idlist(unique_depth, item_size, i);
+        std::memcpy(&tail[sizeof(USHORT)], &i, sizeof(i));
+        bytes.insert(bytes.end(), tail.begin(), tail.end());
+
+        pidls[i] = as_pidl<ITEMIDLIST_ABSOLUTE>(bytes);
+    }
+
+    measure(
+        "parent() clones and pidl_iterator (10k)", 5, clone_parents(pidls));
+    measure("common_prefix (10k)", 200, prefix_only(pidls));
+    measure(
+        "split_common_prefix (10k)", 200, prefix_and_relatives(pidls));
+}
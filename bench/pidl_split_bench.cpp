@@ -0,0 +1,168 @@
+/**
+    @file
+
+    Benchmarks of splitting PIDLs into parent and last item.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#include "benchmark.hpp"
+#include "pidl_fixtures.hpp"
+
+#include <washer/shell/pidl.hpp> // apidl_t, cpidl_t
+#include <washer/shell/pidl_split.hpp> // split_apidl
+#include <washer/shell/pidl_view.hpp> // apidl_view, basic_split_view
+
+#include <boost/lexical_cast.hpp> // lexical_cast
+
+#include <cstddef> // size_t
+#include <string>
+#include <vector>
+
+using washer::bench::as_pidl;
+using washer::bench::keep;
+using washer::bench::measure;
+using washer::bench::opaque;
+using washer::bench::synthetic_idlist;
+using washer::shell::pidl::apidl_t;
+using washer::shell::pidl::apidl_view;
+using washer::shell::pidl::basic_split_view;
+using washer::shell::pidl::cpidl_t;
+using washer::shell::pidl::cpidl_view;
+using washer::shell::pidl::split_apidl;
+
+namespace {
+
+    /**
+     * Copy the parent and last item separately, as we do today.
+     */
+    struct wrapper_parent_and_last_item
+    {
+        explicit wrapper_parent_and_last_item(const apidl_t& pidl)
+            : m_pidl(pidl) {}
+
+        void operator()() const
+        {
+            const apidl_t& pidl = *opaque(&m_pidl);
+            apidl_t parent = pidl.parent();
+            cpidl_t child = pidl.last_item();
+            keep(opaque(parent.size() + child.size()));
+        }
+
+        const apidl_t& m_pidl;
+    };
+
+    struct wrapper_split
+    {
+        explicit wrapper_split(const apidl_t& pidl) : m_pidl(pidl) {}
+
+        void operator()() const
+        {
+            basic_split_view<ITEMIDLIST_ABSOLUTE> split =
+                opaque(&m_pidl)->split();
+            keep(opaque(split.parent.size() + split.child.size()));
+        }
+
+        const apidl_t& m_pidl;
+    };
+
+    struct wrapper_owning_split
+    {
+        explicit wrapper_owning_split(const apidl_t& pidl) : m_pidl(pidl) {}
+
+        void operator()() const
+        {
+            split_apidl split(*opaque(&m_pidl));
+            keep(opaque(split.allocated_bytes()));
+        }
+
+        const apidl_t& m_pidl;
+    };
+
+    struct view_parent_and_last
+    {
+        explicit view_parent_and_last(apidl_view view) : m_view(view) {}
+
+        void operator()() const
+        {
+            apidl_view view = *opaque(&m_view);
+            apidl_view parent = view.parent();
+            cpidl_view child = view.last();
+            keep(opaque(parent.size() + child.size()));
+        }
+
+        apidl_view m_view;
+    };
+
+    struct view_split
+    {
+        explicit view_split(apidl_view view) : m_view(view) {}
+
+        void operator()() const
+        {
+            basic_split_view<ITEMIDLIST_ABSOLUTE> split =
+                opaque(&m_view)->split();
+            keep(opaque(split.parent.size() + split.child.size()));
+        }
+
+        apidl_view m_view;
+    };
+}
+
+/**
+ * Getting both the parent and the last item of a PIDL, separately and
+ * with split().
+ */
+WASHER_BENCHMARK(pidl_split)
+{
+    const size_t depths[] = { 2, 8, 32 };
+    for (size_t d = 0; d < sizeof(depths) / sizeof(depths[0]); ++d)
+    {
+        size_t depth = depths[d];
+        std::vector<BYTE> buffer = synthetic_idlist(depth, 24);
+        apidl_t pidl(as_pidl<ITEMIDLIST_ABSOLUTE>(buffer));
+        apidl_view view(pidl);
+
+        size_t iterations = 2000000;
+        std::string suffix =
+            " (depth " + boost::lexical_cast<std::string>(depth) + ")";
+
+        measure(
+            "apidl_t parent() + last_item()" + suffix, iterations,
+            wrapper_parent_and_last_item(pidl));
+        measure(
+            "apidl_t split() views" + suffix, iterations,
+            wrapper_split(pidl));
+        measure(
+            "split_apidl owning copy" + suffix, iterations,
+            wrapper_owning_split(pidl));
+        measure(
+            "apidl_view parent() + last()" + suffix, iterations,
+            view_parent_and_last(view));
+        measure(
+            "apidl_view split()" + suffix, iterations, view_split(view));
+    }
+}
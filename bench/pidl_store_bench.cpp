@@ -0,0 +1,149 @@
+/**
+    @file
+
+    Benchmarks of reloading PIDLs from a store file.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#include "benchmark.hpp"
+#include "pidl_fixtures.hpp"
+
+#include <washer/shell/pidl.hpp> // cpidl_t
+#include <washer/shell/pidl_store.hpp> // pidl_store_writer, mapped_cpidl_store
+
+#include <cstddef> // size_t
+#include <cstdio> // remove
+#include <fstream> // ifstream
+#include <iterator> // istreambuf_iterator
+#include <vector>
+
+using washer::bench::keep;
+using washer::bench::measure;
+using washer::bench::opaque;
+using washer::bench::report_quantity;
+using washer::bench::synthetic_idlist;
+using washer::shell::pidl::cpidl_store_view;
+using washer::shell::pidl::cpidl_t;
+using washer::shell::pidl::cpidl_view;
+using washer::shell::pidl::mapped_cpidl_store;
+using washer::shell::pidl::pidl_store_writer;
+using washer::shell::pidl::skip_checksum;
+using washer::shell::pidl::store_check;
+using washer::shell::pidl::verify_checksum;
+
+namespace {
+
+    const char* store_file = "washer_pidl_store_bench.tmp";
+
+    /**
+     * Reload the way we do without a store: read the file and clone each
+     * PIDL into its own cpidl_t.
+     */
+    struct clone_each
+    {
+        void operator()() const
+        {
+            std::ifstream file(store_file, std::ios::binary);
+            std::vector<BYTE> bytes(
+                (std::istreambuf_iterator<char>(file)),
+                std::istreambuf_iterator<char>());
+
+            cpidl_store_view store(&bytes[0], bytes.size(), skip_checksum);
+
+            std::vector<cpidl_t> pidls;
+            pidls.reserve(store.size());
+            for (cpidl_store_view::const_iterator it = store.begin();
+                 it != store.end(); ++it)
+            {
+                pidls.push_back(cpidl_t(it->data()));
+            }
+            keep(opaque(pidls.size()));
+        }
+    };
+
+    /**
+     * Map the store and look at every PIDL in place.
+     */
+    struct map_store
+    {
+        explicit map_store(store_check check)
+            : m_check(check), m_bytes(0) {}
+
+        void operator()() const
+        {
+            mapped_cpidl_store store(store_file, m_check);
+
+            size_t bytes = 0;
+            for (cpidl_store_view::const_iterator it = store.view().begin();
+                 it != store.view().end(); ++it)
+            {
+                bytes += it->item_bytes();
+            }
+            m_bytes = opaque(bytes);
+            keep(m_bytes);
+        }
+
+        store_check m_check;
+        mutable size_t m_bytes;
+    };
+}
+
+/**
+ * Reloading a million child PIDLs by cloning each one compared with
+ * mapping a store of them.  The file is in the page cache throughout, so
+ * this measures the cost of the loading strategy rather than of the disk.
+ */
+WASHER_BENCHMARK(pidl_store)
+{
+    const size_t count = 1000000;
+    {
+        pidl_store_writer writer(store_file);
+        for (size_t i = 0; i < count; ++i)
+        {
+            std::vector<BYTE> pidl = synthetic_idlist(1, 24, i);
+            writer.push_back(reinterpret_cast<PCUITEMID_CHILD>(&pidl[0]));
+        }
+        writer.commit();
+    }
+
+    {
+        std::ifstream file(store_file, std::ios::binary | std::ios::ate);
+        report_quantity(
+            "store size (1M child PIDLs)",
+            static_cast<double>(file.tellg()) / (1024 * 1024), "MiB");
+    }
+
+    measure("read and clone each PIDL (1M)", 5, clone_each());
+    measure(
+        "map and view each PIDL (1M, verify CRC)", 5,
+        map_store(verify_checksum));
+    measure(
+        "map and view each PIDL (1M, skip CRC)", 5,
+        map_store(skip_checksum));
+
+    std::remove(store_file);
+}
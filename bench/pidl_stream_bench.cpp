@@ -0,0 +1,170 @@
+/**
+    @file
+
+    Benchmarks for streaming PIDLs from bytes.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#include "benchmark.hpp"
+#include "pidl_fixtures.hpp"
+
+#include <washer/shell/pidl.hpp> // apidl_t, raw_pidl
+#include <washer/shell/pidl_stream.hpp> // basic_pidl_reader, pidl_writer
+
+#include <cstddef> // size_t
+#include <vector>
+
+using washer::bench::keep;
+using washer::bench::measure;
+using washer::bench::opaque;
+using washer::bench::report_quantity;
+using washer::bench::synthetic_idlist;
+using washer::shell::pidl::apidl_t;
+using washer::shell::pidl::basic_pidl_reader;
+using washer::shell::pidl::basic_pidl_view;
+using washer::shell::pidl::memory_byte_source;
+using washer::shell::pidl::pidl_writer;
+using washer::shell::pidl::vector_byte_sink;
+
+namespace raw_pidl = washer::shell::pidl::raw_pidl;
+
+namespace {
+
+    typedef basic_pidl_reader<ITEMIDLIST_ABSOLUTE, memory_byte_source>
+        memory_reader;
+
+    const size_t history_length = 100000;
+
+    /**
+     * What reading history does today: copy the whole stream into memory,
+     * then walk it cloning each PIDL.
+     */
+    struct slurp_and_clone
+    {
+        explicit slurp_and_clone(const std::vector<BYTE>& stream)
+            : m_stream(stream) {}
+
+        void operator()() const
+        {
+            memory_byte_source source(&m_stream[0], m_stream.size());
+            std::vector<BYTE> slurped(m_stream.size());
+            source.read(&slurped[0], slurped.size());
+
+            std::vector<apidl_t> pidls;
+            const BYTE* position = &slurped[0];
+            const BYTE* end = position + slurped.size();
+            while (position < end)
+            {
+                const ITEMIDLIST_ABSOLUTE* pidl =
+                    reinterpret_cast<const ITEMIDLIST_ABSOLUTE*>(position);
+                pidls.push_back(apidl_t(pidl));
+                position += raw_pidl::size(pidl);
+            }
+            keep(opaque(pidls.size()));
+        }
+
+        const std::vector<BYTE>& m_stream;
+    };
+
+    struct stream_and_clone
+    {
+        explicit stream_and_clone(const std::vector<BYTE>& stream)
+            : m_stream(stream) {}
+
+        void operator()() const
+        {
+            memory_byte_source source(&m_stream[0], m_stream.size());
+            memory_reader reader(source);
+
+            std::vector<apidl_t> pidls;
+            apidl_t pidl;
+            while (reader.read(pidl))
+            {
+                pidls.push_back(pidl);
+            }
+            keep(opaque(pidls.size()));
+        }
+
+        const std::vector<BYTE>& m_stream;
+    };
+
+    /**
+     * Visit each PIDL without keeping it, such as to search the history.
+     */
+    struct stream_views
+    {
+        explicit stream_views(const std::vector<BYTE>& stream)
+            : m_stream(stream) {}
+
+        void operator()() const
+        {
+            memory_byte_source source(&m_stream[0], m_stream.size());
+            memory_reader reader(source);
+
+            size_t items = 0;
+            basic_pidl_view<ITEMIDLIST_ABSOLUTE> view;
+            while (reader.next(view))
+            {
+                items += view.item_count();
+            }
+            keep(opaque(items));
+        }
+
+        const std::vector<BYTE>& m_stream;
+    };
+}
+
+/**
+ * Reading back 100k PIDLs of navigation history from a stream.
+ */
+WASHER_BENCHMARK(pidl_stream)
+{
+    std::vector<BYTE> stream;
+    {
+        vector_byte_sink sink(stream);
+        pidl_writer<vector_byte_sink> writer(sink);
+        for (size_t i = 0; i < history_length; ++i)
+        {
+            std::vector<BYTE> pidl = synthetic_idlist(1 + i % 12, 24, i);
+            writer.write(
+                reinterpret_cast<const ITEMIDLIST_ABSOLUTE*>(&pidl[0]));
+        }
+        writer.flush();
+    }
+
+    report_quantity(
+        "history stream size (100k)",
+        static_cast<double>(stream.size()) / 1024, "KiB");
+    report_quantity(
+        "reader buffer",
+        static_cast<double>(memory_reader::default_buffer_size) / 1024,
+        "KiB");
+
+    measure("slurp and clone (100k)", 10, slurp_and_clone(stream));
+    measure("stream and clone (100k)", 10, stream_and_clone(stream));
+    measure("stream views (100k)", 10, stream_views(stream));
+}
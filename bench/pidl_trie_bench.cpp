@@ -0,0 +1,325 @@
+/**
+    @file
+
+    Benchmarks of the PIDL prefix trie.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#include "benchmark.hpp"
+
+#include <washer/shell/pidl.hpp> // apidl_t
+#include <washer/shell/pidl_compare.hpp> // pidl_hash, pidl_equal_to
+#include <washer/shell/pidl_iterator.hpp> // raw_pidl_iterator
+#include <washer/shell/pidl_trie.hpp> // pidl_trie
+#include <washer/shell/pidl_view.hpp> // apidl_view
+
+#include <boost/chrono/chrono.hpp> // steady_clock, duration_cast
+#include <boost/unordered_map.hpp>
+
+#include <cstddef> // size_t
+#include <cstring> // memcpy
+#include <sstream> // ostringstream
+#include <string>
+#include <vector>
+
+using washer::bench::keep;
+using washer::bench::measure;
+using washer::bench::report;
+using washer::shell::pidl::apidl_t;
+using washer::shell::pidl::apidl_view;
+using washer::shell::pidl::pidl_equal_to;
+using washer::shell::pidl::pidl_hash;
+using washer::shell::pidl::raw_pidl_iterator;
+
+namespace {
+
+    typedef washer::shell::pidl::pidl_trie<size_t> pidl_trie_type;
+    typedef boost::unordered_map<apidl_t, size_t, pidl_hash, pidl_equal_to>
+        pidl_map;
+
+    typedef std::vector<BYTE> buffer;
+
+    const size_t fan_out = 10;
+    const size_t item_size = 16;
+    const size_t query_count = 100000;
+
+    /**
+     * Append an item identifying the @a index'th child at @a level.
+     */
+    void push_item(buffer& path, size_t level, size_t index)
+    {
+        size_t offset = path.size();
+        path.resize(offset + item_size, 0);
+        reinterpret_cast<SHITEMID*>(&path[offset])->cb =
+            static_cast<USHORT>(item_size);
+        std::memcpy(&path[offset + sizeof(USHORT)], &level, sizeof(level));
+        std::memcpy(
+            &path[offset + sizeof(USHORT) + sizeof(level)], &index,
+            sizeof(index) / 2);
+    }
+
+    buffer terminated(buffer path)
+    {
+        path.resize(path.size() + sizeof(USHORT), 0);
+        return path;
+    }
+
+    /**
+     * Every node of a complete tree with the given fan-out, down to
+     * @a levels below the desktop, as a shell namespace might be.
+     */
+    void tree_keys(
+        buffer& path, size_t level, size_t levels, std::vector<buffer>& keys)
+    {
+        if (level == levels)
+            return;
+
+        for (size_t i = 0; i < fan_out; ++i)
+        {
+            buffer child = path;
+            push_item(child, level, i);
+            keys.push_back(terminated(child));
+            tree_keys(child, level + 1, levels, keys);
+        }
+    }
+
+    const ITEMIDLIST_ABSOLUTE* as_absolute(const buffer& key)
+    {
+        return reinterpret_cast<const ITEMIDLIST_ABSOLUTE*>(&key[0]);
+    }
+
+    /**
+     * PIDLs below entries in the tree but not themselves entries, so that
+     * the longest prefix is a few items short of the whole PIDL.
+     */
+    std::vector<buffer> queries(const std::vector<buffer>& keys)
+    {
+        std::vector<buffer> result(query_count);
+        size_t state = 12345;
+        for (size_t i = 0; i < query_count; ++i)
+        {
+            state = state * 1103515245 + 12345;
+            buffer path = keys[(state >> 8) % keys.size()];
+            path.resize(path.size() - sizeof(USHORT));
+            push_item(path, 1000, i);
+            push_item(path, 1001, i);
+            result[i] = terminated(path);
+        }
+
+        return result;
+    }
+
+    struct trie_longest_prefix
+    {
+        trie_longest_prefix(
+            const pidl_trie_type& trie, const std::vector<buffer>& queries)
+            : m_trie(trie), m_queries(queries) {}
+
+        void operator()() const
+        {
+            size_t found = 0;
+            for (size_t i = 0; i < m_queries.size(); ++i)
+            {
+                if (m_trie.longest_prefix(as_absolute(m_queries[i])))
+                    ++found;
+            }
+            keep(found);
+        }
+
+        const pidl_trie_type& m_trie;
+        const std::vector<buffer>& m_queries;
+    };
+
+    /**
+     * The alternative to a trie: probe a hash table with each ancestor
+     * in turn, longest first.  Ancestors are probed as views so that the
+     * comparison isn't dominated by copying.
+     */
+    struct map_longest_prefix
+    {
+        map_longest_prefix(
+            const pidl_map& map, const std::vector<buffer>& queries)
+            : m_map(map), m_queries(queries) {}
+
+        void operator()() const
+        {
+            size_t found = 0;
+            std::vector<size_t> offsets;
+            for (size_t i = 0; i < m_queries.size(); ++i)
+            {
+                const ITEMIDLIST_ABSOLUTE* query = as_absolute(m_queries[i]);
+
+                offsets.assign(1, 0);
+                size_t offset = 0;
+                for (raw_pidl_iterator it(query), end; it != end; ++it)
+                {
+                    offset += (*it)->mkid.cb;
+                    offsets.push_back(offset);
+                }
+
+                for (size_t n = offsets.size(); n-- > 0; )
+                {
+                    apidl_view ancestor(
+                        query, offsets[n] + sizeof(USHORT), n);
+                    if (m_map.find(ancestor, pidl_hash(), pidl_equal_to()) !=
+                        m_map.end())
+                    {
+                        ++found;
+                        break;
+                    }
+                }
+            }
+            keep(found);
+        }
+
+        const pidl_map& m_map;
+        const std::vector<buffer>& m_queries;
+    };
+
+    /**
+     * Remove every entry in a hash table under the prefix by checking
+     * each one.
+     */
+    size_t map_erase_under(pidl_map& map, const buffer& prefix)
+    {
+        size_t prefix_bytes = prefix.size() - sizeof(USHORT);
+        size_t erased = 0;
+        for (pidl_map::iterator it = map.begin(); it != map.end(); )
+        {
+            if (it->first.size() - sizeof(USHORT) >= prefix_bytes &&
+                std::memcmp(it->first.get(), &prefix[0], prefix_bytes) == 0)
+            {
+                it = map.erase(it);
+                ++erased;
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        return erased;
+    }
+
+    template<typename Operation>
+    void time_once(const std::string& label, Operation operation)
+    {
+        typedef boost::chrono::steady_clock clock;
+
+        clock::time_point start = clock::now();
+        keep(operation());
+        clock::time_point end = clock::now();
+
+        report(
+            label, 1,
+            boost::chrono::duration_cast<boost::chrono::nanoseconds>(
+                end - start));
+    }
+
+    struct trie_erase
+    {
+        trie_erase(pidl_trie_type& trie, const buffer& prefix)
+            : m_trie(trie), m_prefix(prefix) {}
+
+        size_t operator()() const
+        {
+            return m_trie.erase_under(as_absolute(m_prefix));
+        }
+
+        pidl_trie_type& m_trie;
+        const buffer& m_prefix;
+    };
+
+    struct map_erase
+    {
+        map_erase(pidl_map& map, const buffer& prefix)
+            : m_map(map), m_prefix(prefix) {}
+
+        size_t operator()() const
+        {
+            return map_erase_under(m_map, m_prefix);
+        }
+
+        pidl_map& m_map;
+        const buffer& m_prefix;
+    };
+
+    std::string label(const char* text, size_t entries)
+    {
+        std::ostringstream stream;
+        stream << text << " (" << entries << " entries)";
+        return stream.str();
+    }
+
+    /**
+     * Compare the trie with a flat hash table for a tree @a levels deep.
+     *
+     * Subtree erasure removes one of the desktop's children, a tenth of
+     * all entries, and is timed once on each structure since it is
+     * destructive.
+     */
+    void compare_with_map(size_t levels)
+    {
+        std::vector<buffer> keys;
+        buffer root;
+        tree_keys(root, 0, levels, keys);
+
+        pidl_trie_type trie;
+        pidl_map map;
+        for (size_t i = 0; i < keys.size(); ++i)
+        {
+            trie.insert(as_absolute(keys[i]), i);
+            map[apidl_t(as_absolute(keys[i]))] = i;
+        }
+
+        std::vector<buffer> probes = queries(keys);
+        measure(
+            label("trie longest_prefix x100k", keys.size()), 3,
+            trie_longest_prefix(trie, probes));
+        measure(
+            label("hash map ancestor probes x100k", keys.size()), 3,
+            map_longest_prefix(map, probes));
+
+        const buffer& subtree = keys[0];
+        time_once(
+            label("trie erase_under a tenth", keys.size()),
+            trie_erase(trie, subtree));
+        time_once(
+            label("hash map scan-and-erase a tenth", keys.size()),
+            map_erase(map, subtree));
+    }
+}
+
+/**
+ * Longest-prefix lookup and subtree removal over trees of about 10^5 and
+ * 10^6 absolute PIDLs.
+ */
+WASHER_BENCHMARK(pidl_trie)
+{
+    compare_with_map(5);
+    compare_with_map(6);
+}
@@ -0,0 +1,154 @@
+/**
+    @file
+
+    Benchmarks of copying shared PIDLs across threads.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#include "benchmark.hpp"
+#include "pidl_fixtures.hpp"
+
+#include <washer/shell/pidl.hpp> // apidl_t
+#include <washer/shell/shared_pidl.hpp> // shared_apidl
+
+#include <boost/chrono/chrono.hpp> // steady_clock, duration_cast
+#include <boost/lexical_cast.hpp> // lexical_cast
+#include <boost/thread/thread.hpp> // thread_group
+
+#include <cstddef> // size_t
+#include <string>
+#include <vector>
+
+using washer::bench::as_pidl;
+using washer::bench::keep;
+using washer::bench::report;
+using washer::bench::synthetic_idlist;
+using washer::shell::pidl::apidl_t;
+using washer::shell::pidl::shared_apidl;
+
+namespace {
+
+    const size_t copies_per_thread = 1000000;
+
+    /**
+     * Copy a PIDL into a small ring of slots, so each copy also destroys
+     * an older one, the way handing PIDLs to workers and caches does.
+     */
+    template<typename Pidl>
+    class copier
+    {
+    public:
+        explicit copier(const Pidl& pidl) : m_pidl(pidl) {}
+
+        void operator()() const
+        {
+            std::vector<Pidl> slots(8);
+            for (size_t i = 0; i < copies_per_thread; ++i)
+            {
+                slots[i % slots.size()] = m_pidl;
+            }
+            keep(slots[0].get());
+        }
+
+    private:
+        const Pidl& m_pidl;
+    };
+
+    /**
+     * Run one copier per PIDL, each on its own thread, and report the
+     * wall-clock time per copy across all of them.
+     */
+    template<typename Pidl>
+    void measure_threads(
+        const std::string& label, const std::vector<const Pidl*>& pidls)
+    {
+        typedef boost::chrono::steady_clock clock;
+
+        clock::time_point start = clock::now();
+        boost::thread_group threads;
+        for (size_t t = 0; t < pidls.size(); ++t)
+        {
+            threads.create_thread(copier<Pidl>(*pidls[t]));
+        }
+        threads.join_all();
+        clock::time_point end = clock::now();
+
+        report(
+            label, copies_per_thread * pidls.size(),
+            boost::chrono::duration_cast<boost::chrono::nanoseconds>(
+                end - start));
+    }
+}
+
+/**
+ * Copying an absolute PIDL from several threads at once: deep clones,
+ * shared PIDLs that all refer to one block, so every copy contends for
+ * the same reference count, and shared PIDLs with a block per thread.
+ * Times are wall-clock per copy across all threads, so perfect scaling
+ * shows as the time falling in proportion to the thread count.
+ */
+WASHER_BENCHMARK(shared_pidl_copy)
+{
+    const size_t max_threads = 8;
+    const size_t depths[] = { 4, 32 };
+    for (size_t d = 0; d < sizeof(depths) / sizeof(depths[0]); ++d)
+    {
+        std::vector<BYTE> buffer = synthetic_idlist(depths[d], 24);
+        apidl_t cloned(as_pidl<ITEMIDLIST_ABSOLUTE>(buffer));
+        shared_apidl shared(cloned);
+
+        std::vector<shared_apidl> per_thread_shared;
+        for (size_t t = 0; t < max_threads; ++t)
+        {
+            per_thread_shared.push_back(shared_apidl(cloned));
+        }
+
+        for (size_t threads = 1; threads <= max_threads; threads *= 2)
+        {
+            std::string suffix =
+                " (depth " + boost::lexical_cast<std::string>(depths[d]) +
+                ", " + boost::lexical_cast<std::string>(threads) +
+                " threads)";
+
+            measure_threads(
+                "apidl_t deep clone" + suffix,
+                std::vector<const apidl_t*>(threads, &cloned));
+
+            measure_threads(
+                "shared_apidl, one block" + suffix,
+                std::vector<const shared_apidl*>(threads, &shared));
+
+            std::vector<const shared_apidl*> separate;
+            for (size_t t = 0; t < threads; ++t)
+            {
+                separate.push_back(&per_thread_shared[t]);
+            }
+            measure_threads(
+                "shared_apidl, block per thread" + suffix, separate);
+        }
+    }
+}
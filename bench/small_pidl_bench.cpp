@@ -0,0 +1,139 @@
+/**
+    @file
+
+    Benchmarks comparing inline small PIDLs with heap-allocated clones.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#include "benchmark.hpp"
+#include "pidl_fixtures.hpp"
+
+#include <washer/shell/pidl.hpp> // cpidl_t, raw_pidl::clone
+#include <washer/shell/small_pidl.hpp> // small_cpidl_t
+
+#include <boost/lexical_cast.hpp> // lexical_cast
+
+#include <string>
+#include <vector>
+
+using washer::bench::as_pidl;
+using washer::bench::keep;
+using washer::bench::measure;
+using washer::bench::synthetic_idlist;
+using washer::shell::pidl::cpidl_t;
+using washer::shell::pidl::small_cpidl_t;
+
+namespace raw_pidl = washer::shell::pidl::raw_pidl;
+
+namespace {
+
+    const size_t iterations = 2000000;
+
+    struct raw_clone
+    {
+        explicit raw_clone(PCUITEMID_CHILD pidl) : m_pidl(pidl) {}
+
+        void operator()() const
+        {
+            ITEMID_CHILD* copy =
+                raw_pidl::clone<cpidl_t::allocator>(m_pidl);
+            keep(copy);
+            cpidl_t::allocator::deallocate(copy);
+        }
+
+        PCUITEMID_CHILD m_pidl;
+    };
+
+    template<typename Wrapper>
+    struct construct_wrapper
+    {
+        explicit construct_wrapper(PCUITEMID_CHILD pidl) : m_pidl(pidl) {}
+
+        void operator()() const
+        {
+            Wrapper copy(m_pidl);
+            keep(copy);
+        }
+
+        PCUITEMID_CHILD m_pidl;
+    };
+
+    template<typename Wrapper>
+    struct copy_wrapper
+    {
+        explicit copy_wrapper(const Wrapper& pidl) : m_pidl(pidl) {}
+
+        void operator()() const
+        {
+            Wrapper copy(m_pidl);
+            keep(copy);
+        }
+
+        Wrapper m_pidl;
+    };
+
+    void compare_child_copies(size_t item_size)
+    {
+        std::vector<BYTE> buffer = synthetic_idlist(1, item_size);
+        PCUITEMID_CHILD pidl = as_pidl<ITEMID_CHILD>(buffer);
+
+        std::string suffix =
+            " (" + boost::lexical_cast<std::string>(item_size) + "-byte item)";
+
+        measure("raw_pidl::clone" + suffix, iterations, raw_clone(pidl));
+        measure(
+            "cpidl_t from raw" + suffix, iterations,
+            construct_wrapper<cpidl_t>(pidl));
+        measure(
+            "small_cpidl_t from raw" + suffix, iterations,
+            construct_wrapper<small_cpidl_t>(pidl));
+        measure(
+            "cpidl_t copy" + suffix, iterations,
+            copy_wrapper<cpidl_t>(cpidl_t(pidl)));
+        measure(
+            "small_cpidl_t copy" + suffix, iterations,
+            copy_wrapper<small_cpidl_t>(small_cpidl_t(pidl)));
+    }
+}
+
+/**
+ * Child PIDLs small enough to be stored inline.
+ */
+WASHER_BENCHMARK(small_pidl_inline_child)
+{
+    compare_child_copies(24);
+    compare_child_copies(48);
+}
+
+/**
+ * Child PIDLs too large for the inline buffer so small PIDLs spill to the
+ * heap like basic_pidl.
+ */
+WASHER_BENCHMARK(small_pidl_spilled_child)
+{
+    compare_child_copies(200);
+}
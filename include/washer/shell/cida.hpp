@@ -0,0 +1,423 @@
+/**
+    @file
+
+    Reading and writing the shell's CIDA (CFSTR_SHELLIDLIST) format.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#ifndef WASHER_SHELL_CIDA_HPP
+#define WASHER_SHELL_CIDA_HPP
+#pragma once
+
+#include <washer/shell/detail/indexed_iterator.hpp> // indexed_iterator
+#include <washer/shell/pidl_parse.hpp> // validate_pidl
+#include <washer/shell/pidl_view.hpp> // apidl_view, pidl_view, measure_items
+
+#include <boost/static_assert.hpp> // BOOST_STATIC_ASSERT
+#include <boost/throw_exception.hpp> // BOOST_THROW_EXCEPTION
+#include <boost/type_traits/is_convertible.hpp> // is_convertible
+
+#include <cassert> // assert
+#include <cstddef> // size_t
+#include <cstring> // memcpy
+#include <iterator> // distance, iterator_traits
+#include <limits> // numeric_limits
+#include <stdexcept> // invalid_argument, length_error, out_of_range
+
+#ifdef _WIN32
+#include <washer/error.hpp> // last_error
+#include <washer/global_lock.hpp> // global_lock
+
+#include <boost/exception/errinfo_api_function.hpp> // errinfo_api_function
+#include <boost/exception/info.hpp> // errinfo
+#endif
+
+#include <washer/shell/itemidlist.hpp> // Raw PIDL types
+
+namespace washer {
+namespace shell {
+
+/**
+ * @name  CIDA
+ *
+ * A CIDA is how the shell puts a selection of items on the clipboard or
+ * in a drag-and-drop data object.  It is a count of the children, @c cidl,
+ * followed by @c cidl + 1 offsets from the start of the CIDA: first to
+ * the absolute PIDL of the folder they are in and then to each child's
+ * PIDL relative to it.  The PIDLs follow the offsets.
+ *
+ * The format is handled as plain bytes so that it works on any platform
+ * and with any memory.  On Windows, the memory is usually an HGLOBAL and
+ * cida_to_hglobal() and locked_cida wrap the portable functions with the
+ * allocation and locking.
+ */
+// @{
+
+namespace detail {
+
+    inline void write_uint(BYTE* buffer, size_t index, UINT value)
+    {
+        std::memcpy(buffer + index * sizeof(UINT), &value, sizeof(UINT));
+    }
+
+    inline UINT read_uint(const BYTE* buffer, size_t index)
+    {
+        UINT value;
+        std::memcpy(&value, buffer + index * sizeof(UINT), sizeof(UINT));
+        return value;
+    }
+
+    /**
+     * Bytes before the first PIDL: the count and the offsets.
+     */
+    inline size_t cida_header_size(size_t child_count)
+    {
+        return (child_count + 2) * sizeof(UINT);
+    }
+
+    template<typename Parent, typename It>
+    inline void check_cida_types()
+    {
+        typedef typename pidl::detail::pidl_type_of<Parent>::type parent_type;
+        typedef typename pidl::detail::pidl_type_of<
+            typename std::iterator_traits<It>::value_type>::type child_type;
+
+        BOOST_STATIC_ASSERT((
+            boost::is_convertible<
+                const parent_type*, const ITEMIDLIST_ABSOLUTE*>::value));
+        BOOST_STATIC_ASSERT((
+            boost::is_convertible<
+                const child_type*, const ITEMIDLIST_RELATIVE*>::value));
+    }
+
+    /**
+     * Copy the items of a PIDL into the buffer with a terminator.
+     *
+     * @returns  Offset just past the terminator.
+     */
+    inline size_t write_cida_pidl(
+        BYTE* buffer, size_t buffer_size, size_t offset,
+        const pidl::detail::measured_items& items)
+    {
+        size_t size = items.bytes + sizeof(USHORT);
+        if (size > buffer_size - offset)
+            BOOST_THROW_EXCEPTION(
+                std::length_error("Buffer too small for CIDA"));
+
+        if (items.bytes)
+            std::memcpy(buffer + offset, items.data, items.bytes);
+
+        USHORT terminator = 0;
+        std::memcpy(
+            buffer + offset + items.bytes, &terminator, sizeof(terminator));
+
+        return offset + size;
+    }
+
+    /**
+     * Measure the PIDL at @a offset without reading beyond @a size bytes.
+     *
+     * @throws std::invalid_argument if an item or the terminator would
+     *         overrun the buffer.
+     */
+    inline pidl::detail::measured_items measure_cida_pidl(
+        const BYTE* buffer, size_t size, size_t offset)
+    {
+        if (offset > size)
+            BOOST_THROW_EXCEPTION(
+                std::invalid_argument("CIDA PIDL overruns buffer"));
+
+        return pidl::detail::measure_items(
+            pidl::validate_pidl<ITEMIDLIST_RELATIVE>(
+                buffer + offset, size - offset));
+    }
+}
+
+/**
+ * Bytes needed for a CIDA of @a parent and the children in the range
+ * [@a first, @a last).
+ *
+ * The parent must be absolute and the children relative or child PIDLs.
+ * Each may be a raw PIDL, wrapper or view.
+ */
+template<typename Parent, typename It>
+inline size_t cida_size(const Parent& parent, It first, It last)
+{
+    detail::check_cida_types<Parent, It>();
+
+    size_t count = 0;
+    size_t bytes = pidl::detail::measure_items(parent).bytes + sizeof(USHORT);
+    for (It it = first; it != last; ++it)
+    {
+        bytes += pidl::detail::measure_items(*it).bytes + sizeof(USHORT);
+        ++count;
+    }
+
+    return detail::cida_header_size(count) + bytes;
+}
+
+/**
+ * Write a CIDA of @a parent and the children in the range [@a first,
+ * @a last) into @a buffer.
+ *
+ * Each PIDL is copied directly into place in one pass over the children,
+ * so size the buffer with cida_size() first.
+ *
+ * @returns  Number of bytes written.
+ *
+ * @throws std::length_error if the CIDA doesn't fit in @a buffer_size
+ *         bytes or its offsets don't fit in a UINT.  The contents of the
+ *         buffer are then unspecified.
+ */
+template<typename Parent, typename It>
+inline size_t write_cida(
+    BYTE* buffer, size_t buffer_size, const Parent& parent, It first,
+    It last)
+{
+    detail::check_cida_types<Parent, It>();
+
+    size_t count = std::distance(first, last);
+    size_t offset = detail::cida_header_size(count);
+    if (offset > buffer_size)
+        BOOST_THROW_EXCEPTION(std::length_error("Buffer too small for CIDA"));
+
+    // Every offset written is less than the buffer size
+    if (buffer_size > (std::numeric_limits<UINT>::max)())
+        buffer_size = (std::numeric_limits<UINT>::max)();
+
+    detail::write_uint(buffer, 0, static_cast<UINT>(count));
+
+    detail::write_uint(buffer, 1, static_cast<UINT>(offset));
+    offset = detail::write_cida_pidl(
+        buffer, buffer_size, offset, pidl::detail::measure_items(parent));
+
+    size_t i = 0;
+    for (It it = first; it != last; ++it, ++i)
+    {
+        detail::write_uint(buffer, i + 2, static_cast<UINT>(offset));
+        offset = detail::write_cida_pidl(
+            buffer, buffer_size, offset, pidl::detail::measure_items(*it));
+    }
+
+    return offset;
+}
+
+/**
+ * Read-only, zero-copy view of a CIDA in memory.
+ *
+ * The header and offsets are checked against the size of the memory when
+ * the view is created.  Each PIDL is checked as it is accessed, so looking
+ * at a few children of a large selection doesn't cost a pass over all of
+ * it.  The PIDLs are returned as views of the CIDA's memory, which must
+ * outlive them.
+ */
+class cida_view
+{
+public:
+
+    typedef pidl::pidl_view value_type;
+    typedef pidl::pidl_view reference;
+    typedef pidl::pidl_view const_reference;
+    typedef washer::shell::detail::indexed_iterator<cida_view, pidl::pidl_view>
+        iterator;
+    typedef iterator const_iterator;
+
+    /**
+     * View the CIDA in the @a size bytes at @a data.
+     *
+     * @throws std::invalid_argument if the count and offsets don't fit in
+     *         the memory or an offset points outside it.
+     */
+    cida_view(const void* data, size_t size)
+        : m_buffer(static_cast<const BYTE*>(data)), m_size(size), m_count(0)
+    {
+        if (!m_buffer || size < sizeof(UINT))
+            BOOST_THROW_EXCEPTION(
+                std::invalid_argument("CIDA too small for its header"));
+
+        size_t count = detail::read_uint(m_buffer, 0);
+        if (count > size / sizeof(UINT) ||
+            detail::cida_header_size(count) > size)
+            BOOST_THROW_EXCEPTION(
+                std::invalid_argument("CIDA too small for its offsets"));
+
+        for (size_t i = 0; i <= count; ++i)
+        {
+            if (detail::read_uint(m_buffer, i + 1) >= size)
+                BOOST_THROW_EXCEPTION(
+                    std::invalid_argument("CIDA offset past end of buffer"));
+        }
+
+        m_count = count;
+    }
+
+    /**
+     * The absolute PIDL of the folder the children are in.
+     *
+     * @throws std::invalid_argument if the PIDL overruns the CIDA.
+     */
+    pidl::apidl_view parent() const
+    {
+        pidl::detail::measured_items items = measure(0);
+        return pidl::apidl_view(
+            static_cast<PCUIDLIST_ABSOLUTE>(items.data), items.bytes,
+            items.item_count);
+    }
+
+    /**
+     * The PIDL of child @a index, relative to parent().
+     *
+     * @throws std::invalid_argument if the PIDL overruns the CIDA.
+     */
+    pidl::pidl_view operator[](size_t index) const
+    {
+        pidl::detail::measured_items items = measure(index + 1);
+        return pidl::pidl_view(
+            static_cast<PCUIDLIST_RELATIVE>(items.data), items.bytes,
+            items.item_count);
+    }
+
+    /**
+     * The PIDL of child @a index, checking it is in range.
+     */
+    pidl::pidl_view at(size_t index) const
+    {
+        if (index >= m_count)
+            BOOST_THROW_EXCEPTION(
+                std::out_of_range("Child index past end of CIDA"));
+
+        return (*this)[index];
+    }
+
+    const_iterator begin() const
+    {
+        return const_iterator(*this, 0);
+    }
+
+    const_iterator end() const
+    {
+        return const_iterator(*this, m_count);
+    }
+
+    /**
+     * Number of children.
+     */
+    size_t size() const
+    {
+        return m_count;
+    }
+
+    bool empty() const
+    {
+        return m_count == 0;
+    }
+
+private:
+
+    /**
+     * The PIDL at position @a index in the offset table, where 0 is the
+     * parent.
+     */
+    pidl::detail::measured_items measure(size_t index) const
+    {
+        assert(index <= m_count);
+        return detail::measure_cida_pidl(
+            m_buffer, m_size, detail::read_uint(m_buffer, index + 1));
+    }
+
+    const BYTE* m_buffer;
+    size_t m_size;
+    size_t m_count;
+};
+
+#ifdef _WIN32
+
+/**
+ * Allocate an HGLOBAL holding a CIDA of @a parent and the children in the
+ * range [@a first, @a last).
+ *
+ * The HGLOBAL is sized exactly and the PIDLs written straight into it.
+ * The caller owns the result, usually by handing it to a data object.
+ */
+template<typename Parent, typename It>
+inline HGLOBAL cida_to_hglobal(const Parent& parent, It first, It last)
+{
+    size_t size = cida_size(parent, first, last);
+
+    HGLOBAL global = ::GlobalAlloc(GMEM_MOVEABLE, size);
+    if (!global)
+        BOOST_THROW_EXCEPTION(
+            boost::enable_error_info(washer::last_error()) <<
+            boost::errinfo_api_function("GlobalAlloc"));
+
+    try
+    {
+        global_lock<BYTE> lock(global);
+        write_cida(lock.get(), size, parent, first, last);
+    }
+    catch (...)
+    {
+        ::GlobalFree(global);
+        throw;
+    }
+
+    return global;
+}
+
+/**
+ * A CIDA in an HGLOBAL, locked for as long as this object lives.
+ */
+class locked_cida
+{
+public:
+
+    /**
+     * Lock the HGLOBAL and check the CIDA's header against its size.
+     */
+    explicit locked_cida(HGLOBAL global) :
+        m_lock(global), m_view(m_lock.get(), ::GlobalSize(global)) {}
+
+    /**
+     * The CIDA.  Valid as long as this object.
+     */
+    const cida_view& view() const
+    {
+        return m_view;
+    }
+
+private:
+    global_lock<BYTE> m_lock;
+    cida_view m_view;
+};
+
+#endif
+
+// @}
+
+}} // namespace washer::shell
+
+#endif
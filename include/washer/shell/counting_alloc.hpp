@@ -0,0 +1,320 @@
+/**
+    @file
+
+    PIDL allocator that counts the allocations made through it.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#ifndef WASHER_SHELL_COUNTING_ALLOC_HPP
+#define WASHER_SHELL_COUNTING_ALLOC_HPP
+#pragma once
+
+#include <washer/shell/pidl.hpp> // default_alloc
+
+#include <boost/noncopyable.hpp> // noncopyable
+#include <boost/thread/tss.hpp> // thread_specific_ptr
+
+#include <algorithm> // max
+#include <cstddef> // size_t, ptrdiff_t
+
+#include <washer/shell/itemidlist.hpp> // Raw PIDL types
+
+namespace washer {
+namespace shell {
+namespace pidl {
+
+/**
+ * Allocations made through counting_alloc on one thread.
+ */
+struct allocation_stats
+{
+    allocation_stats() :
+        allocations(0), deallocations(0), bytes_allocated(0),
+        bytes_deallocated(0), peak_live_bytes(0) {}
+
+    size_t allocations;
+    size_t deallocations;
+    size_t bytes_allocated;
+    size_t bytes_deallocated;
+
+    /**
+     * Most bytes allocated and not yet freed at any one time.
+     */
+    size_t peak_live_bytes;
+
+    /**
+     * Bytes allocated and not freed.
+     *
+     * Negative if the thread freed more than it allocated, which happens
+     * when PIDLs are handed to it by another thread.
+     */
+    std::ptrdiff_t live_bytes() const
+    {
+        return static_cast<std::ptrdiff_t>(bytes_allocated) -
+            static_cast<std::ptrdiff_t>(bytes_deallocated);
+    }
+
+    std::ptrdiff_t live_allocations() const
+    {
+        return static_cast<std::ptrdiff_t>(allocations) -
+            static_cast<std::ptrdiff_t>(deallocations);
+    }
+};
+
+namespace detail {
+
+    struct allocation_counters
+    {
+        allocation_counters() : live_bytes(0), watermark(0) {}
+
+        allocation_stats totals;
+        std::ptrdiff_t live_bytes;
+
+        /// Highest live_bytes since the innermost allocation_probe began
+        std::ptrdiff_t watermark;
+    };
+
+    /**
+     * Holder for the per-thread counters, as a template so that the
+     * static member can be defined in this header.
+     */
+    template<typename Dummy>
+    struct thread_counters_holder
+    {
+        static boost::thread_specific_ptr<allocation_counters> counters;
+    };
+
+    template<typename Dummy>
+    boost::thread_specific_ptr<allocation_counters>
+        thread_counters_holder<Dummy>::counters;
+
+    inline allocation_counters& thread_counters()
+    {
+        boost::thread_specific_ptr<allocation_counters>& counters =
+            thread_counters_holder<void>::counters;
+        if (!counters.get())
+            counters.reset(new allocation_counters());
+        return *counters;
+    }
+
+    inline void count_allocation(size_t size)
+    {
+        allocation_counters& counters = thread_counters();
+        ++counters.totals.allocations;
+        counters.totals.bytes_allocated += size;
+        counters.live_bytes += size;
+
+        if (counters.live_bytes > counters.watermark)
+            counters.watermark = counters.live_bytes;
+        if (counters.live_bytes >
+            static_cast<std::ptrdiff_t>(counters.totals.peak_live_bytes))
+            counters.totals.peak_live_bytes =
+                static_cast<size_t>(counters.live_bytes);
+    }
+
+    inline void count_deallocation(size_t size)
+    {
+        allocation_counters& counters = thread_counters();
+        ++counters.totals.deallocations;
+        counters.totals.bytes_deallocated += size;
+        counters.live_bytes -= size;
+    }
+
+    /**
+     * Stored in front of each counted allocation so the size is known when
+     * it is freed.  The union keeps the PIDL after it aligned.
+     */
+    union counted_header
+    {
+        size_t size;
+        void* pointer_alignment;
+        double double_alignment;
+    };
+}
+
+/**
+ * Everything counted on the calling thread since it started.
+ */
+inline allocation_stats thread_allocation_stats()
+{
+    return detail::thread_counters().totals;
+}
+
+/**
+ * Counts the allocations made on the calling thread while it exists.
+ *
+ * Create one before an operation and check stats() afterwards to find
+ * what the operation allocated, for instance to assert that a hot path
+ * stays within an allocation budget.  Probes may be nested.  A probe must
+ * be used and destroyed on the thread that created it.
+ */
+class allocation_probe : private boost::noncopyable
+{
+public:
+
+    allocation_probe()
+        : m_start(detail::thread_counters().totals),
+          m_start_live(detail::thread_counters().live_bytes),
+          m_outer_watermark(detail::thread_counters().watermark)
+    {
+        detail::thread_counters().watermark = m_start_live;
+    }
+
+    ~allocation_probe()
+    {
+        // Let any enclosing probe see the peak reached during this one
+        detail::allocation_counters& counters = detail::thread_counters();
+        counters.watermark =
+            (std::max)(counters.watermark, m_outer_watermark);
+    }
+
+    /**
+     * Allocations since the probe was created.
+     *
+     * The peak is the most by which live bytes rose above where they
+     * stood when the probe was created.
+     */
+    allocation_stats stats() const
+    {
+        const detail::allocation_counters& counters =
+            detail::thread_counters();
+
+        allocation_stats result;
+        result.allocations =
+            counters.totals.allocations - m_start.allocations;
+        result.deallocations =
+            counters.totals.deallocations - m_start.deallocations;
+        result.bytes_allocated =
+            counters.totals.bytes_allocated - m_start.bytes_allocated;
+        result.bytes_deallocated =
+            counters.totals.bytes_deallocated - m_start.bytes_deallocated;
+        result.peak_live_bytes =
+            static_cast<size_t>(counters.watermark - m_start_live);
+        return result;
+    }
+
+private:
+    allocation_stats m_start;
+    std::ptrdiff_t m_start_live;
+    std::ptrdiff_t m_outer_watermark;
+};
+
+/**
+ * PIDL allocator that counts allocations made through another allocator.
+ *
+ * Each allocation and its size are added to counters kept separately for
+ * each thread, which allocation_probe and thread_allocation_stats()
+ * report.  Frees are counted on the thread that makes them.  Counting
+ * costs a thread-local lookup per call, so this is meant for tests and
+ * profiling builds.
+ *
+ * The size is kept in a small header in front of each PIDL, so PIDLs
+ * allocated this way must only be freed by a counting_alloc.  In
+ * particular they must not be handed to the shell to free.
+ *
+ * Wraps any PIDL allocator, stateless or stateful, which does the real
+ * allocating.  The counting allocator itself always has state, so it can
+ * only be used by PIDL types that hold an allocator instance, such as
+ * basic_pidl, basic_small_pidl, basic_shared_pidl and basic_split_pidl, and
+ * not with raw_pidl::clone().
+ */
+template<typename T, typename Alloc = typename default_alloc<T>::type>
+class counting_alloc
+{
+public:
+
+    counting_alloc() {}
+
+    explicit counting_alloc(const Alloc& inner) : m_inner(inner) {}
+
+    template<typename U, typename AllocU>
+    counting_alloc(const counting_alloc<U, AllocU>& other)
+        : m_inner(other.inner()) {}
+
+    T* allocate(size_t size) const
+    {
+        BYTE* mem = reinterpret_cast<BYTE*>(
+            m_inner.allocate(sizeof(detail::counted_header) + size));
+
+        reinterpret_cast<detail::counted_header*>(mem)->size = size;
+        detail::count_allocation(size);
+
+        return reinterpret_cast<T*>(mem + sizeof(detail::counted_header));
+    }
+
+    void deallocate(T* mem) const throw()
+    {
+        if (!mem)
+            return;
+
+        BYTE* start =
+            reinterpret_cast<BYTE*>(mem) - sizeof(detail::counted_header);
+        detail::count_deallocation(
+            reinterpret_cast<detail::counted_header*>(start)->size);
+
+        m_inner.deallocate(reinterpret_cast<T*>(start));
+    }
+
+    /**
+     * The allocator that does the real work.
+     */
+    Alloc inner() const
+    {
+        return m_inner;
+    }
+
+    template<class Other>
+    struct rebind
+    {
+        typedef counting_alloc<
+            Other, typename Alloc::template rebind<Other>::other> other;
+    };
+
+private:
+    mutable Alloc m_inner;
+};
+
+/**
+ * Counting allocators are equal if the allocators they wrap are.
+ */
+template<typename T, typename AllocT, typename U, typename AllocU>
+inline bool operator==(
+    const counting_alloc<T, AllocT>& lhs, const counting_alloc<U, AllocU>& rhs)
+{
+    return lhs.inner() == rhs.inner();
+}
+
+template<typename T, typename AllocT, typename U, typename AllocU>
+inline bool operator!=(
+    const counting_alloc<T, AllocT>& lhs, const counting_alloc<U, AllocU>& rhs)
+{
+    return !(lhs == rhs);
+}
+
+}}} // namespace washer::shell::pidl
+
+#endif
@@ -0,0 +1,119 @@
+/**
+    @file
+
+    Random-access iterator over any container indexed by position.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#ifndef WASHER_SHELL_DETAIL_INDEXED_ITERATOR_HPP
+#define WASHER_SHELL_DETAIL_INDEXED_ITERATOR_HPP
+#pragma once
+
+#include <boost/iterator/iterator_categories.hpp> // random_access_traversal_tag
+#include <boost/iterator/iterator_facade.hpp>
+
+#include <cassert> // assert
+#include <cstddef> // size_t, ptrdiff_t
+
+namespace washer {
+namespace shell {
+namespace detail {
+
+/**
+ * Iterator over a container whose operator[] produces values rather than
+ * references, such as views of the PIDLs it holds.
+ *
+ * Dereferencing calls the container's operator[] with the iterator's
+ * position.  The iterator refers to the container, so is invalidated if
+ * the container is destroyed or assigned to.
+ */
+template<typename Container, typename Value>
+class indexed_iterator :
+    public boost::iterator_facade<
+        indexed_iterator<Container, Value>, Value,
+        boost::random_access_traversal_tag, Value> // reference = value_type
+{
+public:
+
+    indexed_iterator() : m_container(NULL), m_position(0) {}
+
+    indexed_iterator(const Container& container, size_t position)
+        : m_container(&container), m_position(position) {}
+
+    /**
+     * Index of the element the iterator points to.
+     */
+    size_t position() const
+    {
+        return m_position;
+    }
+
+private:
+    friend class boost::iterator_core_access;
+
+    Value dereference() const
+    {
+        assert(m_container);
+        return (*m_container)[m_position];
+    }
+
+    bool equal(const indexed_iterator& other) const
+    {
+        assert(m_container == other.m_container);
+        return m_position == other.m_position;
+    }
+
+    void increment()
+    {
+        ++m_position;
+    }
+
+    void decrement()
+    {
+        assert(m_position > 0);
+        --m_position;
+    }
+
+    void advance(std::ptrdiff_t n)
+    {
+        m_position += n;
+    }
+
+    std::ptrdiff_t distance_to(const indexed_iterator& other) const
+    {
+        assert(m_container == other.m_container);
+        return static_cast<std::ptrdiff_t>(other.m_position) -
+            static_cast<std::ptrdiff_t>(m_position);
+    }
+
+    const Container* m_container;
+    size_t m_position;
+};
+
+}}} // namespace washer::shell::detail
+
+#endif
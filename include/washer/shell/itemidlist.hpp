@@ -0,0 +1,109 @@
+/**
+    @file
+
+    Raw PIDL types.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#ifndef WASHER_SHELL_ITEMIDLIST_HPP
+#define WASHER_SHELL_ITEMIDLIST_HPP
+#pragma once
+
+#ifdef _WIN32
+
+#ifndef STRICT_TYPED_ITEMIDS
+#error Currently, washer requires strict PIDL types: define STRICT_TYPED_ITEMIDS
+#endif
+
+#include <ShTypes.h> // Raw PIDL types
+
+#else
+
+/**
+ * @name  Raw PIDL types
+ *
+ * Outside Windows there is no SDK to supply the item ID list structures, so
+ * we define them here with the same byte layout and the same strict typing
+ * that the SDK provides when STRICT_TYPED_ITEMIDS is defined.  This lets the
+ * platform-neutral parts of washer, PIDL storage and manipulation, build and
+ * be tested anywhere.
+ *
+ * PIDLs are byte-packed: an item is a 16-bit size followed by that many
+ * bytes (including the size itself) and the list ends with a zero size.
+ * Nothing about a PIDL is aligned, which on Windows is marked with
+ * @c __unaligned.  Elsewhere, the compilers we target do not need the
+ * annotation for byte-wise access so it expands to nothing.
+ */
+// @{
+
+#ifndef __unaligned
+#define __unaligned
+#endif
+
+typedef unsigned char BYTE;
+typedef unsigned short USHORT;
+typedef unsigned int UINT;
+
+#pragma pack(push, 1)
+
+typedef struct _SHITEMID
+{
+    USHORT cb;
+    BYTE abID[1];
+} SHITEMID;
+
+typedef struct _ITEMIDLIST
+{
+    SHITEMID mkid;
+} ITEMIDLIST;
+
+typedef struct _ITEMIDLIST_RELATIVE : ITEMIDLIST {} ITEMIDLIST_RELATIVE;
+typedef struct _ITEMID_CHILD : ITEMIDLIST_RELATIVE {} ITEMID_CHILD;
+typedef struct _ITEMIDLIST_ABSOLUTE : ITEMIDLIST_RELATIVE {} ITEMIDLIST_ABSOLUTE;
+
+#pragma pack(pop)
+
+typedef ITEMIDLIST_ABSOLUTE* PIDLIST_ABSOLUTE;
+typedef const ITEMIDLIST_ABSOLUTE* PCIDLIST_ABSOLUTE;
+typedef ITEMIDLIST_ABSOLUTE __unaligned* PUIDLIST_ABSOLUTE;
+typedef const ITEMIDLIST_ABSOLUTE __unaligned* PCUIDLIST_ABSOLUTE;
+
+typedef ITEMIDLIST_RELATIVE* PIDLIST_RELATIVE;
+typedef const ITEMIDLIST_RELATIVE* PCIDLIST_RELATIVE;
+typedef ITEMIDLIST_RELATIVE __unaligned* PUIDLIST_RELATIVE;
+typedef const ITEMIDLIST_RELATIVE __unaligned* PCUIDLIST_RELATIVE;
+
+typedef ITEMID_CHILD* PITEMID_CHILD;
+typedef const ITEMID_CHILD* PCITEMID_CHILD;
+typedef ITEMID_CHILD __unaligned* PUITEMID_CHILD;
+typedef const ITEMID_CHILD __unaligned* PCUITEMID_CHILD;
+
+// @}
+
+#endif
+
+#endif
@@ -34,23 +34,26 @@
 #define WASHER_SHELL_PIDL_HPP
 #pragma once
 
+#include <boost/move/move.hpp> // BOOST_RV_REF, BOOST_COPYABLE_AND_MOVABLE
+#include <boost/static_assert.hpp> // BOOST_STATIC_ASSERT
 #include <boost/throw_exception.hpp> // BOOST_THROW_EXCEPTION
+#include <boost/type_traits/integral_constant.hpp> // true_type, false_type
+#include <boost/type_traits/is_same.hpp> // is_same
 #include <boost/utility/enable_if.hpp> // conditional specsation of combine
 
 #include <algorithm> // swap
 #include <cassert> // assert
-#include <cstring> // memcpy
+#include <cstdlib> // malloc, free
+#include <cstring> // memcpy, memmove, memset
 #include <exception> // bad_alloc
 #include <stdexcept> // invalid_argument, logic_error
 
-#include <Objbase.h> // CoTaskMemAlloc/Free
+#include <washer/shell/itemidlist.hpp> // Raw PIDL types
 
-#ifndef STRICT_TYPED_ITEMIDS
-#error Currently, washer requires strict PIDL types: define STRICT_TYPED_ITEMIDS
+#ifdef _WIN32
+#include <Objbase.h> // CoTaskMemAlloc/Free
 #endif
 
-#include <ShTypes.h> // Raw PIDL types
-
 namespace washer {
 namespace shell {
 namespace pidl {
@@ -60,6 +63,13 @@ namespace pidl {
  * These are inspired by the Standard Library allocators but differ in one
  * important respect: they allocate memory given a size in @b bytes rather
  * than a number of elements.  This is due to unorthodox nature of PIDLs.
+ *
+ * Allocators may be stateful.  Each wrapper keeps a copy of the allocator
+ * that allocated its PIDL and PIDLs derived from it, such as the result of
+ * joining it to another PIDL, are allocated by a copy of the same
+ * allocator rebound to the new PIDL type.  Allocators must therefore be
+ * copyable, default-constructible and constructible from any rebound
+ * version of themselves.
  */
 // @{
 
@@ -72,6 +82,11 @@ namespace pidl {
 template<typename T>
 struct newdelete_alloc
 {
+    newdelete_alloc() {}
+
+    template<typename U>
+    newdelete_alloc(const newdelete_alloc<U>&) {}
+
     static T* allocate(size_t size)
     {
         return reinterpret_cast<T*>(new BYTE[size]);
@@ -113,6 +128,62 @@ inline bool operator!=(const newdelete_alloc<T>&, const newdelete_alloc<U>&)
 }
 
 
+/**
+ * Allocator for PIDLs using the C heap.
+ */
+template<typename T>
+struct malloc_alloc
+{
+    malloc_alloc() {}
+
+    template<typename U>
+    malloc_alloc(const malloc_alloc<U>&) {}
+
+    static T* allocate(size_t size)
+    {
+        T* mem = reinterpret_cast<T*>(std::malloc(size));
+        if (!mem)
+            BOOST_THROW_EXCEPTION(std::bad_alloc());
+        return mem;
+    }
+
+    static void deallocate(T* mem) throw()
+    {
+        std::free(mem);
+    }
+
+    /**
+     * Allow reference to C heap allocator for different element types.
+     */
+    template<class Other>
+    struct rebind
+    {
+        typedef malloc_alloc<Other> other;
+    };
+};
+
+/**
+ * Allocators using the same allocation scheme are always equal regardless of
+ * element type.
+ */
+template<typename T, typename U>
+inline bool operator==(const malloc_alloc<T>&, const malloc_alloc<U>&)
+{
+    return true;
+}
+
+/**
+ * Allocators using different allocation schemes are never equal regardless of
+ * element type.
+ */
+template<typename T, typename U>
+inline bool operator!=(const malloc_alloc<T>&, const malloc_alloc<U>&)
+{
+    return false;
+}
+
+#ifdef _WIN32
+
 /**
  * Allocator for PIDLs using the COM memory allocator.
  *
@@ -122,6 +193,11 @@ inline bool operator!=(const newdelete_alloc<T>&, const newdelete_alloc<U>&)
 template<typename T>
 struct cotaskmem_alloc
 {
+    cotaskmem_alloc() {}
+
+    template<typename U>
+    cotaskmem_alloc(const cotaskmem_alloc<U>&) {}
+
     static T* allocate(size_t size)
     {
         T* mem = reinterpret_cast<T*>(::CoTaskMemAlloc(size));
@@ -168,6 +244,25 @@ inline bool operator!=(const cotaskmem_alloc<T>&, const cotaskmem_alloc<U>&)
     return false;
 }
 
+#endif
+
+/**
+ * Allocator used by the standard PIDL types.
+ *
+ * On Windows, PIDLs are exchanged with the shell which frees them with the
+ * COM allocator so that is what we must use.  Elsewhere there is no shell
+ * to satisfy and PIDLs live on the C heap.
+ */
+template<typename T>
+struct default_alloc
+{
+#ifdef _WIN32
+    typedef cotaskmem_alloc<T> type;
+#else
+    typedef malloc_alloc<T> type;
+#endif
+};
+
 // @}
 
 
@@ -199,6 +294,15 @@ namespace raw_pidl {
         return skip(pidl, pidl->mkid.cb);
     }
 
+    /**
+     * Return if PIDL is considered empty (aka. desktop folder).
+     */
+    template<typename T>
+    inline bool empty(const T __unaligned* pidl)
+    {
+        return (pidl == NULL) || (pidl->mkid.cb == 0);
+    }
+
     /**
      * Return address of the last item in the PIDL.
      */
@@ -215,15 +319,6 @@ namespace raw_pidl {
         return reinterpret_cast<const ITEMID_CHILD __unaligned*>(p);
     }
 
-    /**
-     * Return if PIDL is considered empty (aka. desktop folder).
-     */
-    template<typename T>
-    inline bool empty(const T __unaligned* pidl)
-    {
-        return (pidl == NULL) || (pidl->mkid.cb == 0);
-    }
-
     /**
      * Traits governing operations on raw PIDLs.
      */
@@ -266,7 +361,7 @@ namespace raw_pidl {
         typedef ITEMIDLIST_RELATIVE combine_type;
         typedef ITEMIDLIST_RELATIVE* combine_pidl_type;
         static const bool is_appendable = true;
-        static const void type_check(clone_pidl_type pidl)
+        static void type_check(clone_pidl_type pidl)
         {
             if (!empty(pidl) && !empty(next(pidl)))
                 BOOST_THROW_EXCEPTION(
@@ -285,7 +380,7 @@ namespace raw_pidl {
         typedef idlist_type combine_type;
         typedef pidl_type combine_pidl_type;
         static const bool is_appendable = false;
-        static const void type_check(clone_pidl_type) {}
+        static void type_check(clone_pidl_type) {}
     };
 
     /**
@@ -310,8 +405,46 @@ namespace raw_pidl {
         return s;
     }
 
+    /**
+     * Measurements of a raw PIDL.
+     */
+    struct extent
+    {
+        size_t size; ///< Bytes in the PIDL including the null-terminator
+        size_t item_count; ///< Number of items before the null-terminator
+        size_t last_offset; ///< Offset of the last item in bytes (zero if
+                            ///< the PIDL has no items)
+    };
+
+    /**
+     * Find the size, item count and last item of a raw PIDL in a single
+     * walk along its items.
+     *
+     * A NULL PIDL measures zero in every respect.
+     */
+    template<typename T>
+    inline extent measure(const T __unaligned* pidl)
+    {
+        extent e = { 0, 0, 0 };
+        if (!pidl)
+            return e;
+
+        e.size = sizeof(pidl->mkid.cb);
+        while (pidl->mkid.cb)
+        {
+            e.last_offset = e.size - sizeof(pidl->mkid.cb);
+            e.size += pidl->mkid.cb;
+            ++e.item_count;
+            pidl = next(pidl);
+        }
+
+        return e;
+    }
+
     /**
      * Clone a raw PIDL.
+     *
+     * Like combine(), this can only be used with stateless allocators.
      */
     template<typename Alloc, typename T>
     inline T* clone(const T __unaligned* pidl)
@@ -365,7 +498,7 @@ namespace raw_pidl {
     {
         (void) dummy;
         typedef typename traits<T>::combine_type return_item_type;
-        typedef typename Alloc::rebind<return_item_type>::other
+        typedef typename Alloc::template rebind<return_item_type>::other
             allocator_type;
 
         if (!lhs_pidl && !rhs_pidl)
@@ -379,16 +512,64 @@ namespace raw_pidl {
         if (lhs_len && rhs_len)
             len -= sizeof(lhs_pidl->mkid.cb);
 
-        traits<T>::combine_pidl_type mem = allocator_type::allocate(len);
-        std::memcpy(mem, lhs_pidl, lhs_len);
-        std::memcpy(
-            skip(mem, lhs_len - ((lhs_len) ? sizeof(lhs_pidl->mkid.cb) : 0)),
-            rhs_pidl, rhs_len);
+        typename traits<T>::combine_pidl_type mem = allocator_type::allocate(len);
+        if (lhs_len)
+            std::memcpy(mem, lhs_pidl, lhs_len);
+        if (rhs_len)
+        {
+            // Overwrites the left PIDL's terminator
+            size_t offset =
+                (lhs_len) ? lhs_len - sizeof(lhs_pidl->mkid.cb) : 0;
+            std::memcpy(skip(mem, offset), rhs_pidl, rhs_len);
+        }
 
         return mem;
     }
 }
 
+template<typename T> class basic_pidl_view;
+template<typename T> struct basic_split_view;
+
+namespace detail {
+
+    /**
+     * Copy an allocator as another allocator of the same kind.
+     */
+    template<typename To, typename From>
+    inline To rebind_allocator(const From& alloc, boost::true_type)
+    {
+        return To(alloc);
+    }
+
+    /**
+     * Allocators of a different kind can't be copied so the target starts
+     * afresh.
+     */
+    template<typename To, typename From>
+    inline To rebind_allocator(const From&, boost::false_type)
+    {
+        return To();
+    }
+
+    /**
+     * Copy @a bytes bytes of items to @a destination and null-terminate
+     * them.
+     *
+     * The terminator is written as bytes rather than through an item
+     * pointer as there is only room for the terminator, not a whole item.
+     */
+    inline void copy_terminated(
+        void* destination, const void* items, size_t bytes)
+    {
+        BYTE* out = static_cast<BYTE*>(destination);
+        if (bytes)
+            std::memcpy(out, items, bytes);
+
+        USHORT terminator = 0;
+        std::memcpy(out + bytes, &terminator, sizeof(terminator));
+    }
+}
+
 /**
  * Templated PIDL wrapper class.
  *
@@ -400,7 +581,10 @@ namespace raw_pidl {
  * The template also takes a parameter, Alloc, which specifies an allocator
  * to use when creating new PIDLs.  This allows us to use new & delete rather
  * than the COM allocator (the usual allocator for PIDLs) when testing so that
- * we can detect memory leaks.
+ * we can detect memory leaks.  Allocators may be stateful, such as
+ * arena_alloc, in which case the allocator is passed to the constructor.
+ * Assigning to a wrapper copies the PIDL using the wrapper's own allocator
+ * whereas moving and swapping exchange allocators along with the PIDLs.
  *
  * PIDLs being copied from elsewhere are always treated as unaligned because
  * they may be part way through a larger ITEMIDLIST. Although there may be a
@@ -409,6 +593,18 @@ namespace raw_pidl {
  * aligned absolute PIDLs will have to be treated as unaligned from the second
  * item in the list onwards.  Relative PIDLs should always be treated as
  * unaligned.
+ *
+ * Wrappers are movable as well as copyable.  Moving transfers ownership of
+ * the PIDL without copying it.  PIDLs whose type doesn't change when joined
+ * (relative and absolute PIDLs) can also grow in place using reserve() and
+ * append() so that building a deep PIDL one item at a time doesn't
+ * reallocate on every step.
+ *
+ * The wrapper remembers the size, item count and position of the last item
+ * of its PIDL so that size(), item_count(), last_item() and parent() don't
+ * have to walk the list each time they are called.  PIDLs handed to the
+ * wrapper through attach() or out() are measured the first time the
+ * information is needed.
  */
 template<typename T, typename Alloc>
 class basic_pidl
@@ -422,10 +618,19 @@ public:
     typedef typename raw_pidl::traits<T>::combine_type            join_type;
     typedef typename raw_pidl::traits<T>::combine_pidl_type       join_pidl_type;
     typedef typename allocator::template rebind<join_type>::other join_allocator;
-    typedef typename basic_pidl<join_type, join_allocator>        join_pidl;
+    typedef basic_pidl<join_type, join_allocator>                 join_pidl;
     typedef typename raw_pidl::traits<T>::clone_pidl_type         foreign_pidl_type;
 
-    basic_pidl() : m_pidl(NULL), m_allocator(Alloc()) {}
+    basic_pidl() :
+        m_pidl(NULL), m_capacity(0), m_size(0), m_item_count(0),
+        m_last_offset(0), m_allocator(Alloc()) {}
+
+    /**
+     * NULL PIDL that will allocate using the given allocator.
+     */
+    explicit basic_pidl(Alloc alloc) :
+        m_pidl(NULL), m_capacity(0), m_size(0), m_item_count(0),
+        m_last_offset(0), m_allocator(alloc) {}
 
     ~basic_pidl() throw()
     {
@@ -434,22 +639,129 @@ public:
 
     /**
      * Copy construction.
+     *
+     * The copy is allocated by a copy of the other wrapper's allocator.
      */
     basic_pidl(const basic_pidl& pidl) :
-        m_pidl(typename raw_pidl::clone<Alloc>(pidl.m_pidl)) {}
+        m_pidl(NULL), m_capacity(0), m_size(0), m_item_count(0),
+        m_last_offset(0), m_allocator(pidl.m_allocator)
+    {
+        if (pidl.m_pidl)
+        {
+            pidl.measure();
+            copy_measured(pidl.m_pidl, pidl.cached_extent());
+        }
+    }
+
+    /**
+     * Copy construction using the given allocator.
+     */
+    basic_pidl(const basic_pidl& pidl, Alloc alloc) :
+        m_pidl(NULL), m_capacity(0), m_size(0), m_item_count(0),
+        m_last_offset(0), m_allocator(alloc)
+    {
+        if (pidl.m_pidl)
+        {
+            pidl.measure();
+            copy_measured(pidl.m_pidl, pidl.cached_extent());
+        }
+    }
+
+    /**
+     * Move construction.
+     *
+     * Takes ownership of the other wrapper's PIDL, leaving it NULL.
+     */
+    basic_pidl(BOOST_RV_REF(basic_pidl) pidl) :
+        m_pidl(pidl.m_pidl), m_capacity(pidl.m_capacity),
+        m_size(pidl.m_size), m_item_count(pidl.m_item_count),
+        m_last_offset(pidl.m_last_offset), m_allocator(pidl.m_allocator)
+    {
+        pidl.m_pidl = NULL;
+        pidl.forget_extent();
+    }
 
     /**
      * Construct by copying a raw PIDL.
      */
-    basic_pidl(const __unaligned T* raw_pidl) :
-        m_pidl(typename raw_pidl::type_checked_clone<Alloc>(raw_pidl)) {}
+    basic_pidl(const __unaligned T* pidl, Alloc alloc=Alloc()) :
+        m_pidl(NULL), m_capacity(0), m_size(0), m_item_count(0),
+        m_last_offset(0), m_allocator(alloc)
+    {
+        raw_pidl::traits<T>::type_check(pidl);
+
+        if (pidl)
+            copy_measured(pidl, raw_pidl::measure(pidl));
+    }
+
+    /**
+     * Construct by copying the items seen by a PIDL view.
+     *
+     * The copy is null-terminated even when the view is not.  Will fail to
+     * compile unless it is legal to upcast the view's raw PIDL type to this
+     * PIDL's type.
+     */
+    template<typename U>
+    explicit basic_pidl(
+        const basic_pidl_view<U>& view, Alloc alloc=Alloc()) :
+        m_pidl(NULL), m_capacity(0), m_size(0), m_item_count(0),
+        m_last_offset(0), m_allocator(alloc)
+    {
+        const T __unaligned* items = view.data();
+        if (!items)
+            return;
+
+        size_t len = view.size();
+        m_pidl = m_allocator.allocate(len);
+        detail::copy_terminated(m_pidl, items, view.item_bytes());
+
+        m_capacity = len;
+        m_size = len;
+        m_item_count = view.item_count();
+        m_last_offset = (m_item_count == 0) ? 0 : unknown_offset();
+    }
 
     /**
      * Copy assignment.
+     *
+     * The copy is allocated by this wrapper's allocator.
+     */
+    basic_pidl& operator=(BOOST_COPY_ASSIGN_REF(basic_pidl) pidl)
+    {
+        basic_pidl copy(pidl, m_allocator);
+        swap(copy);
+        return *this;
+    }
+
+    /**
+     * Move assignment.
+     *
+     * The current PIDL, if any, is deallocated and this wrapper takes
+     * ownership of the other wrapper's PIDL, and its allocator, leaving it
+     * NULL.
      */
-    basic_pidl& operator=(const basic_pidl& pidl)
+    basic_pidl& operator=(BOOST_RV_REF(basic_pidl) pidl)
+    {
+        if (this != &pidl)
+        {
+            basic_pidl moved(boost::move(pidl));
+            swap(moved);
+        }
+        return *this;
+    }
+
+    /**
+     * Copy a wrapped PIDL of another type into this wrapper instance.
+     *
+     * Will fail to compile unless it is legal to upcast the other wrapper's
+     * raw PIDL type to this PIDL's type.
+     */
+    template<typename U, typename AllocU>
+    typename boost::disable_if<
+        boost::is_same<basic_pidl<U, AllocU>, basic_pidl>, basic_pidl&>::type
+    operator=(const basic_pidl<U, AllocU>& pidl)
     {
-        basic_pidl copy(pidl);
+        basic_pidl copy(pidl.get(), m_allocator);
         swap(copy);
         return *this;
     }
@@ -459,7 +771,7 @@ public:
      */
     basic_pidl& operator=(foreign_pidl_type raw_pidl)
     {
-        basic_pidl copy(raw_pidl);
+        basic_pidl copy(raw_pidl, m_allocator);
         swap(copy);
         return *this;
     }
@@ -476,11 +788,27 @@ public:
      * Upcast operator.
      * Will fail to compile unless it is legal to upcasting the underlying raw
      * PIDL type to this PIDL's type.
+     *
+     * If the target uses the same kind of allocator, the copy is allocated by
+     * a rebound copy of this wrapper's allocator.
      */
     template<typename U, typename AllocU>
     operator basic_pidl<U, AllocU>() const
     {
-        return m_pidl;
+        return basic_pidl<U, AllocU>(
+            m_pidl,
+            detail::rebind_allocator<AllocU>(
+                m_allocator,
+                boost::is_same<
+                    AllocU, typename allocator::template rebind<U>::other>()));
+    }
+
+    /**
+     * The allocator used for this wrapper's PIDL.
+     */
+    allocator get_allocator() const
+    {
+        return m_allocator;
     }
 
     /**
@@ -507,6 +835,7 @@ public:
     {
         m_allocator.deallocate(m_pidl);
         m_pidl = NULL;
+        forget_extent();
         return &m_pidl;
     }
 
@@ -527,7 +856,15 @@ public:
     template<typename U>
     void copy_to(U*& raw_pidl) const
     {
-        raw_pidl = typename raw_pidl::clone<Alloc>(m_pidl);
+        if (!m_pidl)
+        {
+            raw_pidl = NULL;
+            return;
+        }
+
+        T* mem = m_allocator.allocate(size());
+        std::memcpy(mem, m_pidl, m_size);
+        raw_pidl = mem;
     }
 
     /**
@@ -540,14 +877,15 @@ public:
      * The PIDL must @b not be unaligned as that would imply we are attaching
      * to the middle of an ITEMIDLIST.
      */
-    basic_pidl& attach(T* raw_pidl)
+    basic_pidl& attach(T* pidl)
     {
-        assert(m_pidl != raw_pidl);
+        assert(m_pidl != pidl);
 
-        raw_pidl::traits<T>::type_check(raw_pidl);
+        raw_pidl::traits<T>::type_check(pidl);
 
         m_allocator.deallocate(m_pidl);
-        m_pidl = raw_pidl;
+        m_pidl = pidl;
+        forget_extent();
         return *this;
     }
 
@@ -558,6 +896,7 @@ public:
     {
         T* pidl = m_pidl;
         m_pidl = NULL;
+        forget_extent();
         return pidl;
     }
 
@@ -570,7 +909,19 @@ public:
      */
     size_t size() const
     {
-        return raw_pidl::size(m_pidl);
+        measure();
+        return m_size;
+    }
+
+    /**
+     * The number of items in the PIDL.
+     *
+     * Zero if the PIDL is empty or NULL.
+     */
+    size_t item_count() const
+    {
+        measure();
+        return m_item_count;
     }
 
     /**
@@ -583,6 +934,90 @@ public:
         return raw_pidl::empty(m_pidl);
     }
 
+    /**
+     * Number of bytes the PIDL can grow to without reallocating.
+     *
+     * Zero if the wrapper doesn't know how much memory is behind the PIDL,
+     * which is the case after attach() or out().
+     */
+    size_t capacity() const
+    {
+        return m_capacity;
+    }
+
+    /**
+     * Make sure the PIDL can grow to @a bytes bytes, including the
+     * null-terminator, without reallocating.
+     *
+     * Reserving space for a NULL PIDL turns it into an empty PIDL.
+     */
+    void reserve(size_t bytes)
+    {
+        if (bytes <= m_capacity)
+            return;
+
+        size_t len = size();
+        if (bytes < sizeof(m_pidl->mkid.cb))
+            bytes = sizeof(m_pidl->mkid.cb);
+
+        T* mem = m_allocator.allocate(bytes);
+        if (m_pidl)
+        {
+            std::memcpy(mem, m_pidl, len);
+        }
+        else
+        {
+            std::memset(mem, 0, sizeof(m_pidl->mkid.cb));
+            m_size = sizeof(m_pidl->mkid.cb);
+            m_item_count = 0;
+            m_last_offset = 0;
+        }
+
+        m_allocator.deallocate(m_pidl);
+        m_pidl = mem;
+        m_capacity = bytes;
+    }
+
+    /**
+     * Append a PIDL to this one, growing the buffer in place if possible.
+     *
+     * The result is the same as that of joining the PIDLs with @c + but,
+     * when the buffer has to grow, its capacity is at least doubled so a
+     * sequence of appends costs amortised constant allocations.
+     *
+     * Only legal when joining doesn't change the type of this PIDL, i.e. for
+     * relative and absolute PIDLs.  The template will fail to compile if
+     * used with an absolute PIDL as the appended PIDL.
+     */
+    template<typename U>
+    basic_pidl& append(const U __unaligned* pidl)
+    {
+        BOOST_STATIC_ASSERT((boost::is_same<join_type, T>::value));
+        BOOST_STATIC_ASSERT(raw_pidl::traits<U>::is_appendable);
+
+        if (!pidl)
+            return *this;
+
+        return append_measured(pidl, raw_pidl::measure(pidl));
+    }
+
+    /**
+     * Append a wrapped PIDL to this one, growing the buffer in place if
+     * possible.
+     */
+    template<typename U, typename AllocU>
+    basic_pidl& append(const basic_pidl<U, AllocU>& pidl)
+    {
+        BOOST_STATIC_ASSERT((boost::is_same<join_type, T>::value));
+        BOOST_STATIC_ASSERT(raw_pidl::traits<U>::is_appendable);
+
+        if (!pidl.m_pidl)
+            return *this;
+
+        pidl.measure();
+        return append_measured(pidl.m_pidl, pidl.cached_extent());
+    }
+
     /**
      * The single child pidl of this namespace item.
      */
@@ -594,9 +1029,15 @@ public:
             BOOST_THROW_EXCEPTION(
                 std::logic_error("Empty PIDL cannot have a last item"));
 
-        return basic_pidl<
-            ITEMID_CHILD, typename allocator::rebind<ITEMID_CHILD>::other>(
-                raw_pidl::last(m_pidl));
+        measure();
+
+        typedef typename allocator::template rebind<ITEMID_CHILD>::other
+            child_allocator;
+
+        return basic_pidl<ITEMID_CHILD, child_allocator>(
+            reinterpret_cast<const ITEMID_CHILD __unaligned*>(
+                raw_pidl::skip(m_pidl, m_last_offset)),
+            child_allocator(m_allocator));
     }
 
     /**
@@ -608,36 +1049,254 @@ public:
             BOOST_THROW_EXCEPTION(
                 std::logic_error("Empty PIDL cannot have a parent"));
 
-        basic_pidl copy(*this);
+        measure();
 
-        // Force-terminate the copy's last item, then re-clone to get
-        // clean version
+        // Copy everything before the last item and terminate the copy
+        // where the last item started
 
-        const ITEMID_CHILD __unaligned* last = raw_pidl::last(copy.m_pidl);
+        size_t len = m_last_offset + sizeof(m_pidl->mkid.cb);
 
-        const_cast<ITEMID_CHILD __unaligned*>(last)->mkid.cb = 0;
+        basic_pidl parent(m_allocator);
+        parent.m_pidl = parent.m_allocator.allocate(len);
+        detail::copy_terminated(parent.m_pidl, m_pidl, m_last_offset);
 
-        return copy;
+        parent.m_capacity = len;
+        parent.m_size = len;
+        parent.m_item_count = m_item_count - 1;
+
+        // Finding the parent's own last item would mean walking it, so
+        // leave that until someone asks
+        parent.m_last_offset =
+            (parent.m_item_count == 0) ? 0 : unknown_offset();
+
+        return parent;
+    }
+
+    /**
+     * Views of the parent and last item together, without copying either.
+     *
+     * Uses the wrapper's knowledge of where its last item starts, so the
+     * PIDL is walked at most once, to measure it, and nothing is allocated.
+     * The views are only valid while this wrapper is alive and unchanged,
+     * and the parent view is @b not null-terminated.
+     *
+     * basic_split_view is defined in pidl_view.hpp, which must be included
+     * to call this.  basic_split_pidl in pidl_split.hpp is the owning
+     * equivalent.
+     */
+    basic_split_view<T> split() const
+    {
+        if (empty())
+            BOOST_THROW_EXCEPTION(
+                std::logic_error("Empty PIDL cannot be split"));
+
+        measure();
+
+        basic_split_view<T> result;
+        result.parent = basic_pidl_view<T>(
+            m_pidl, m_last_offset, m_item_count - 1);
+        result.child = basic_pidl_view<ITEMID_CHILD>(
+            reinterpret_cast<const ITEMID_CHILD __unaligned*>(
+                raw_pidl::skip(m_pidl, m_last_offset)),
+            m_size - sizeof(m_pidl->mkid.cb) - m_last_offset, 1);
+        return result;
     }
 
     /**
      * No-fail swap.
+     *
+     * The wrappers exchange allocators along with their PIDLs so each PIDL
+     * stays with the allocator that allocated it and nothing is copied.
      */
     void swap(basic_pidl& pidl) throw()
     {
-        if (m_allocator == pidl.m_allocator)
-            std::swap(pidl.m_pidl, m_pidl);
+        std::swap(pidl.m_pidl, m_pidl);
+        std::swap(pidl.m_capacity, m_capacity);
+        std::swap(pidl.m_size, m_size);
+        std::swap(pidl.m_item_count, m_item_count);
+        std::swap(pidl.m_last_offset, m_last_offset);
+        std::swap(pidl.m_allocator, m_allocator);
+    }
+
+private:
+    BOOST_COPYABLE_AND_MOVABLE(basic_pidl)
+
+    template<typename U, typename AllocU> friend class basic_pidl;
+
+    template<typename U, typename V, typename AllocU, typename AllocV>
+    friend typename basic_pidl<U, AllocU>::join_pidl operator+(
+        const basic_pidl<U, AllocU>& lhs, const basic_pidl<V, AllocV>& rhs);
+
+    template<typename U, typename V, typename AllocU>
+    friend typename basic_pidl<U, AllocU>::join_pidl operator+(
+        const basic_pidl<U, AllocU>& lhs, const V __unaligned* rhs);
+
+    template<typename U, typename V, typename AllocU>
+    friend typename basic_pidl<U, AllocU>::join_pidl operator+(
+        const V __unaligned* lhs, const basic_pidl<U, AllocU>& rhs);
+
+    /**
+     * Join two measured PIDLs into a new PIDL of exactly the right size.
+     *
+     * Neither PIDL is walked and the result knows its size, item count and
+     * last item from the outset.
+     */
+    template<typename U>
+    static join_pidl join_measured(
+        const T __unaligned* lhs, const raw_pidl::extent& lhs_extent,
+        const U __unaligned* rhs, const raw_pidl::extent& rhs_extent,
+        const join_allocator& alloc)
+    {
+        const size_t terminator_size = sizeof(USHORT);
+
+        join_pidl pidl(alloc);
+        if (!lhs && !rhs)
+            return pidl;
+
+        size_t lhs_len = (lhs) ? lhs_extent.size - terminator_size : 0;
+        size_t rhs_len = (rhs) ? rhs_extent.size : terminator_size;
+        size_t len = lhs_len + rhs_len;
+
+        pidl.m_pidl = pidl.m_allocator.allocate(len);
+        if (lhs_len)
+            std::memcpy(pidl.m_pidl, lhs, lhs_len);
+        if (rhs)
+            std::memcpy(raw_pidl::skip(pidl.m_pidl, lhs_len), rhs, rhs_len);
+        else
+            detail::copy_terminated(
+                raw_pidl::skip(pidl.m_pidl, lhs_len), NULL, 0);
+
+        pidl.m_capacity = len;
+        pidl.m_size = len;
+        pidl.m_item_count = lhs_extent.item_count + rhs_extent.item_count;
+        pidl.m_last_offset = (rhs_extent.item_count) ?
+            lhs_len + rhs_extent.last_offset : lhs_extent.last_offset;
+
+        return pidl;
+    }
+
+    /**
+     * Marks a last-item offset that hasn't been worked out yet.
+     */
+    static size_t unknown_offset()
+    {
+        return static_cast<size_t>(-1);
+    }
+
+    /**
+     * Walk the PIDL to fill in whatever the wrapper doesn't already know
+     * about it.
+     *
+     * A size of zero for a non-NULL PIDL means it arrived via attach() or
+     * out() and hasn't been measured yet.
+     */
+    void measure() const
+    {
+        if (m_pidl && (m_size == 0 || m_last_offset == unknown_offset()))
+        {
+            raw_pidl::extent e = raw_pidl::measure(m_pidl);
+            m_size = e.size;
+            m_item_count = e.item_count;
+            m_last_offset = e.last_offset;
+        }
+    }
+
+    /**
+     * The measurements of the PIDL.  Only valid after calling measure().
+     */
+    raw_pidl::extent cached_extent() const
+    {
+        raw_pidl::extent e = { m_size, m_item_count, m_last_offset };
+        return e;
+    }
+
+    /**
+     * Forget the buffer's capacity and measurements, for instance because
+     * the wrapper has given up the PIDL or been handed a new one.
+     */
+    void forget_extent()
+    {
+        m_capacity = 0;
+        m_size = 0;
+        m_item_count = 0;
+        m_last_offset = 0;
+    }
+
+    /**
+     * Make this (NULL) wrapper hold a copy of a PIDL whose measurements are
+     * already known.
+     */
+    void copy_measured(
+        const T __unaligned* pidl, const raw_pidl::extent& extent)
+    {
+        assert(!m_pidl);
+
+        m_pidl = m_allocator.allocate(extent.size);
+        std::memcpy(m_pidl, pidl, extent.size);
+
+        m_capacity = extent.size;
+        m_size = extent.size;
+        m_item_count = extent.item_count;
+        m_last_offset = extent.last_offset;
+    }
+
+    /**
+     * Append a non-NULL PIDL whose measurements are already known.
+     */
+    template<typename U>
+    basic_pidl& append_measured(
+        const U __unaligned* pidl, const raw_pidl::extent& extent)
+    {
+        assert(pidl);
+
+        if (!m_pidl)
+        {
+            reserve(extent.size);
+            std::memcpy(m_pidl, pidl, extent.size);
+            m_size = extent.size;
+            m_item_count = extent.item_count;
+            m_last_offset = extent.last_offset;
+            return *this;
+        }
+
+        measure();
+
+        size_t offset = m_size - sizeof(m_pidl->mkid.cb);
+        size_t len = offset + extent.size;
+
+        if (len > m_capacity)
+        {
+            // The appended PIDL may be part of this one so copy it before
+            // giving up the old buffer
+            size_t grown = (std::max)(len, 2 * m_capacity);
+            T* mem = m_allocator.allocate(grown);
+            std::memcpy(mem, m_pidl, offset);
+            std::memcpy(raw_pidl::skip(mem, offset), pidl, extent.size);
+
+            m_allocator.deallocate(m_pidl);
+            m_pidl = mem;
+            m_capacity = grown;
+        }
         else
         {
-            // Differing allocators require us to copy memory between the pools
-            basic_pidl<T, Alloc> temp = *this;
-            *this = pidl;
-            pidl = temp;
+            std::memmove(raw_pidl::skip(m_pidl, offset), pidl, extent.size);
+        }
+
+        m_size = len;
+        if (extent.item_count)
+        {
+            m_item_count += extent.item_count;
+            m_last_offset = offset + extent.last_offset;
         }
+
+        return *this;
     }
 
-private:
     T* m_pidl;
+    size_t m_capacity;
+    mutable size_t m_size; ///< Bytes including terminator; zero if unknown
+    mutable size_t m_item_count;
+    mutable size_t m_last_offset; ///< Offset of last item from start
     Alloc m_allocator;
 };
 
@@ -658,30 +1317,85 @@ template<typename T, typename U, typename Alloc, typename AllocU>
 inline typename basic_pidl<T, Alloc>::join_pidl operator+(
     const basic_pidl<T, Alloc>& lhs, const basic_pidl<U, AllocU>& rhs)
 {
-    typedef basic_pidl<T, Alloc>::join_pidl result_type;
+    // Both operands know their sizes so neither is walked to join them
 
-    typename result_type pidl;
-    pidl.attach(
-        raw_pidl::combine<result_type::allocator>(lhs.get(), rhs.get()));
-    return pidl;
+    lhs.measure();
+    rhs.measure();
+
+    return basic_pidl<T, Alloc>::join_measured(
+        lhs.m_pidl, lhs.cached_extent(), rhs.m_pidl, rhs.cached_extent(),
+        typename basic_pidl<T, Alloc>::join_allocator(lhs.get_allocator()));
 }
 
+/**
+ * The raw operand is measured in place and joined straight into the
+ * result rather than being copied into a wrapper first.
+ */
 template<typename T, typename U, typename Alloc>
 inline typename basic_pidl<T, Alloc>::join_pidl operator+(
     const basic_pidl<T, Alloc>& lhs, const U __unaligned* rhs)
 {
-    typedef basic_pidl<U, basic_pidl<T, Alloc>::allocator::rebind<U>::other>
-        wrapped_type;
-    return lhs + wrapped_type(rhs);
+    lhs.measure();
+
+    return basic_pidl<T, Alloc>::join_measured(
+        lhs.m_pidl, lhs.cached_extent(), rhs, raw_pidl::measure(rhs),
+        typename basic_pidl<T, Alloc>::join_allocator(lhs.get_allocator()));
 }
 
 template<typename T, typename U, typename Alloc>
 inline typename basic_pidl<T, Alloc>::join_pidl operator+(
     const U __unaligned* lhs, const basic_pidl<T, Alloc>& rhs)
 {
-    typedef basic_pidl<U, basic_pidl<T, Alloc>::allocator::rebind<U>::other>
-        wrapped_type;
-    return wrapped_type(lhs) + rhs;
+    typedef basic_pidl<
+        U, typename basic_pidl<T, Alloc>::allocator::template rebind<U>::other>
+        lhs_type;
+
+    rhs.measure();
+
+    return lhs_type::join_measured(
+        lhs, raw_pidl::measure(lhs), rhs.m_pidl, rhs.cached_extent(),
+        typename lhs_type::join_allocator(rhs.get_allocator()));
+}
+// @}
+
+/**
+ * @name Concatenation onto a temporary
+ *
+ * Join a PIDL onto an rvalue PIDL with the + operator.
+ *
+ * When the type of the left-hand PIDL doesn't change by joining (relative and
+ * absolute PIDLs), its buffer is taken over and grown in place instead of a
+ * new PIDL being allocated for the result.  Otherwise, the ordinary
+ * overloads are used.
+ *
+ * @returns  The left-hand PIDL with the contents of the second operand
+ *           appended.
+ */
+// @{
+template<typename T, typename U, typename Alloc, typename AllocU>
+inline typename boost::enable_if<
+    boost::is_same<
+        typename basic_pidl<T, Alloc>::join_pidl, basic_pidl<T, Alloc> >,
+    basic_pidl<T, Alloc> >::type
+operator+(
+    BOOST_RV_REF_2_TEMPL_ARGS(basic_pidl, T, Alloc) lhs,
+    const basic_pidl<U, AllocU>& rhs)
+{
+    lhs.append(rhs);
+    return basic_pidl<T, Alloc>(boost::move(lhs));
+}
+
+template<typename T, typename U, typename Alloc>
+inline typename boost::enable_if<
+    boost::is_same<
+        typename basic_pidl<T, Alloc>::join_pidl, basic_pidl<T, Alloc> >,
+    basic_pidl<T, Alloc> >::type
+operator+(
+    BOOST_RV_REF_2_TEMPL_ARGS(basic_pidl, T, Alloc) lhs,
+    const U __unaligned* rhs)
+{
+    lhs.append(rhs);
+    return basic_pidl<T, Alloc>(boost::move(lhs));
 }
 // @}
 
@@ -694,25 +1408,24 @@ inline typename basic_pidl<T, Alloc>::join_pidl operator+(
  * right-hand operand.  It doesn't make sense to append an abolute PIDL to
  * something else.
  *
- * Results in the left-hand PIDL's contents being replaced by new memory
- * that contains the contents of both PIDLs with the null-terminator adjusted
- * appropriately.
+ * Results in the left-hand PIDL containing the contents of both PIDLs with
+ * the null-terminator adjusted appropriately.  The left-hand PIDL's buffer
+ * is grown in place, as by basic_pidl::append, so repeatedly appending to the
+ * same PIDL only reallocates occasionally.
  */
 //@{
 template<typename T, typename U, typename Alloc, typename AllocU>
 inline basic_pidl<T, Alloc>& operator+=(
     basic_pidl<T, Alloc>& lhs, const basic_pidl<U, AllocU>& rhs)
 {
-    lhs = lhs + rhs;
-    return lhs;
+    return lhs.append(rhs);
 }
 
 template<typename T, typename U, typename Alloc>
 inline basic_pidl<T, Alloc>& operator+=(
     basic_pidl<T, Alloc>& lhs, const U* rhs)
 {
-    lhs = lhs + rhs;
-    return lhs;
+    return lhs.append(rhs);
 }
 //@}
 
@@ -727,34 +1440,35 @@ inline void swap(
 }
 
 /**
- * Explicit downcast.
+ * Explicit downcast from raw pointer to basic_pidl.
  */
-template<typename T, typename U, typename Alloc>
-inline T pidl_cast(const basic_pidl<U, Alloc>& pidl)
+template<typename T, typename U>
+inline T pidl_cast(const U* raw_pidl)
 {
-    return pidl_cast<T>(pidl.get());
+    return static_cast<typename T::const_pointer>(raw_pidl);
 }
 
 /**
- * Explicit downcast from raw pointer to basic_pidl.
+ * Explicit downcast.
  */
-template<typename T, typename U>
-inline T pidl_cast(const U* raw_pidl)
+template<typename T, typename U, typename Alloc>
+inline T pidl_cast(const basic_pidl<U, Alloc>& pidl)
 {
-    return static_cast<T::const_pointer>(raw_pidl);
+    return pidl_cast<T>(pidl.get());
 }
 
 /**
  * @name  Standard shell PIDL types.
  *
- * These all use the CoTaskMemAlloc allocation method.
+ * These all use the default_alloc allocation method: CoTaskMemAlloc on
+ * Windows and malloc elsewhere.
  */
 // @{
 typedef basic_pidl<
-    ITEMIDLIST_RELATIVE, cotaskmem_alloc<ITEMIDLIST_RELATIVE> > pidl_t;
+    ITEMIDLIST_RELATIVE, default_alloc<ITEMIDLIST_RELATIVE>::type> pidl_t;
 typedef basic_pidl<
-    ITEMIDLIST_ABSOLUTE, cotaskmem_alloc<ITEMIDLIST_ABSOLUTE> > apidl_t;
-typedef basic_pidl<ITEMID_CHILD, cotaskmem_alloc<ITEMID_CHILD> > cpidl_t;
+    ITEMIDLIST_ABSOLUTE, default_alloc<ITEMIDLIST_ABSOLUTE>::type> apidl_t;
+typedef basic_pidl<ITEMID_CHILD, default_alloc<ITEMID_CHILD>::type> cpidl_t;
 // @}
 
 }}} // namespace washer::shell::pidl
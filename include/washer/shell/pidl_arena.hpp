@@ -0,0 +1,278 @@
+/**
+    @file
+
+    Arena allocation of PIDLs.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#ifndef WASHER_SHELL_PIDL_ARENA_HPP
+#define WASHER_SHELL_PIDL_ARENA_HPP
+#pragma once
+
+#include <washer/shell/pidl.hpp> // basic_pidl
+
+#include <boost/noncopyable.hpp> // noncopyable
+#include <boost/throw_exception.hpp> // BOOST_THROW_EXCEPTION
+
+#include <cassert> // assert
+#include <cstddef> // size_t
+#include <new> // operator new, operator delete
+#include <stdexcept> // logic_error
+#include <vector>
+
+#include <washer/shell/itemidlist.hpp> // Raw PIDL types
+
+namespace washer {
+namespace shell {
+namespace pidl {
+
+/**
+ * Block of memory that PIDLs are carved out of one after another.
+ *
+ * Allocation just advances a pointer through the current block, moving on
+ * to a new block when it is full.  PIDLs are never freed individually;
+ * instead, release() frees every PIDL allocated from the arena at once.
+ * This suits creating a batch of PIDLs, such as the children found by one
+ * enumeration, which all die together.
+ *
+ * Use with basic_pidl through the arena_alloc allocator.  The arena must
+ * outlive every wrapper allocated from it and isn't safe to share between
+ * threads without external locking.
+ */
+class pidl_arena : private boost::noncopyable
+{
+public:
+
+    /**
+     * Size of the blocks the arena allocates unless told otherwise.
+     */
+    static const size_t default_block_size = 64 * 1024;
+
+    /**
+     * All allocations are rounded up to a multiple of this so that every
+     * PIDL from the arena is aligned.
+     */
+    static const size_t alignment = 8;
+
+    explicit pidl_arena(size_t block_size=default_block_size) :
+        m_block_size(block_size), m_blocks_in_use(0), m_next(NULL),
+        m_end(NULL), m_bytes_allocated(0)
+    {
+        assert(block_size > 0);
+    }
+
+    ~pidl_arena() throw()
+    {
+        release();
+        free_blocks(0);
+    }
+
+    /**
+     * Allocate @a size bytes for a PIDL.
+     *
+     * Requests too large to share a block are given a block of their own.
+     */
+    void* allocate(size_t size)
+    {
+        size = (size + alignment - 1) & ~(alignment - 1);
+
+        if (size > m_block_size / 2)
+        {
+            m_large_blocks.reserve(m_large_blocks.size() + 1);
+            void* mem = ::operator new(size);
+            m_large_blocks.push_back(mem);
+            m_bytes_allocated += size;
+            return mem;
+        }
+
+        if (size > static_cast<size_t>(m_end - m_next))
+            next_block();
+
+        void* mem = m_next;
+        m_next += size;
+        m_bytes_allocated += size;
+        return mem;
+    }
+
+    /**
+     * Free every PIDL allocated from the arena.
+     *
+     * The first block is kept so the next batch of PIDLs can reuse it
+     * without going back to the heap.
+     */
+    void release() throw()
+    {
+        for (size_t i = 0; i < m_large_blocks.size(); ++i)
+        {
+            ::operator delete(m_large_blocks[i]);
+        }
+        m_large_blocks.clear();
+
+        free_blocks(1);
+
+        m_blocks_in_use = 0;
+        m_next = NULL;
+        m_end = NULL;
+        m_bytes_allocated = 0;
+    }
+
+    /**
+     * Bytes handed out since the arena was created or last released.
+     */
+    size_t bytes_allocated() const
+    {
+        return m_bytes_allocated;
+    }
+
+    /**
+     * Number of blocks, including oversized ones, the arena currently holds.
+     */
+    size_t block_count() const
+    {
+        return m_blocks.size() + m_large_blocks.size();
+    }
+
+private:
+
+    /**
+     * Move on to the next block, reusing the block kept by release() if
+     * there is one.
+     */
+    void next_block()
+    {
+        if (m_blocks_in_use == m_blocks.size())
+        {
+            m_blocks.reserve(m_blocks.size() + 1);
+            m_blocks.push_back(static_cast<BYTE*>(::operator new(m_block_size)));
+        }
+
+        m_next = m_blocks[m_blocks_in_use++];
+        m_end = m_next + m_block_size;
+    }
+
+    /**
+     * Free all but the first @a keep blocks.
+     */
+    void free_blocks(size_t keep) throw()
+    {
+        while (m_blocks.size() > keep)
+        {
+            ::operator delete(m_blocks.back());
+            m_blocks.pop_back();
+        }
+    }
+
+    size_t m_block_size;
+    std::vector<BYTE*> m_blocks;
+    std::vector<void*> m_large_blocks;
+    size_t m_blocks_in_use;
+    BYTE* m_next; ///< Where the next allocation starts
+    BYTE* m_end; ///< End of the current block
+    size_t m_bytes_allocated;
+};
+
+/**
+ * Allocator for PIDLs carved out of a pidl_arena.
+ *
+ * Deallocating does nothing; the memory is reclaimed when the arena is
+ * released.  A default-constructed allocator has no arena and throws if
+ * asked to allocate.
+ */
+template<typename T>
+class arena_alloc
+{
+public:
+
+    arena_alloc() : m_arena(NULL) {}
+
+    explicit arena_alloc(pidl_arena& arena) : m_arena(&arena) {}
+
+    template<typename U>
+    arena_alloc(const arena_alloc<U>& other) : m_arena(other.arena()) {}
+
+    T* allocate(size_t size) const
+    {
+        if (!m_arena)
+            BOOST_THROW_EXCEPTION(
+                std::logic_error("No arena to allocate PIDL from"));
+
+        return reinterpret_cast<T*>(m_arena->allocate(size));
+    }
+
+    void deallocate(T*) const throw() {}
+
+    /**
+     * The arena this allocator allocates from, if any.
+     */
+    pidl_arena* arena() const
+    {
+        return m_arena;
+    }
+
+    /**
+     * Allow reference to the same arena for different element types.
+     */
+    template<class Other>
+    struct rebind
+    {
+        typedef arena_alloc<Other> other;
+    };
+
+private:
+    pidl_arena* m_arena;
+};
+
+/**
+ * Arena allocators are equal if they allocate from the same arena,
+ * regardless of element type.
+ */
+template<typename T, typename U>
+inline bool operator==(const arena_alloc<T>& lhs, const arena_alloc<U>& rhs)
+{
+    return lhs.arena() == rhs.arena();
+}
+
+template<typename T, typename U>
+inline bool operator!=(const arena_alloc<T>& lhs, const arena_alloc<U>& rhs)
+{
+    return !(lhs == rhs);
+}
+
+/**
+ * @name  Arena-allocated PIDL types.
+ */
+// @{
+typedef basic_pidl<
+    ITEMIDLIST_RELATIVE, arena_alloc<ITEMIDLIST_RELATIVE> > arena_pidl_t;
+typedef basic_pidl<
+    ITEMIDLIST_ABSOLUTE, arena_alloc<ITEMIDLIST_ABSOLUTE> > arena_apidl_t;
+typedef basic_pidl<ITEMID_CHILD, arena_alloc<ITEMID_CHILD> > arena_cpidl_t;
+// @}
+
+}}} // namespace washer::shell::pidl
+
+#endif
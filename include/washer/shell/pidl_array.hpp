@@ -1,7 +1,7 @@
 /**
     @file
 
-    Helper class to use wrapped PIDLs as an array.
+    Arrays of PIDLs in the form the shell's APIs expect.
 
     @if license
 
@@ -33,9 +33,24 @@
 #define WASHER_SHELL_PIDL_ARRAY_HPP
 #pragma once
 
+#include <washer/shell/pidl.hpp> // raw_pidl, default_alloc
+#include <washer/shell/pidl_view.hpp> // basic_pidl_view, measure_items
+
+#include <boost/move/move.hpp> // BOOST_RV_REF, BOOST_COPYABLE_AND_MOVABLE
+#include <boost/static_assert.hpp> // BOOST_STATIC_ASSERT
+#include <boost/throw_exception.hpp> // BOOST_THROW_EXCEPTION
+#include <boost/type_traits/is_convertible.hpp> // is_convertible
+
 #include <algorithm>  // swap, transform
+#include <cassert> // assert
+#include <cstddef> // size_t
+#include <cstring> // memcpy
+#include <iterator> // iterator_traits
+#include <stdexcept> // out_of_range
 #include <vector>
 
+#include <washer/shell/itemidlist.hpp> // Raw PIDL types
+
 namespace washer {
 namespace shell {
 namespace pidl {
@@ -55,7 +70,7 @@ namespace detail {
         std::vector<typename It::value_type::const_pointer> array;
         transform(
             begin, end, back_inserter(array),
-            raw_pidl_from_wrapper<It::value_type>);
+            raw_pidl_from_wrapper<typename It::value_type>);
         return array;
     }
 }
@@ -120,6 +135,314 @@ private:
     std::vector<value_type> m_array;
 };
 
+/**
+ * Array of PIDLs that owns its PIDLs, packed back to back in one block.
+ *
+ * Unlike pidl_array, which points into a collection of wrappers that must
+ * be kept alive alongside it, a packed array copies the PIDLs into a
+ * single allocation.  The block starts with the array of pointers that
+ * as_array() hands to the shell, followed by each PIDL's item count and
+ * then the PIDLs themselves, each null-terminated.  So:
+ *
+ * - as_array() costs nothing: the pointers are already laid out.
+ * - Indexing is O(1) and scanning the PIDLs in order touches memory
+ *   sequentially.
+ * - Moving or swapping an array only exchanges the block.
+ * - Copying is a single allocation and memcpy; only the pointers need
+ *   adjusting to point into the new block.
+ *
+ * The array is immutable once built.
+ *
+ * T is the type of PIDL in the array.  Elements of the source range may be
+ * raw PIDLs, wrappers or views of any PIDL type that upcasts to T.
+ * Alloc is a PIDL allocator, rebound to allocate the block as bytes.
+ */
+template<typename T, typename Alloc = typename default_alloc<T>::type>
+class basic_packed_pidl_array
+{
+public:
+
+    typedef const T __unaligned* value_type;
+    typedef const value_type* const_iterator;
+    typedef const_iterator iterator;
+    typedef size_t size_type;
+    typedef Alloc allocator;
+
+    /**
+     * Empty array.
+     */
+    explicit basic_packed_pidl_array(Alloc alloc=Alloc()) :
+        m_buffer(NULL), m_count(0), m_bytes(0), m_allocator(alloc) {}
+
+    /**
+     * Copy the PIDLs in the range [@a begin, @a end) into the array.
+     *
+     * The range is traversed twice: once to size the block and again to
+     * fill it.  A NULL PIDL in the range is stored as an empty one.
+     */
+    template<typename It>
+    basic_packed_pidl_array(It begin, It end, Alloc alloc=Alloc()) :
+        m_buffer(NULL), m_count(0), m_bytes(0), m_allocator(alloc)
+    {
+        typedef typename detail::pidl_type_of<
+            typename std::iterator_traits<It>::value_type>::type
+            element_type;
+
+        BOOST_STATIC_ASSERT((
+            boost::is_convertible<
+                const element_type*, const T*>::value));
+
+        size_t count = 0;
+        size_t pidl_bytes = 0;
+        for (It it = begin; it != end; ++it)
+        {
+            pidl_bytes +=
+                detail::measure_items(*it).bytes + sizeof(USHORT);
+            ++count;
+        }
+
+        m_bytes = header_bytes(count) + pidl_bytes;
+        m_buffer = m_allocator.allocate(m_bytes);
+        m_count = count;
+
+        value_type* pointers = table();
+        size_t* item_counts = counts();
+        BYTE* next = m_buffer + header_bytes(count);
+        size_t i = 0;
+        for (It it = begin; it != end; ++it, ++i)
+        {
+            detail::measured_items items = detail::measure_items(*it);
+
+            // Ranges that change between the passes would overrun the block
+            assert(i < count);
+            assert(next + items.bytes < m_buffer + m_bytes);
+
+            pointers[i] = reinterpret_cast<value_type>(next);
+            item_counts[i] = items.item_count;
+
+            if (items.bytes)
+                std::memcpy(next, items.data, items.bytes);
+            next += items.bytes;
+
+            USHORT terminator = 0;
+            std::memcpy(next, &terminator, sizeof(terminator));
+            next += sizeof(terminator);
+        }
+
+        assert(next == m_buffer + m_bytes);
+        pointers[count] = reinterpret_cast<value_type>(next);
+
+        try
+        {
+            for (i = 0; i < count; ++i)
+            {
+                raw_pidl::traits<T>::type_check(pointers[i]);
+            }
+        }
+        catch (...)
+        {
+            m_allocator.deallocate(m_buffer);
+            throw;
+        }
+    }
+
+    ~basic_packed_pidl_array() throw()
+    {
+        if (m_buffer)
+            m_allocator.deallocate(m_buffer);
+    }
+
+    /**
+     * Copy construction.
+     *
+     * The copy is one allocation, made by a copy of the other array's
+     * allocator.
+     */
+    basic_packed_pidl_array(const basic_packed_pidl_array& array) :
+        m_buffer(NULL), m_count(0), m_bytes(0),
+        m_allocator(array.m_allocator)
+    {
+        if (!array.m_buffer)
+            return;
+
+        m_buffer = m_allocator.allocate(array.m_bytes);
+        std::memcpy(m_buffer, array.m_buffer, array.m_bytes);
+        m_count = array.m_count;
+        m_bytes = array.m_bytes;
+
+        // The pointers still point into the other block
+        value_type* pointers = table();
+        for (size_t i = 0; i <= m_count; ++i)
+        {
+            pointers[i] = reinterpret_cast<value_type>(
+                m_buffer + (reinterpret_cast<const BYTE*>(pointers[i]) -
+                    array.m_buffer));
+        }
+    }
+
+    /**
+     * Move construction.
+     */
+    basic_packed_pidl_array(BOOST_RV_REF(basic_packed_pidl_array) array) :
+        m_buffer(array.m_buffer), m_count(array.m_count),
+        m_bytes(array.m_bytes), m_allocator(array.m_allocator)
+    {
+        array.m_buffer = NULL;
+        array.m_count = 0;
+        array.m_bytes = 0;
+    }
+
+    basic_packed_pidl_array& operator=(
+        BOOST_COPY_ASSIGN_REF(basic_packed_pidl_array) array)
+    {
+        basic_packed_pidl_array copy(array);
+        swap(copy);
+        return *this;
+    }
+
+    basic_packed_pidl_array& operator=(
+        BOOST_RV_REF(basic_packed_pidl_array) array)
+    {
+        basic_packed_pidl_array moved(boost::move(array));
+        swap(moved);
+        return *this;
+    }
+
+    /**
+     * The array of PIDLs, as expected by APIs taking a
+     * @c PCUITEMID_CHILD_ARRAY or similar.
+     *
+     * NULL if the array is empty.
+     */
+    const value_type* as_array() const
+    {
+        return (m_count) ? table() : NULL;
+    }
+
+    /**
+     * The PIDL at @a index.
+     */
+    value_type operator[](size_t index) const
+    {
+        assert(index < m_count);
+        return table()[index];
+    }
+
+    /**
+     * The PIDL at @a index, checking it is in range.
+     */
+    value_type at(size_t index) const
+    {
+        if (index >= m_count)
+            BOOST_THROW_EXCEPTION(
+                std::out_of_range("PIDL index past end of array"));
+
+        return table()[index];
+    }
+
+    /**
+     * View of the PIDL at @a index, which already knows its size.
+     */
+    basic_pidl_view<T> view(size_t index) const
+    {
+        assert(index < m_count);
+
+        const value_type* pointers = table();
+        return basic_pidl_view<T>(
+            pointers[index],
+            reinterpret_cast<const BYTE*>(pointers[index + 1]) -
+                reinterpret_cast<const BYTE*>(pointers[index]) -
+                sizeof(USHORT),
+            counts()[index]);
+    }
+
+    const_iterator begin() const
+    {
+        return (m_count) ? table() : NULL;
+    }
+
+    const_iterator end() const
+    {
+        return (m_count) ? table() + m_count : NULL;
+    }
+
+    /**
+     * Number of PIDLs in the array.
+     */
+    size_t size() const
+    {
+        return m_count;
+    }
+
+    bool empty() const
+    {
+        return m_count == 0;
+    }
+
+    /**
+     * Size of the single block holding the PIDLs, pointers and counts.
+     */
+    size_t allocated_bytes() const
+    {
+        return m_bytes;
+    }
+
+    Alloc get_allocator() const
+    {
+        return Alloc(m_allocator);
+    }
+
+    /**
+     * No-fail swap.
+     */
+    void swap(basic_packed_pidl_array& array) throw()
+    {
+        std::swap(m_buffer, array.m_buffer);
+        std::swap(m_count, array.m_count);
+        std::swap(m_bytes, array.m_bytes);
+        std::swap(m_allocator, array.m_allocator);
+    }
+
+private:
+    BOOST_COPYABLE_AND_MOVABLE(basic_packed_pidl_array)
+
+    typedef typename Alloc::template rebind<BYTE>::other byte_allocator;
+
+    /**
+     * Bytes before the first PIDL: a pointer to each PIDL, plus one to the
+     * end of the last, then each PIDL's item count.
+     */
+    static size_t header_bytes(size_t count)
+    {
+        return (count + 1) * sizeof(value_type) + count * sizeof(size_t);
+    }
+
+    value_type* table() const
+    {
+        return reinterpret_cast<value_type*>(m_buffer);
+    }
+
+    size_t* counts() const
+    {
+        return reinterpret_cast<size_t*>(
+            m_buffer + (m_count + 1) * sizeof(value_type));
+    }
+
+    BYTE* m_buffer;
+    size_t m_count;
+    size_t m_bytes;
+    byte_allocator m_allocator;
+};
+
+/**
+ * @name  Standard packed array types.
+ */
+// @{
+typedef basic_packed_pidl_array<ITEMIDLIST_RELATIVE> packed_pidl_array;
+typedef basic_packed_pidl_array<ITEMIDLIST_ABSOLUTE> packed_apidl_array;
+typedef basic_packed_pidl_array<ITEMID_CHILD> packed_cpidl_array;
+// @}
+
 }}} // namespace washer::shell::pidl
 
 #endif
@@ -0,0 +1,371 @@
+/**
+    @file
+
+    Joining one parent PIDL to many children in a single allocation.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#ifndef WASHER_SHELL_PIDL_BATCH_HPP
+#define WASHER_SHELL_PIDL_BATCH_HPP
+#pragma once
+
+#include <washer/shell/detail/indexed_iterator.hpp> // indexed_iterator
+#include <washer/shell/pidl.hpp> // basic_pidl, raw_pidl, default_alloc
+#include <washer/shell/pidl_view.hpp> // basic_pidl_view
+
+#include <boost/move/move.hpp> // BOOST_RV_REF, BOOST_MOVABLE_BUT_NOT_COPYABLE
+#include <boost/static_assert.hpp> // BOOST_STATIC_ASSERT
+#include <boost/throw_exception.hpp> // BOOST_THROW_EXCEPTION
+#include <boost/type_traits/is_same.hpp> // is_same
+
+#include <algorithm> // swap
+#include <cassert> // assert
+#include <cstddef> // size_t, ptrdiff_t
+#include <cstring> // memcpy
+#include <iterator> // iterator_traits
+#include <stdexcept> // out_of_range
+
+#include <washer/shell/itemidlist.hpp> // Raw PIDL types
+
+namespace washer {
+namespace shell {
+namespace pidl {
+
+namespace detail {
+
+    /**
+     * Where one joined PIDL starts in the batch's buffer and how many
+     * items it has.
+     */
+    struct batch_entry
+    {
+        size_t offset;
+        size_t item_count;
+    };
+}
+
+/**
+ * One parent PIDL joined to each of a range of children, with every result
+ * held in a single allocation.
+ *
+ * Enumerating a folder produces a run of child PIDLs that, to be any use
+ * outside the folder, each need joining to the folder's own PIDL.  Doing
+ * that with @c + allocates once per child and copies the parent each time.
+ * A batch measures the parent once, sizes every result up front and
+ * writes them all, each null-terminated, into one block along with a
+ * table of where each one starts.  Freeing the batch frees them all.
+ *
+ * The joined PIDLs are presented as views so they can be used in place,
+ * as raw PIDLs through get() or view data(), or copied into wrappers when
+ * one needs to outlive the batch.
+ *
+ * T is the type of the joined PIDLs, which is the type that joining
+ * children to the parent produces: absolute for an absolute parent,
+ * otherwise relative.  Alloc is a PIDL allocator, stateless or stateful;
+ * it is rebound to allocate the block as bytes.
+ */
+template<typename T, typename Alloc = typename default_alloc<T>::type>
+class basic_pidl_batch
+{
+public:
+
+    typedef basic_pidl_view<T> value_type;
+    typedef basic_pidl_view<T> reference;
+    typedef basic_pidl_view<T> const_reference;
+    typedef size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef washer::shell::detail::indexed_iterator<
+        basic_pidl_batch, basic_pidl_view<T> > iterator;
+    typedef iterator const_iterator;
+    typedef Alloc allocator;
+
+    /**
+     * Empty batch.
+     */
+    explicit basic_pidl_batch(Alloc alloc=Alloc()) :
+        m_buffer(NULL), m_count(0), m_bytes(0), m_allocator(alloc) {}
+
+    /**
+     * Join @a parent to each child in the range [@a first, @a last).
+     *
+     * The parent may be a raw PIDL, a wrapper or a view and so may the
+     * range's elements.  A NULL parent is treated as empty, so the results
+     * are copies of the children.  The range is traversed twice: once to
+     * size the block and again to fill it.
+     */
+    template<typename Parent, typename It>
+    basic_pidl_batch(
+        const Parent& parent, It first, It last, Alloc alloc=Alloc()) :
+        m_buffer(NULL), m_count(0), m_bytes(0), m_allocator(alloc)
+    {
+        typedef typename detail::pidl_type_of<Parent>::type parent_type;
+        typedef typename detail::pidl_type_of<
+            typename std::iterator_traits<It>::value_type>::type child_type;
+
+        BOOST_STATIC_ASSERT((
+            boost::is_same<
+                typename raw_pidl::traits<parent_type>::combine_type,
+                T>::value));
+        BOOST_STATIC_ASSERT(raw_pidl::traits<child_type>::is_appendable);
+
+        detail::measured_items head = detail::measure_items(parent);
+
+        size_t count = 0;
+        size_t child_bytes = 0;
+        for (It it = first; it != last; ++it)
+        {
+            child_bytes += detail::measure_items(*it).bytes;
+            ++count;
+        }
+
+        size_t table_bytes = (count + 1) * sizeof(detail::batch_entry);
+        size_t pidl_bytes =
+            count * (head.bytes + sizeof(USHORT)) + child_bytes;
+
+        m_bytes = table_bytes + pidl_bytes;
+        m_buffer = m_allocator.allocate(m_bytes);
+        m_count = count;
+
+        detail::batch_entry* table = entries();
+        BYTE* pidls = m_buffer + table_bytes;
+        size_t offset = 0;
+        size_t i = 0;
+        for (It it = first; it != last; ++it, ++i)
+        {
+            detail::measured_items tail = detail::measure_items(*it);
+
+            // Ranges that change between the passes would overrun the block
+            assert(i < count);
+            assert(offset + head.bytes + tail.bytes < pidl_bytes);
+
+            table[i].offset = offset;
+            table[i].item_count = head.item_count + tail.item_count;
+
+            if (head.bytes)
+                std::memcpy(pidls + offset, head.data, head.bytes);
+            offset += head.bytes;
+            if (tail.bytes)
+                std::memcpy(pidls + offset, tail.data, tail.bytes);
+            offset += tail.bytes;
+
+            USHORT terminator = 0;
+            std::memcpy(pidls + offset, &terminator, sizeof(terminator));
+            offset += sizeof(terminator);
+        }
+
+        assert(offset == pidl_bytes);
+        table[count].offset = offset;
+        table[count].item_count = 0;
+    }
+
+    ~basic_pidl_batch() throw()
+    {
+        if (m_buffer)
+            m_allocator.deallocate(m_buffer);
+    }
+
+    /**
+     * Move construction.
+     */
+    basic_pidl_batch(BOOST_RV_REF(basic_pidl_batch) batch) :
+        m_buffer(batch.m_buffer), m_count(batch.m_count),
+        m_bytes(batch.m_bytes), m_allocator(batch.m_allocator)
+    {
+        batch.m_buffer = NULL;
+        batch.m_count = 0;
+        batch.m_bytes = 0;
+    }
+
+    /**
+     * Move assignment.
+     */
+    basic_pidl_batch& operator=(BOOST_RV_REF(basic_pidl_batch) batch)
+    {
+        basic_pidl_batch moved(boost::move(batch));
+        swap(moved);
+        return *this;
+    }
+
+    /**
+     * The joined PIDL at @a index.
+     */
+    basic_pidl_view<T> operator[](size_t index) const
+    {
+        assert(index < m_count);
+
+        const detail::batch_entry* table = entries();
+        return basic_pidl_view<T>(
+            get(index),
+            table[index + 1].offset - table[index].offset - sizeof(USHORT),
+            table[index].item_count);
+    }
+
+    /**
+     * The joined PIDL at @a index, checking it is in range.
+     */
+    basic_pidl_view<T> at(size_t index) const
+    {
+        if (index >= m_count)
+            BOOST_THROW_EXCEPTION(
+                std::out_of_range("PIDL index past end of batch"));
+
+        return (*this)[index];
+    }
+
+    /**
+     * The joined PIDL at @a index as a raw, null-terminated PIDL.
+     */
+    const T __unaligned* get(size_t index) const
+    {
+        assert(index < m_count);
+
+        return reinterpret_cast<const T __unaligned*>(
+            pidls() + entries()[index].offset);
+    }
+
+    const_iterator begin() const
+    {
+        return const_iterator(*this, 0);
+    }
+
+    const_iterator end() const
+    {
+        return const_iterator(*this, m_count);
+    }
+
+    /**
+     * Number of joined PIDLs.
+     */
+    size_t size() const
+    {
+        return m_count;
+    }
+
+    bool empty() const
+    {
+        return m_count == 0;
+    }
+
+    /**
+     * Size of the single block holding the PIDLs and their offsets.
+     */
+    size_t allocated_bytes() const
+    {
+        return m_bytes;
+    }
+
+    Alloc get_allocator() const
+    {
+        return Alloc(m_allocator);
+    }
+
+    /**
+     * No-fail swap.
+     */
+    void swap(basic_pidl_batch& batch) throw()
+    {
+        std::swap(m_buffer, batch.m_buffer);
+        std::swap(m_count, batch.m_count);
+        std::swap(m_bytes, batch.m_bytes);
+        std::swap(m_allocator, batch.m_allocator);
+    }
+
+private:
+    BOOST_MOVABLE_BUT_NOT_COPYABLE(basic_pidl_batch)
+
+    typedef typename Alloc::template rebind<BYTE>::other byte_allocator;
+
+    /**
+     * The block starts with one entry per PIDL, plus one marking the end of
+     * the last, so that the entries are aligned.  The PIDLs follow.
+     */
+    detail::batch_entry* entries() const
+    {
+        return reinterpret_cast<detail::batch_entry*>(m_buffer);
+    }
+
+    const BYTE* pidls() const
+    {
+        return m_buffer + (m_count + 1) * sizeof(detail::batch_entry);
+    }
+
+    BYTE* m_buffer;
+    size_t m_count;
+    size_t m_bytes;
+    byte_allocator m_allocator;
+};
+
+/**
+ * Join @a parent to each child in the range [@a first, @a last) in a
+ * single allocation.
+ *
+ * The result's PIDL type is that of joining a child to @a parent.
+ */
+// @{
+template<typename T, typename Alloc, typename It>
+inline basic_pidl_batch<
+    typename raw_pidl::traits<T>::combine_type,
+    typename basic_pidl<T, Alloc>::join_allocator>
+join_all(const basic_pidl<T, Alloc>& parent, It first, It last)
+{
+    typedef basic_pidl_batch<
+        typename raw_pidl::traits<T>::combine_type,
+        typename basic_pidl<T, Alloc>::join_allocator> result_type;
+
+    return result_type(
+        parent, first, last,
+        typename result_type::allocator(parent.get_allocator()));
+}
+
+template<typename T, typename It>
+inline basic_pidl_batch<typename raw_pidl::traits<T>::combine_type>
+join_all(const T __unaligned* parent, It first, It last)
+{
+    return basic_pidl_batch<typename raw_pidl::traits<T>::combine_type>(
+        parent, first, last);
+}
+
+template<typename T, typename It>
+inline basic_pidl_batch<typename raw_pidl::traits<T>::combine_type>
+join_all(const basic_pidl_view<T>& parent, It first, It last)
+{
+    return basic_pidl_batch<typename raw_pidl::traits<T>::combine_type>(
+        parent, first, last);
+}
+// @}
+
+/**
+ * @name  Standard batch types.
+ */
+// @{
+typedef basic_pidl_batch<ITEMIDLIST_RELATIVE> pidl_batch;
+typedef basic_pidl_batch<ITEMIDLIST_ABSOLUTE> apidl_batch;
+// @}
+
+}}} // namespace washer::shell::pidl
+
+#endif
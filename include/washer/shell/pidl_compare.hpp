@@ -0,0 +1,413 @@
+/**
+    @file
+
+    Equality, ordering and hashing of PIDLs.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#ifndef WASHER_SHELL_PIDL_COMPARE_HPP
+#define WASHER_SHELL_PIDL_COMPARE_HPP
+#pragma once
+
+#include <washer/shell/pidl.hpp> // basic_pidl, raw_pidl
+#include <washer/shell/pidl_iterator.hpp> // raw_pidl_iterator
+#include <washer/shell/pidl_view.hpp> // basic_pidl_view, measure_items
+
+#include <boost/config.hpp> // BOOST_NO_CXX11_HDR_FUNCTIONAL
+#include <boost/cstdint.hpp> // uint64_t
+
+#include <cstddef> // size_t
+#include <cstring> // memcpy
+
+#ifndef BOOST_NO_CXX11_HDR_FUNCTIONAL
+#include <functional> // hash
+#endif
+
+#include <washer/shell/itemidlist.hpp> // Raw PIDL types
+
+namespace washer {
+namespace shell {
+namespace pidl {
+
+namespace detail {
+
+    /**
+     * The bytes of the items from @a first up to, but not including,
+     * @a last.
+     *
+     * Comparing and hashing only look at the bytes so, unlike
+     * measure_items(), this doesn't count the items and leaves
+     * @c item_count zero.  Unless the range runs to the end of the PIDL,
+     * its length is just the distance between the iterators and no items
+     * are walked at all.
+     */
+    inline measured_items measure_range_bytes(
+        raw_pidl_iterator first, raw_pidl_iterator last)
+    {
+        PCUIDLIST_RELATIVE begin = first.base();
+        if (begin == NULL)
+            return measured_items(NULL, 0, 0);
+
+        if (last.base() == NULL)
+            return measured_items(
+                begin, raw_pidl::size(begin) - sizeof(USHORT), 0);
+
+        return measured_items(
+            begin,
+            reinterpret_cast<const BYTE*>(last.base()) -
+            reinterpret_cast<const BYTE*>(begin),
+            0);
+    }
+
+    /**
+     * Number of leading bytes two runs have in common.
+     *
+     * Compares a word at a time, read through memcpy, and only looks at
+     * individual bytes within the word where they first differ.
+     */
+    inline size_t common_bytes(const BYTE* lhs, const BYTE* rhs, size_t size)
+    {
+        size_t i = 0;
+        for (; size - i >= sizeof(boost::uint64_t);
+             i += sizeof(boost::uint64_t))
+        {
+            boost::uint64_t lhs_word;
+            boost::uint64_t rhs_word;
+            std::memcpy(&lhs_word, lhs + i, sizeof(lhs_word));
+            std::memcpy(&rhs_word, rhs + i, sizeof(rhs_word));
+            if (lhs_word != rhs_word)
+                break;
+        }
+
+        while (i < size && lhs[i] == rhs[i])
+        {
+            ++i;
+        }
+
+        return i;
+    }
+
+    /**
+     * Hash a run of bytes eight at a time.
+     *
+     * This is MurmurHash64A.  The bytes are read a word at a time through
+     * memcpy because nothing about a PIDL is aligned.
+     */
+    inline std::size_t hash_bytes(const measured_items& items)
+    {
+        const boost::uint64_t m = 0xc6a4a7935bd1e995ULL;
+        const int r = 47;
+
+        boost::uint64_t h = 0x9e3779b97f4a7c15ULL ^ (items.bytes * m);
+
+        const BYTE* p = static_cast<const BYTE*>(items.data);
+        const BYTE* words_end = p + (items.bytes & ~size_t(7));
+        for (; p != words_end; p += sizeof(boost::uint64_t))
+        {
+            boost::uint64_t k;
+            std::memcpy(&k, p, sizeof(k));
+
+            k *= m;
+            k ^= k >> r;
+            k *= m;
+
+            h ^= k;
+            h *= m;
+        }
+
+        size_t tail = items.bytes & 7;
+        if (tail)
+        {
+            boost::uint64_t k = 0;
+            std::memcpy(&k, p, tail);
+
+            h ^= k;
+            h *= m;
+        }
+
+        h ^= h >> r;
+        h *= m;
+        h ^= h >> r;
+
+        return static_cast<std::size_t>(h);
+    }
+}
+
+/**
+ * @name  Comparison
+ *
+ * PIDLs are compared by the bytes of their items, never by address, so two
+ * separately-allocated copies of a PIDL are equal.  The null-terminator is
+ * not included which means NULL PIDLs and empty PIDLs are equal to each
+ * other.
+ *
+ * The ordering is lexicographical by byte, the same as that of
+ * basic_pidl_view, so a PIDL sorts immediately before any PIDL that extends
+ * it with more items.  This is a total order suitable for sorted containers
+ * but it is @b not the order the shell would display items in; ask the
+ * parent folder's @c CompareIDs for that.
+ *
+ * Wrappers know their size so comparing them never walks the item list.
+ * Raw PIDLs have to be measured first.
+ */
+// @{
+
+namespace raw_pidl {
+
+    /**
+     * Three-way comparison of two raw PIDLs.
+     *
+     * @returns  Negative, zero or positive as @a lhs orders before, the same
+     *           as or after @a rhs.
+     */
+    template<typename T, typename U>
+    inline int compare(const T __unaligned* lhs, const U __unaligned* rhs)
+    {
+        return detail::compare_bytes(
+            detail::measure_items(lhs), detail::measure_items(rhs));
+    }
+
+    /**
+     * Are two raw PIDLs made of the same bytes?
+     */
+    template<typename T, typename U>
+    inline bool equal(const T __unaligned* lhs, const U __unaligned* rhs)
+    {
+        return detail::equal_bytes(
+            detail::measure_items(lhs), detail::measure_items(rhs));
+    }
+}
+
+/**
+ * Three-way comparison of two wrapped PIDLs.
+ *
+ * @returns  Negative, zero or positive as @a lhs orders before, the same as
+ *           or after @a rhs.
+ */
+template<typename T, typename AllocT, typename U, typename AllocU>
+inline int compare(
+    const basic_pidl<T, AllocT>& lhs, const basic_pidl<U, AllocU>& rhs)
+{
+    return detail::compare_bytes(
+        detail::measure_items(lhs), detail::measure_items(rhs));
+}
+
+/**
+ * Three-way comparison of the items in two iterator ranges.
+ *
+ * Each range covers the items from @c first up to, but not including,
+ * @c last, where @c last may be the end of the PIDL.
+ */
+inline int compare(
+    raw_pidl_iterator first1, raw_pidl_iterator last1,
+    raw_pidl_iterator first2, raw_pidl_iterator last2)
+{
+    return detail::compare_bytes(
+        detail::measure_range_bytes(first1, last1),
+        detail::measure_range_bytes(first2, last2));
+}
+
+/**
+ * Are the items in two iterator ranges made of the same bytes?
+ */
+inline bool equal(
+    raw_pidl_iterator first1, raw_pidl_iterator last1,
+    raw_pidl_iterator first2, raw_pidl_iterator last2)
+{
+    return detail::equal_bytes(
+        detail::measure_range_bytes(first1, last1),
+        detail::measure_range_bytes(first2, last2));
+}
+
+template<typename T, typename AllocT, typename U, typename AllocU>
+inline bool operator==(
+    const basic_pidl<T, AllocT>& lhs, const basic_pidl<U, AllocU>& rhs)
+{
+    return detail::equal_bytes(
+        detail::measure_items(lhs), detail::measure_items(rhs));
+}
+
+template<typename T, typename AllocT, typename U, typename AllocU>
+inline bool operator!=(
+    const basic_pidl<T, AllocT>& lhs, const basic_pidl<U, AllocU>& rhs)
+{
+    return !(lhs == rhs);
+}
+
+template<typename T, typename AllocT, typename U, typename AllocU>
+inline bool operator<(
+    const basic_pidl<T, AllocT>& lhs, const basic_pidl<U, AllocU>& rhs)
+{
+    return compare(lhs, rhs) < 0;
+}
+
+template<typename T, typename AllocT, typename U, typename AllocU>
+inline bool operator>(
+    const basic_pidl<T, AllocT>& lhs, const basic_pidl<U, AllocU>& rhs)
+{
+    return rhs < lhs;
+}
+
+template<typename T, typename AllocT, typename U, typename AllocU>
+inline bool operator<=(
+    const basic_pidl<T, AllocT>& lhs, const basic_pidl<U, AllocU>& rhs)
+{
+    return !(rhs < lhs);
+}
+
+template<typename T, typename AllocT, typename U, typename AllocU>
+inline bool operator>=(
+    const basic_pidl<T, AllocT>& lhs, const basic_pidl<U, AllocU>& rhs)
+{
+    return !(lhs < rhs);
+}
+
+// @}
+
+/**
+ * @name  Hashing
+ *
+ * Hashes are calculated from the same bytes that are compared so PIDLs
+ * that are equal hash equally whether they are raw, wrapped or viewed.
+ *
+ * The hash_value overloads make the wrappers and views usable with
+ * boost::hash.  They are usable with std::hash too, where the standard
+ * library has it.
+ */
+// @{
+
+namespace raw_pidl {
+
+    template<typename T>
+    inline std::size_t hash(const T __unaligned* pidl)
+    {
+        return detail::hash_bytes(detail::measure_items(pidl));
+    }
+}
+
+/**
+ * Hash of the items from @a first up to, but not including, @a last.
+ */
+inline std::size_t hash(raw_pidl_iterator first, raw_pidl_iterator last)
+{
+    return detail::hash_bytes(detail::measure_range_bytes(first, last));
+}
+
+template<typename T, typename Alloc>
+inline std::size_t hash_value(const basic_pidl<T, Alloc>& pidl)
+{
+    return detail::hash_bytes(detail::measure_items(pidl));
+}
+
+template<typename T>
+inline std::size_t hash_value(const basic_pidl_view<T>& view)
+{
+    return detail::hash_bytes(detail::measure_items(view));
+}
+
+// @}
+
+/**
+ * @name  Function objects
+ *
+ * These accept any mix of raw PIDLs, wrappers and views so that, for
+ * example, a hash table keyed on wrappers can be searched with a raw PIDL.
+ */
+// @{
+
+struct pidl_hash
+{
+    typedef std::size_t result_type;
+
+    template<typename P>
+    std::size_t operator()(const P& pidl) const
+    {
+        return detail::hash_bytes(detail::measure_items(pidl));
+    }
+};
+
+struct pidl_equal_to
+{
+    typedef bool result_type;
+
+    template<typename P, typename Q>
+    bool operator()(const P& lhs, const Q& rhs) const
+    {
+        return detail::equal_bytes(
+            detail::measure_items(lhs), detail::measure_items(rhs));
+    }
+};
+
+struct pidl_less
+{
+    typedef bool result_type;
+
+    template<typename P, typename Q>
+    bool operator()(const P& lhs, const Q& rhs) const
+    {
+        return detail::compare_bytes(
+            detail::measure_items(lhs), detail::measure_items(rhs)) < 0;
+    }
+};
+
+// @}
+
+}}} // namespace washer::shell::pidl
+
+#ifndef BOOST_NO_CXX11_HDR_FUNCTIONAL
+
+namespace std {
+
+template<typename T, typename Alloc>
+struct hash< ::washer::shell::pidl::basic_pidl<T, Alloc> >
+{
+    typedef ::washer::shell::pidl::basic_pidl<T, Alloc> argument_type;
+    typedef std::size_t result_type;
+
+    std::size_t operator()(const argument_type& pidl) const
+    {
+        return ::washer::shell::pidl::hash_value(pidl);
+    }
+};
+
+template<typename T>
+struct hash< ::washer::shell::pidl::basic_pidl_view<T> >
+{
+    typedef ::washer::shell::pidl::basic_pidl_view<T> argument_type;
+    typedef std::size_t result_type;
+
+    std::size_t operator()(const argument_type& view) const
+    {
+        return ::washer::shell::pidl::hash_value(view);
+    }
+};
+
+}
+
+#endif
+
+#endif
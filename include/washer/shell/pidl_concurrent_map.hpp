@@ -0,0 +1,540 @@
+/**
+    @file
+
+    Hash map keyed by PIDL that many threads can use at once.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#ifndef WASHER_SHELL_PIDL_CONCURRENT_MAP_HPP
+#define WASHER_SHELL_PIDL_CONCURRENT_MAP_HPP
+#pragma once
+
+#include <washer/shell/pidl.hpp> // basic_pidl
+#include <washer/shell/pidl_compare.hpp> // hash_bytes, measure_items
+#include <washer/shell/pidl_view.hpp> // basic_pidl_view, view_as
+
+#include <boost/noncopyable.hpp> // noncopyable
+#include <boost/optional/optional.hpp> // optional
+#include <boost/thread/locks.hpp> // lock_guard
+#include <boost/thread/mutex.hpp> // mutex
+
+#include <cassert> // assert
+#include <cstddef> // size_t
+#include <cstring> // memcmp, memcpy, memset
+#include <limits> // numeric_limits
+#include <new> // operator new, operator delete
+#include <vector>
+
+#include <washer/shell/itemidlist.hpp> // Raw PIDL types
+
+namespace washer {
+namespace shell {
+namespace pidl {
+
+namespace detail {
+
+    /**
+     * An entry in a concurrent PIDL map.
+     *
+     * The key's bytes, including its null-terminator, follow the node in
+     * the same allocation so an entry costs one allocation, not one for
+     * the node and another for a basic_pidl key.
+     */
+    template<typename Value>
+    struct concurrent_map_node : private boost::noncopyable
+    {
+        concurrent_map_node(
+            std::size_t hash, const measured_items& items, const Value& value)
+            : next(NULL), hash(hash), item_bytes(items.bytes),
+              item_count(items.item_count), value(value) {}
+
+        const BYTE* bytes() const
+        {
+            return reinterpret_cast<const BYTE*>(this + 1);
+        }
+
+        BYTE* bytes()
+        {
+            return reinterpret_cast<BYTE*>(this + 1);
+        }
+
+        bool matches(
+            std::size_t other_hash, const measured_items& items) const
+        {
+            return hash == other_hash && item_bytes == items.bytes &&
+                (items.bytes == 0 ||
+                 std::memcmp(bytes(), items.data, items.bytes) == 0);
+        }
+
+        concurrent_map_node* next;
+        std::size_t hash;
+        std::size_t item_bytes; ///< Not counting the terminator
+        std::size_t item_count;
+        Value value;
+    };
+
+    template<typename Value>
+    inline concurrent_map_node<Value>* create_node(
+        std::size_t hash, const measured_items& items, const Value& value)
+    {
+        typedef concurrent_map_node<Value> node;
+
+        void* memory =
+            ::operator new(sizeof(node) + items.bytes + sizeof(USHORT));
+        node* entry;
+        try
+        {
+            entry = new (memory) node(hash, items, value);
+        }
+        catch (...)
+        {
+            ::operator delete(memory);
+            throw;
+        }
+
+        if (items.bytes)
+            std::memcpy(entry->bytes(), items.data, items.bytes);
+        std::memset(entry->bytes() + items.bytes, 0, sizeof(USHORT));
+
+        return entry;
+    }
+
+    template<typename Value>
+    inline void destroy_node(concurrent_map_node<Value>* entry) throw()
+    {
+        entry->~concurrent_map_node<Value>();
+        ::operator delete(entry);
+    }
+
+    /**
+     * One lock's worth of a concurrent PIDL map: a chained hash table.
+     */
+    template<typename Value>
+    struct concurrent_map_shard : private boost::noncopyable
+    {
+        typedef concurrent_map_node<Value> node;
+
+        concurrent_map_shard() : buckets(initial_buckets), count(0) {}
+
+        ~concurrent_map_shard()
+        {
+            clear();
+        }
+
+        node* find(std::size_t hash, const measured_items& items) const
+        {
+            node* entry = buckets[hash & (buckets.size() - 1)];
+            while (entry && !entry->matches(hash, items))
+                entry = entry->next;
+            return entry;
+        }
+
+        /**
+         * Add a node whose key isn't already in the shard.
+         */
+        void link(node* entry)
+        {
+            // Grow before linking so a failure leaves the shard unchanged
+            if (count + 1 > buckets.size())
+                rehash(buckets.size() * 2);
+
+            node*& head = buckets[entry->hash & (buckets.size() - 1)];
+            entry->next = head;
+            head = entry;
+            ++count;
+        }
+
+        node* unlink(std::size_t hash, const measured_items& items)
+        {
+            node** link = &buckets[hash & (buckets.size() - 1)];
+            while (*link && !(*link)->matches(hash, items))
+                link = &(*link)->next;
+
+            node* entry = *link;
+            if (entry)
+            {
+                *link = entry->next;
+                --count;
+            }
+            return entry;
+        }
+
+        void rehash(std::size_t bucket_count)
+        {
+            std::vector<node*> grown(bucket_count);
+            for (std::size_t i = 0; i < buckets.size(); ++i)
+            {
+                node* entry = buckets[i];
+                while (entry)
+                {
+                    node* next = entry->next;
+                    node*& head = grown[entry->hash & (bucket_count - 1)];
+                    entry->next = head;
+                    head = entry;
+                    entry = next;
+                }
+            }
+            buckets.swap(grown);
+        }
+
+        void clear()
+        {
+            for (std::size_t i = 0; i < buckets.size(); ++i)
+            {
+                node* entry = buckets[i];
+                while (entry)
+                {
+                    node* next = entry->next;
+                    destroy_node(entry);
+                    entry = next;
+                }
+                buckets[i] = NULL;
+            }
+            count = 0;
+        }
+
+        static const std::size_t initial_buckets = 16;
+
+        mutable boost::mutex mutex;
+        std::vector<node*> buckets; ///< Always a power of two
+        std::size_t count;
+    };
+
+    /**
+     * Size of the cache lines that threads contend for.
+     *
+     * 64 bytes on every x86 and x64 processor Windows runs on.
+     */
+    const std::size_t cache_line_size = 64;
+
+    /**
+     * A shard followed by a cache line of padding.
+     *
+     * Without it, neighbouring shards share cache lines, so threads
+     * taking different shards' locks still fight over the same line.  The
+     * array of shards need not start on a cache line, so the padding is a
+     * whole line rather than just enough to round up to one: that keeps
+     * the last line one shard touches clear of the next shard wherever the
+     * array starts.
+     */
+    template<typename Shard>
+    struct cache_line_padded : Shard
+    {
+        char padding[cache_line_size];
+    };
+}
+
+/**
+ * Hash map keyed by PIDL that is safe to use from many threads at once.
+ *
+ * Meant for caches of things looked up by PIDL, such as attributes,
+ * display names and icons, that many threads read and few write.  The map
+ * is split into 64 shards by hash, like basic_pidl_intern_table, each with
+ * its own lock, so threads only wait for each other when they use the same
+ * shard at the same moment.  Shards are padded apart so that their locks
+ * don't share cache lines.  Keys are hashed and measured before taking a
+ * lock, leaving little more than a comparison inside it, which is why a
+ * plain mutex is used: a reader-writer lock costs more to take than the
+ * lookups it would let run in parallel.
+ *
+ * Each entry is a single allocation holding the value and a copy of the
+ * key, so no basic_pidl is allocated to store a key.  Keys are hashed
+ * once per operation, over the length already known to a wrapper or
+ * view, and the hash is kept with the entry so collisions are rejected
+ * without comparing the keys.
+ *
+ * Lookups return a copy of the value as the entry may be changed or
+ * removed by another thread as soon as the shard's lock is released.
+ * Keep values cheap to copy, for instance by holding a shared_ptr.
+ *
+ * Keys may be given as raw PIDLs, wrappers or views of any PIDL type that
+ * upcasts to T.
+ */
+template<typename T, typename Value>
+class basic_concurrent_pidl_map : private boost::noncopyable
+{
+    typedef detail::concurrent_map_shard<Value> shard_type;
+    typedef typename shard_type::node node;
+
+public:
+
+    typedef Value mapped_type;
+
+    basic_concurrent_pidl_map() {}
+
+    /**
+     * @name  Lookup
+     */
+    // @{
+
+    /**
+     * Copy of the value for @a pidl, if the map has one.
+     */
+    template<typename P>
+    boost::optional<Value> find(const P& pidl) const
+    {
+        detail::measured_items items = measure(pidl);
+        std::size_t hash = hash_of(items);
+        const shard_type& shard = shard_for(hash);
+
+        boost::lock_guard<boost::mutex> lock(shard.mutex);
+
+        node* entry = shard.find(hash, items);
+        if (entry)
+            return entry->value;
+        else
+            return boost::none;
+    }
+
+    template<typename P>
+    bool contains(const P& pidl) const
+    {
+        detail::measured_items items = measure(pidl);
+        std::size_t hash = hash_of(items);
+        const shard_type& shard = shard_for(hash);
+
+        boost::lock_guard<boost::mutex> lock(shard.mutex);
+        return shard.find(hash, items) != NULL;
+    }
+
+    /**
+     * The value for @a pidl, calling @a make to create it if the map has
+     * none.
+     *
+     * @a make is called without holding any lock, so it may be slow or
+     * use the map itself.  If another thread adds a value for the same
+     * key meanwhile, theirs is kept and returned and the one made here is
+     * discarded.
+     */
+    template<typename P, typename Factory>
+    Value find_or_insert(const P& pidl, Factory make)
+    {
+        detail::measured_items items = measure(pidl);
+        std::size_t hash = hash_of(items);
+        shard_type& shard = shard_for(hash);
+
+        {
+            boost::lock_guard<boost::mutex> lock(shard.mutex);
+            node* entry = shard.find(hash, items);
+            if (entry)
+                return entry->value;
+        }
+
+        node* created = detail::create_node(hash, items, Value(make()));
+
+        boost::lock_guard<boost::mutex> lock(shard.mutex);
+
+        node* entry = shard.find(hash, items);
+        if (entry)
+        {
+            detail::destroy_node(created);
+            return entry->value;
+        }
+
+        link(shard, created);
+        return created->value;
+    }
+
+    // @}
+
+    /**
+     * @name  Modifiers
+     */
+    // @{
+
+    /**
+     * Add @a value for @a pidl unless the map already has a value for it.
+     *
+     * The entry is made before taking the lock, as find_or_insert() does,
+     * so allocating it and copying the value don't hold up other threads.
+     * It is thrown away if the map already has a value.
+     *
+     * @returns whether the value was added.
+     */
+    template<typename P>
+    bool insert(const P& pidl, const Value& value)
+    {
+        detail::measured_items items = measure(pidl);
+        std::size_t hash = hash_of(items);
+        shard_type& shard = shard_for(hash);
+
+        node* created = detail::create_node(hash, items, value);
+
+        {
+            boost::lock_guard<boost::mutex> lock(shard.mutex);
+
+            if (!shard.find(hash, items))
+            {
+                link(shard, created);
+                return true;
+            }
+        }
+
+        detail::destroy_node(created);
+        return false;
+    }
+
+    /**
+     * Set the value for @a pidl, replacing any it already has.
+     *
+     * The new entry is made before taking the lock and swapped for the old
+     * one inside it, so the lock isn't held while copying the value.
+     *
+     * @returns whether the key is new to the map.
+     */
+    template<typename P>
+    bool insert_or_assign(const P& pidl, const Value& value)
+    {
+        detail::measured_items items = measure(pidl);
+        std::size_t hash = hash_of(items);
+        shard_type& shard = shard_for(hash);
+
+        node* created = detail::create_node(hash, items, value);
+
+        node* replaced;
+        {
+            boost::lock_guard<boost::mutex> lock(shard.mutex);
+
+            // Unlinking any old entry first means the shard can't need to
+            // grow, so linking the new one can only fail for a new key
+            replaced = shard.unlink(hash, items);
+            link(shard, created);
+        }
+
+        // Destroy the old value outside the lock in case that is slow
+        if (replaced)
+            detail::destroy_node(replaced);
+        return replaced == NULL;
+    }
+
+    /**
+     * Remove the value for @a pidl.
+     *
+     * @returns whether the map had a value to remove.
+     */
+    template<typename P>
+    bool erase(const P& pidl)
+    {
+        detail::measured_items items = measure(pidl);
+        std::size_t hash = hash_of(items);
+        shard_type& shard = shard_for(hash);
+
+        node* entry;
+        {
+            boost::lock_guard<boost::mutex> lock(shard.mutex);
+            entry = shard.unlink(hash, items);
+        }
+
+        // Destroy the value outside the lock in case that is slow
+        if (entry)
+            detail::destroy_node(entry);
+        return entry != NULL;
+    }
+
+    /**
+     * Remove every entry.
+     *
+     * Each shard is cleared in turn, so entries added by other threads
+     * meanwhile may survive.
+     */
+    void clear()
+    {
+        for (std::size_t i = 0; i < shard_count; ++i)
+        {
+            boost::lock_guard<boost::mutex> lock(m_shards[i].mutex);
+            m_shards[i].clear();
+        }
+    }
+
+    // @}
+
+    /**
+     * Number of entries.
+     *
+     * Only a snapshot if other threads are changing the map.
+     */
+    std::size_t size() const
+    {
+        std::size_t total = 0;
+        for (std::size_t i = 0; i < shard_count; ++i)
+        {
+            boost::lock_guard<boost::mutex> lock(m_shards[i].mutex);
+            total += m_shards[i].count;
+        }
+        return total;
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+private:
+
+    static const std::size_t shard_bits = 6;
+    static const std::size_t shard_count = 1 << shard_bits;
+
+    template<typename P>
+    static detail::measured_items measure(const P& pidl)
+    {
+        return detail::measure_items(detail::view_as<T>(pidl));
+    }
+
+    static std::size_t hash_of(const detail::measured_items& items)
+    {
+        return detail::hash_bytes(items);
+    }
+
+    /**
+     * Each shard buckets its entries by the low bits of the hash so pick
+     * the shard from the top bits to keep the two choices independent.
+     */
+    shard_type& shard_for(std::size_t hash) const
+    {
+        return m_shards[
+            hash >> (std::numeric_limits<std::size_t>::digits - shard_bits)];
+    }
+
+    static void link(shard_type& shard, node* entry)
+    {
+        try
+        {
+            shard.link(entry);
+        }
+        catch (...)
+        {
+            detail::destroy_node(entry);
+            throw;
+        }
+    }
+
+    mutable detail::cache_line_padded<shard_type> m_shards[shard_count];
+};
+
+}}} // namespace washer::shell::pidl
+
+#endif
@@ -0,0 +1,815 @@
+/**
+    @file
+
+    Sorted flat set and map of PIDLs.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#ifndef WASHER_SHELL_PIDL_FLAT_SET_HPP
+#define WASHER_SHELL_PIDL_FLAT_SET_HPP
+#pragma once
+
+#include <washer/shell/pidl.hpp> // basic_pidl, default_alloc
+#include <washer/shell/pidl_compare.hpp> // compare_bytes, measure_items
+#include <washer/shell/pidl_view.hpp> // basic_pidl_view, view_as
+
+#include <boost/container/vector.hpp> // vector
+#include <boost/cstdint.hpp> // uint64_t
+#include <boost/move/move.hpp> // BOOST_RV_REF, BOOST_COPYABLE_AND_MOVABLE
+
+#include <algorithm> // lower_bound, min, stable_sort, swap, unique
+#include <cassert> // assert
+#include <cstddef> // size_t
+#include <utility> // pair
+#include <vector>
+
+#include <washer/shell/itemidlist.hpp> // Raw PIDL types
+
+namespace washer {
+namespace shell {
+namespace pidl {
+
+namespace detail {
+
+    /**
+     * A PIDL from a source range, measured once so it can be sorted
+     * without walking it again.
+     */
+    struct sort_entry
+    {
+        sort_entry(const measured_items& items, size_t position)
+            : items(items), position(position) {}
+
+        measured_items items;
+        size_t position; ///< Index of the PIDL in the source range
+    };
+
+    inline bool sort_entry_less(const sort_entry& lhs, const sort_entry& rhs)
+    {
+        return compare_bytes(lhs.items, rhs.items) < 0;
+    }
+
+    inline bool sort_entry_equal(
+        const sort_entry& lhs, const sort_entry& rhs)
+    {
+        return equal_bytes(lhs.items, rhs.items);
+    }
+
+    /**
+     * Sort the keys measured from a range and drop all but the first of
+     * each run of equal keys.
+     */
+    inline void sort_unique(std::vector<sort_entry>& entries)
+    {
+        std::stable_sort(entries.begin(), entries.end(), sort_entry_less);
+        entries.erase(
+            std::unique(entries.begin(), entries.end(), sort_entry_equal),
+            entries.end());
+    }
+
+    /**
+     * What a flat set searches: where each PIDL is, its length and its
+     * first eight bytes packed so they compare as an integer.
+     *
+     * Most comparisons are settled by the prefix without touching the
+     * PIDL's own memory, and the keys are packed far more densely than the
+     * wrappers.  Shorter PIDLs are padded with zeros, which orders them
+     * the same as compare_bytes.
+     */
+    struct search_key
+    {
+        explicit search_key(const measured_items& items)
+            : items(items), prefix(0)
+        {
+            const BYTE* bytes = static_cast<const BYTE*>(items.data);
+            size_t count = (std::min)(items.bytes, sizeof(prefix));
+            for (size_t i = 0; i < count; ++i)
+            {
+                prefix |= static_cast<boost::uint64_t>(bytes[i]) <<
+                    (8 * (sizeof(prefix) - 1 - i));
+            }
+        }
+
+        measured_items items;
+        boost::uint64_t prefix;
+    };
+
+    inline bool search_key_less(const search_key& lhs, const search_key& rhs)
+    {
+        if (lhs.prefix != rhs.prefix)
+            return lhs.prefix < rhs.prefix;
+        else
+            return compare_bytes(lhs.items, rhs.items) < 0;
+    }
+}
+
+/**
+ * Set of PIDLs kept sorted in a single array.
+ *
+ * The PIDLs are ordered by their bytes, as by pidl_less.  Alongside the
+ * wrappers, the set keeps a compact array with each PIDL's length and
+ * first few bytes, so lookups are a binary search over contiguous memory
+ * that mostly doesn't need to visit the PIDLs themselves.  This suits sets
+ * that are built once and searched often, such as the items selected in a
+ * view.
+ *
+ * - Building a set from a range sorts the range once and drops duplicates,
+ *   keeping the first, rather than inserting the PIDLs one at a time.
+ * - insert() and erase() of single PIDLs shift the later elements so cost
+ *   O(N), although no PIDL is copied to do it.
+ * - set_union(), set_intersection() and set_difference() merge two sets
+ *   in linear time.
+ *
+ * Lookups accept raw PIDLs, wrappers and views of any type.  Raw PIDLs
+ * are measured once per lookup, not once per comparison.  An empty PIDL
+ * and a NULL one are the same element.
+ *
+ * Inserting or erasing invalidates iterators and references to elements.
+ */
+template<typename T, typename Alloc = typename default_alloc<T>::type>
+class basic_pidl_flat_set
+{
+    typedef boost::container::vector< basic_pidl<T, Alloc> > storage_type;
+
+public:
+
+    typedef basic_pidl<T, Alloc> value_type;
+    typedef basic_pidl<T, Alloc> key_type;
+    typedef const value_type& reference;
+    typedef const value_type& const_reference;
+    typedef typename storage_type::const_iterator const_iterator;
+    typedef const_iterator iterator;
+    typedef size_t size_type;
+    typedef Alloc allocator;
+
+    /**
+     * Empty set.
+     */
+    explicit basic_pidl_flat_set(Alloc alloc=Alloc()) : m_allocator(alloc) {}
+
+    /**
+     * Set of the PIDLs in the range [@a begin, @a end).
+     *
+     * Elements of the range may be raw PIDLs, wrappers or views of any
+     * PIDL type that upcasts to T.  Each is measured once, the range is
+     * sorted and the distinct PIDLs are copied into the set in order.
+     */
+    template<typename It>
+    basic_pidl_flat_set(It begin, It end, Alloc alloc=Alloc())
+        : m_allocator(alloc)
+    {
+        std::vector<detail::sort_entry> entries;
+        size_t position = 0;
+        for (It it = begin; it != end; ++it, ++position)
+        {
+            entries.push_back(
+                detail::sort_entry(
+                    detail::measure_items(detail::view_as<T>(*it)),
+                    position));
+        }
+
+        detail::sort_unique(entries);
+
+        reserve(entries.size());
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            push_back_ordered(view_of(entries[i]));
+        }
+    }
+
+    basic_pidl_flat_set(const basic_pidl_flat_set& other)
+        : m_items(other.m_items), m_keys(other.m_keys),
+          m_allocator(other.m_allocator)
+    {
+        // The copied keys still point at the other set's PIDLs
+        for (size_t i = 0; i < m_keys.size(); ++i)
+        {
+            m_keys[i].items.data = m_items[i].get();
+        }
+    }
+
+    /**
+     * The keys go on pointing at the same PIDLs, which move with the
+     * wrappers.
+     */
+    basic_pidl_flat_set(BOOST_RV_REF(basic_pidl_flat_set) other)
+        : m_items(boost::move(other.m_items)),
+          m_keys(boost::move(other.m_keys)),
+          m_allocator(other.m_allocator) {}
+
+    basic_pidl_flat_set& operator=(
+        BOOST_COPY_ASSIGN_REF(basic_pidl_flat_set) other)
+    {
+        basic_pidl_flat_set copy(other);
+        swap(copy);
+        return *this;
+    }
+
+    basic_pidl_flat_set& operator=(BOOST_RV_REF(basic_pidl_flat_set) other)
+    {
+        swap(other);
+        return *this;
+    }
+
+    /**
+     * @name  Lookup
+     */
+    // @{
+
+    /**
+     * Whether the set holds a PIDL equal to @a pidl.
+     */
+    template<typename P>
+    bool contains(const P& pidl) const
+    {
+        return find(pidl) != end();
+    }
+
+    template<typename P>
+    size_t count(const P& pidl) const
+    {
+        return (contains(pidl)) ? 1 : 0;
+    }
+
+    /**
+     * The element equal to @a pidl or end() if there is none.
+     */
+    template<typename P>
+    const_iterator find(const P& pidl) const
+    {
+        detail::search_key key(detail::measure_items(pidl));
+        size_t index = lower_bound_position(key);
+        return (is_match(index, key)) ? begin() + index : end();
+    }
+
+    /**
+     * The first element not ordered before @a pidl.
+     */
+    template<typename P>
+    const_iterator lower_bound(const P& pidl) const
+    {
+        detail::search_key key(detail::measure_items(pidl));
+        return begin() + lower_bound_position(key);
+    }
+
+    // @}
+
+    /**
+     * @name  Modifiers
+     */
+    // @{
+
+    /**
+     * Add a copy of @a pidl unless the set already has an equal PIDL.
+     *
+     * @returns the element equal to @a pidl and whether it was inserted.
+     */
+    template<typename P>
+    std::pair<const_iterator, bool> insert(const P& pidl)
+    {
+        basic_pidl_view<T> view = detail::view_as<T>(pidl);
+        detail::search_key key(detail::measure_items(view));
+
+        size_t index = lower_bound_position(key);
+        if (is_match(index, key))
+            return std::make_pair(begin() + index, false);
+
+        insert_at(index, view);
+        return std::make_pair(begin() + index, true);
+    }
+
+    /**
+     * Remove the PIDL equal to @a pidl.
+     *
+     * @returns the number of PIDLs removed: 0 or 1.
+     */
+    template<typename P>
+    size_t erase(const P& pidl)
+    {
+        const_iterator it = find(pidl);
+        if (it == end())
+            return 0;
+
+        erase(it);
+        return 1;
+    }
+
+    const_iterator erase(const_iterator position)
+    {
+        m_keys.erase(m_keys.begin() + (position - begin()));
+        return m_items.erase(position);
+    }
+
+    void clear()
+    {
+        m_items.clear();
+        m_keys.clear();
+    }
+
+    /**
+     * Make room for @a count elements without reallocating the array.
+     */
+    void reserve(size_t count)
+    {
+        m_items.reserve(count);
+        m_keys.reserve(count);
+    }
+
+    void swap(basic_pidl_flat_set& other)
+    {
+        m_items.swap(other.m_items);
+        m_keys.swap(other.m_keys);
+        std::swap(m_allocator, other.m_allocator);
+    }
+
+    // @}
+
+    /**
+     * @name  Elements
+     */
+    // @{
+
+    /**
+     * The element at @a index in order.
+     */
+    const value_type& operator[](size_t index) const
+    {
+        assert(index < size());
+        return m_items[index];
+    }
+
+    const_iterator begin() const
+    {
+        return m_items.begin();
+    }
+
+    const_iterator end() const
+    {
+        return m_items.end();
+    }
+
+    size_t size() const
+    {
+        return m_items.size();
+    }
+
+    bool empty() const
+    {
+        return m_items.empty();
+    }
+
+    Alloc get_allocator() const
+    {
+        return m_allocator;
+    }
+
+    // @}
+
+    /**
+     * @name  Set operations
+     *
+     * The result holds copies of the PIDLs and uses the allocator of the
+     * left-hand set.
+     */
+    // @{
+
+    /**
+     * PIDLs in either set.
+     */
+    friend basic_pidl_flat_set set_union(
+        const basic_pidl_flat_set& lhs, const basic_pidl_flat_set& rhs)
+    {
+        return merge(lhs, rhs, true, true, true);
+    }
+
+    /**
+     * PIDLs in both sets.
+     */
+    friend basic_pidl_flat_set set_intersection(
+        const basic_pidl_flat_set& lhs, const basic_pidl_flat_set& rhs)
+    {
+        return merge(lhs, rhs, false, true, false);
+    }
+
+    /**
+     * PIDLs in @a lhs but not in @a rhs.
+     */
+    friend basic_pidl_flat_set set_difference(
+        const basic_pidl_flat_set& lhs, const basic_pidl_flat_set& rhs)
+    {
+        return merge(lhs, rhs, true, false, false);
+    }
+
+    // @}
+
+    friend bool operator==(
+        const basic_pidl_flat_set& lhs, const basic_pidl_flat_set& rhs)
+    {
+        if (lhs.size() != rhs.size())
+            return false;
+
+        for (size_t i = 0; i < lhs.size(); ++i)
+        {
+            if (!detail::equal_bytes(
+                    detail::measure_items(lhs[i]),
+                    detail::measure_items(rhs[i])))
+                return false;
+        }
+
+        return true;
+    }
+
+    friend bool operator!=(
+        const basic_pidl_flat_set& lhs, const basic_pidl_flat_set& rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+private:
+    BOOST_COPYABLE_AND_MOVABLE(basic_pidl_flat_set)
+
+    template<typename, typename, typename> friend class basic_pidl_flat_map;
+
+    static basic_pidl_flat_set merge(
+        const basic_pidl_flat_set& lhs, const basic_pidl_flat_set& rhs,
+        bool keep_only_lhs, bool keep_both, bool keep_only_rhs)
+    {
+        basic_pidl_flat_set result(lhs.m_allocator);
+
+        const_iterator left = lhs.begin();
+        const_iterator right = rhs.begin();
+        while (left != lhs.end() && right != rhs.end())
+        {
+            int order = detail::compare_bytes(
+                detail::measure_items(*left), detail::measure_items(*right));
+            if (order < 0)
+            {
+                if (keep_only_lhs)
+                    result.push_back_copy(*left);
+                ++left;
+            }
+            else if (order > 0)
+            {
+                if (keep_only_rhs)
+                    result.push_back_copy(*right);
+                ++right;
+            }
+            else
+            {
+                if (keep_both)
+                    result.push_back_copy(*left);
+                ++left;
+                ++right;
+            }
+        }
+
+        if (keep_only_lhs)
+        {
+            for (; left != lhs.end(); ++left)
+                result.push_back_copy(*left);
+        }
+
+        if (keep_only_rhs)
+        {
+            for (; right != rhs.end(); ++right)
+                result.push_back_copy(*right);
+        }
+
+        return result;
+    }
+
+    /**
+     * Append a PIDL ordered after every element, using this set's
+     * allocator.
+     */
+    void push_back_copy(const value_type& pidl)
+    {
+        push_back_ordered(basic_pidl_view<T>(pidl));
+    }
+
+    void push_back_ordered(const basic_pidl_view<T>& view)
+    {
+        assert(empty() ||
+            detail::compare_bytes(
+                m_keys.back().items, detail::measure_items(view)) < 0);
+        insert_at(size(), view);
+    }
+
+    /**
+     * Copy @a view into the set at @a index, which must be its place in
+     * the order.
+     */
+    void insert_at(size_t index, const basic_pidl_view<T>& view)
+    {
+        m_keys.insert(
+            m_keys.begin() + index,
+            detail::search_key(detail::measure_items(view)));
+
+        try
+        {
+            m_items.insert(
+                m_items.begin() + index, value_type(view, m_allocator));
+        }
+        catch (...)
+        {
+            m_keys.erase(m_keys.begin() + index);
+            throw;
+        }
+
+        // Point the key at the set's copy of the PIDL
+        m_keys[index].items.data = m_items[index].get();
+    }
+
+    size_t lower_bound_position(const detail::search_key& key) const
+    {
+        return std::lower_bound(
+            m_keys.begin(), m_keys.end(), key, detail::search_key_less) -
+            m_keys.begin();
+    }
+
+    bool is_match(size_t index, const detail::search_key& key) const
+    {
+        return index < m_keys.size() &&
+            m_keys[index].prefix == key.prefix &&
+            detail::equal_bytes(m_keys[index].items, key.items);
+    }
+
+    static basic_pidl_view<T> view_of(const detail::sort_entry& entry)
+    {
+        return basic_pidl_view<T>(
+            static_cast<const T __unaligned*>(entry.items.data),
+            entry.items.bytes, entry.items.item_count);
+    }
+
+    storage_type m_items;
+    boost::container::vector<detail::search_key> m_keys;
+    Alloc m_allocator;
+};
+
+template<typename T, typename Alloc>
+inline void swap(
+    basic_pidl_flat_set<T, Alloc>& lhs, basic_pidl_flat_set<T, Alloc>& rhs)
+{
+    lhs.swap(rhs);
+}
+
+/**
+ * Map from PIDLs to values, kept sorted in flat arrays.
+ *
+ * The keys are a basic_pidl_flat_set, available from keys(), and each
+ * value is stored at the same position as its key in a parallel array.
+ * Lookups and the costs of inserting and erasing are as for the set.
+ */
+template<
+    typename T, typename Value,
+    typename Alloc = typename default_alloc<T>::type>
+class basic_pidl_flat_map
+{
+public:
+
+    typedef basic_pidl_flat_set<T, Alloc> key_set;
+    typedef typename key_set::key_type key_type;
+    typedef Value mapped_type;
+    typedef size_t size_type;
+    typedef Alloc allocator;
+
+    /**
+     * Empty map.
+     */
+    explicit basic_pidl_flat_map(Alloc alloc=Alloc()) : m_keys(alloc) {}
+
+    /**
+     * Map of the key-value pairs in the range [@a begin, @a end).
+     *
+     * The keys may be raw PIDLs, wrappers or views.  If keys repeat, the
+     * value paired with the first of them is kept, as when inserting the
+     * pairs one at a time.
+     */
+    template<typename It>
+    basic_pidl_flat_map(It begin, It end, Alloc alloc=Alloc())
+        : m_keys(alloc)
+    {
+        std::vector<detail::sort_entry> entries;
+        std::vector<It> sources;
+        size_t position = 0;
+        for (It it = begin; it != end; ++it, ++position)
+        {
+            entries.push_back(
+                detail::sort_entry(
+                    detail::measure_items(detail::view_as<T>(it->first)),
+                    position));
+            sources.push_back(it);
+        }
+
+        detail::sort_unique(entries);
+
+        m_keys.reserve(entries.size());
+        m_values.reserve(entries.size());
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            m_keys.push_back_ordered(key_set::view_of(entries[i]));
+            m_values.push_back(sources[entries[i].position]->second);
+        }
+    }
+
+    /**
+     * @name  Lookup
+     */
+    // @{
+
+    /**
+     * The value for @a pidl, or NULL if the map has no such key.
+     */
+    template<typename P>
+    Value* find(const P& pidl)
+    {
+        size_t index = position_of(pidl);
+        return (index == size()) ? NULL : &m_values[index];
+    }
+
+    template<typename P>
+    const Value* find(const P& pidl) const
+    {
+        size_t index = position_of(pidl);
+        return (index == size()) ? NULL : &m_values[index];
+    }
+
+    template<typename P>
+    bool contains(const P& pidl) const
+    {
+        return m_keys.contains(pidl);
+    }
+
+    /**
+     * The value for @a pidl, inserting a default one if there is none.
+     */
+    template<typename P>
+    Value& operator[](const P& pidl)
+    {
+        return *insert(pidl, Value()).first;
+    }
+
+    // @}
+
+    /**
+     * @name  Modifiers
+     */
+    // @{
+
+    /**
+     * Add @a pidl with @a value unless the map already has the key.
+     *
+     * @returns the value for the key and whether it was inserted.
+     */
+    template<typename P>
+    std::pair<Value*, bool> insert(const P& pidl, const Value& value)
+    {
+        std::pair<typename key_set::const_iterator, bool> key =
+            m_keys.insert(pidl);
+        size_t index = key.first - m_keys.begin();
+
+        if (key.second)
+        {
+            try
+            {
+                m_values.insert(m_values.begin() + index, value);
+            }
+            catch (...)
+            {
+                m_keys.erase(key.first);
+                throw;
+            }
+        }
+
+        return std::make_pair(&m_values[index], key.second);
+    }
+
+    /**
+     * Remove the key equal to @a pidl and its value.
+     *
+     * @returns the number of entries removed: 0 or 1.
+     */
+    template<typename P>
+    size_t erase(const P& pidl)
+    {
+        size_t index = position_of(pidl);
+        if (index == size())
+            return 0;
+
+        m_keys.erase(m_keys.begin() + index);
+        m_values.erase(m_values.begin() + index);
+        return 1;
+    }
+
+    void clear()
+    {
+        m_keys.clear();
+        m_values.clear();
+    }
+
+    void swap(basic_pidl_flat_map& other)
+    {
+        m_keys.swap(other.m_keys);
+        m_values.swap(other.m_values);
+    }
+
+    // @}
+
+    /**
+     * @name  Entries by position
+     */
+    // @{
+
+    /**
+     * The keys, in order.
+     *
+     * The key at a position is the key of the value at the same position.
+     */
+    const key_set& keys() const
+    {
+        return m_keys;
+    }
+
+    const key_type& key(size_t index) const
+    {
+        return m_keys[index];
+    }
+
+    Value& value(size_t index)
+    {
+        assert(index < size());
+        return m_values[index];
+    }
+
+    const Value& value(size_t index) const
+    {
+        assert(index < size());
+        return m_values[index];
+    }
+
+    size_t size() const
+    {
+        return m_keys.size();
+    }
+
+    bool empty() const
+    {
+        return m_keys.empty();
+    }
+
+    // @}
+
+private:
+
+    /**
+     * Index of the key equal to @a pidl, or size() if there is none.
+     */
+    template<typename P>
+    size_t position_of(const P& pidl) const
+    {
+        return m_keys.find(pidl) - m_keys.begin();
+    }
+
+    key_set m_keys;
+    boost::container::vector<Value> m_values;
+};
+
+template<typename T, typename Value, typename Alloc>
+inline void swap(
+    basic_pidl_flat_map<T, Value, Alloc>& lhs,
+    basic_pidl_flat_map<T, Value, Alloc>& rhs)
+{
+    lhs.swap(rhs);
+}
+
+typedef basic_pidl_flat_set<ITEMID_CHILD> cpidl_flat_set;
+typedef basic_pidl_flat_set<ITEMIDLIST_RELATIVE> pidl_flat_set;
+typedef basic_pidl_flat_set<ITEMIDLIST_ABSOLUTE> apidl_flat_set;
+
+}}} // namespace washer::shell::pidl
+
+#endif
@@ -0,0 +1,446 @@
+/**
+    @file
+
+    Front-coded storage for lists of PIDLs that share prefixes.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#ifndef WASHER_SHELL_PIDL_FRONT_CODED_HPP
+#define WASHER_SHELL_PIDL_FRONT_CODED_HPP
+#pragma once
+
+#include <washer/shell/pidl.hpp> // basic_pidl, default_alloc
+#include <washer/shell/pidl_compare.hpp> // common_bytes
+#include <washer/shell/pidl_view.hpp> // basic_pidl_view, view_as
+
+#include <boost/iterator/iterator_categories.hpp> // forward_traversal_tag
+#include <boost/iterator/iterator_facade.hpp>
+#include <boost/throw_exception.hpp> // BOOST_THROW_EXCEPTION
+
+#include <algorithm> // min, swap
+#include <cassert> // assert
+#include <cstddef> // size_t
+#include <cstring> // memcpy
+#include <stdexcept> // out_of_range, invalid_argument
+#include <vector>
+
+#include <washer/shell/itemidlist.hpp> // Raw PIDL types
+
+namespace washer {
+namespace shell {
+namespace pidl {
+
+namespace detail {
+
+    /**
+     * Append @a value to @a out in seven-bit groups, least significant
+     * first, with the top bit of each byte set if more follow.
+     */
+    inline void append_varint(std::vector<BYTE>& out, size_t value)
+    {
+        while (value >= 0x80)
+        {
+            out.push_back(static_cast<BYTE>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<BYTE>(value));
+    }
+
+    /**
+     * Read a value written by append_varint and advance past it.
+     */
+    inline size_t read_varint(const BYTE*& position)
+    {
+        size_t value = 0;
+        for (unsigned int shift = 0; ; shift += 7)
+        {
+            BYTE b = *position++;
+            value |= static_cast<size_t>(b & 0x7F) << shift;
+            if (!(b & 0x80))
+                return value;
+        }
+    }
+}
+
+/**
+ * List of PIDLs stored with the bytes each shares with the one before it
+ * removed.
+ *
+ * Listings of folders hold many absolute PIDLs with long parents in
+ * common, so storing each PIDL in full repeats the parent bytes in every
+ * entry.  Here each entry records how many leading bytes it shares with
+ * the previous entry and only the bytes that follow, all packed into one
+ * growing buffer.  PIDLs appended in sorted order, or grouped by folder,
+ * compress best.
+ *
+ * Every restart_interval entries, an entry is stored in full so that any
+ * entry can be rebuilt by decoding at most that many entries.  Iterating
+ * decodes each entry once, reusing the previous one's bytes, and yields
+ * views that are valid until the iterator moves on.  operator[] and at()
+ * return an owning copy.
+ *
+ * Entries can only be appended.  Elements appended may be raw PIDLs,
+ * wrappers or views of any PIDL type that upcasts to T.  Alloc allocates
+ * the PIDLs returned by operator[] and at().
+ */
+template<typename T, typename Alloc = typename default_alloc<T>::type>
+class basic_front_coded_pidl_list
+{
+public:
+
+    typedef basic_pidl_view<T> value_type;
+    typedef basic_pidl<T, Alloc> pidl_type;
+    typedef size_t size_type;
+    typedef Alloc allocator;
+
+    class const_iterator;
+    typedef const_iterator iterator;
+
+    static const size_t default_restart_interval = 16;
+
+    /**
+     * Empty list.
+     *
+     * @throws std::invalid_argument if @a restart_interval is zero.
+     */
+    explicit basic_front_coded_pidl_list(
+        size_t restart_interval=default_restart_interval,
+        Alloc alloc=Alloc())
+        : m_count(0), m_restart_interval(restart_interval),
+          m_allocator(alloc)
+    {
+        check_restart_interval();
+    }
+
+    /**
+     * List of the PIDLs in the range [@a begin, @a end), in order.
+     */
+    template<typename It>
+    basic_front_coded_pidl_list(
+        It begin, It end,
+        size_t restart_interval=default_restart_interval,
+        Alloc alloc=Alloc())
+        : m_count(0), m_restart_interval(restart_interval),
+          m_allocator(alloc)
+    {
+        check_restart_interval();
+
+        for (It it = begin; it != end; ++it)
+        {
+            push_back(*it);
+        }
+    }
+
+    /**
+     * Add a PIDL to the end of the list.
+     *
+     * A NULL PIDL is stored as an empty one.
+     */
+    template<typename P>
+    void push_back(const P& pidl)
+    {
+        basic_pidl_view<T> view = detail::view_as<T>(pidl);
+        const BYTE* items = reinterpret_cast<const BYTE*>(view.data());
+        size_t bytes = view.item_bytes();
+
+        size_t shared = 0;
+        if (m_count % m_restart_interval == 0)
+        {
+            m_restarts.push_back(m_data.size());
+        }
+        else
+        {
+            shared = detail::common_bytes(
+                items, (m_last.empty()) ? NULL : &m_last[0],
+                (std::min)(bytes, m_last.size()));
+        }
+
+        size_t old_size = m_data.size();
+        try
+        {
+            detail::append_varint(m_data, shared);
+            detail::append_varint(m_data, bytes - shared);
+            detail::append_varint(m_data, view.item_count());
+            m_data.insert(m_data.end(), items + shared, items + bytes);
+
+            m_last.assign(items, items + bytes);
+        }
+        catch (...)
+        {
+            m_data.resize(old_size);
+            if (m_count % m_restart_interval == 0)
+                m_restarts.pop_back();
+            throw;
+        }
+
+        ++m_count;
+    }
+
+    /**
+     * @name  Entries
+     */
+    // @{
+
+    /**
+     * Copy of the PIDL at @a index.
+     *
+     * Decodes up to restart_interval() entries.
+     */
+    pidl_type operator[](size_t index) const
+    {
+        std::vector<BYTE> buffer;
+        return pidl_type(decode(index, buffer), m_allocator);
+    }
+
+    /**
+     * @throws std::out_of_range if @a index is past the end of the list.
+     */
+    pidl_type at(size_t index) const
+    {
+        if (index >= size())
+            BOOST_THROW_EXCEPTION(
+                std::out_of_range("Index past end of PIDL list"));
+
+        return (*this)[index];
+    }
+
+    /**
+     * Decode the PIDL at @a index into @a buffer and view it there.
+     *
+     * Reusing a buffer across calls avoids allocating for each entry.  The
+     * view is valid until the buffer is next changed.  The PIDL in the
+     * buffer is null-terminated so can also be used as a raw PIDL.
+     */
+    basic_pidl_view<T> decode(size_t index, std::vector<BYTE>& buffer) const
+    {
+        assert(index < size());
+
+        size_t first = index - index % m_restart_interval;
+        size_t offset = m_restarts[first / m_restart_interval];
+
+        size_t item_count = 0;
+        for (size_t i = first; i <= index; ++i)
+        {
+            offset = decode_entry(offset, buffer, item_count);
+        }
+
+        return view_buffer(buffer, item_count);
+    }
+
+    const_iterator begin() const
+    {
+        return const_iterator(*this, 0);
+    }
+
+    const_iterator end() const
+    {
+        return const_iterator(*this, size());
+    }
+
+    size_t size() const
+    {
+        return m_count;
+    }
+
+    bool empty() const
+    {
+        return m_count == 0;
+    }
+
+    // @}
+
+    /**
+     * @name  Storage
+     */
+    // @{
+
+    /**
+     * Bytes taken by the encoded entries and the restart index.
+     */
+    size_t encoded_bytes() const
+    {
+        return m_data.size() + m_restarts.size() * sizeof(size_t);
+    }
+
+    size_t restart_interval() const
+    {
+        return m_restart_interval;
+    }
+
+    void clear()
+    {
+        m_data.clear();
+        m_restarts.clear();
+        m_last.clear();
+        m_count = 0;
+    }
+
+    void swap(basic_front_coded_pidl_list& other)
+    {
+        m_data.swap(other.m_data);
+        m_restarts.swap(other.m_restarts);
+        m_last.swap(other.m_last);
+        std::swap(m_count, other.m_count);
+        std::swap(m_restart_interval, other.m_restart_interval);
+        std::swap(m_allocator, other.m_allocator);
+    }
+
+    Alloc get_allocator() const
+    {
+        return m_allocator;
+    }
+
+    // @}
+
+    /**
+     * Iterator that decodes each entry as it reaches it.
+     *
+     * Dereferencing gives a view of the iterator's own copy of the entry,
+     * valid until the iterator is moved or destroyed.
+     */
+    class const_iterator :
+        public boost::iterator_facade<
+            const_iterator, basic_pidl_view<T>,
+            boost::forward_traversal_tag, basic_pidl_view<T> >
+    {
+    public:
+
+        const_iterator() : m_list(NULL), m_index(0), m_offset(0),
+            m_item_count(0) {}
+
+    private:
+        friend class basic_front_coded_pidl_list;
+        friend class boost::iterator_core_access;
+
+        const_iterator(
+            const basic_front_coded_pidl_list& list, size_t index)
+            : m_list(&list), m_index(index), m_offset(0), m_item_count(0)
+        {
+            if (m_index < m_list->size())
+                m_offset =
+                    m_list->decode_entry(m_offset, m_buffer, m_item_count);
+        }
+
+        basic_pidl_view<T> dereference() const
+        {
+            assert(m_list && m_index < m_list->size());
+            return m_list->view_buffer(m_buffer, m_item_count);
+        }
+
+        bool equal(const const_iterator& other) const
+        {
+            assert(m_list == other.m_list);
+            return m_index == other.m_index;
+        }
+
+        void increment()
+        {
+            assert(m_list && m_index < m_list->size());
+
+            ++m_index;
+            if (m_index < m_list->size())
+                m_offset =
+                    m_list->decode_entry(m_offset, m_buffer, m_item_count);
+        }
+
+        const basic_front_coded_pidl_list* m_list;
+        size_t m_index;
+        size_t m_offset; ///< Where the next entry starts
+        std::vector<BYTE> m_buffer;
+        size_t m_item_count;
+    };
+
+private:
+
+    void check_restart_interval() const
+    {
+        if (m_restart_interval == 0)
+            BOOST_THROW_EXCEPTION(
+                std::invalid_argument("Restart interval must not be zero"));
+    }
+
+    /**
+     * Decode the entry at @a offset over the previous entry in @a buffer.
+     *
+     * @returns the offset of the next entry.
+     */
+    size_t decode_entry(
+        size_t offset, std::vector<BYTE>& buffer, size_t& item_count) const
+    {
+        const BYTE* position = &m_data[offset];
+        size_t shared = detail::read_varint(position);
+        size_t suffix = detail::read_varint(position);
+        item_count = detail::read_varint(position);
+
+        // The buffer holds the previous entry and its terminator
+        assert(shared == 0 || shared + sizeof(USHORT) <= buffer.size());
+
+        buffer.resize(shared + suffix + sizeof(USHORT));
+        if (suffix)
+            std::memcpy(&buffer[shared], position, suffix);
+        buffer[shared + suffix] = 0;
+        buffer[shared + suffix + 1] = 0;
+
+        return (position - &m_data[0]) + suffix;
+    }
+
+    basic_pidl_view<T> view_buffer(
+        const std::vector<BYTE>& buffer, size_t item_count) const
+    {
+        return basic_pidl_view<T>(
+            reinterpret_cast<const T __unaligned*>(&buffer[0]),
+            buffer.size() - sizeof(USHORT), item_count);
+    }
+
+    std::vector<BYTE> m_data;
+    std::vector<size_t> m_restarts; ///< Offset of every restart entry
+    std::vector<BYTE> m_last; ///< Items of the last entry, to share from
+    size_t m_count;
+    size_t m_restart_interval;
+    Alloc m_allocator;
+};
+
+template<typename T, typename Alloc>
+const size_t
+basic_front_coded_pidl_list<T, Alloc>::default_restart_interval;
+
+template<typename T, typename Alloc>
+inline void swap(
+    basic_front_coded_pidl_list<T, Alloc>& lhs,
+    basic_front_coded_pidl_list<T, Alloc>& rhs)
+{
+    lhs.swap(rhs);
+}
+
+typedef basic_front_coded_pidl_list<ITEMIDLIST_ABSOLUTE>
+    front_coded_apidl_list;
+typedef basic_front_coded_pidl_list<ITEMIDLIST_RELATIVE>
+    front_coded_pidl_list;
+
+}}} // namespace washer::shell::pidl
+
+#endif
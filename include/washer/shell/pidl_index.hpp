@@ -0,0 +1,308 @@
+/**
+    @file
+
+    Random-access index of the items in a PIDL.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#ifndef WASHER_SHELL_PIDL_INDEX_HPP
+#define WASHER_SHELL_PIDL_INDEX_HPP
+#pragma once
+
+#include <washer/shell/detail/indexed_iterator.hpp> // indexed_iterator
+#include <washer/shell/pidl.hpp> // basic_pidl, raw_pidl
+#include <washer/shell/pidl_view.hpp> // basic_pidl_view, cpidl_view
+
+#include <boost/iterator/reverse_iterator.hpp> // reverse_iterator
+#include <boost/throw_exception.hpp> // BOOST_THROW_EXCEPTION
+
+#include <cassert> // assert
+#include <cstddef> // size_t, ptrdiff_t
+#include <stdexcept> // out_of_range
+#include <vector>
+
+#include <washer/shell/itemidlist.hpp> // Raw PIDL types
+
+namespace washer {
+namespace shell {
+namespace pidl {
+
+/**
+ * Items of an ITEMIDLIST with their offsets measured once, up front.
+ *
+ * A PIDL has to be walked from the start to find any item in it, so with
+ * raw_pidl_iterator or pidl_iterator, reaching the Nth or last item costs
+ * O(N) and there is no going backwards.  pidl_iterator also copies every
+ * item it visits.  The index walks the PIDL once when it is created and
+ * records where each item starts.  After that, any item, prefix or suffix
+ * is available in constant time, as a view of the original memory, and
+ * the items can be iterated in either direction or jumped between.
+ *
+ * The item views are @b not null-terminated, except for the last one, so
+ * copy them into a cpidl_t before passing them where a raw PIDL is
+ * expected.
+ *
+ * Like a view, the index borrows the PIDL it was created from and is only
+ * valid while that PIDL is alive and unchanged.
+ *
+ * Like the wrappers and views, the index takes the type of raw PIDL
+ * (ITEMID_CHILD, ITEMIDLIST_RELATIVE or ITEMIDLIST_ABSOLUTE) as a
+ * template parameter, T.
+ */
+template<typename T>
+class basic_pidl_index
+{
+public:
+
+    typedef cpidl_view value_type;
+    typedef cpidl_view reference;
+    typedef cpidl_view const_reference;
+    typedef size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef washer::shell::detail::indexed_iterator<
+        basic_pidl_index, cpidl_view> iterator;
+    typedef iterator const_iterator;
+    typedef boost::reverse_iterator<iterator> reverse_iterator;
+    typedef reverse_iterator const_reverse_iterator;
+
+    /**
+     * Index of no items.
+     */
+    basic_pidl_index() : m_offsets(1, 0) {}
+
+    /**
+     * Index a raw PIDL.
+     */
+    explicit basic_pidl_index(const T __unaligned* pidl)
+    {
+        build(basic_pidl_view<T>(pidl));
+    }
+
+    /**
+     * Index the PIDL held by a wrapper.
+     *
+     * The index borrows the wrapper's PIDL so the wrapper must outlive it.
+     */
+    template<typename U, typename Alloc>
+    explicit basic_pidl_index(const basic_pidl<U, Alloc>& pidl)
+    {
+        build(basic_pidl_view<T>(pidl));
+    }
+
+    /**
+     * Index the items of a view.
+     */
+    explicit basic_pidl_index(const basic_pidl_view<T>& view)
+    {
+        build(view);
+    }
+
+    /**
+     * @name  Items
+     */
+    // @{
+
+    /**
+     * View of the item at @a index.
+     */
+    cpidl_view operator[](size_t index) const
+    {
+        assert(index < item_count());
+
+        return cpidl_view(
+            reinterpret_cast<PCUITEMID_CHILD>(
+                raw_pidl::skip(m_view.data(), m_offsets[index])),
+            m_offsets[index + 1] - m_offsets[index], 1);
+    }
+
+    /**
+     * View of the item at @a index, checking it is in range.
+     */
+    cpidl_view at(size_t index) const
+    {
+        if (index >= item_count())
+            BOOST_THROW_EXCEPTION(
+                std::out_of_range("Item index past end of PIDL"));
+
+        return (*this)[index];
+    }
+
+    cpidl_view front() const
+    {
+        return at(0);
+    }
+
+    cpidl_view back() const
+    {
+        if (empty())
+            BOOST_THROW_EXCEPTION(
+                std::out_of_range("Empty PIDL has no last item"));
+
+        return (*this)[item_count() - 1];
+    }
+
+    /**
+     * Byte offset of the item at @a index from the start of the PIDL.
+     *
+     * An index equal to the item count gives the offset of the
+     * null-terminator.
+     */
+    size_t offset(size_t index) const
+    {
+        assert(index <= item_count());
+        return m_offsets[index];
+    }
+
+    // @}
+
+    /**
+     * @name  Iteration
+     */
+    // @{
+
+    const_iterator begin() const
+    {
+        return const_iterator(*this, 0);
+    }
+
+    const_iterator end() const
+    {
+        return const_iterator(*this, item_count());
+    }
+
+    const_reverse_iterator rbegin() const
+    {
+        return const_reverse_iterator(end());
+    }
+
+    const_reverse_iterator rend() const
+    {
+        return const_reverse_iterator(begin());
+    }
+
+    // @}
+
+    /**
+     * @name  Sub-lists
+     *
+     * These are the same as the view operations of the same name but take
+     * constant time.
+     */
+    // @{
+
+    /**
+     * View of the whole indexed PIDL.
+     */
+    const basic_pidl_view<T>& view() const
+    {
+        return m_view;
+    }
+
+    /**
+     * View of the first @a count items.
+     */
+    basic_pidl_view<T> prefix(size_t count) const
+    {
+        if (count > item_count())
+            BOOST_THROW_EXCEPTION(
+                std::out_of_range("Prefix longer than PIDL"));
+
+        return basic_pidl_view<T>(m_view.data(), m_offsets[count], count);
+    }
+
+    /**
+     * View of the last @a count items.
+     */
+    basic_pidl_view<ITEMIDLIST_RELATIVE> suffix(size_t count) const
+    {
+        if (count > item_count())
+            BOOST_THROW_EXCEPTION(
+                std::out_of_range("Suffix longer than PIDL"));
+
+        size_t offset = m_offsets[item_count() - count];
+        return basic_pidl_view<ITEMIDLIST_RELATIVE>(
+            reinterpret_cast<const ITEMIDLIST_RELATIVE __unaligned*>(
+                raw_pidl::skip(m_view.data(), offset)),
+            m_view.item_bytes() - offset, count);
+    }
+
+    // @}
+
+    /**
+     * The number of items.
+     */
+    size_t item_count() const
+    {
+        return m_offsets.size() - 1;
+    }
+
+    bool empty() const
+    {
+        return item_count() == 0;
+    }
+
+private:
+
+    void build(const basic_pidl_view<T>& view)
+    {
+        m_view = view;
+        m_offsets.resize(view.item_count() + 1);
+
+        size_t offset = 0;
+        const T __unaligned* item = view.data();
+        for (size_t i = 0; i < view.item_count(); ++i)
+        {
+            m_offsets[i] = offset;
+            offset += item->mkid.cb;
+            item = raw_pidl::next(item);
+        }
+
+        assert(offset == view.item_bytes());
+        m_offsets.back() = offset;
+    }
+
+    basic_pidl_view<T> m_view;
+
+    /**
+     * Where each item starts followed by where the terminator starts, so
+     * item i spans [m_offsets[i], m_offsets[i + 1]).
+     */
+    std::vector<size_t> m_offsets;
+};
+
+/**
+ * @name  Standard index types.
+ */
+// @{
+typedef basic_pidl_index<ITEMIDLIST_RELATIVE> pidl_index;
+typedef basic_pidl_index<ITEMIDLIST_ABSOLUTE> apidl_index;
+typedef basic_pidl_index<ITEMID_CHILD> cpidl_index;
+// @}
+
+}}} // namespace washer::shell::pidl
+
+#endif
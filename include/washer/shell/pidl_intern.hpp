@@ -0,0 +1,547 @@
+/**
+    @file
+
+    Interning of PIDLs into shared, immutable handles.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#ifndef WASHER_SHELL_PIDL_INTERN_HPP
+#define WASHER_SHELL_PIDL_INTERN_HPP
+#pragma once
+
+#include <washer/shell/pidl.hpp> // basic_pidl, raw_pidl
+#include <washer/shell/pidl_compare.hpp> // hash_bytes, measure_items
+#include <washer/shell/pidl_view.hpp> // basic_pidl_view
+
+#include <boost/config.hpp> // BOOST_NO_CXX11_HDR_FUNCTIONAL
+#include <boost/detail/atomic_count.hpp> // atomic_count
+#include <boost/move/move.hpp> // BOOST_RV_REF, BOOST_COPYABLE_AND_MOVABLE
+#include <boost/noncopyable.hpp> // noncopyable
+#include <boost/thread/mutex.hpp> // mutex
+#include <boost/unordered_set.hpp> // unordered_set
+
+#include <algorithm> // swap
+#include <cassert> // assert
+#include <cstddef> // size_t
+#include <cstring> // memcmp, memcpy, memset
+#include <functional> // equal_to, less
+#include <limits> // numeric_limits
+#include <new> // operator new, operator delete
+
+#include <washer/shell/itemidlist.hpp> // Raw PIDL types
+
+namespace washer {
+namespace shell {
+namespace pidl {
+
+template<typename T> class basic_pidl_intern_table;
+
+namespace detail {
+
+    struct intern_shard;
+
+    /**
+     * A single interned PIDL.
+     *
+     * The PIDL's bytes, including its null-terminator, follow the entry in
+     * the same allocation.
+     */
+    struct interned_entry : private boost::noncopyable
+    {
+        interned_entry(
+            intern_shard* shard, std::size_t hash, std::size_t size)
+            : references(1), shard(shard), hash(hash), size(size),
+              item_count(0) {}
+
+        const BYTE* bytes() const
+        {
+            return reinterpret_cast<const BYTE*>(this + 1);
+        }
+
+        BYTE* bytes()
+        {
+            return reinterpret_cast<BYTE*>(this + 1);
+        }
+
+        boost::detail::atomic_count references;
+        intern_shard* shard;
+        std::size_t hash;
+        std::size_t size; ///< Bytes in the PIDL including the terminator
+        std::size_t item_count;
+    };
+
+    /**
+     * Items being looked up along with their already-calculated hash.
+     */
+    struct hashed_run
+    {
+        hashed_run(const measured_items& items, std::size_t hash)
+            : items(items), hash(hash) {}
+
+        measured_items items;
+        std::size_t hash;
+    };
+
+    struct entry_hash
+    {
+        std::size_t operator()(const interned_entry* entry) const
+        {
+            return entry->hash;
+        }
+
+        std::size_t operator()(const hashed_run& run) const
+        {
+            return run.hash;
+        }
+    };
+
+    struct entry_matches
+    {
+        bool operator()(
+            const hashed_run& run, const interned_entry* entry) const
+        {
+            return run.hash == entry->hash &&
+                run.items.bytes + sizeof(USHORT) == entry->size &&
+                (run.items.bytes == 0 ||
+                 std::memcmp(
+                     run.items.data, entry->bytes(), run.items.bytes) == 0);
+        }
+
+        bool operator()(
+            const interned_entry* entry, const hashed_run& run) const
+        {
+            return (*this)(run, entry);
+        }
+    };
+
+    /**
+     * One lock's worth of the intern table.
+     *
+     * Entries are counted atomically so that handles can be copied without
+     * taking the lock.  The count is only ever decremented with the lock
+     * held, though, so that an entry cannot be found by a lookup at the
+     * same moment its last handle is letting go of it.
+     */
+    struct intern_shard : private boost::noncopyable
+    {
+        typedef boost::unordered_set<
+            interned_entry*, entry_hash, std::equal_to<interned_entry*> >
+            entry_set;
+
+        intern_shard() : bytes(0) {}
+
+        boost::mutex mutex;
+        entry_set entries;
+        std::size_t bytes;
+    };
+
+    inline interned_entry* create_entry(
+        intern_shard& shard, const measured_items& items, std::size_t hash)
+    {
+        std::size_t size = items.bytes + sizeof(USHORT);
+        void* memory = ::operator new(sizeof(interned_entry) + size);
+        interned_entry* entry = new (memory) interned_entry(&shard, hash, size);
+
+        if (items.bytes)
+            std::memcpy(entry->bytes(), items.data, items.bytes);
+        std::memset(entry->bytes() + items.bytes, 0, sizeof(USHORT));
+
+        entry->item_count = items.item_count;
+
+        return entry;
+    }
+
+    inline void destroy_entry(interned_entry* entry) throw()
+    {
+        entry->~interned_entry();
+        ::operator delete(entry);
+    }
+
+    /**
+     * Find the entry for the given items, creating it if there isn't one,
+     * and take a reference to it.
+     */
+    inline interned_entry* acquire_entry(
+        intern_shard& shard, const measured_items& items, std::size_t hash)
+    {
+        boost::mutex::scoped_lock lock(shard.mutex);
+
+        intern_shard::entry_set::iterator it = shard.entries.find(
+            hashed_run(items, hash), entry_hash(), entry_matches());
+        if (it != shard.entries.end())
+        {
+            ++(*it)->references;
+            return *it;
+        }
+
+        interned_entry* entry = create_entry(shard, items, hash);
+        try
+        {
+            shard.entries.insert(entry);
+        }
+        catch (...)
+        {
+            destroy_entry(entry);
+            throw;
+        }
+
+        shard.bytes += entry->size;
+        return entry;
+    }
+
+    /**
+     * Drop a reference to the entry, removing it from the table if that was
+     * the last.
+     */
+    inline void release_entry(interned_entry* entry)
+    {
+        intern_shard& shard = *entry->shard;
+        boost::mutex::scoped_lock lock(shard.mutex);
+
+        if (--entry->references == 0)
+        {
+            shard.entries.erase(entry);
+            shard.bytes -= entry->size;
+            destroy_entry(entry);
+        }
+    }
+}
+
+/**
+ * Shared, immutable handle to a PIDL in a basic_pidl_intern_table.
+ *
+ * Every handle to equal PIDLs from the same table points to the same entry
+ * so comparing handles is just comparing pointers.  Copying a handle
+ * increments a reference count without locking; the entry is removed from
+ * the table when the last handle to it is destroyed.
+ *
+ * Handles ordering with @c < is by address, not by contents, so is
+ * consistent with @c == but otherwise arbitrary.  Their hash, on the other
+ * hand, is the same as that of an equal wrapper or raw PIDL.
+ *
+ * A default-constructed handle, and the handle for a NULL PIDL, is NULL.
+ */
+template<typename T>
+class basic_interned_pidl
+{
+public:
+
+    typedef T value_type;
+    typedef const T __unaligned* const_pointer;
+
+    basic_interned_pidl() : m_entry(NULL) {}
+
+    basic_interned_pidl(const basic_interned_pidl& other)
+        : m_entry(other.m_entry)
+    {
+        if (m_entry)
+            ++m_entry->references;
+    }
+
+    basic_interned_pidl(BOOST_RV_REF(basic_interned_pidl) other)
+        : m_entry(other.m_entry)
+    {
+        other.m_entry = NULL;
+    }
+
+    ~basic_interned_pidl()
+    {
+        if (m_entry)
+            detail::release_entry(m_entry);
+    }
+
+    basic_interned_pidl& operator=(
+        BOOST_COPY_ASSIGN_REF(basic_interned_pidl) other)
+    {
+        basic_interned_pidl copy(other);
+        swap(copy);
+        return *this;
+    }
+
+    basic_interned_pidl& operator=(BOOST_RV_REF(basic_interned_pidl) other)
+    {
+        basic_interned_pidl moved(boost::move(other));
+        swap(moved);
+        return *this;
+    }
+
+    void swap(basic_interned_pidl& other) throw()
+    {
+        std::swap(m_entry, other.m_entry);
+    }
+
+    bool operator!() const
+    {
+        return m_entry == NULL;
+    }
+
+    /**
+     * The interned PIDL.
+     *
+     * Valid for as long as this handle, or any copy of it, is alive.
+     */
+    const_pointer get() const
+    {
+        return (m_entry) ?
+            reinterpret_cast<const_pointer>(m_entry->bytes()) : NULL;
+    }
+
+    /**
+     * Size of the PIDL in bytes, including the null-terminator.
+     */
+    std::size_t size() const
+    {
+        return (m_entry) ? m_entry->size : 0;
+    }
+
+    std::size_t item_count() const
+    {
+        return (m_entry) ? m_entry->item_count : 0;
+    }
+
+    bool empty() const
+    {
+        return item_count() == 0;
+    }
+
+    /**
+     * Hash of the PIDL's contents.
+     */
+    std::size_t hash() const
+    {
+        return (m_entry) ? m_entry->hash :
+            detail::hash_bytes(detail::measured_items(NULL, 0, 0));
+    }
+
+    template<typename U>
+    friend bool operator==(
+        const basic_interned_pidl<U>& lhs, const basic_interned_pidl<U>& rhs);
+
+    template<typename U>
+    friend bool operator<(
+        const basic_interned_pidl<U>& lhs, const basic_interned_pidl<U>& rhs);
+
+private:
+    BOOST_COPYABLE_AND_MOVABLE(basic_interned_pidl)
+
+    friend class basic_pidl_intern_table<T>;
+
+    /**
+     * Adopt a reference already taken on the entry.
+     */
+    explicit basic_interned_pidl(detail::interned_entry* entry)
+        : m_entry(entry) {}
+
+    detail::interned_entry* m_entry;
+};
+
+template<typename T>
+inline bool operator==(
+    const basic_interned_pidl<T>& lhs, const basic_interned_pidl<T>& rhs)
+{
+    return lhs.m_entry == rhs.m_entry;
+}
+
+template<typename T>
+inline bool operator!=(
+    const basic_interned_pidl<T>& lhs, const basic_interned_pidl<T>& rhs)
+{
+    return !(lhs == rhs);
+}
+
+template<typename T>
+inline bool operator<(
+    const basic_interned_pidl<T>& lhs, const basic_interned_pidl<T>& rhs)
+{
+    return std::less<detail::interned_entry*>()(lhs.m_entry, rhs.m_entry);
+}
+
+template<typename T>
+inline void swap(
+    basic_interned_pidl<T>& lhs, basic_interned_pidl<T>& rhs) throw()
+{
+    lhs.swap(rhs);
+}
+
+template<typename T>
+inline std::size_t hash_value(const basic_interned_pidl<T>& pidl)
+{
+    return pidl.hash();
+}
+
+/**
+ * View an interned PIDL.
+ */
+template<typename T>
+inline basic_pidl_view<T> view(const basic_interned_pidl<T>& pidl)
+{
+    return (!pidl) ? basic_pidl_view<T>() :
+        basic_pidl_view<T>(
+            pidl.get(), pidl.size() - sizeof(USHORT), pidl.item_count());
+}
+
+/**
+ * Hash-consing table of PIDLs.
+ *
+ * Interning a PIDL returns a handle to the table's single copy of it,
+ * adding a copy if the table doesn't have one yet.  Code holding many
+ * duplicate PIDLs, such as caches of the same folder items, can intern them
+ * so that the duplicates share memory and compare in constant time.
+ *
+ * The table is safe to use from many threads at once.  It is split into
+ * shards by hash, each with its own lock, so that threads interning
+ * different PIDLs rarely wait for each other.
+ *
+ * @warning  The table must outlive every handle it hands out.
+ */
+template<typename T>
+class basic_pidl_intern_table : private boost::noncopyable
+{
+public:
+
+    typedef basic_interned_pidl<T> handle_type;
+
+    basic_pidl_intern_table() {}
+
+    ~basic_pidl_intern_table()
+    {
+        assert(size() == 0 || !"Interned PIDLs outlived their table");
+    }
+
+    handle_type intern(const T __unaligned* pidl)
+    {
+        if (!pidl)
+            return handle_type();
+
+        return intern_items(detail::measure_items(pidl));
+    }
+
+    template<typename Alloc>
+    handle_type intern(const basic_pidl<T, Alloc>& pidl)
+    {
+        if (!pidl)
+            return handle_type();
+
+        return intern_items(detail::measure_items(pidl));
+    }
+
+    handle_type intern(const basic_pidl_view<T>& view)
+    {
+        if (!view)
+            return handle_type();
+
+        return intern_items(detail::measure_items(view));
+    }
+
+    /**
+     * Number of distinct PIDLs in the table.
+     */
+    std::size_t size() const
+    {
+        std::size_t total = 0;
+        for (std::size_t i = 0; i < shard_count; ++i)
+        {
+            boost::mutex::scoped_lock lock(m_shards[i].mutex);
+            total += m_shards[i].entries.size();
+        }
+
+        return total;
+    }
+
+    /**
+     * Bytes of PIDL held by the table, including terminators but not the
+     * bookkeeping for each entry.
+     */
+    std::size_t bytes() const
+    {
+        std::size_t total = 0;
+        for (std::size_t i = 0; i < shard_count; ++i)
+        {
+            boost::mutex::scoped_lock lock(m_shards[i].mutex);
+            total += m_shards[i].bytes;
+        }
+
+        return total;
+    }
+
+private:
+
+    static const std::size_t shard_bits = 4;
+    static const std::size_t shard_count = 1 << shard_bits;
+
+    handle_type intern_items(const detail::measured_items& items)
+    {
+        std::size_t hash = detail::hash_bytes(items);
+
+        // Each shard's set buckets its entries by the same hash so pick the
+        // shard from the top bits to keep the two choices independent
+        std::size_t shard =
+            hash >> (std::numeric_limits<std::size_t>::digits - shard_bits);
+
+        return handle_type(
+            detail::acquire_entry(m_shards[shard], items, hash));
+    }
+
+    mutable detail::intern_shard m_shards[shard_count];
+};
+
+/**
+ * @name  Standard interned PIDL types.
+ */
+// @{
+typedef basic_interned_pidl<ITEMIDLIST_RELATIVE> interned_pidl;
+typedef basic_interned_pidl<ITEMIDLIST_ABSOLUTE> interned_apidl;
+typedef basic_interned_pidl<ITEMID_CHILD> interned_cpidl;
+
+typedef basic_pidl_intern_table<ITEMIDLIST_RELATIVE> pidl_intern_table;
+typedef basic_pidl_intern_table<ITEMIDLIST_ABSOLUTE> apidl_intern_table;
+typedef basic_pidl_intern_table<ITEMID_CHILD> cpidl_intern_table;
+// @}
+
+}}} // namespace washer::shell::pidl
+
+#ifndef BOOST_NO_CXX11_HDR_FUNCTIONAL
+
+namespace std {
+
+template<typename T>
+struct hash< ::washer::shell::pidl::basic_interned_pidl<T> >
+{
+    typedef ::washer::shell::pidl::basic_interned_pidl<T> argument_type;
+    typedef std::size_t result_type;
+
+    std::size_t operator()(const argument_type& pidl) const
+    {
+        return pidl.hash();
+    }
+};
+
+}
+
+#endif
+
+#endif
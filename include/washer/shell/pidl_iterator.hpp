@@ -34,17 +34,14 @@
 #pragma once
 
 #include <washer/shell/pidl.hpp> // next, empty, pidl_t
+#include <washer/shell/pidl_view.hpp> // cpidl_view
 
 #include <boost/iterator/iterator_adaptor.hpp> // iterator_adaptor
 
 #include <cassert> // assert
 #include <stdexcept> // range_error
 
-#ifndef STRICT_TYPED_ITEMIDS
-#error Currently, washer requires strict PIDL types: define STRICT_TYPED_ITEMIDS
-#endif
-#include <Shlobj.h> // ILCloneFirst
-#include <ShTypes.h> // Raw PIDL types
+#include <washer/shell/itemidlist.hpp> // Raw PIDL types
 
 namespace washer {
 namespace shell {
@@ -91,7 +88,7 @@ public:
     raw_pidl_iterator() : raw_pidl_iterator::iterator_adaptor_(NULL) {}
 
 private:
-    friend boost::iterator_core_access;
+    friend class boost::iterator_core_access;
 
     reference dereference() const
     {
@@ -159,11 +156,17 @@ public:
     pidl_iterator() : pidl_iterator::iterator_adaptor_() {}
 
 private:
-    friend boost::iterator_core_access;
+    friend class boost::iterator_core_access;
 
     reference dereference() const
     {
-        m_item.attach(::ILCloneFirst(*this->base_reference()));
+        PCUIDLIST_RELATIVE item = *this->base_reference();
+
+        // Copy just the first item, with its own terminator, in one
+        // allocation
+        m_item = cpidl_t(
+            cpidl_view(
+                reinterpret_cast<PCUITEMID_CHILD>(item), item->mkid.cb, 1));
         return m_item;
     }
 
@@ -0,0 +1,216 @@
+/**
+    @file
+
+    PIDLs laid out at compile time in static storage.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#ifndef WASHER_SHELL_PIDL_LITERAL_HPP
+#define WASHER_SHELL_PIDL_LITERAL_HPP
+#pragma once
+
+#include <washer/shell/pidl.hpp> // raw_pidl
+#include <washer/shell/pidl_view.hpp> // basic_pidl_view
+
+#include <boost/config.hpp> // BOOST_STATIC_CONSTANT
+#include <boost/static_assert.hpp> // BOOST_STATIC_ASSERT
+#include <boost/type_traits/is_same.hpp> // is_same
+
+#include <cassert> // assert
+#include <cstddef> // size_t
+
+#include <washer/shell/itemidlist.hpp> // Raw PIDL types
+
+namespace washer {
+namespace shell {
+namespace pidl {
+
+/**
+ * @name  PIDL literals
+ *
+ * Templates that lay a whole ITEMIDLIST out as one POD struct, so a fixed
+ * PIDL, such as the root of a virtual folder or a test fixture, can be
+ * written as a constant aggregate.  The compiler places it in read-only
+ * static storage, initialised before any code runs, and nothing is
+ * allocated or measured when it is used.
+ *
+ * Each item's payload is a POD type: either literal_bytes<N> for a run of
+ * bytes or a struct of the caller's own, which should itself be
+ * byte-packed.  Items are chained with idlist_literal and the chain ends
+ * with idlist_literal_end.  Write each item with WASHER_PIDL_LITERAL_ITEM,
+ * which fills in its size, and the end with WASHER_PIDL_LITERAL_END, for
+ * instance:
+ *
+ * @code
+ * typedef idlist_literal<
+ *     literal_bytes<3>, idlist_literal<folder_item> > root_layout;
+ *
+ * const root_layout root = {
+ *     WASHER_PIDL_LITERAL_ITEM(literal_bytes<3>, { { 'a', 'b', 'c' } }),
+ *     {
+ *         WASHER_PIDL_LITERAL_ITEM(folder_item, { 42, 7 }),
+ *         WASHER_PIDL_LITERAL_END
+ *     }
+ * };
+ *
+ * apidl_view view = literal_view<ITEMIDLIST_ABSOLUTE>(root);
+ * @endcode
+ *
+ * The item count and size come from the layout's type, so literal_view()
+ * and literal_pidl() don't walk the PIDL.  Debug builds check that the
+ * sizes in the literal match the layout, which catches an item written
+ * with the wrong payload type.
+ */
+// @{
+
+#pragma pack(push, 1)
+
+/**
+ * Payload of an item that is a run of @a N bytes.
+ */
+template<size_t N>
+struct literal_bytes
+{
+    BYTE bytes[N];
+};
+
+/**
+ * One item: its size followed by its payload.
+ */
+template<typename Data>
+struct item_literal
+{
+    USHORT cb;
+    Data data;
+};
+
+/**
+ * The null terminator that ends every literal.  Initialise it with
+ * WASHER_PIDL_LITERAL_END.
+ */
+struct idlist_literal_end
+{
+    USHORT cb;
+};
+
+/**
+ * An item followed by the rest of the list.
+ */
+template<typename Data, typename Rest = idlist_literal_end>
+struct idlist_literal
+{
+    item_literal<Data> item;
+    Rest rest;
+};
+
+#pragma pack(pop)
+
+/**
+ * Size, including the @c cb field, of an item with payload @a Data.
+ */
+template<typename Data>
+struct literal_item_size
+{
+    BOOST_STATIC_ASSERT(sizeof(item_literal<Data>) ==
+                        sizeof(USHORT) + sizeof(Data));
+    BOOST_STATIC_ASSERT(sizeof(item_literal<Data>) <= 0xFFFF);
+
+    BOOST_STATIC_CONSTANT(
+        USHORT, value = static_cast<USHORT>(sizeof(item_literal<Data>)));
+};
+
+/**
+ * Number of items in a literal layout.
+ */
+template<typename Layout>
+struct literal_item_count;
+
+template<>
+struct literal_item_count<idlist_literal_end>
+{
+    BOOST_STATIC_CONSTANT(size_t, value = 0);
+};
+
+template<typename Data, typename Rest>
+struct literal_item_count< idlist_literal<Data, Rest> >
+{
+    BOOST_STATIC_CONSTANT(
+        size_t, value = 1 + literal_item_count<Rest>::value);
+};
+
+/**
+ * The literal as a raw PIDL of type T.
+ *
+ * A child PIDL literal must have exactly one item.
+ */
+template<typename T, typename Layout>
+inline const T* literal_pidl(const Layout& literal)
+{
+    BOOST_STATIC_ASSERT((
+        !boost::is_same<T, ITEMID_CHILD>::value ||
+        literal_item_count<Layout>::value == 1));
+
+    const T* pidl = reinterpret_cast<const T*>(&literal);
+    assert(raw_pidl::size(pidl) == sizeof(Layout) &&
+           "Item sizes don't match the literal's layout");
+    return pidl;
+}
+
+/**
+ * View of the literal as a PIDL of type T, measured at compile time.
+ *
+ * Copy the view into a basic_pidl to get an owning PIDL with a single
+ * allocation and memcpy.
+ */
+template<typename T, typename Layout>
+inline basic_pidl_view<T> literal_view(const Layout& literal)
+{
+    return basic_pidl_view<T>(
+        literal_pidl<T>(literal), sizeof(Layout) - sizeof(USHORT),
+        literal_item_count<Layout>::value);
+}
+
+// @}
+
+}}} // namespace washer::shell::pidl
+
+/**
+ * Initialiser for one item of a PIDL literal.
+ *
+ * Emits the item's size, worked out from @a Data, followed by the
+ * payload's initialiser, which may contain commas.  @a Data must be the
+ * payload type the layout has at that position.
+ */
+#define WASHER_PIDL_LITERAL_ITEM(Data, ...) \
+    { ::washer::shell::pidl::literal_item_size< Data >::value, __VA_ARGS__ }
+
+/**
+ * Initialiser for the null terminator that ends a PIDL literal.
+ */
+#define WASHER_PIDL_LITERAL_END { 0 }
+
+#endif
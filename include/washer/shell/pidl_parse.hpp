@@ -0,0 +1,214 @@
+/**
+    @file
+
+    Bounds-checked parsing of PIDLs from untrusted buffers.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#ifndef WASHER_SHELL_PIDL_PARSE_HPP
+#define WASHER_SHELL_PIDL_PARSE_HPP
+#pragma once
+
+#include <washer/shell/pidl_view.hpp> // basic_pidl_view
+
+#include <boost/throw_exception.hpp> // BOOST_THROW_EXCEPTION
+
+#include <cstddef> // size_t
+#include <cstring> // memcpy
+#include <stdexcept> // invalid_argument
+
+#include <washer/shell/itemidlist.hpp> // Raw PIDL types
+
+namespace washer {
+namespace shell {
+namespace pidl {
+
+/**
+ * Why a buffer does not hold a valid PIDL.
+ */
+enum parse_status
+{
+    parse_ok = 0,
+
+    /// An item or the null-terminator runs off the end of the buffer.
+    parse_truncated,
+
+    /// An item's cb is too small to cover its own size field.
+    parse_bad_item_size,
+
+    /// The PIDL is well-formed but has too many items for its type.
+    parse_wrong_type
+};
+
+namespace detail {
+
+    /**
+     * Most items a PIDL of type T may have.
+     */
+    template<typename T>
+    struct max_items
+    {
+        static const size_t value = static_cast<size_t>(-1);
+    };
+
+    template<>
+    struct max_items<ITEMID_CHILD>
+    {
+        static const size_t value = 1;
+    };
+
+    inline const char* parse_status_message(parse_status status)
+    {
+        switch (status)
+        {
+        case parse_truncated:
+            return "PIDL overruns its buffer";
+        case parse_bad_item_size:
+            return "PIDL item has an impossible size";
+        case parse_wrong_type:
+            return "type violation, encountered non-child pidl";
+        default:
+            return "Invalid PIDL";
+        }
+    }
+}
+
+/**
+ * Parse a PIDL from a buffer of untrusted bytes without throwing.
+ *
+ * Checks every item's cb against the space left in the buffer in a single
+ * pass, so nothing outside [@a data, @a data + @a size) is ever read, no
+ * matter what the bytes contain.  A valid PIDL must be null-terminated
+ * within the buffer; any bytes after the terminator are ignored.  Nothing
+ * is assumed about the alignment of @a data.
+ *
+ * On success, @a result views the whole PIDL with its size and item count
+ * already measured, so nothing that uses the view needs to walk the PIDL
+ * again.  On failure @a result is not modified.
+ *
+ * @param data          Start of the buffer.  May be NULL if @a size is 0.
+ * @param size          Bytes in the buffer.
+ * @param[out] result   View of the PIDL if it is valid.
+ * @param[out] error_offset
+ *     If not NULL and the PIDL is invalid, receives the offset of the item
+ *     at fault.  An item that leaves no room for a terminator after it is
+ *     at fault for the PIDL being truncated.
+ *
+ * @returns parse_ok or the reason the buffer is not a valid PIDL.
+ */
+template<typename T>
+inline parse_status parse_pidl(
+    const void* data, size_t size, basic_pidl_view<T>& result,
+    size_t* error_offset=NULL)
+{
+    const BYTE* start = static_cast<const BYTE*>(data);
+    const size_t max_items = detail::max_items<T>::value;
+    size_t item_count = 0;
+    parse_status status = parse_ok;
+
+    if (size < sizeof(USHORT))
+    {
+        if (error_offset)
+            *error_offset = 0;
+        return parse_truncated;
+    }
+
+    // Every item is checked to leave room for at least the terminator
+    // after it, so there is always a whole cb to read at the top of the
+    // loop without testing for it separately.  Walking a pointer rather
+    // than an offset keeps the chain of dependent loads as short as the
+    // trusting walk in raw_pidl::size
+    const BYTE* last_cb = start + size - sizeof(USHORT);
+    const BYTE* item = start;
+    for (;;)
+    {
+        USHORT cb;
+        std::memcpy(&cb, item, sizeof(cb));
+        if (cb == 0)
+            break;
+
+        size_t room = last_cb - item;
+        if (cb < sizeof(USHORT))
+        {
+            status = parse_bad_item_size;
+            break;
+        }
+
+        if (cb > room)
+        {
+            status = parse_truncated;
+            break;
+        }
+
+        if (max_items != static_cast<size_t>(-1) && item_count == max_items)
+        {
+            status = parse_wrong_type;
+            break;
+        }
+
+        item += cb;
+        ++item_count;
+    }
+
+    size_t offset = item - start;
+    if (status != parse_ok)
+    {
+        if (error_offset)
+            *error_offset = offset;
+        return status;
+    }
+
+    result = basic_pidl_view<T>(
+        reinterpret_cast<const T __unaligned*>(start), offset, item_count);
+    return parse_ok;
+}
+
+/**
+ * Parse a PIDL from a buffer of untrusted bytes.
+ *
+ * The same checks as parse_pidl() but failure is reported by throwing.
+ *
+ * @returns View of the whole, null-terminated PIDL at the start of the
+ *          buffer, with its size and item count measured.
+ *
+ * @throws std::invalid_argument if the buffer does not hold a valid PIDL.
+ */
+template<typename T>
+inline basic_pidl_view<T> validate_pidl(const void* data, size_t size)
+{
+    basic_pidl_view<T> view;
+    parse_status status = parse_pidl(data, size, view);
+    if (status != parse_ok)
+        BOOST_THROW_EXCEPTION(
+            std::invalid_argument(detail::parse_status_message(status)));
+
+    return view;
+}
+
+}}} // namespace washer::shell::pidl
+
+#endif
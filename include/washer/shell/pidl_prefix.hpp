@@ -0,0 +1,204 @@
+/**
+    @file
+
+    Common ancestors of sets of PIDLs and paths relative to them.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#ifndef WASHER_SHELL_PIDL_PREFIX_HPP
+#define WASHER_SHELL_PIDL_PREFIX_HPP
+#pragma once
+
+#include <washer/shell/pidl_compare.hpp> // common_bytes
+#include <washer/shell/pidl_view.hpp> // basic_pidl_view, measure_items
+
+#include <boost/throw_exception.hpp> // BOOST_THROW_EXCEPTION
+
+#include <algorithm> // min
+#include <cassert> // assert
+#include <cstddef> // size_t
+#include <cstring> // memcpy
+#include <iterator> // iterator_traits
+#include <stdexcept> // invalid_argument
+
+#include <washer/shell/itemidlist.hpp> // Raw PIDL types
+
+namespace washer {
+namespace shell {
+namespace pidl {
+
+namespace detail {
+
+    template<typename It>
+    struct element_pidl_type
+    {
+        typedef typename pidl_type_of<
+            typename std::iterator_traits<It>::value_type>::type type;
+    };
+
+    /**
+     * The items of a PIDL after its first @a bytes bytes, which must be
+     * whole items.
+     */
+    inline pidl_view suffix_after(
+        const measured_items& items, size_t bytes, size_t item_count)
+    {
+        assert(bytes <= items.bytes && item_count <= items.item_count);
+
+        if (!items.data)
+            return pidl_view();
+
+        return pidl_view(
+            reinterpret_cast<PCUIDLIST_RELATIVE>(
+                static_cast<const BYTE*>(items.data) + bytes),
+            items.bytes - bytes, items.item_count - item_count);
+    }
+}
+
+/**
+ * @name  Common prefixes
+ *
+ * The common prefix of a set of absolute PIDLs is the PIDL of their
+ * nearest common ancestor folder: for a multiple selection, the folder
+ * that contains all of it.
+ */
+// @{
+
+/**
+ * Longest run of whole items that every PIDL in the range [@a first,
+ * @a last) starts with.
+ *
+ * Each PIDL is compared, a word at a time, only as far as the prefix
+ * shared by those before it, so the cost never exceeds one pass over the
+ * range and is usually much less.  Nothing is copied or allocated.
+ *
+ * The elements may be raw PIDLs, wrappers or views.
+ *
+ * @returns  A view of the prefix in the first PIDL, so valid as long as
+ *           that is.  NULL if the range is empty.  Like other prefix
+ *           views, it is generally not null-terminated.
+ */
+template<typename It>
+inline basic_pidl_view<typename detail::element_pidl_type<It>::type>
+common_prefix(It first, It last)
+{
+    typedef typename detail::element_pidl_type<It>::type pidl_type;
+
+    if (first == last)
+        return basic_pidl_view<pidl_type>();
+
+    detail::measured_items head = detail::measure_items(*first);
+    const BYTE* head_bytes = static_cast<const BYTE*>(head.data);
+
+    // Byte-wise first; the bytes shared by every PIDL are cut back to a
+    // whole number of items at the end.  Up to where they first differ,
+    // the PIDLs have identical items so their item boundaries agree.
+    size_t common = head.bytes;
+    for (It it = first; common && ++it != last; )
+    {
+        detail::measured_items other = detail::measure_items(*it);
+        common = detail::common_bytes(
+            head_bytes, static_cast<const BYTE*>(other.data),
+            (std::min)(common, other.bytes));
+    }
+
+    size_t bytes = 0;
+    size_t item_count = 0;
+    while (item_count < head.item_count)
+    {
+        USHORT cb;
+        std::memcpy(&cb, head_bytes + bytes, sizeof(cb));
+        if (cb > common - bytes)
+            break;
+
+        bytes += cb;
+        ++item_count;
+    }
+
+    return basic_pidl_view<pidl_type>(
+        reinterpret_cast<const pidl_type __unaligned*>(head.data), bytes,
+        item_count);
+}
+
+/**
+ * View of the items of @a pidl after @a prefix.
+ *
+ * The PIDL may be a raw PIDL, wrapper or view.  The result is a view into
+ * it, null-terminated if the PIDL is, and is empty if the PIDL is the
+ * prefix.
+ *
+ * @throws std::invalid_argument if the PIDL doesn't start with @a prefix.
+ */
+template<typename T, typename P>
+inline pidl_view relative_to(const basic_pidl_view<T>& prefix, const P& pidl)
+{
+    detail::measured_items items = detail::measure_items(pidl);
+
+    size_t bytes = prefix.item_bytes();
+    if (bytes > items.bytes ||
+        (bytes && detail::common_bytes(
+            reinterpret_cast<const BYTE*>(prefix.data()),
+            static_cast<const BYTE*>(items.data), bytes) != bytes))
+        BOOST_THROW_EXCEPTION(
+            std::invalid_argument("PIDL does not start with the prefix"));
+
+    return detail::suffix_after(items, bytes, prefix.item_count());
+}
+
+/**
+ * Find the common prefix of the PIDLs in the range [@a first, @a last)
+ * and write a view of each one relative to it to @a relatives.
+ *
+ * The range is traversed twice: once to find the prefix, as
+ * common_prefix() does, and again to produce the relative views.  The
+ * second pass doesn't compare anything.
+ *
+ * @returns  A view of the prefix in the first PIDL.
+ */
+template<typename It, typename OutIt>
+inline basic_pidl_view<typename detail::element_pidl_type<It>::type>
+split_common_prefix(It first, It last, OutIt relatives)
+{
+    typedef typename detail::element_pidl_type<It>::type pidl_type;
+
+    basic_pidl_view<pidl_type> prefix = common_prefix(first, last);
+
+    for (It it = first; it != last; ++it)
+    {
+        *relatives++ = detail::suffix_after(
+            detail::measure_items(*it), prefix.item_bytes(),
+            prefix.item_count());
+    }
+
+    return prefix;
+}
+
+// @}
+
+}}} // namespace washer::shell::pidl
+
+#endif
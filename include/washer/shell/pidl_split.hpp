@@ -0,0 +1,243 @@
+/**
+    @file
+
+    PIDL split into its parent and last item in a single allocation.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#ifndef WASHER_SHELL_PIDL_SPLIT_HPP
+#define WASHER_SHELL_PIDL_SPLIT_HPP
+#pragma once
+
+#include <washer/shell/pidl.hpp> // basic_pidl, copy_terminated, default_alloc
+#include <washer/shell/pidl_view.hpp> // basic_pidl_view, basic_split_view
+
+#include <boost/move/move.hpp> // BOOST_RV_REF, BOOST_MOVABLE_BUT_NOT_COPYABLE
+#include <boost/throw_exception.hpp> // BOOST_THROW_EXCEPTION
+
+#include <algorithm> // swap
+#include <cstddef> // size_t
+#include <stdexcept> // logic_error
+
+#include <washer/shell/itemidlist.hpp> // Raw PIDL types
+
+namespace washer {
+namespace shell {
+namespace pidl {
+
+namespace detail {
+
+    /**
+     * Split a raw PIDL, finding its size and last item in one walk.
+     */
+    template<typename T>
+    inline basic_split_view<T> split_items(const T __unaligned* pidl)
+    {
+        if (raw_pidl::empty(pidl))
+            BOOST_THROW_EXCEPTION(
+                std::logic_error("Empty PIDL cannot be split"));
+
+        raw_pidl::extent e = raw_pidl::measure(pidl);
+
+        basic_split_view<T> result;
+        result.parent = basic_pidl_view<T>(
+            pidl, e.last_offset, e.item_count - 1);
+        result.child = basic_pidl_view<ITEMID_CHILD>(
+            reinterpret_cast<const ITEMID_CHILD __unaligned*>(
+                raw_pidl::skip(pidl, e.last_offset)),
+            e.size - sizeof(USHORT) - e.last_offset, 1);
+        return result;
+    }
+
+    template<typename T, typename Alloc>
+    inline basic_split_view<T> split_items(const basic_pidl<T, Alloc>& pidl)
+    {
+        return pidl.split();
+    }
+
+    template<typename T>
+    inline basic_split_view<T> split_items(const basic_pidl_view<T>& view)
+    {
+        return view.split();
+    }
+}
+
+/**
+ * Owning copy of a PIDL's parent and last item in a single allocation.
+ *
+ * Most shell calls on an item need both its parent, to bind to the folder,
+ * and its last item, to pass to the folder.  Copying them with
+ * basic_pidl::parent() and basic_pidl::last_item() allocates twice.  This
+ * class copies both, each null-terminated, into one block so either can
+ * be passed straight to the shell as a raw PIDL.
+ *
+ * The child follows the parent directly, so may not be aligned.
+ */
+template<typename T, typename Alloc = typename default_alloc<T>::type>
+class basic_split_pidl
+{
+public:
+
+    typedef Alloc allocator;
+
+    /**
+     * Split @a pidl, which may be a raw PIDL, wrapper or view.
+     *
+     * The source is walked at most once.
+     *
+     * @throws std::logic_error if the PIDL is empty or NULL.
+     */
+    template<typename Pidl>
+    explicit basic_split_pidl(const Pidl& pidl, Alloc alloc=Alloc())
+        : m_buffer(NULL), m_parent_bytes(0), m_parent_count(0),
+          m_child_bytes(0), m_allocator(alloc)
+    {
+        basic_split_view<T> split = detail::split_items(pidl);
+
+        m_parent_bytes = split.parent.item_bytes();
+        m_parent_count = split.parent.item_count();
+        m_child_bytes = split.child.item_bytes();
+        m_buffer = m_allocator.allocate(allocated_bytes());
+
+        detail::copy_terminated(
+            m_buffer, split.parent.data(), m_parent_bytes);
+        detail::copy_terminated(
+            child_buffer(), split.child.data(), m_child_bytes);
+    }
+
+    ~basic_split_pidl() throw()
+    {
+        if (m_buffer)
+            m_allocator.deallocate(m_buffer);
+    }
+
+    /**
+     * Move construction.
+     */
+    basic_split_pidl(BOOST_RV_REF(basic_split_pidl) split) :
+        m_buffer(split.m_buffer), m_parent_bytes(split.m_parent_bytes),
+        m_parent_count(split.m_parent_count),
+        m_child_bytes(split.m_child_bytes), m_allocator(split.m_allocator)
+    {
+        split.m_buffer = NULL;
+        split.m_parent_bytes = 0;
+        split.m_parent_count = 0;
+        split.m_child_bytes = 0;
+    }
+
+    /**
+     * Move assignment.
+     */
+    basic_split_pidl& operator=(BOOST_RV_REF(basic_split_pidl) split)
+    {
+        basic_split_pidl moved(boost::move(split));
+        swap(moved);
+        return *this;
+    }
+
+    /**
+     * View of the null-terminated copy of the parent.
+     */
+    basic_pidl_view<T> parent() const
+    {
+        return basic_pidl_view<T>(
+            get_parent(), m_parent_bytes, m_parent_count);
+    }
+
+    /**
+     * View of the null-terminated copy of the last item.
+     */
+    basic_pidl_view<ITEMID_CHILD> child() const
+    {
+        return basic_pidl_view<ITEMID_CHILD>(get_child(), m_child_bytes, 1);
+    }
+
+    /**
+     * The parent as a raw PIDL.
+     */
+    const T* get_parent() const
+    {
+        return reinterpret_cast<const T*>(m_buffer);
+    }
+
+    /**
+     * The last item as a raw PIDL.
+     */
+    const ITEMID_CHILD __unaligned* get_child() const
+    {
+        return reinterpret_cast<const ITEMID_CHILD __unaligned*>(
+            child_buffer());
+    }
+
+    /**
+     * Size of the single block holding both PIDLs.
+     */
+    size_t allocated_bytes() const
+    {
+        return m_parent_bytes + m_child_bytes + 2 * sizeof(USHORT);
+    }
+
+    Alloc get_allocator() const
+    {
+        return Alloc(m_allocator);
+    }
+
+    /**
+     * No-fail swap.
+     */
+    void swap(basic_split_pidl& split) throw()
+    {
+        std::swap(m_buffer, split.m_buffer);
+        std::swap(m_parent_bytes, split.m_parent_bytes);
+        std::swap(m_parent_count, split.m_parent_count);
+        std::swap(m_child_bytes, split.m_child_bytes);
+        std::swap(m_allocator, split.m_allocator);
+    }
+
+private:
+    BOOST_MOVABLE_BUT_NOT_COPYABLE(basic_split_pidl)
+
+    typedef typename Alloc::template rebind<BYTE>::other byte_allocator;
+
+    BYTE* child_buffer() const
+    {
+        return m_buffer + m_parent_bytes + sizeof(USHORT);
+    }
+
+    BYTE* m_buffer;
+    size_t m_parent_bytes;
+    size_t m_parent_count;
+    size_t m_child_bytes;
+    byte_allocator m_allocator;
+};
+
+typedef basic_split_pidl<ITEMIDLIST_RELATIVE> split_pidl;
+typedef basic_split_pidl<ITEMIDLIST_ABSOLUTE> split_apidl;
+
+}}} // namespace washer::shell::pidl
+
+#endif
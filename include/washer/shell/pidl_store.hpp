@@ -0,0 +1,591 @@
+/**
+    @file
+
+    Memory-mapped store of PIDLs persisted between sessions.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#ifndef WASHER_SHELL_PIDL_STORE_HPP
+#define WASHER_SHELL_PIDL_STORE_HPP
+#pragma once
+
+#include <washer/shell/detail/indexed_iterator.hpp> // indexed_iterator
+#include <washer/shell/pidl_parse.hpp> // parse_pidl
+#include <washer/shell/pidl_view.hpp> // basic_pidl_view, measure_items
+
+#include <boost/cstdint.hpp> // uint32_t, uint64_t
+#include <boost/crc.hpp> // crc_32_type
+#include <boost/interprocess/file_mapping.hpp> // file_mapping
+#include <boost/interprocess/mapped_region.hpp> // mapped_region
+#include <boost/noncopyable.hpp> // noncopyable
+#include <boost/range/iterator_range.hpp> // iterator_range
+#include <boost/static_assert.hpp> // BOOST_STATIC_ASSERT
+#include <boost/throw_exception.hpp> // BOOST_THROW_EXCEPTION
+
+#include <algorithm> // min
+#include <cassert> // assert
+#include <cstddef> // size_t
+#include <cstring> // memcpy, memcmp
+#include <fstream> // fstream
+#include <limits> // numeric_limits
+#include <stdexcept> // runtime_error, out_of_range, length_error
+#include <string>
+#include <vector>
+
+#include <washer/shell/itemidlist.hpp> // Raw PIDL types
+
+namespace washer {
+namespace shell {
+namespace pidl {
+
+/**
+ * @name  PIDL store
+ *
+ * A file of PIDLs, each with optional opaque metadata, that can be mapped
+ * into memory and read in place.
+ *
+ * The file is a fixed header, the records and then an index of where each
+ * record is.  A record is a null-terminated PIDL followed immediately by
+ * its metadata.  The header holds a magic number, the format version, the
+ * number of records, the offset of the index and a CRC-32 of everything
+ * after the header.  Fields are in the byte order of the machine that
+ * wrote the store, like the PIDLs themselves, so a store written on a
+ * machine of the other endianness is rejected as an unknown version.
+ *
+ * The index is at the end so more records can be appended by writing them
+ * over the old index and writing a new one after them.
+ */
+// @{
+
+namespace detail {
+
+    struct store_header
+    {
+        char magic[8];
+        boost::uint32_t version;
+        boost::uint32_t header_size;
+        boost::uint64_t count;
+        boost::uint64_t index_offset;
+        boost::uint32_t checksum;
+        boost::uint32_t reserved;
+    };
+
+    struct store_entry
+    {
+        boost::uint64_t offset;
+        boost::uint32_t pidl_size; ///< Including the null-terminator
+        boost::uint32_t metadata_size;
+    };
+
+    BOOST_STATIC_ASSERT(sizeof(store_header) == 40);
+    BOOST_STATIC_ASSERT(sizeof(store_entry) == 16);
+
+    const boost::uint32_t store_version = 1;
+
+    inline const char* store_magic()
+    {
+        return "WPIDLSTR";
+    }
+
+    inline void corrupt_store(const char* message)
+    {
+        BOOST_THROW_EXCEPTION(std::runtime_error(message));
+    }
+
+    /**
+     * Check the header and the extent of the index against the size of
+     * the store.
+     *
+     * Only the header is read from @a data so the rest of the store need
+     * not be in memory.
+     */
+    inline store_header read_store_header(const BYTE* data, size_t size)
+    {
+        store_header header;
+        if (!data || size < sizeof(header))
+            corrupt_store("PIDL store too small for its header");
+
+        std::memcpy(&header, data, sizeof(header));
+        if (std::memcmp(header.magic, store_magic(), sizeof(header.magic)))
+            corrupt_store("Not a PIDL store");
+
+        if (header.version != store_version ||
+            header.header_size != sizeof(header))
+            corrupt_store("Unknown PIDL store version");
+
+        if (header.index_offset < sizeof(header) ||
+            header.index_offset > size)
+            corrupt_store("PIDL store index outside the store");
+
+        if (header.count != (size - header.index_offset) / sizeof(store_entry)
+            || (size - header.index_offset) % sizeof(store_entry))
+            corrupt_store("PIDL store index doesn't match its count");
+
+        return header;
+    }
+
+    inline boost::uint32_t store_checksum(const BYTE* data, size_t size)
+    {
+        boost::crc_32_type crc;
+        crc.process_bytes(data + sizeof(store_header),
+            size - sizeof(store_header));
+        return crc.checksum();
+    }
+}
+
+/**
+ * Whether to check a store's CRC when opening it.
+ *
+ * Checking reads every byte of the store.  The structure of each record
+ * is checked as it is read regardless, so skipping the CRC can't lead to
+ * reading outside the store, only to missing corrupt item data.
+ */
+enum store_check
+{
+    verify_checksum,
+    skip_checksum
+};
+
+/**
+ * Read-only, zero-copy view of a PIDL store in memory.
+ *
+ * The header and the extent of the index are checked when the view is
+ * created.  Each record is checked as it is accessed, using parse_pidl(),
+ * so opening a store with a million records doesn't cost a pass over all
+ * of them unless the CRC is verified.  The PIDLs are returned as views of
+ * the store's memory, which must outlive them.
+ */
+template<typename T>
+class basic_pidl_store_view
+{
+public:
+
+    typedef basic_pidl_view<T> value_type;
+    typedef basic_pidl_view<T> reference;
+    typedef basic_pidl_view<T> const_reference;
+    typedef washer::shell::detail::indexed_iterator<
+        basic_pidl_store_view, basic_pidl_view<T> > iterator;
+    typedef iterator const_iterator;
+
+    /**
+     * View the store in the @a size bytes at @a data.
+     *
+     * @throws std::runtime_error if the memory isn't a PIDL store of the
+     *         supported version or, when checked, its CRC doesn't match.
+     */
+    basic_pidl_store_view(
+        const void* data, size_t size, store_check check=verify_checksum)
+        : m_data(static_cast<const BYTE*>(data)), m_size(size)
+    {
+        detail::store_header header =
+            detail::read_store_header(m_data, m_size);
+
+        if (check == verify_checksum &&
+            detail::store_checksum(m_data, m_size) != header.checksum)
+            detail::corrupt_store("PIDL store checksum mismatch");
+
+        m_count = static_cast<size_t>(header.count);
+        m_index_offset = static_cast<size_t>(header.index_offset);
+    }
+
+    /**
+     * PIDL of the record at @a index.
+     *
+     * @throws std::runtime_error if the record is malformed.
+     */
+    basic_pidl_view<T> operator[](size_t index) const
+    {
+        detail::store_entry entry = read_entry(index);
+
+        basic_pidl_view<T> view;
+        if (parse_pidl(m_data + entry.offset, entry.pidl_size, view) !=
+            parse_ok || view.item_bytes() + sizeof(USHORT) != entry.pidl_size)
+            detail::corrupt_store("Malformed PIDL in PIDL store");
+
+        return view;
+    }
+
+    /**
+     * PIDL of the record at @a index.
+     *
+     * @throws std::out_of_range if @a index is past the end.
+     * @throws std::runtime_error if the record is malformed.
+     */
+    basic_pidl_view<T> at(size_t index) const
+    {
+        if (index >= m_count)
+            BOOST_THROW_EXCEPTION(
+                std::out_of_range("PIDL store index out of range"));
+
+        return (*this)[index];
+    }
+
+    /**
+     * Metadata stored with the record at @a index.
+     *
+     * @throws std::runtime_error if the record is malformed.
+     */
+    boost::iterator_range<const BYTE*> metadata(size_t index) const
+    {
+        detail::store_entry entry = read_entry(index);
+        const BYTE* start = m_data + entry.offset + entry.pidl_size;
+        return boost::iterator_range<const BYTE*>(
+            start, start + entry.metadata_size);
+    }
+
+    iterator begin() const
+    {
+        return iterator(*this, 0);
+    }
+
+    iterator end() const
+    {
+        return iterator(*this, m_count);
+    }
+
+    size_t size() const
+    {
+        return m_count;
+    }
+
+    bool empty() const
+    {
+        return m_count == 0;
+    }
+
+private:
+
+    /**
+     * Read an index entry and check its record lies between the header
+     * and the index.
+     */
+    detail::store_entry read_entry(size_t index) const
+    {
+        assert(index < m_count);
+
+        detail::store_entry entry;
+        std::memcpy(
+            &entry, m_data + m_index_offset + index * sizeof(entry),
+            sizeof(entry));
+
+        boost::uint64_t record_space = m_index_offset;
+        if (entry.offset < sizeof(detail::store_header) ||
+            entry.offset > record_space ||
+            entry.pidl_size > record_space - entry.offset ||
+            entry.metadata_size >
+                record_space - entry.offset - entry.pidl_size)
+            detail::corrupt_store("PIDL store record outside the store");
+
+        return entry;
+    }
+
+    const BYTE* m_data;
+    size_t m_size;
+    size_t m_count;
+    size_t m_index_offset;
+};
+
+/**
+ * PIDL store file mapped into memory.
+ *
+ * Opening the store is a single map call however many records it has.
+ * The records are read in place through view(), so reloading a large
+ * folder listing doesn't allocate anything per PIDL.
+ */
+template<typename T>
+class basic_mapped_pidl_store : private boost::noncopyable
+{
+public:
+
+    /**
+     * Map the store in @a filename read-only.
+     *
+     * @throws boost::interprocess::interprocess_exception if the file
+     *         can't be opened or mapped.
+     * @throws std::runtime_error if the file isn't a valid PIDL store.
+     */
+    explicit basic_mapped_pidl_store(
+        const char* filename, store_check check=verify_checksum)
+        :
+    m_file(filename, boost::interprocess::read_only),
+    m_region(m_file, boost::interprocess::read_only),
+    m_view(m_region.get_address(), m_region.get_size(), check) {}
+
+    const basic_pidl_store_view<T>& view() const
+    {
+        return m_view;
+    }
+
+private:
+    boost::interprocess::file_mapping m_file;
+    boost::interprocess::mapped_region m_region;
+    basic_pidl_store_view<T> m_view;
+};
+
+/**
+ * Writes PIDLs and their metadata to a store file.
+ *
+ * Records are streamed to the file as they are added; only the index is
+ * kept in memory.  Nothing is visible to readers until commit() writes
+ * the index and header.  More records can be added after committing and
+ * committed in turn.
+ *
+ * A store whose writer fails or is destroyed part-way through appending
+ * is left with a header that doesn't match its contents, so readers
+ * reject it rather than see a partial update.
+ */
+class pidl_store_writer : private boost::noncopyable
+{
+public:
+
+    enum open_mode
+    {
+        create, ///< Start a new, empty store, replacing any existing file
+        append ///< Add records to the end of an existing store
+    };
+
+    /**
+     * @throws std::runtime_error if the file can't be opened or, when
+     *         appending, isn't a valid PIDL store.
+     */
+    explicit pidl_store_writer(const char* filename, open_mode mode=create)
+        : m_data_end(sizeof(detail::store_header))
+    {
+        if (mode == create)
+        {
+            m_file.open(filename,
+                std::ios::in | std::ios::out | std::ios::binary |
+                std::ios::trunc);
+            check_stream("Unable to create PIDL store");
+
+            // Placeholder header with no magic until the first commit
+            detail::store_header header = detail::store_header();
+            write_at(0, &header, sizeof(header));
+        }
+        else
+        {
+            m_file.open(filename,
+                std::ios::in | std::ios::out | std::ios::binary);
+            check_stream("Unable to open PIDL store");
+            load_existing();
+        }
+    }
+
+    /**
+     * Add a PIDL with no metadata.
+     */
+    template<typename Pidl>
+    void push_back(const Pidl& pidl)
+    {
+        push_back(pidl, NULL, 0);
+    }
+
+    /**
+     * Add a PIDL with @a metadata_size bytes of metadata.
+     *
+     * The PIDL may be a raw PIDL, wrapper or view.
+     *
+     * @throws std::length_error if the PIDL or metadata is too big for the
+     *         format.
+     * @throws std::runtime_error if writing to the file fails.
+     */
+    template<typename Pidl>
+    void push_back(
+        const Pidl& pidl, const void* metadata, size_t metadata_size)
+    {
+        detail::measured_items items = detail::measure_items(pidl);
+        size_t pidl_size = items.bytes + sizeof(USHORT);
+        if (pidl_size > (std::numeric_limits<boost::uint32_t>::max)() ||
+            metadata_size > (std::numeric_limits<boost::uint32_t>::max)())
+            BOOST_THROW_EXCEPTION(
+                std::length_error("Record too big for PIDL store"));
+
+        detail::store_entry entry;
+        entry.offset = m_data_end;
+        entry.pidl_size = static_cast<boost::uint32_t>(pidl_size);
+        entry.metadata_size = static_cast<boost::uint32_t>(metadata_size);
+
+        USHORT terminator = 0;
+        m_file.seekp(static_cast<std::streamoff>(m_data_end));
+        write(items.data, items.bytes);
+        write(&terminator, sizeof(terminator));
+        write(metadata, metadata_size);
+
+        m_data_end += pidl_size + metadata_size;
+        m_entries.push_back(entry);
+    }
+
+    /**
+     * Number of records, committed or not.
+     */
+    size_t size() const
+    {
+        return m_entries.size();
+    }
+
+    /**
+     * Write the index and header so readers see every record added so
+     * far.
+     *
+     * @throws std::runtime_error if writing to the file fails.
+     */
+    void commit()
+    {
+        boost::crc_32_type crc = m_data_crc;
+
+        const void* index = (m_entries.empty()) ? NULL : &m_entries[0];
+        size_t index_size = m_entries.size() * sizeof(detail::store_entry);
+        write_at(m_data_end, index, index_size);
+        crc.process_bytes(index, index_size);
+
+        detail::store_header header = detail::store_header();
+        std::memcpy(
+            header.magic, detail::store_magic(), sizeof(header.magic));
+        header.version = detail::store_version;
+        header.header_size = sizeof(header);
+        header.count = m_entries.size();
+        header.index_offset = m_data_end;
+        header.checksum = crc.checksum();
+
+        // The header goes last so that a failure while writing the index
+        // leaves the old header, which no longer matches
+        m_file.flush();
+        write_at(0, &header, sizeof(header));
+        m_file.flush();
+        check_stream("Unable to commit PIDL store");
+    }
+
+private:
+
+    void check_stream(const char* message)
+    {
+        if (!m_file)
+            BOOST_THROW_EXCEPTION(std::runtime_error(message));
+    }
+
+    void write_at(boost::uint64_t offset, const void* data, size_t size)
+    {
+        m_file.seekp(static_cast<std::streamoff>(offset));
+        write_raw(data, size);
+    }
+
+    /**
+     * Write record bytes at the current position, adding them to the CRC.
+     */
+    void write(const void* data, size_t size)
+    {
+        write_raw(data, size);
+        m_data_crc.process_bytes(data, size);
+    }
+
+    void write_raw(const void* data, size_t size)
+    {
+        if (size)
+            m_file.write(static_cast<const char*>(data), size);
+        check_stream("Unable to write to PIDL store");
+    }
+
+    /**
+     * Read the index of the store being appended to and the CRC of its
+     * records.
+     */
+    void load_existing()
+    {
+        m_file.seekg(0, std::ios::end);
+        size_t size = static_cast<size_t>(m_file.tellg());
+
+        if (size < sizeof(detail::store_header))
+            detail::corrupt_store("PIDL store too small for its header");
+
+        BYTE header_bytes[sizeof(detail::store_header)];
+        m_file.seekg(0);
+        m_file.read(
+            reinterpret_cast<char*>(header_bytes), sizeof(header_bytes));
+        check_stream("Unable to read PIDL store");
+
+        // Only the header is read from the file but the rest of it is only
+        // measured, so give the real size to check the index against
+        detail::store_header header =
+            detail::read_store_header(header_bytes, size);
+
+        std::vector<char> buffer(64 * 1024);
+        boost::crc_32_type crc;
+        boost::uint64_t remaining = size - sizeof(header);
+        while (remaining)
+        {
+            size_t chunk = static_cast<size_t>(
+                (std::min<boost::uint64_t>)(remaining, buffer.size()));
+            m_file.read(&buffer[0], chunk);
+            check_stream("Unable to read PIDL store");
+
+            // Records are CRC'd separately so more can be added to them
+            if (size - remaining < header.index_offset)
+            {
+                size_t records = static_cast<size_t>(
+                    (std::min<boost::uint64_t>)(
+                        chunk, header.index_offset - (size - remaining)));
+                m_data_crc.process_bytes(&buffer[0], records);
+            }
+
+            crc.process_bytes(&buffer[0], chunk);
+            remaining -= chunk;
+        }
+
+        if (crc.checksum() != header.checksum)
+            detail::corrupt_store("PIDL store checksum mismatch");
+
+        m_entries.resize(static_cast<size_t>(header.count));
+        if (!m_entries.empty())
+        {
+            m_file.seekg(static_cast<std::streamoff>(header.index_offset));
+            m_file.read(reinterpret_cast<char*>(&m_entries[0]),
+                m_entries.size() * sizeof(detail::store_entry));
+            check_stream("Unable to read PIDL store");
+        }
+
+        m_data_end = header.index_offset;
+    }
+
+    std::fstream m_file;
+    std::vector<detail::store_entry> m_entries;
+    boost::uint64_t m_data_end;
+    boost::crc_32_type m_data_crc;
+};
+
+typedef basic_pidl_store_view<ITEMIDLIST_RELATIVE> pidl_store_view;
+typedef basic_pidl_store_view<ITEMID_CHILD> cpidl_store_view;
+typedef basic_pidl_store_view<ITEMIDLIST_ABSOLUTE> apidl_store_view;
+
+typedef basic_mapped_pidl_store<ITEMIDLIST_RELATIVE> mapped_pidl_store;
+typedef basic_mapped_pidl_store<ITEMID_CHILD> mapped_cpidl_store;
+typedef basic_mapped_pidl_store<ITEMIDLIST_ABSOLUTE> mapped_apidl_store;
+
+// @}
+
+}}} // namespace washer::shell::pidl
+
+#endif
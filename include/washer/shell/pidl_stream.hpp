@@ -0,0 +1,540 @@
+/**
+    @file
+
+    Reading and writing sequences of PIDLs as a stream of bytes.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#ifndef WASHER_SHELL_PIDL_STREAM_HPP
+#define WASHER_SHELL_PIDL_STREAM_HPP
+#pragma once
+
+#include <washer/shell/pidl.hpp> // basic_pidl, default_alloc
+#include <washer/shell/pidl_parse.hpp> // max_items, parse_status_message
+#include <washer/shell/pidl_view.hpp> // basic_pidl_view, measure_items
+
+#include <boost/noncopyable.hpp> // noncopyable
+#include <boost/throw_exception.hpp> // BOOST_THROW_EXCEPTION
+
+#ifdef _WIN32
+#include <comet/error.h> // com_error
+#include <comet/ptr.h> // com_ptr
+
+#include <boost/exception/errinfo_api_function.hpp> // errinfo_api_function
+#include <boost/exception/info.hpp> // errinfo
+#include <boost/numeric/conversion/cast.hpp> // numeric_cast
+#endif
+
+#include <algorithm> // min
+#include <cassert> // assert
+#include <cstddef> // size_t
+#include <cstring> // memcpy
+#include <istream>
+#include <ostream>
+#include <stdexcept> // runtime_error, invalid_argument
+#include <vector>
+
+#include <washer/shell/itemidlist.hpp> // Raw PIDL types
+
+namespace washer {
+namespace shell {
+namespace pidl {
+
+/**
+ * @name  Byte sources and sinks
+ *
+ * The PIDL reader pulls bytes from a source: any object with a member
+ * @c size_t read(void* buffer, size_t size) that copies up to @a size
+ * bytes into the buffer and returns how many it copied, returning zero
+ * only at the end of the stream.
+ *
+ * The PIDL writer pushes bytes to a sink: any object with a member
+ * @c void write(const void* data, size_t size) that writes all of them.
+ *
+ * Both throw if the underlying stream fails.
+ */
+// @{
+
+/**
+ * Source reading from a block of memory.
+ */
+class memory_byte_source
+{
+public:
+
+    memory_byte_source(const void* data, size_t size)
+        : m_position(static_cast<const BYTE*>(data)),
+          m_end(static_cast<const BYTE*>(data) + size) {}
+
+    size_t read(void* buffer, size_t size)
+    {
+        size_t count =
+            (std::min)(size, static_cast<size_t>(m_end - m_position));
+        if (count)
+            std::memcpy(buffer, m_position, count);
+        m_position += count;
+        return count;
+    }
+
+private:
+    const BYTE* m_position;
+    const BYTE* m_end;
+};
+
+/**
+ * Source reading from a standard stream, such as a file opened in binary
+ * mode.
+ */
+class istream_byte_source
+{
+public:
+
+    explicit istream_byte_source(std::istream& stream) : m_stream(&stream) {}
+
+    /**
+     * @throws std::runtime_error if the stream fails other than by
+     *         reaching its end.
+     */
+    size_t read(void* buffer, size_t size)
+    {
+        m_stream->read(
+            static_cast<char*>(buffer), static_cast<std::streamsize>(size));
+        if (m_stream->bad())
+            BOOST_THROW_EXCEPTION(
+                std::runtime_error("Couldn't read from PIDL stream"));
+
+        return static_cast<size_t>(m_stream->gcount());
+    }
+
+private:
+    std::istream* m_stream;
+};
+
+/**
+ * Sink appending to a vector of bytes.
+ */
+class vector_byte_sink
+{
+public:
+
+    explicit vector_byte_sink(std::vector<BYTE>& bytes) : m_bytes(&bytes) {}
+
+    void write(const void* data, size_t size)
+    {
+        const BYTE* begin = static_cast<const BYTE*>(data);
+        m_bytes->insert(m_bytes->end(), begin, begin + size);
+    }
+
+private:
+    std::vector<BYTE>* m_bytes;
+};
+
+/**
+ * Sink writing to a standard stream.
+ */
+class ostream_byte_sink
+{
+public:
+
+    explicit ostream_byte_sink(std::ostream& stream) : m_stream(&stream) {}
+
+    /**
+     * @throws std::runtime_error if the stream fails.
+     */
+    void write(const void* data, size_t size)
+    {
+        m_stream->write(
+            static_cast<const char*>(data),
+            static_cast<std::streamsize>(size));
+        if (!*m_stream)
+            BOOST_THROW_EXCEPTION(
+                std::runtime_error("Couldn't write to PIDL stream"));
+    }
+
+private:
+    std::ostream* m_stream;
+};
+
+#ifdef _WIN32
+
+/**
+ * Source reading from a COM stream, such as one from stream_from_pidl().
+ */
+class com_stream_byte_source
+{
+public:
+
+    explicit com_stream_byte_source(
+        const comet::com_ptr<ISequentialStream>& stream) : m_stream(stream) {}
+
+    /**
+     * @throws comet::com_error if reading from the stream fails.
+     */
+    size_t read(void* buffer, size_t size)
+    {
+        ULONG count = 0;
+        HRESULT hr = m_stream->Read(
+            buffer, boost::numeric_cast<ULONG>(size), &count);
+        if (FAILED(hr))
+            BOOST_THROW_EXCEPTION(
+                boost::enable_error_info(comet::com_error(hr)) <<
+                boost::errinfo_api_function("ISequentialStream::Read"));
+
+        return count;
+    }
+
+private:
+    comet::com_ptr<ISequentialStream> m_stream;
+};
+
+/**
+ * Sink writing to a COM stream.
+ */
+class com_stream_byte_sink
+{
+public:
+
+    explicit com_stream_byte_sink(
+        const comet::com_ptr<ISequentialStream>& stream) : m_stream(stream) {}
+
+    /**
+     * @throws comet::com_error if writing to the stream fails.
+     */
+    void write(const void* data, size_t size)
+    {
+        ULONG count = 0;
+        HRESULT hr = m_stream->Write(
+            data, boost::numeric_cast<ULONG>(size), &count);
+        if (SUCCEEDED(hr) && count != size)
+            hr = STG_E_MEDIUMFULL;
+        if (FAILED(hr))
+            BOOST_THROW_EXCEPTION(
+                boost::enable_error_info(comet::com_error(hr)) <<
+                boost::errinfo_api_function("ISequentialStream::Write"));
+    }
+
+private:
+    comet::com_ptr<ISequentialStream> m_stream;
+};
+
+#endif
+
+// @}
+
+/**
+ * Reads PIDLs, one after another, from a stream of bytes.
+ *
+ * Each PIDL in the stream is its items followed by its null terminator,
+ * as written by pidl_writer, so the stream is parsed item by item using
+ * the items' @c cb fields.  Bytes are pulled from the source a buffer at
+ * a time and items may straddle buffers, so the reader never holds more
+ * than its buffer and the PIDL being read, however long the stream.
+ * PIDLs longer than the reader's limit are rejected rather than growing
+ * the memory without bound.
+ *
+ * Source is a byte source, which the reader borrows, so it must outlive
+ * the reader.
+ */
+template<
+    typename T, typename Source,
+    typename Alloc = typename default_alloc<T>::type>
+class basic_pidl_reader : private boost::noncopyable
+{
+public:
+
+    static const size_t default_buffer_size = 4096;
+    static const size_t default_max_pidl_size = 64 * 1024;
+
+    /**
+     * @throws std::invalid_argument if the buffer is empty or the limit is
+     *         too small for any PIDL.
+     */
+    explicit basic_pidl_reader(
+        Source& source, size_t buffer_size=default_buffer_size,
+        size_t max_pidl_size=default_max_pidl_size, Alloc alloc=Alloc())
+        : m_source(source), m_buffer(buffer_size), m_begin(0), m_end(0),
+          m_max_pidl_size(max_pidl_size), m_pidls_read(0),
+          m_allocator(alloc)
+    {
+        if (buffer_size == 0)
+            BOOST_THROW_EXCEPTION(
+                std::invalid_argument("PIDL reader needs a buffer"));
+        if (max_pidl_size < sizeof(USHORT))
+            BOOST_THROW_EXCEPTION(
+                std::invalid_argument("PIDL size limit is too small"));
+    }
+
+    /**
+     * Read the next PIDL and view it in the reader's own memory.
+     *
+     * The view is valid until the next PIDL is read.  It is null-terminated
+     * so can be used as a raw PIDL.
+     *
+     * @returns false, leaving @a view unchanged, if the stream ended
+     *          cleanly before another PIDL.
+     *
+     * @throws std::runtime_error if the stream ends part-way through a
+     *         PIDL, an item's size is invalid, the PIDL has too many items
+     *         for T or is longer than the reader's limit.
+     */
+    bool next(basic_pidl_view<T>& view)
+    {
+        m_pidl.clear();
+
+        const size_t max_items = detail::max_items<T>::value;
+        size_t item_count = 0;
+        for (;;)
+        {
+            size_t offset = m_pidl.size();
+            size_t got = take(sizeof(USHORT));
+            if (got == 0 && offset == 0)
+                return false;
+            else if (got < sizeof(USHORT))
+                throw_truncated();
+
+            USHORT cb;
+            std::memcpy(&cb, &m_pidl[offset], sizeof(cb));
+            if (cb == 0)
+                break;
+
+            if (cb < sizeof(USHORT))
+                BOOST_THROW_EXCEPTION(
+                    std::runtime_error("Invalid item size in PIDL stream"));
+
+            if (max_items != static_cast<size_t>(-1) &&
+                item_count == max_items)
+                BOOST_THROW_EXCEPTION(
+                    std::runtime_error(
+                        detail::parse_status_message(parse_wrong_type)));
+
+            // Must leave room for at least the terminator
+            if (offset + cb + sizeof(USHORT) > m_max_pidl_size)
+                BOOST_THROW_EXCEPTION(
+                    std::runtime_error("PIDL in stream is too long"));
+
+            if (take(cb - sizeof(USHORT)) < cb - sizeof(USHORT))
+                throw_truncated();
+
+            ++item_count;
+        }
+
+        ++m_pidls_read;
+        view = basic_pidl_view<T>(
+            reinterpret_cast<const T __unaligned*>(&m_pidl[0]),
+            m_pidl.size() - sizeof(USHORT), item_count);
+        return true;
+    }
+
+    /**
+     * Read the next PIDL into @a pidl.
+     *
+     * @returns false, leaving @a pidl unchanged, if the stream ended
+     *          cleanly before another PIDL.
+     *
+     * @throws std::runtime_error as for next().
+     */
+    bool read(basic_pidl<T, Alloc>& pidl)
+    {
+        basic_pidl_view<T> view;
+        if (!next(view))
+            return false;
+
+        basic_pidl<T, Alloc>(view, m_allocator).swap(pidl);
+        return true;
+    }
+
+    /**
+     * Number of PIDLs read so far.
+     */
+    size_t pidls_read() const
+    {
+        return m_pidls_read;
+    }
+
+private:
+
+    /**
+     * Append up to @a count bytes from the stream to the PIDL being read.
+     *
+     * @returns how many were appended, which is fewer than asked for only
+     *          at the end of the stream.
+     */
+    size_t take(size_t count)
+    {
+        size_t taken = 0;
+        while (taken < count)
+        {
+            if (m_begin == m_end && !refill())
+                break;
+
+            size_t chunk = (std::min)(count - taken, m_end - m_begin);
+            m_pidl.insert(
+                m_pidl.end(), m_buffer.begin() + m_begin,
+                m_buffer.begin() + m_begin + chunk);
+            m_begin += chunk;
+            taken += chunk;
+        }
+        return taken;
+    }
+
+    bool refill()
+    {
+        assert(m_begin == m_end);
+        m_begin = 0;
+        m_end = m_source.read(&m_buffer[0], m_buffer.size());
+        assert(m_end <= m_buffer.size());
+        return m_end != 0;
+    }
+
+    void throw_truncated()
+    {
+        BOOST_THROW_EXCEPTION(
+            std::runtime_error("PIDL stream ended part-way through a PIDL"));
+    }
+
+    Source& m_source;
+    std::vector<BYTE> m_buffer;
+    size_t m_begin; ///< First unread byte in the buffer
+    size_t m_end; ///< End of the bytes read into the buffer
+    std::vector<BYTE> m_pidl; ///< The PIDL being read, with terminator
+    size_t m_max_pidl_size;
+    size_t m_pidls_read;
+    Alloc m_allocator;
+};
+
+template<typename T, typename Source, typename Alloc>
+const size_t basic_pidl_reader<T, Source, Alloc>::default_buffer_size;
+
+template<typename T, typename Source, typename Alloc>
+const size_t basic_pidl_reader<T, Source, Alloc>::default_max_pidl_size;
+
+/**
+ * Writes PIDLs, one after another, to a stream of bytes.
+ *
+ * Each PIDL is written as its items followed by a null terminator, which
+ * basic_pidl_reader reads back.  Small writes are gathered into a buffer
+ * before being passed to the sink.
+ *
+ * The destructor flushes the buffer but can't report failure, so call
+ * flush() when done to find out whether everything was written.
+ *
+ * Sink is a byte sink, which the writer borrows, so it must outlive the
+ * writer.
+ */
+template<typename Sink>
+class pidl_writer : private boost::noncopyable
+{
+public:
+
+    static const size_t default_buffer_size = 4096;
+
+    explicit pidl_writer(
+        Sink& sink, size_t buffer_size=default_buffer_size)
+        : m_sink(sink), m_buffer_size(buffer_size), m_pidls_written(0)
+    {
+        m_buffer.reserve(buffer_size);
+    }
+
+    ~pidl_writer() throw()
+    {
+        try
+        {
+            flush();
+        }
+        catch (...) {}
+    }
+
+    /**
+     * Append a raw PIDL, wrapper or view to the stream.
+     *
+     * A NULL PIDL is written as an empty one.
+     */
+    template<typename P>
+    void write(const P& pidl)
+    {
+        detail::measured_items items = detail::measure_items(pidl);
+
+        append(items.data, items.bytes);
+
+        const USHORT terminator = 0;
+        append(&terminator, sizeof(terminator));
+
+        ++m_pidls_written;
+    }
+
+    /**
+     * Pass everything written so far to the sink.
+     */
+    void flush()
+    {
+        if (!m_buffer.empty())
+        {
+            m_sink.write(&m_buffer[0], m_buffer.size());
+            m_buffer.clear();
+        }
+    }
+
+    /**
+     * Number of PIDLs written so far.
+     */
+    size_t pidls_written() const
+    {
+        return m_pidls_written;
+    }
+
+private:
+
+    void append(const void* data, size_t size)
+    {
+        if (m_buffer.size() + size > m_buffer_size)
+        {
+            flush();
+
+            // Too big to be worth buffering
+            if (size >= m_buffer_size)
+            {
+                m_sink.write(data, size);
+                return;
+            }
+        }
+
+        const BYTE* bytes = static_cast<const BYTE*>(data);
+        m_buffer.insert(m_buffer.end(), bytes, bytes + size);
+    }
+
+    Sink& m_sink;
+    std::vector<BYTE> m_buffer;
+    size_t m_buffer_size;
+    size_t m_pidls_written;
+};
+
+template<typename Sink>
+const size_t pidl_writer<Sink>::default_buffer_size;
+
+}}} // namespace washer::shell::pidl
+
+#endif
@@ -0,0 +1,540 @@
+/**
+    @file
+
+    Prefix trie of absolute PIDLs.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#ifndef WASHER_SHELL_PIDL_TRIE_HPP
+#define WASHER_SHELL_PIDL_TRIE_HPP
+#pragma once
+
+#include <washer/shell/pidl.hpp> // basic_pidl, cpidl_t
+#include <washer/shell/pidl_compare.hpp> // pidl_hash, pidl_equal_to
+#include <washer/shell/pidl_iterator.hpp> // raw_pidl_iterator
+#include <washer/shell/pidl_view.hpp> // apidl_view, cpidl_view
+
+#include <boost/noncopyable.hpp> // noncopyable
+#include <boost/optional/optional.hpp> // optional
+#include <boost/unordered_map.hpp> // unordered_map
+
+#include <cassert> // assert
+#include <cstddef> // size_t
+#include <cstring> // memcpy
+#include <vector>
+
+#include <washer/shell/itemidlist.hpp> // Raw PIDL types
+
+namespace washer {
+namespace shell {
+namespace pidl {
+
+/**
+ * Map from absolute PIDLs to values, organised by their items.
+ *
+ * Each item of a key is one step down the tree from the desktop so the
+ * entries for everything inside a folder share the folder's node.  That
+ * makes the questions the shell namespace keeps asking cheap:
+ *
+ * - longest_prefix(): which entry is the nearest ancestor of (or is) a
+ *   given PIDL?  For example, which cached folder owns an item.
+ * - for_each_under(): what entries are there inside a folder?
+ * - erase_under(): forget everything inside a folder.
+ *
+ * Finding the node for a PIDL takes one hash lookup per item, walking the
+ * PIDL with a raw_pidl_iterator, regardless of how many entries the trie
+ * holds.  Visiting or erasing a subtree then costs time proportional to
+ * its size.  Each node counts the entries at or under it, kept up to date
+ * along the key's path on every insert and erase, so erase_under() knows
+ * how many entries it removed without counting them.
+ *
+ * The empty PIDL, the desktop, is the root and can have an entry like any
+ * other.
+ */
+template<typename Value>
+class pidl_trie : private boost::noncopyable
+{
+public:
+
+    typedef Value mapped_type;
+
+    pidl_trie() : m_root(NULL), m_size(0) {}
+
+    ~pidl_trie()
+    {
+        destroy(m_root);
+    }
+
+    /**
+     * Add an entry if the trie doesn't already have one for the PIDL.
+     *
+     * @returns  Whether an entry was added.
+     */
+    bool insert(PCUIDLIST_ABSOLUTE pidl, const Value& value)
+    {
+        node& target = make_node(pidl);
+        if (target.value)
+            return false;
+
+        target.value = value;
+        add_entries(&target, 1);
+        ++m_size;
+        return true;
+    }
+
+    template<typename Alloc>
+    bool insert(
+        const basic_pidl<ITEMIDLIST_ABSOLUTE, Alloc>& pidl,
+        const Value& value)
+    {
+        return insert(pidl.get(), value);
+    }
+
+    /**
+     * The value for the PIDL, default-constructing it if there is none.
+     */
+    Value& operator[](PCUIDLIST_ABSOLUTE pidl)
+    {
+        node& target = make_node(pidl);
+        if (!target.value)
+        {
+            target.value = Value();
+            add_entries(&target, 1);
+            ++m_size;
+        }
+
+        return *target.value;
+    }
+
+    template<typename Alloc>
+    Value& operator[](const basic_pidl<ITEMIDLIST_ABSOLUTE, Alloc>& pidl)
+    {
+        return (*this)[pidl.get()];
+    }
+
+    /**
+     * The value for exactly this PIDL or NULL if there isn't one.
+     */
+    Value* find(PCUIDLIST_ABSOLUTE pidl)
+    {
+        node* target = find_node(pidl);
+        return (target && target->value) ? &*target->value : NULL;
+    }
+
+    const Value* find(PCUIDLIST_ABSOLUTE pidl) const
+    {
+        return const_cast<pidl_trie*>(this)->find(pidl);
+    }
+
+    template<typename Alloc>
+    Value* find(const basic_pidl<ITEMIDLIST_ABSOLUTE, Alloc>& pidl)
+    {
+        return find(pidl.get());
+    }
+
+    template<typename Alloc>
+    const Value* find(
+        const basic_pidl<ITEMIDLIST_ABSOLUTE, Alloc>& pidl) const
+    {
+        return find(pidl.get());
+    }
+
+    /**
+     * The value of the entry whose key is the longest prefix of the PIDL.
+     *
+     * The PIDL itself counts as one of its prefixes.
+     *
+     * @param[out] matched_items  If not NULL, receives the number of items
+     *                            in the matching key.
+     * @returns  The matching entry's value or NULL if no entry's key is a
+     *           prefix of the PIDL.
+     */
+    Value* longest_prefix(
+        PCUIDLIST_ABSOLUTE pidl, std::size_t* matched_items=NULL)
+    {
+        node* match = NULL;
+        std::size_t match_depth = 0;
+
+        node* current = m_root;
+        std::size_t depth = 0;
+        for (raw_pidl_iterator it(pidl), end; current; ++it, ++depth)
+        {
+            if (current->value)
+            {
+                match = current;
+                match_depth = depth;
+            }
+
+            if (it == end)
+                break;
+
+            current = child(*current, *it);
+        }
+
+        if (matched_items)
+            *matched_items = match_depth;
+
+        return (match) ? &*match->value : NULL;
+    }
+
+    const Value* longest_prefix(
+        PCUIDLIST_ABSOLUTE pidl, std::size_t* matched_items=NULL) const
+    {
+        return const_cast<pidl_trie*>(this)->longest_prefix(
+            pidl, matched_items);
+    }
+
+    template<typename Alloc>
+    Value* longest_prefix(
+        const basic_pidl<ITEMIDLIST_ABSOLUTE, Alloc>& pidl,
+        std::size_t* matched_items=NULL)
+    {
+        return longest_prefix(pidl.get(), matched_items);
+    }
+
+    template<typename Alloc>
+    const Value* longest_prefix(
+        const basic_pidl<ITEMIDLIST_ABSOLUTE, Alloc>& pidl,
+        std::size_t* matched_items=NULL) const
+    {
+        return longest_prefix(pidl.get(), matched_items);
+    }
+
+    /**
+     * Call @a f with the key and value of every entry at or under the
+     * PIDL.
+     *
+     * The key is passed as an apidl_view that is only valid for the
+     * duration of the call and the value by reference.  Entries are visited
+     * parents first but otherwise in no particular order.  @a f must not
+     * modify the trie.
+     */
+    template<typename F>
+    void for_each_under(PCUIDLIST_ABSOLUTE prefix, F f)
+    {
+        node* top = find_node(prefix);
+        if (!top)
+            return;
+
+        std::vector<BYTE> path;
+        std::size_t depth = 0;
+        for (raw_pidl_iterator it(prefix), end; it != end; ++it, ++depth)
+        {
+            append_item(path, *it);
+        }
+
+        visit(*top, path, depth, f);
+    }
+
+    template<typename Alloc, typename F>
+    void for_each_under(
+        const basic_pidl<ITEMIDLIST_ABSOLUTE, Alloc>& prefix, F f)
+    {
+        for_each_under(prefix.get(), f);
+    }
+
+    /**
+     * Remove the entry for exactly this PIDL, if any.
+     *
+     * Entries under it are not affected.
+     *
+     * @returns  The number of entries removed.
+     */
+    std::size_t erase(PCUIDLIST_ABSOLUTE pidl)
+    {
+        node* target = find_node(pidl);
+        if (!target || !target->value)
+            return 0;
+
+        target->value = boost::none;
+        remove_entries(target, 1);
+        --m_size;
+        prune(target);
+        return 1;
+    }
+
+    template<typename Alloc>
+    std::size_t erase(const basic_pidl<ITEMIDLIST_ABSOLUTE, Alloc>& pidl)
+    {
+        return erase(pidl.get());
+    }
+
+    /**
+     * Remove the entry for the PIDL and every entry under it.
+     *
+     * @returns  The number of entries removed.
+     */
+    std::size_t erase_under(PCUIDLIST_ABSOLUTE prefix)
+    {
+        node* top = find_node(prefix);
+        if (!top)
+            return 0;
+
+        std::size_t removed = top->entries;
+
+        if (top == m_root)
+        {
+            destroy(m_root);
+            m_root = NULL;
+        }
+        else
+        {
+            node* parent = top->parent;
+            remove_entries(parent, removed);
+            detach(top);
+            prune(parent);
+        }
+
+        m_size -= removed;
+        return removed;
+    }
+
+    template<typename Alloc>
+    std::size_t erase_under(
+        const basic_pidl<ITEMIDLIST_ABSOLUTE, Alloc>& prefix)
+    {
+        return erase_under(prefix.get());
+    }
+
+    /**
+     * Number of entries.
+     */
+    std::size_t size() const
+    {
+        return m_size;
+    }
+
+    bool empty() const
+    {
+        return m_size == 0;
+    }
+
+    void clear()
+    {
+        destroy(m_root);
+        m_root = NULL;
+        m_size = 0;
+    }
+
+private:
+
+    struct node;
+
+    typedef boost::unordered_map<cpidl_t, node*, pidl_hash, pidl_equal_to>
+        child_map;
+
+    struct node : private boost::noncopyable
+    {
+        node(node* parent, const cpidl_t* key)
+            : parent(parent), key(key), entries(0) {}
+
+        node* parent;
+        const cpidl_t* key; ///< This node's item, owned by parent's map
+        std::size_t entries; ///< Entries at or under this node
+        boost::optional<Value> value;
+        child_map children;
+    };
+
+    static cpidl_view item_view(PCUIDLIST_RELATIVE item)
+    {
+        return cpidl_view(
+            reinterpret_cast<PCUITEMID_CHILD>(item), item->mkid.cb, 1);
+    }
+
+    static node* child(const node& parent, PCUIDLIST_RELATIVE item)
+    {
+        typename child_map::const_iterator it = parent.children.find(
+            item_view(item), pidl_hash(), pidl_equal_to());
+        return (it == parent.children.end()) ? NULL : it->second;
+    }
+
+    node* find_node(PCUIDLIST_ABSOLUTE pidl) const
+    {
+        node* current = m_root;
+        for (raw_pidl_iterator it(pidl), end; current && it != end; ++it)
+        {
+            current = child(*current, *it);
+        }
+
+        return current;
+    }
+
+    node& make_node(PCUIDLIST_ABSOLUTE pidl)
+    {
+        if (!m_root)
+            m_root = new node(NULL, NULL);
+
+        node* current = m_root;
+        for (raw_pidl_iterator it(pidl), end; it != end; ++it)
+        {
+            node* next = child(*current, *it);
+            if (!next)
+            {
+                std::pair<typename child_map::iterator, bool> added =
+                    current->children.insert(
+                        typename child_map::value_type(
+                            cpidl_t(item_view(*it)), NULL));
+                assert(added.second);
+
+                try
+                {
+                    next = new node(current, &added.first->first);
+                }
+                catch (...)
+                {
+                    current->children.erase(added.first);
+                    prune(current);
+                    throw;
+                }
+
+                added.first->second = next;
+            }
+
+            current = next;
+        }
+
+        return *current;
+    }
+
+    /**
+     * Remove nodes that no longer lead to any entry, working up from the
+     * given node.
+     */
+    void prune(node* n)
+    {
+        while (n && !n->value && n->children.empty())
+        {
+            node* parent = n->parent;
+            if (parent)
+            {
+                detach(n);
+            }
+            else
+            {
+                assert(n == m_root);
+                destroy(m_root);
+                m_root = NULL;
+            }
+
+            n = parent;
+        }
+    }
+
+    /**
+     * Remove a non-root node, and everything under it, from its parent.
+     */
+    static void detach(node* n)
+    {
+        assert(n->parent);
+
+        typename child_map::iterator it = n->parent->children.find(*n->key);
+        assert(it != n->parent->children.end() && it->second == n);
+
+        n->parent->children.erase(it);
+        destroy(n);
+    }
+
+    static void destroy(node* n)
+    {
+        if (!n)
+            return;
+
+        for (typename child_map::iterator it = n->children.begin();
+             it != n->children.end(); ++it)
+        {
+            destroy(it->second);
+        }
+
+        delete n;
+    }
+
+    /**
+     * Update the entry counts of a node and its ancestors.
+     */
+    static void add_entries(node* n, std::size_t entries)
+    {
+        for (; n; n = n->parent)
+        {
+            n->entries += entries;
+        }
+    }
+
+    static void remove_entries(node* n, std::size_t entries)
+    {
+        for (; n; n = n->parent)
+        {
+            assert(n->entries >= entries);
+            n->entries -= entries;
+        }
+    }
+
+    /**
+     * Add an item to the end of a path of items.
+     */
+    static void append_item(std::vector<BYTE>& path, PCUIDLIST_RELATIVE item)
+    {
+        std::size_t offset = path.size();
+        path.resize(offset + item->mkid.cb);
+        std::memcpy(&path[offset], item, item->mkid.cb);
+    }
+
+    template<typename F>
+    static void visit(
+        node& n, std::vector<BYTE>& path, std::size_t depth, F& f)
+    {
+        if (n.value)
+        {
+            // Terminate the path temporarily so that the view handed out
+            // can be used as a raw PIDL
+            std::size_t items_size = path.size();
+            path.resize(items_size + sizeof(USHORT), 0);
+
+            f(apidl_view(
+                reinterpret_cast<PCUIDLIST_ABSOLUTE>(&path[0]), items_size,
+                depth),
+              *n.value);
+
+            path.resize(items_size);
+        }
+
+        for (typename child_map::iterator it = n.children.begin();
+             it != n.children.end(); ++it)
+        {
+            std::size_t items_size = path.size();
+            append_item(path, it->first.get());
+            visit(*it->second, path, depth + 1, f);
+            path.resize(items_size);
+        }
+    }
+
+    node* m_root;
+    std::size_t m_size;
+};
+
+}}} // namespace washer::shell::pidl
+
+#endif
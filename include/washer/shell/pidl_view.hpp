@@ -0,0 +1,534 @@
+/**
+    @file
+
+    Non-owning views of PIDLs.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#ifndef WASHER_SHELL_PIDL_VIEW_HPP
+#define WASHER_SHELL_PIDL_VIEW_HPP
+#pragma once
+
+#include <washer/shell/pidl.hpp> // basic_pidl, raw_pidl
+
+#include <boost/static_assert.hpp> // BOOST_STATIC_ASSERT
+#include <boost/throw_exception.hpp> // BOOST_THROW_EXCEPTION
+#include <boost/type_traits/is_convertible.hpp> // is_convertible
+
+#include <algorithm> // min
+#include <cassert> // assert
+#include <cstring> // memcmp
+#include <stdexcept> // logic_error, out_of_range
+
+#include <washer/shell/itemidlist.hpp> // Raw PIDL types
+
+namespace washer {
+namespace shell {
+namespace pidl {
+
+/**
+ * Borrowed view of a run of items in an existing ITEMIDLIST.
+ *
+ * A view is just a pointer to the first item, the number of bytes the items
+ * take up and how many items there are.  Taking the parent, last item,
+ * prefix or suffix of a view produces another view of the same memory so
+ * navigating a PIDL this way never allocates.  Only constructing a
+ * basic_pidl from a view copies the items.
+ *
+ * The view is only valid while the ITEMIDLIST it was created from is alive
+ * and unchanged.
+ *
+ * Views that reach the end of the original list (views of a whole PIDL and
+ * those returned by last() and suffix()) are followed in memory by its
+ * null-terminator so data() can be passed to anything expecting a raw PIDL.
+ * Views returned by parent() and prefix() generally are @b not terminated
+ * and must be copied into a basic_pidl before being used as a raw PIDL.
+ *
+ * Like the wrappers, a view takes the type of raw PIDL (ITEMID_CHILD,
+ * ITEMIDLIST_RELATIVE or ITEMIDLIST_ABSOLUTE) as a template parameter, T.
+ */
+template<typename T>
+class basic_pidl_view
+{
+public:
+
+    typedef T value_type;
+    typedef const T __unaligned* const_pointer;
+
+    /**
+     * NULL view.
+     */
+    basic_pidl_view() : m_pidl(NULL), m_bytes(0), m_item_count(0) {}
+
+    /**
+     * View a whole raw PIDL.
+     *
+     * Walks the PIDL once to find its size.
+     */
+    basic_pidl_view(const T __unaligned* pidl) :
+        m_pidl(pidl), m_bytes(0), m_item_count(0)
+    {
+        raw_pidl::traits<T>::type_check(pidl);
+
+        if (pidl)
+        {
+            raw_pidl::extent e = raw_pidl::measure(pidl);
+            m_bytes = e.size - sizeof(pidl->mkid.cb);
+            m_item_count = e.item_count;
+        }
+    }
+
+    /**
+     * View the PIDL held by a wrapper.
+     *
+     * Uses the wrapper's knowledge of its size so the PIDL isn't walked
+     * unless the wrapper hasn't measured it yet.
+     *
+     * Will fail to compile unless it is legal to upcast the wrapper's raw
+     * PIDL type to this view's type.
+     */
+    template<typename U, typename Alloc>
+    basic_pidl_view(const basic_pidl<U, Alloc>& pidl) :
+        m_pidl(pidl.get()), m_bytes(0), m_item_count(pidl.item_count())
+    {
+        if (m_pidl)
+            m_bytes = pidl.size() - sizeof(m_pidl->mkid.cb);
+    }
+
+    /**
+     * View a run of items whose extent is already known.
+     *
+     * @param pidl        First item of the run.
+     * @param bytes       Number of bytes the items take up, not counting any
+     *                    null-terminator.
+     * @param item_count  Number of items in the run.
+     */
+    basic_pidl_view(const T __unaligned* pidl, size_t bytes, size_t item_count)
+        : m_pidl(pidl), m_bytes(bytes), m_item_count(item_count)
+    {
+        assert(pidl || (bytes == 0 && item_count == 0));
+    }
+
+    /**
+     * Upcast to a view of a more general PIDL type.
+     *
+     * Will fail to compile unless it is legal to upcast the underlying raw
+     * PIDL type to the target type.
+     */
+    template<typename U>
+    operator basic_pidl_view<U>() const
+    {
+        return basic_pidl_view<U>(m_pidl, m_bytes, m_item_count);
+    }
+
+    /**
+     * Result of comparing with NULL.
+     */
+    bool operator!() const
+    {
+        return !m_pidl;
+    }
+
+    /**
+     * Address of the first item.
+     *
+     * @warning  Unless the view reaches the end of the original list, the
+     *           items are @b not null-terminated.
+     */
+    const_pointer data() const
+    {
+        return m_pidl;
+    }
+
+    /**
+     * Size in bytes of the PIDL this view would become if copied, including
+     * a null-terminator.
+     *
+     * Zero if the view is NULL.  This matches basic_pidl::size().
+     */
+    size_t size() const
+    {
+        return (m_pidl) ? m_bytes + sizeof(m_pidl->mkid.cb) : 0;
+    }
+
+    /**
+     * Number of bytes taken up by the items, not counting any terminator.
+     */
+    size_t item_bytes() const
+    {
+        return m_bytes;
+    }
+
+    /**
+     * The number of items in the view.
+     */
+    size_t item_count() const
+    {
+        return m_item_count;
+    }
+
+    /**
+     * Is the view empty?
+     *
+     * Empty views are either NULL or contain no items.
+     */
+    bool empty() const
+    {
+        return m_item_count == 0;
+    }
+
+    /**
+     * View of all but the last item.
+     */
+    basic_pidl_view parent() const
+    {
+        if (empty())
+            BOOST_THROW_EXCEPTION(
+                std::logic_error("Empty PIDL cannot have a parent"));
+
+        return prefix(m_item_count - 1);
+    }
+
+    /**
+     * View of just the last item.
+     */
+    basic_pidl_view<ITEMID_CHILD> last() const
+    {
+        if (empty())
+            BOOST_THROW_EXCEPTION(
+                std::logic_error("Empty PIDL cannot have a last item"));
+
+        size_t offset = offset_of(m_item_count - 1);
+        const ITEMID_CHILD __unaligned* item =
+            reinterpret_cast<const ITEMID_CHILD __unaligned*>(
+                raw_pidl::skip(m_pidl, offset));
+
+        return basic_pidl_view<ITEMID_CHILD>(item, m_bytes - offset, 1);
+    }
+
+    /**
+     * Views of the parent and last item together.
+     *
+     * Walks the items once to find the last one, where calling parent()
+     * and last() separately walks them twice.
+     */
+    basic_split_view<T> split() const
+    {
+        if (empty())
+            BOOST_THROW_EXCEPTION(
+                std::logic_error("Empty PIDL cannot be split"));
+
+        size_t offset = offset_of(m_item_count - 1);
+
+        basic_split_view<T> result;
+        result.parent = basic_pidl_view(m_pidl, offset, m_item_count - 1);
+        result.child = basic_pidl_view<ITEMID_CHILD>(
+            reinterpret_cast<const ITEMID_CHILD __unaligned*>(
+                raw_pidl::skip(m_pidl, offset)),
+            m_bytes - offset, 1);
+        return result;
+    }
+
+    /**
+     * View of the first @a count items.
+     */
+    basic_pidl_view prefix(size_t count) const
+    {
+        if (count > m_item_count)
+            BOOST_THROW_EXCEPTION(
+                std::out_of_range("Prefix longer than PIDL"));
+
+        return basic_pidl_view(m_pidl, offset_of(count), count);
+    }
+
+    /**
+     * View of the last @a count items.
+     *
+     * Whatever the type of this view, the items after the first one are
+     * relative to it, so the suffix is relative.
+     */
+    basic_pidl_view<ITEMIDLIST_RELATIVE> suffix(size_t count) const
+    {
+        if (count > m_item_count)
+            BOOST_THROW_EXCEPTION(
+                std::out_of_range("Suffix longer than PIDL"));
+
+        size_t offset = offset_of(m_item_count - count);
+        return basic_pidl_view<ITEMIDLIST_RELATIVE>(
+            reinterpret_cast<const ITEMIDLIST_RELATIVE __unaligned*>(
+                raw_pidl::skip(m_pidl, offset)),
+            m_bytes - offset, count);
+    }
+
+private:
+
+    /**
+     * Byte offset of the item at @a index.  Walks the items before it.
+     *
+     * An index equal to the item count gives the offset just past the last
+     * item.
+     */
+    size_t offset_of(size_t index) const
+    {
+        assert(index <= m_item_count);
+
+        if (index == m_item_count)
+            return m_bytes;
+
+        size_t offset = 0;
+        const T __unaligned* item = m_pidl;
+        for (size_t i = 0; i < index; ++i)
+        {
+            offset += item->mkid.cb;
+            item = raw_pidl::next(item);
+        }
+
+        return offset;
+    }
+
+    const T __unaligned* m_pidl;
+    size_t m_bytes;
+    size_t m_item_count;
+};
+
+/**
+ * A PIDL split into a view of its parent and a view of its last item.
+ *
+ * The child view is null-terminated but the parent view generally is not,
+ * as with basic_pidl_view::parent() and basic_pidl_view::last().
+ */
+template<typename T>
+struct basic_split_view
+{
+    basic_pidl_view<T> parent;
+    basic_pidl_view<ITEMID_CHILD> child;
+};
+
+namespace detail {
+
+    /**
+     * The items of a PIDL, however it is held, and how many there are.
+     *
+     * Comparison, hashing and the PIDL containers all work from this, so
+     * a new way of holding a PIDL only needs a measure_items overload to
+     * work with them.
+     */
+    struct measured_items
+    {
+        measured_items(const void* data, size_t bytes, size_t item_count)
+            : data(data), bytes(bytes), item_count(item_count) {}
+
+        const void* data;
+        size_t bytes; ///< Not counting the terminator
+        size_t item_count;
+    };
+
+    template<typename T>
+    inline measured_items measure_items(const T __unaligned* pidl)
+    {
+        if (!pidl)
+            return measured_items(NULL, 0, 0);
+
+        raw_pidl::extent e = raw_pidl::measure(pidl);
+        return measured_items(pidl, e.size - sizeof(USHORT), e.item_count);
+    }
+
+    template<typename T, typename Alloc>
+    inline measured_items measure_items(const basic_pidl<T, Alloc>& pidl)
+    {
+        if (!pidl)
+            return measured_items(NULL, 0, 0);
+
+        return measured_items(
+            pidl.get(), pidl.size() - sizeof(USHORT), pidl.item_count());
+    }
+
+    template<typename T>
+    inline measured_items measure_items(const basic_pidl_view<T>& view)
+    {
+        return measured_items(
+            view.data(), view.item_bytes(), view.item_count());
+    }
+
+    inline bool equal_bytes(
+        const measured_items& lhs, const measured_items& rhs)
+    {
+        return lhs.bytes == rhs.bytes &&
+            (lhs.bytes == 0 ||
+             std::memcmp(lhs.data, rhs.data, lhs.bytes) == 0);
+    }
+
+    inline int compare_bytes(
+        const measured_items& lhs, const measured_items& rhs)
+    {
+        size_t common = (std::min)(lhs.bytes, rhs.bytes);
+        if (common)
+        {
+            int result = std::memcmp(lhs.data, rhs.data, common);
+            if (result != 0)
+                return result;
+        }
+
+        if (lhs.bytes < rhs.bytes)
+            return -1;
+        else if (rhs.bytes < lhs.bytes)
+            return 1;
+        else
+            return 0;
+    }
+}
+
+/**
+ * @name  Comparison
+ *
+ * Views are compared by the bytes of their items.  NULL views and views of
+ * empty PIDLs compare equal.
+ *
+ * The ordering is lexicographical by byte, so a view sorts immediately
+ * before any view that extends it with more items.
+ */
+// @{
+
+/**
+ * Three-way comparison of two views.
+ *
+ * @returns  Negative, zero or positive as @a lhs orders before, the same as
+ *           or after @a rhs.
+ */
+template<typename T, typename U>
+inline int compare(
+    const basic_pidl_view<T>& lhs, const basic_pidl_view<U>& rhs)
+{
+    return detail::compare_bytes(
+        detail::measure_items(lhs), detail::measure_items(rhs));
+}
+
+template<typename T, typename U>
+inline bool operator==(
+    const basic_pidl_view<T>& lhs, const basic_pidl_view<U>& rhs)
+{
+    return lhs.item_bytes() == rhs.item_bytes() &&
+        lhs.item_count() == rhs.item_count() && compare(lhs, rhs) == 0;
+}
+
+template<typename T, typename U>
+inline bool operator!=(
+    const basic_pidl_view<T>& lhs, const basic_pidl_view<U>& rhs)
+{
+    return !(lhs == rhs);
+}
+
+template<typename T, typename U>
+inline bool operator<(
+    const basic_pidl_view<T>& lhs, const basic_pidl_view<U>& rhs)
+{
+    return compare(lhs, rhs) < 0;
+}
+
+// @}
+
+/**
+ * View a wrapped PIDL.
+ */
+template<typename T, typename Alloc>
+inline basic_pidl_view<T> view(const basic_pidl<T, Alloc>& pidl)
+{
+    return basic_pidl_view<T>(pidl);
+}
+
+/**
+ * View a raw PIDL.
+ */
+template<typename T>
+inline basic_pidl_view<T> view(const T __unaligned* pidl)
+{
+    return basic_pidl_view<T>(pidl);
+}
+
+namespace detail {
+
+    /**
+     * Raw PIDL type held by a raw PIDL, wrapper or view.
+     */
+    template<typename P>
+    struct pidl_type_of;
+
+    template<typename T>
+    struct pidl_type_of<const T __unaligned*>
+    {
+        typedef T type;
+    };
+
+    template<typename T>
+    struct pidl_type_of<T __unaligned*>
+    {
+        typedef T type;
+    };
+
+    template<typename T, typename Alloc>
+    struct pidl_type_of< basic_pidl<T, Alloc> >
+    {
+        typedef T type;
+    };
+
+    template<typename T>
+    struct pidl_type_of< basic_pidl_view<T> >
+    {
+        typedef T type;
+    };
+
+    /**
+     * View of any PIDL, checking at compile time that it can be held in a
+     * container of T.
+     */
+    template<typename T, typename P>
+    inline basic_pidl_view<T> view_as(const P& pidl)
+    {
+        typedef typename pidl_type_of<P>::type element_type;
+
+        BOOST_STATIC_ASSERT((
+            boost::is_convertible<const element_type*, const T*>::value));
+
+        measured_items items = measure_items(pidl);
+        return basic_pidl_view<T>(
+            static_cast<const T __unaligned*>(items.data), items.bytes,
+            items.item_count);
+    }
+}
+
+/**
+ * @name  Standard view types.
+ */
+// @{
+typedef basic_pidl_view<ITEMIDLIST_RELATIVE> pidl_view;
+typedef basic_pidl_view<ITEMIDLIST_ABSOLUTE> apidl_view;
+typedef basic_pidl_view<ITEMID_CHILD> cpidl_view;
+// @}
+
+}}} // namespace washer::shell::pidl
+
+#endif
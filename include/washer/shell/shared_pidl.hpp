@@ -0,0 +1,453 @@
+/**
+    @file
+
+    Immutable, reference-counted PIDL shared between threads.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#ifndef WASHER_SHELL_SHARED_PIDL_HPP
+#define WASHER_SHELL_SHARED_PIDL_HPP
+#pragma once
+
+#include <washer/shell/pidl.hpp> // basic_pidl, raw_pidl, default_alloc
+#include <washer/shell/pidl_view.hpp> // basic_pidl_view, measure_items
+
+#include <boost/move/move.hpp> // BOOST_RV_REF, BOOST_COPYABLE_AND_MOVABLE
+#include <boost/detail/atomic_count.hpp> // atomic_count
+#include <boost/static_assert.hpp> // BOOST_STATIC_ASSERT
+#include <boost/type_traits/is_convertible.hpp> // is_convertible
+#include <boost/type_traits/is_same.hpp> // is_same
+
+#include <algorithm> // swap
+#include <cassert> // assert
+#include <cstddef> // size_t
+#include <cstring> // memcpy
+#include <new> // placement new
+
+#include <washer/shell/itemidlist.hpp> // Raw PIDL types
+
+namespace washer {
+namespace shell {
+namespace pidl {
+
+template<typename T, typename Alloc> class basic_shared_pidl;
+
+namespace detail {
+
+    template<typename T, typename Alloc>
+    measured_items measure_items(const basic_shared_pidl<T, Alloc>& pidl);
+
+    /**
+     * Start of the block holding a shared PIDL.  The PIDL follows it.
+     */
+    struct shared_pidl_header
+    {
+        shared_pidl_header(size_t item_bytes, size_t item_count)
+            : references(1), item_bytes(item_bytes), item_count(item_count) {}
+
+        boost::detail::atomic_count references;
+        size_t item_bytes; ///< Not counting the null-terminator
+        size_t item_count;
+    };
+}
+
+/**
+ * Immutable PIDL whose copies share one reference-counted allocation.
+ *
+ * Copying a basic_pidl clones the PIDL.  Copying a shared PIDL only
+ * increments an atomic reference count, so passing the same PIDL between
+ * threads and caches doesn't allocate.  The count, the PIDL's size and
+ * item count and the PIDL itself are held in a single block.
+ *
+ * Different shared PIDLs may be copied, read and destroyed on different
+ * threads at the same time even when they share a block.  A single shared
+ * PIDL object is not safe to change from one thread while another uses it,
+ * like any other value.
+ *
+ * The PIDL can't be changed through a shared PIDL that shares its block.
+ * mutable_get() and append() copy the PIDL into a block of its own first,
+ * if it isn't already unique, so other copies never see the change.
+ *
+ * Converting from a basic_pidl or a view copies the PIDL once without
+ * walking it again; to_pidl() copies it back into a basic_pidl the same
+ * way.
+ */
+template<typename T, typename Alloc = typename default_alloc<T>::type>
+class basic_shared_pidl
+{
+public:
+
+    typedef T value_type;
+    typedef const T* const_pointer;
+    typedef Alloc allocator;
+
+    basic_shared_pidl() : m_block(NULL), m_allocator(Alloc()) {}
+
+    /**
+     * NULL PIDL that will allocate using the given allocator.
+     */
+    explicit basic_shared_pidl(Alloc alloc)
+        : m_block(NULL), m_allocator(alloc) {}
+
+    /**
+     * Copy a raw PIDL into a new shared block.
+     */
+    explicit basic_shared_pidl(
+        const __unaligned T* pidl, Alloc alloc=Alloc())
+        : m_block(NULL), m_allocator(alloc)
+    {
+        raw_pidl::traits<T>::type_check(pidl);
+        if (pidl)
+            m_block = make_block(detail::measure_items(pidl));
+    }
+
+    /**
+     * Copy a wrapped PIDL into a new shared block.
+     *
+     * Uses the wrapper's knowledge of its size rather than walking the
+     * PIDL.  Will fail to compile unless it is legal to upcast the
+     * wrapper's raw PIDL type to this PIDL's type.
+     *
+     * If the wrapper uses the same kind of allocator, the block is
+     * allocated by a copy of the wrapper's allocator.
+     */
+    template<typename U, typename AllocU>
+    basic_shared_pidl(const basic_pidl<U, AllocU>& pidl)
+        :
+    m_block(NULL),
+    m_allocator(
+        detail::rebind_allocator<Alloc>(
+            pidl.get_allocator(),
+            boost::is_same<
+                Alloc, typename AllocU::template rebind<T>::other>()))
+    {
+        BOOST_STATIC_ASSERT((boost::is_convertible<U*, T*>::value));
+        if (!!pidl)
+            m_block = make_block(detail::measure_items(pidl));
+    }
+
+    /**
+     * Copy the items seen by a view into a new shared block.
+     *
+     * The copy is null-terminated even when the view is not.
+     */
+    template<typename U>
+    explicit basic_shared_pidl(
+        const basic_pidl_view<U>& view, Alloc alloc=Alloc())
+        : m_block(NULL), m_allocator(alloc)
+    {
+        BOOST_STATIC_ASSERT((boost::is_convertible<U*, T*>::value));
+        if (view.data())
+            m_block = make_block(detail::measure_items(view));
+    }
+
+    /**
+     * Share the other PIDL's block.
+     */
+    basic_shared_pidl(const basic_shared_pidl& pidl)
+        : m_block(pidl.m_block), m_allocator(pidl.m_allocator)
+    {
+        if (m_block)
+            ++m_block->references;
+    }
+
+    /**
+     * Take over the other PIDL's reference, leaving it NULL.
+     */
+    basic_shared_pidl(BOOST_RV_REF(basic_shared_pidl) pidl)
+        : m_block(pidl.m_block), m_allocator(pidl.m_allocator)
+    {
+        pidl.m_block = NULL;
+    }
+
+    ~basic_shared_pidl() throw()
+    {
+        release();
+    }
+
+    basic_shared_pidl& operator=(BOOST_COPY_ASSIGN_REF(basic_shared_pidl) pidl)
+    {
+        basic_shared_pidl copy(pidl);
+        swap(copy);
+        return *this;
+    }
+
+    basic_shared_pidl& operator=(BOOST_RV_REF(basic_shared_pidl) pidl)
+    {
+        if (this != &pidl)
+        {
+            basic_shared_pidl moved(boost::move(pidl));
+            swap(moved);
+        }
+        return *this;
+    }
+
+    /**
+     * Result of comparing with NULL.
+     */
+    bool operator!() const
+    {
+        return !m_block;
+    }
+
+    /**
+     * The shared PIDL.
+     *
+     * Valid as long as this or any other shared PIDL refers to the block.
+     */
+    const T* get() const
+    {
+        return (m_block) ? pidl_of(m_block) : NULL;
+    }
+
+    /**
+     * View of the PIDL with its size and item count already known.
+     */
+    basic_pidl_view<T> view() const
+    {
+        if (!m_block)
+            return basic_pidl_view<T>();
+
+        return basic_pidl_view<T>(
+            pidl_of(m_block), m_block->item_bytes, m_block->item_count);
+    }
+
+    /**
+     * Copy the PIDL into a wrapper of its own.
+     *
+     * The size is already known, so this is a single allocation and copy.
+     */
+    basic_pidl<T, Alloc> to_pidl() const
+    {
+        Alloc alloc(m_allocator);
+        if (!m_block)
+            return basic_pidl<T, Alloc>(alloc);
+
+        return basic_pidl<T, Alloc>(view(), alloc);
+    }
+
+    /**
+     * Writable pointer to the PIDL, copying it first if the block is
+     * shared so the change is only seen through this object.
+     *
+     * The pointer is invalidated by anything that copies or changes this
+     * shared PIDL.  Items may be changed in place but the PIDL's layout,
+     * the @c cb of each item, must stay the same.
+     */
+    T* mutable_get()
+    {
+        if (!m_block)
+            return NULL;
+
+        if (!unique())
+        {
+            basic_shared_pidl copy(view(), get_allocator());
+            swap(copy);
+        }
+
+        return pidl_of(m_block);
+    }
+
+    /**
+     * Append a PIDL, leaving any other copies unchanged.
+     *
+     * The PIDL may be a raw PIDL, wrapper or view.  Appending always
+     * produces a new block as the PIDL changes size.  Only legal when
+     * joining doesn't change the type of this PIDL, i.e. for relative and
+     * absolute PIDLs.
+     */
+    template<typename P>
+    basic_shared_pidl& append(const P& pidl)
+    {
+        typedef typename detail::pidl_type_of<P>::type U;
+        BOOST_STATIC_ASSERT((boost::is_same<
+            typename raw_pidl::traits<T>::combine_type, T>::value));
+        BOOST_STATIC_ASSERT(raw_pidl::traits<U>::is_appendable);
+
+        detail::measured_items head = detail::measure_items(view());
+        detail::measured_items tail = detail::measure_items(pidl);
+        if (!tail.data)
+            return *this;
+
+        basic_shared_pidl joined(m_allocator);
+        joined.m_block = joined.make_block(head, tail);
+        swap(joined);
+        return *this;
+    }
+
+    /**
+     * The size of the PIDL in bytes, including the null-terminator.
+     *
+     * Zero for a NULL PIDL.
+     */
+    size_t size() const
+    {
+        return (m_block) ? m_block->item_bytes + sizeof(USHORT) : 0;
+    }
+
+    /**
+     * The number of items in the PIDL.
+     */
+    size_t item_count() const
+    {
+        return (m_block) ? m_block->item_count : 0;
+    }
+
+    /**
+     * Is the PIDL empty?
+     *
+     * Empty PIDLs are either NULL or only a null-terminator.
+     */
+    bool empty() const
+    {
+        return item_count() == 0;
+    }
+
+    /**
+     * Number of shared PIDLs referring to this one's block.
+     *
+     * Zero for a NULL PIDL.  Only a hint if other threads hold copies.
+     */
+    long use_count() const
+    {
+        return (m_block) ? static_cast<long>(m_block->references) : 0;
+    }
+
+    /**
+     * Is this the only shared PIDL referring to its block?
+     */
+    bool unique() const
+    {
+        return use_count() == 1;
+    }
+
+    /**
+     * Drop this object's reference, leaving it NULL.
+     */
+    void reset()
+    {
+        release();
+        m_block = NULL;
+    }
+
+    Alloc get_allocator() const
+    {
+        return Alloc(m_allocator);
+    }
+
+    /**
+     * No-fail swap.
+     */
+    void swap(basic_shared_pidl& pidl) throw()
+    {
+        std::swap(m_block, pidl.m_block);
+        std::swap(m_allocator, pidl.m_allocator);
+    }
+
+private:
+    BOOST_COPYABLE_AND_MOVABLE(basic_shared_pidl)
+
+    typedef typename Alloc::template rebind<BYTE>::other byte_allocator;
+    typedef detail::shared_pidl_header header;
+
+    static T* pidl_of(header* block)
+    {
+        return reinterpret_cast<T*>(block + 1);
+    }
+
+    /**
+     * Allocate a block holding @a head followed by @a tail and a
+     * null-terminator.
+     */
+    header* make_block(
+        const detail::measured_items& head,
+        const detail::measured_items& tail=detail::measured_items(NULL, 0, 0))
+    {
+        size_t item_bytes = head.bytes + tail.bytes;
+        BYTE* memory = m_allocator.allocate(
+            sizeof(header) + item_bytes + sizeof(USHORT));
+
+        header* block = new (memory) header(
+            item_bytes, head.item_count + tail.item_count);
+
+        BYTE* items = reinterpret_cast<BYTE*>(pidl_of(block));
+        if (head.bytes)
+            std::memcpy(items, head.data, head.bytes);
+        if (tail.bytes)
+            std::memcpy(items + head.bytes, tail.data, tail.bytes);
+
+        USHORT terminator = 0;
+        std::memcpy(items + item_bytes, &terminator, sizeof(terminator));
+
+        return block;
+    }
+
+    void release() throw()
+    {
+        if (m_block && --m_block->references == 0)
+        {
+            m_block->~header();
+            m_allocator.deallocate(reinterpret_cast<BYTE*>(m_block));
+        }
+    }
+
+    header* m_block;
+    byte_allocator m_allocator;
+};
+
+namespace detail {
+
+    template<typename T, typename Alloc>
+    inline measured_items measure_items(
+        const basic_shared_pidl<T, Alloc>& pidl)
+    {
+        basic_pidl_view<T> view = pidl.view();
+        return measured_items(
+            view.data(), view.item_bytes(), view.item_count());
+    }
+
+    template<typename T, typename Alloc>
+    struct pidl_type_of< basic_shared_pidl<T, Alloc> >
+    {
+        typedef T type;
+    };
+}
+
+/**
+ * @name Shared PIDL types
+ *
+ * These all use the default_alloc allocation method.
+ */
+// @{
+typedef basic_shared_pidl<ITEMIDLIST_RELATIVE> shared_pidl;
+typedef basic_shared_pidl<ITEMIDLIST_ABSOLUTE> shared_apidl;
+typedef basic_shared_pidl<ITEMID_CHILD> shared_cpidl;
+// @}
+
+}}} // namespace washer::shell::pidl
+
+#endif
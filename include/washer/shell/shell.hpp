@@ -34,7 +34,8 @@
 #pragma once
 
 #include <washer/detail/path_traits.hpp> // choose_path
-#include <washer/shell/pidl.hpp> // cpidl_t, apidl_t
+#include <washer/shell/pidl.hpp> // apidl_t
+#include <washer/shell/pidl_view.hpp> // cpidl_view, basic_split_view
 #include <washer/shell/shell_item.hpp> // pidl_shell_item
 
 #include <comet/ptr.h> // com_ptr
@@ -68,11 +69,11 @@ namespace detail {
 
 
         inline HRESULT str_ret_to_str(
-            STRRET* strret, const ITEMID_CHILD* pidl, char** string_out)
+            STRRET* strret, PCUITEMID_CHILD pidl, char** string_out)
         { return ::StrRetToStrA(strret, pidl, string_out); }
 
         inline HRESULT str_ret_to_str(
-            STRRET* strret, const ITEMID_CHILD* pidl, wchar_t** string_out)
+            STRRET* strret, PCUITEMID_CHILD pidl, wchar_t** string_out)
         { return ::StrRetToStrW(strret, pidl, string_out); }
 
 
@@ -182,10 +183,10 @@ inline comet::com_ptr<IShellFolder> desktop_folder()
  */
 template<typename T>
 inline std::basic_string<T> strret_to_string(
-    STRRET& strret, const pidl::cpidl_t& pidl=pidl::cpidl_t())
+    STRRET& strret, PCUITEMID_CHILD pidl=NULL)
 {
     T* str = NULL;
-    HRESULT hr = detail::native::str_ret_to_str(&strret, pidl.get(), &str);
+    HRESULT hr = detail::native::str_ret_to_str(&strret, pidl, &str);
 
     // RAII for CoTaskMemAlloced string
     boost::shared_ptr<T> str_lifetime(str, ::CoTaskMemFree);
@@ -308,11 +309,8 @@ inline comet::com_ptr<T> bind_to_parent(const pidl::apidl_t& pidl)
     if (pidl.empty())
         BOOST_THROW_EXCEPTION(std::logic_error("Already at top level"));
 
-    // Create parent of PIDL given
-    pidl::apidl_t parent = pidl.parent();
-
     comet::com_ptr<T> requested_interface;
-    if (parent.empty())
+    if (pidl.item_count() == 1)
     {
         /*
         The given PIDL is a child of the desktop so the requested
@@ -322,7 +320,8 @@ inline comet::com_ptr<T> bind_to_parent(const pidl::apidl_t& pidl)
     }
     else
     {
-        requested_interface = bind_to_handler_object<T>(parent);
+        // Create parent of PIDL given
+        requested_interface = bind_to_handler_object<T>(pidl.parent());
     }
 
     return requested_interface;
@@ -337,15 +336,20 @@ inline comet::com_ptr<IStream> stream_from_pidl(const pidl::apidl_t& pidl)
 {
     comet::com_ptr<IShellFolder> parent = bind_to_parent<IShellFolder>(pidl);
 
+    // The last item is followed by the PIDL's terminator so it can be passed
+    // to the folder in place rather than copied.  The wrapper already knows
+    // where it starts.
+    pidl::cpidl_view item = pidl.split().child;
+
     comet::com_ptr<IStream> stream;
 
     HRESULT hr = parent->BindToObject(
-        pidl.last_item().get(), NULL, stream.iid(),
+        item.data(), NULL, stream.iid(),
         reinterpret_cast<void**>(stream.out()));
     if (FAILED(hr))
     {
         hr = parent->BindToStorage(
-            pidl.last_item().get(), NULL, stream.iid(),
+            item.data(), NULL, stream.iid(),
             reinterpret_cast<void**>(stream.out()));
         if (FAILED(hr))
             BOOST_THROW_EXCEPTION(
@@ -33,7 +33,8 @@
 #define WASHER_SHELL_SHELL_ITEM_HPP
 #pragma once
 
-#include <washer/shell/pidl.hpp> // apidl_t, cpidl_t
+#include <washer/shell/pidl.hpp> // apidl_t
+#include <washer/shell/pidl_view.hpp> // cpidl_view, basic_split_view
 #include <washer/shell/folder_error_adapters.hpp> // comtype<IShellFolder>
 
 #include <comet/ptr.h> // com_ptr
@@ -55,7 +56,7 @@ inline comet::com_ptr<T> bind_to_parent(const pidl::apidl_t& pidl);
 
 template<typename T>
 inline std::basic_string<T> strret_to_string(
-    STRRET& strret, const pidl::cpidl_t& pidl);
+    STRRET& strret, PCUITEMID_CHILD pidl);
 
 /**
  * Interface to items in the shell namespace.
@@ -352,13 +353,14 @@ namespace detail {
     {
         comet::com_ptr<IShellFolder> parent = bind_to_parent<IShellFolder>(pidl);
 
+        pidl::cpidl_view item = pidl.split().child;
+
         STRRET str;
-        HRESULT hr = parent->GetDisplayNameOf(
-            pidl.last_item().get(), type_flags, &str);
+        HRESULT hr = parent->GetDisplayNameOf(item.data(), type_flags, &str);
         if (FAILED(hr))
             BOOST_THROW_EXCEPTION(comet::com_error_from_interface(parent, hr));
 
-        return strret_to_string<wchar_t>(str, pidl.last_item());
+        return strret_to_string<wchar_t>(str, item.data());
     }
 }
 
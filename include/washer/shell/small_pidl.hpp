@@ -0,0 +1,741 @@
+/**
+    @file
+
+    PIDL wrapper that stores short ITEMIDLISTs inline.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#ifndef WASHER_SHELL_SMALL_PIDL_HPP
+#define WASHER_SHELL_SMALL_PIDL_HPP
+#pragma once
+
+#include <washer/shell/pidl.hpp> // basic_pidl, raw_pidl, allocators
+#include <washer/shell/pidl_view.hpp> // basic_split_view
+
+#include <boost/static_assert.hpp> // BOOST_STATIC_ASSERT
+#include <boost/throw_exception.hpp> // BOOST_THROW_EXCEPTION
+#include <boost/type_traits/is_same.hpp> // is_same
+
+#include <algorithm> // swap
+#include <cassert> // assert
+#include <cstring> // memcpy, memmove
+#include <stdexcept> // logic_error
+
+namespace washer {
+namespace shell {
+namespace pidl {
+
+/**
+ * Default number of bytes a small PIDL can hold without allocating.
+ *
+ * Large enough for a typical single-item child PIDL belonging to a namespace
+ * extension plus its null-terminator.
+ */
+const size_t default_small_pidl_capacity = 64;
+
+template<typename T, typename Alloc, size_t InlineBytes>
+class basic_small_pidl;
+
+namespace detail {
+
+    /**
+     * Marks a last-item offset that hasn't been worked out yet.
+     */
+    inline size_t unknown_small_pidl_offset()
+    {
+        return static_cast<size_t>(-1);
+    }
+
+    /**
+     * A PIDL being joined, with what is already known about it.
+     */
+    struct small_pidl_operand
+    {
+        small_pidl_operand(
+            const void* pidl, size_t size, size_t last_offset)
+            : pidl(pidl), size(size), last_offset(last_offset) {}
+
+        const void* pidl;
+        size_t size; ///< Including the terminator, zero if NULL
+        size_t last_offset; ///< Offset of the last item, if known
+    };
+
+    /**
+     * Joins PIDLs into a small PIDL.
+     *
+     * Granted access to the small PIDL's internals so that operator+ can
+     * write the joined PIDL directly into the result's buffer.
+     */
+    struct small_pidl_join
+    {
+        template<typename T, typename Alloc, size_t N>
+        static small_pidl_operand operand(
+            const basic_small_pidl<T, Alloc, N>& pidl)
+        {
+            return small_pidl_operand(
+                pidl.m_pidl, pidl.m_size, pidl.m_last_offset);
+        }
+
+        template<typename T, typename Alloc>
+        static small_pidl_operand operand(const basic_pidl<T, Alloc>& pidl)
+        {
+            return small_pidl_operand(
+                pidl.get(), pidl.size(),
+                (pidl.empty()) ? 0 : pidl.split().parent.item_bytes());
+        }
+
+        template<typename T>
+        static small_pidl_operand operand(const T __unaligned* pidl)
+        {
+            raw_pidl::extent e = raw_pidl::measure(pidl);
+            return small_pidl_operand(pidl, e.size, e.last_offset);
+        }
+
+        template<typename R>
+        static R join(
+            const small_pidl_operand& lhs, const small_pidl_operand& rhs,
+            const typename R::allocator& alloc)
+        {
+            R result(alloc);
+
+            if (!lhs.pidl && !rhs.pidl)
+                return result;
+
+            size_t lhs_copy =
+                lhs.size - ((lhs.size && rhs.size) ? sizeof(USHORT) : 0);
+            size_t len = lhs_copy + rhs.size;
+
+            BYTE* mem = result.reserve_uninitialised(len);
+            if (lhs_copy)
+                std::memcpy(mem, lhs.pidl, lhs_copy);
+            if (rhs.size)
+                std::memcpy(mem + lhs_copy, rhs.pidl, rhs.size);
+
+            result.m_last_offset = joined_last_offset(lhs, lhs_copy, rhs);
+            return result;
+        }
+
+        /**
+         * Append to a small PIDL, in place if the result fits the storage
+         * it already has.
+         *
+         * The PIDL being appended may be part of @a lhs itself.
+         */
+        template<typename T, typename Alloc, size_t N>
+        static void append(
+            basic_small_pidl<T, Alloc, N>& lhs, const small_pidl_operand& rhs)
+        {
+            if (!rhs.pidl)
+                return;
+
+            if (!lhs.m_pidl)
+            {
+                lhs.assign(rhs);
+                return;
+            }
+
+            small_pidl_operand old = operand(lhs);
+            size_t lhs_copy = old.size - sizeof(USHORT);
+            size_t len = lhs_copy + rhs.size;
+            size_t capacity = (lhs.is_inline()) ? N : old.size;
+
+            if (len <= capacity)
+            {
+                std::memmove(
+                    reinterpret_cast<BYTE*>(lhs.m_pidl) + lhs_copy,
+                    rhs.pidl, rhs.size);
+            }
+            else
+            {
+                BYTE* mem =
+                    reinterpret_cast<BYTE*>(lhs.m_allocator.allocate(len));
+                std::memcpy(mem, old.pidl, lhs_copy);
+                std::memcpy(mem + lhs_copy, rhs.pidl, rhs.size);
+
+                lhs.release();
+                lhs.m_pidl = reinterpret_cast<T*>(mem);
+            }
+
+            lhs.m_size = len;
+            lhs.m_last_offset = joined_last_offset(old, lhs_copy, rhs);
+        }
+
+    private:
+
+        /**
+         * Where the last item of a joined PIDL starts, if known.
+         */
+        static size_t joined_last_offset(
+            const small_pidl_operand& lhs, size_t lhs_copy,
+            const small_pidl_operand& rhs)
+        {
+            if (rhs.size <= sizeof(USHORT))
+                return lhs.last_offset;
+            else if (rhs.last_offset == unknown_small_pidl_offset())
+                return unknown_small_pidl_offset();
+            else
+                return lhs_copy + rhs.last_offset;
+        }
+    };
+}
+
+/**
+ * PIDL wrapper that keeps short ITEMIDLISTs inside the wrapper itself.
+ *
+ * Behaves like basic_pidl but PIDLs of up to @a InlineBytes bytes (including
+ * the null-terminator) are stored in a buffer inside the object rather than
+ * in memory obtained from the allocator.  Only longer PIDLs spill to the heap.
+ * Copying and destroying small child PIDLs therefore never touches the
+ * allocator.
+ *
+ * The size of the wrapped PIDL and where its last item starts are recorded
+ * when it is stored so size(), parent() and last_item() don't have to walk
+ * the item list.
+ *
+ * As the PIDL may live inside the wrapper, there is no attach(), detach() or
+ * out().  Converting to basic_pidl or calling copy_to() produces a PIDL
+ * allocated with @a Alloc that can be handed to the shell.
+ *
+ * Like basic_pidl, the wrapper holds an instance of its allocator so PIDLs
+ * too big for the buffer can spill into a stateful allocator such as
+ * arena_alloc.  Assigning copies the PIDL using the wrapper's own allocator
+ * whereas swapping exchanges allocators along with the PIDLs.
+ *
+ * @warning  The pointer returned by get() is invalidated when the wrapper is
+ *           moved, swapped or destroyed, even if the PIDL contents remain the
+ *           same.
+ */
+template<typename T, typename Alloc,
+         size_t InlineBytes=default_small_pidl_capacity>
+class basic_small_pidl
+{
+public:
+
+    typedef T                                                     value_type;
+    typedef T*                                                    pointer;
+    typedef const T*                                              const_pointer;
+    typedef Alloc                                                 allocator;
+    typedef typename raw_pidl::traits<T>::combine_type            join_type;
+    typedef typename allocator::template rebind<join_type>::other join_allocator;
+    typedef basic_small_pidl<join_type, join_allocator, InlineBytes> join_pidl;
+    typedef typename raw_pidl::traits<T>::clone_pidl_type         foreign_pidl_type;
+
+    static const size_t inline_capacity = InlineBytes;
+
+    basic_small_pidl()
+        : m_pidl(NULL), m_size(0), m_last_offset(0), m_allocator(Alloc()) {}
+
+    /**
+     * NULL PIDL that will allocate using the given allocator.
+     */
+    explicit basic_small_pidl(Alloc alloc)
+        : m_pidl(NULL), m_size(0), m_last_offset(0), m_allocator(alloc) {}
+
+    ~basic_small_pidl() throw()
+    {
+        release();
+    }
+
+    /**
+     * Copy construction.
+     *
+     * A spilled copy is allocated by a copy of the other wrapper's
+     * allocator.
+     */
+    basic_small_pidl(const basic_small_pidl& pidl)
+        : m_pidl(NULL), m_size(0), m_last_offset(0),
+          m_allocator(pidl.m_allocator)
+    {
+        assign(detail::small_pidl_join::operand(pidl));
+    }
+
+    /**
+     * Copy construction using the given allocator.
+     */
+    basic_small_pidl(const basic_small_pidl& pidl, Alloc alloc)
+        : m_pidl(NULL), m_size(0), m_last_offset(0), m_allocator(alloc)
+    {
+        assign(detail::small_pidl_join::operand(pidl));
+    }
+
+    /**
+     * Construct by copying a raw PIDL.
+     */
+    basic_small_pidl(const __unaligned T* pidl, Alloc alloc=Alloc())
+        : m_pidl(NULL), m_size(0), m_last_offset(0), m_allocator(alloc)
+    {
+        raw_pidl::traits<T>::type_check(pidl);
+        assign(detail::small_pidl_join::operand(pidl));
+    }
+
+    /**
+     * Construct by copying a heap-based PIDL wrapper.
+     *
+     * Will fail to compile unless it is legal to upcast the other wrapper's
+     * raw PIDL type to this PIDL's type.
+     */
+    template<typename U, typename AllocU>
+    basic_small_pidl(const basic_pidl<U, AllocU>& pidl, Alloc alloc=Alloc())
+        : m_pidl(NULL), m_size(0), m_last_offset(0), m_allocator(alloc)
+    {
+        const T* raw = pidl.get();
+        raw_pidl::traits<T>::type_check(raw);
+        assign(detail::small_pidl_join::operand(pidl));
+    }
+
+    /**
+     * Copy assignment.
+     *
+     * A spilled copy is allocated by this wrapper's allocator.
+     */
+    basic_small_pidl& operator=(const basic_small_pidl& pidl)
+    {
+        if (this != &pidl)
+        {
+            basic_small_pidl copy(pidl, m_allocator);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    /**
+     * Copy a raw PIDL into this wrapper instance.
+     */
+    basic_small_pidl& operator=(foreign_pidl_type pidl)
+    {
+        basic_small_pidl copy(pidl, m_allocator);
+        swap(copy);
+        return *this;
+    }
+
+    /**
+     * Result of comparing with NULL.
+     */
+    bool operator!() const
+    {
+        return !m_pidl;
+    }
+
+    /**
+     * Conversion to a heap-based PIDL wrapper.
+     *
+     * Will fail to compile unless it is legal to upcast the underlying raw
+     * PIDL type to the target PIDL's type.
+     *
+     * If the target uses the same kind of allocator, the copy is allocated by
+     * a rebound copy of this wrapper's allocator.
+     */
+    template<typename U, typename AllocU>
+    operator basic_pidl<U, AllocU>() const
+    {
+        return basic_pidl<U, AllocU>(
+            m_pidl,
+            detail::rebind_allocator<AllocU>(
+                m_allocator,
+                boost::is_same<
+                    AllocU, typename allocator::template rebind<U>::other>()));
+    }
+
+    /**
+     * The allocator used for PIDLs too big for the wrapper's buffer.
+     */
+    allocator get_allocator() const
+    {
+        return m_allocator;
+    }
+
+    /**
+     * Return underlying PIDL.
+     *
+     * Returned const to prevent unexpected modification outside the wrapper.
+     */
+    const T* get() const
+    {
+        return m_pidl;
+    }
+
+    /**
+     * Clone internal PIDL as a raw PIDL allocated with this wrapper's
+     * allocator.
+     *
+     * @see basic_pidl::copy_to
+     */
+    template<typename U>
+    void copy_to(U*& raw) const
+    {
+        if (!m_pidl)
+        {
+            raw = NULL;
+            return;
+        }
+
+        T* mem = m_allocator.allocate(m_size);
+        std::memcpy(mem, m_pidl, m_size);
+        raw = mem;
+    }
+
+    /**
+     * The size of the PIDL in bytes, including the null-terminator.
+     */
+    size_t size() const
+    {
+        return m_size;
+    }
+
+    /**
+     * Is the PIDL empty?
+     *
+     * Empty PIDLs are either NULL or point to a NULL-terminator.
+     */
+    bool empty() const
+    {
+        return raw_pidl::empty(m_pidl);
+    }
+
+    /**
+     * Is the PIDL stored in the wrapper's internal buffer?
+     *
+     * NULL PIDLs count as inline as they use no heap memory.
+     */
+    bool is_inline() const
+    {
+        return m_pidl == NULL || m_pidl == inline_pidl();
+    }
+
+    /**
+     * The single child pidl of this namespace item.
+     */
+    basic_small_pidl<
+        ITEMID_CHILD, typename allocator::template rebind<ITEMID_CHILD>::other,
+        InlineBytes>
+        last_item() const
+    {
+        if (empty())
+            BOOST_THROW_EXCEPTION(
+                std::logic_error("Empty PIDL cannot have a last item"));
+
+        typedef typename allocator::template rebind<ITEMID_CHILD>::other
+            child_allocator;
+
+        return basic_small_pidl<ITEMID_CHILD, child_allocator, InlineBytes>(
+            reinterpret_cast<const ITEMID_CHILD __unaligned*>(
+                raw_pidl::skip(m_pidl, last_offset())),
+            child_allocator(m_allocator));
+    }
+
+    /**
+     * Upwards navigation.
+     */
+    basic_small_pidl parent() const
+    {
+        if (empty())
+            BOOST_THROW_EXCEPTION(
+                std::logic_error("Empty PIDL cannot have a parent"));
+
+        // Finding the parent's own last item would mean walking it, so
+        // leave that until someone asks
+
+        size_t parent_len = last_offset();
+
+        basic_small_pidl parent(m_allocator);
+        detail::copy_terminated(
+            parent.reserve_uninitialised(parent_len + sizeof(USHORT)),
+            m_pidl, parent_len);
+
+        return parent;
+    }
+
+    /**
+     * No-fail swap.
+     *
+     * Inline PIDLs are copied between the wrappers' buffers; heap PIDLs
+     * just exchange owners.
+     */
+    void swap(basic_small_pidl& pidl) throw()
+    {
+        if (this == &pidl)
+            return;
+
+        if (!is_inline() && !pidl.is_inline())
+        {
+            std::swap(m_pidl, pidl.m_pidl);
+            std::swap(m_size, pidl.m_size);
+            std::swap(m_last_offset, pidl.m_last_offset);
+            std::swap(m_allocator, pidl.m_allocator);
+            return;
+        }
+
+        BYTE temp[InlineBytes];
+        T* this_heap = (is_inline()) ? NULL : m_pidl;
+        T* other_heap = (pidl.is_inline()) ? NULL : pidl.m_pidl;
+        bool this_null = (m_pidl == NULL);
+        bool other_null = (pidl.m_pidl == NULL);
+
+        if (!this_heap)
+            std::memcpy(temp, m_inline, m_size);
+
+        if (other_heap)
+            m_pidl = other_heap;
+        else
+        {
+            std::memcpy(m_inline, pidl.m_inline, pidl.m_size);
+            m_pidl = (other_null) ? NULL : inline_pidl();
+        }
+
+        if (this_heap)
+            pidl.m_pidl = this_heap;
+        else
+        {
+            std::memcpy(pidl.m_inline, temp, m_size);
+            pidl.m_pidl = (this_null) ? NULL : pidl.inline_pidl();
+        }
+
+        std::swap(m_size, pidl.m_size);
+        std::swap(m_last_offset, pidl.m_last_offset);
+        std::swap(m_allocator, pidl.m_allocator);
+    }
+
+private:
+
+    friend struct detail::small_pidl_join;
+
+    T* inline_pidl() const
+    {
+        return reinterpret_cast<T*>(const_cast<BYTE*>(m_inline));
+    }
+
+    /**
+     * Where the last item starts, working it out if it isn't known yet.
+     */
+    size_t last_offset() const
+    {
+        if (m_last_offset == detail::unknown_small_pidl_offset())
+            m_last_offset = raw_pidl::measure(m_pidl).last_offset;
+        return m_last_offset;
+    }
+
+    /**
+     * Free any heap storage and reset to NULL.
+     */
+    void release() throw()
+    {
+        if (!is_inline())
+            m_allocator.deallocate(m_pidl);
+        m_pidl = NULL;
+        m_size = 0;
+        m_last_offset = 0;
+    }
+
+    /**
+     * Point the wrapper at storage for a PIDL of the given size.
+     *
+     * The wrapper must be NULL.  The storage is left for the caller to fill
+     * and the last item is left to be found when it is needed.
+     */
+    BYTE* reserve_uninitialised(size_t len)
+    {
+        assert(m_pidl == NULL);
+
+        if (len <= InlineBytes)
+            m_pidl = inline_pidl();
+        else
+            m_pidl = m_allocator.allocate(len);
+
+        m_size = len;
+        m_last_offset = detail::unknown_small_pidl_offset();
+        return reinterpret_cast<BYTE*>(m_pidl);
+    }
+
+    /**
+     * Copy a PIDL into the wrapper, which must be NULL.
+     */
+    void assign(const detail::small_pidl_operand& pidl)
+    {
+        if (pidl.pidl)
+        {
+            std::memcpy(
+                reserve_uninitialised(pidl.size), pidl.pidl, pidl.size);
+            m_last_offset = pidl.last_offset;
+        }
+    }
+
+    T* m_pidl;
+    size_t m_size;
+    mutable size_t m_last_offset; ///< Offset of last item from start
+    Alloc m_allocator;
+    BYTE m_inline[InlineBytes];
+};
+
+/**
+ * @name Concatenation
+ *
+ * Join two PIDLs with the + operator.
+ *
+ * The joined PIDL is itself a small PIDL so, if it fits, it is also stored
+ * inline.
+ *
+ * @see operator+(const basic_pidl&, const basic_pidl&)
+ */
+// @{
+template<typename T, typename U, typename Alloc, typename AllocU,
+         size_t N, size_t M>
+inline typename basic_small_pidl<T, Alloc, N>::join_pidl operator+(
+    const basic_small_pidl<T, Alloc, N>& lhs,
+    const basic_small_pidl<U, AllocU, M>& rhs)
+{
+    BOOST_STATIC_ASSERT(raw_pidl::traits<U>::is_appendable);
+
+    typedef typename basic_small_pidl<T, Alloc, N>::join_pidl result_type;
+
+    return detail::small_pidl_join::join<result_type>(
+        detail::small_pidl_join::operand(lhs),
+        detail::small_pidl_join::operand(rhs),
+        typename result_type::allocator(lhs.get_allocator()));
+}
+
+template<typename T, typename U, typename Alloc, typename AllocU, size_t N>
+inline typename basic_small_pidl<T, Alloc, N>::join_pidl operator+(
+    const basic_small_pidl<T, Alloc, N>& lhs,
+    const basic_pidl<U, AllocU>& rhs)
+{
+    BOOST_STATIC_ASSERT(raw_pidl::traits<U>::is_appendable);
+
+    typedef typename basic_small_pidl<T, Alloc, N>::join_pidl result_type;
+
+    return detail::small_pidl_join::join<result_type>(
+        detail::small_pidl_join::operand(lhs),
+        detail::small_pidl_join::operand(rhs),
+        typename result_type::allocator(lhs.get_allocator()));
+}
+
+template<typename T, typename U, typename Alloc, size_t N>
+inline typename basic_small_pidl<T, Alloc, N>::join_pidl operator+(
+    const basic_small_pidl<T, Alloc, N>& lhs, const U __unaligned* rhs)
+{
+    BOOST_STATIC_ASSERT(raw_pidl::traits<U>::is_appendable);
+
+    typedef typename basic_small_pidl<T, Alloc, N>::join_pidl result_type;
+
+    return detail::small_pidl_join::join<result_type>(
+        detail::small_pidl_join::operand(lhs),
+        detail::small_pidl_join::operand(rhs),
+        typename result_type::allocator(lhs.get_allocator()));
+}
+// @}
+
+/**
+ * @name Appending
+ *
+ * Append a PIDL to a small PIDL with the += operator.
+ *
+ * Only legal when joining doesn't change the type of the left-hand PIDL.
+ * The items are added to the left-hand PIDL's own storage when they fit,
+ * and otherwise moved to a single new heap block with the result.
+ */
+// @{
+template<typename T, typename U, typename Alloc, typename AllocU,
+         size_t N, size_t M>
+inline basic_small_pidl<T, Alloc, N>& operator+=(
+    basic_small_pidl<T, Alloc, N>& lhs,
+    const basic_small_pidl<U, AllocU, M>& rhs)
+{
+    BOOST_STATIC_ASSERT(raw_pidl::traits<U>::is_appendable);
+    BOOST_STATIC_ASSERT((
+        boost::is_same<typename raw_pidl::traits<T>::combine_type, T>::value));
+
+    detail::small_pidl_join::append(
+        lhs, detail::small_pidl_join::operand(rhs));
+    return lhs;
+}
+
+template<typename T, typename U, typename Alloc, typename AllocU, size_t N>
+inline basic_small_pidl<T, Alloc, N>& operator+=(
+    basic_small_pidl<T, Alloc, N>& lhs, const basic_pidl<U, AllocU>& rhs)
+{
+    BOOST_STATIC_ASSERT(raw_pidl::traits<U>::is_appendable);
+    BOOST_STATIC_ASSERT((
+        boost::is_same<typename raw_pidl::traits<T>::combine_type, T>::value));
+
+    detail::small_pidl_join::append(
+        lhs, detail::small_pidl_join::operand(rhs));
+    return lhs;
+}
+
+template<typename T, typename U, typename Alloc, size_t N>
+inline basic_small_pidl<T, Alloc, N>& operator+=(
+    basic_small_pidl<T, Alloc, N>& lhs, const U __unaligned* rhs)
+{
+    BOOST_STATIC_ASSERT(raw_pidl::traits<U>::is_appendable);
+    BOOST_STATIC_ASSERT((
+        boost::is_same<typename raw_pidl::traits<T>::combine_type, T>::value));
+
+    detail::small_pidl_join::append(
+        lhs, detail::small_pidl_join::operand(rhs));
+    return lhs;
+}
+// @}
+
+/**
+ * No-fail swap.
+ */
+template<typename T, typename Alloc, size_t N>
+inline void swap(
+    basic_small_pidl<T, Alloc, N>& pidl1,
+    basic_small_pidl<T, Alloc, N>& pidl2) throw()
+{
+    pidl1.swap(pidl2);
+}
+
+/**
+ * Explicit downcast.
+ */
+template<typename T, typename U, typename Alloc, size_t N>
+inline T pidl_cast(const basic_small_pidl<U, Alloc, N>& pidl)
+{
+    return pidl_cast<T>(pidl.get());
+}
+
+/**
+ * @name  Small versions of the standard shell PIDL types.
+ *
+ * These use the default_alloc allocation method for PIDLs too large to be
+ * stored inline.
+ */
+// @{
+typedef basic_small_pidl<
+    ITEMIDLIST_RELATIVE, default_alloc<ITEMIDLIST_RELATIVE>::type>
+    small_pidl_t;
+typedef basic_small_pidl<
+    ITEMIDLIST_ABSOLUTE, default_alloc<ITEMIDLIST_ABSOLUTE>::type>
+    small_apidl_t;
+typedef basic_small_pidl<
+    ITEMID_CHILD, default_alloc<ITEMID_CHILD>::type> small_cpidl_t;
+// @}
+
+}}} // namespace washer::shell::pidl
+
+#endif
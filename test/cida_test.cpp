@@ -0,0 +1,312 @@
+/**
+    @file
+
+    Tests for reading and writing CIDAs.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#include "pidl_fixtures.hpp" // pidl_fixture, binary_equal_pidls
+
+#include <washer/shell/cida.hpp> // test subject
+#include <washer/shell/pidl.hpp> // apidl_t, cpidl_t
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstring> // memcpy
+#include <stdexcept> // invalid_argument, length_error, out_of_range
+#include <string>
+#include <vector>
+
+using namespace washer::shell;
+using namespace washer::shell::pidl;
+
+using washer::test::binary_equal_pidls;
+using washer::test::idlist_bytes;
+using washer::test::pidl_fixture;
+
+using std::string;
+using std::vector;
+
+namespace {
+
+    typedef ITEMIDLIST_RELATIVE IDRELATIVE;
+    typedef ITEMIDLIST_ABSOLUTE IDABSOLUTE;
+    typedef ITEMID_CHILD IDCHILD;
+
+    class cida_fixture : public pidl_fixture
+    {
+    public:
+
+        cida_fixture()
+        {
+            m_parent = fake_pidl<IDABSOLUTE>("folder", "subfolder");
+            m_children.push_back(fake_pidl<IDCHILD>("a"));
+            m_children.push_back(fake_pidl<IDCHILD>("second"));
+            m_children.push_back(fake_pidl<IDCHILD>("3rd"));
+        }
+
+        const IDABSOLUTE* parent() const
+        {
+            return m_parent;
+        }
+
+        const vector<const IDCHILD*>& children() const
+        {
+            return m_children;
+        }
+
+        /**
+         * CIDA of the fixture's parent and children.
+         */
+        vector<BYTE> cida()
+        {
+            vector<BYTE> buffer(
+                cida_size(m_parent, m_children.begin(), m_children.end()));
+            write_cida(
+                &buffer[0], buffer.size(), m_parent, m_children.begin(),
+                m_children.end());
+            return buffer;
+        }
+
+    private:
+        const IDABSOLUTE* m_parent;
+        vector<const IDCHILD*> m_children;
+    };
+
+    UINT uint_at(const vector<BYTE>& buffer, size_t index)
+    {
+        UINT value;
+        std::memcpy(&value, &buffer[index * sizeof(UINT)], sizeof(UINT));
+        return value;
+    }
+
+    void set_uint(vector<BYTE>& buffer, size_t index, UINT value)
+    {
+        std::memcpy(&buffer[index * sizeof(UINT)], &value, sizeof(UINT));
+    }
+}
+
+BOOST_FIXTURE_TEST_SUITE(cida_tests, cida_fixture)
+
+/**
+ * The bytes are laid out as the shell expects: count, offsets, PIDLs.
+ */
+BOOST_AUTO_TEST_CASE( layout )
+{
+    vector<BYTE> buffer = cida();
+
+    size_t header = 5 * sizeof(UINT);
+    BOOST_CHECK_EQUAL(uint_at(buffer, 0), 3U);
+    BOOST_CHECK_EQUAL(uint_at(buffer, 1), header);
+
+    size_t offset = header + raw_pidl::size(parent());
+    for (size_t i = 0; i < 3; ++i)
+    {
+        BOOST_CHECK_EQUAL(uint_at(buffer, i + 2), offset);
+        BOOST_CHECK(
+            binary_equal_pidls(
+                reinterpret_cast<const IDRELATIVE*>(&buffer[offset]),
+                children()[i]));
+        offset += raw_pidl::size(children()[i]);
+    }
+
+    BOOST_CHECK_EQUAL(buffer.size(), offset);
+    BOOST_CHECK(
+        binary_equal_pidls(
+            reinterpret_cast<const IDRELATIVE*>(&buffer[header]),
+            parent()));
+}
+
+#ifdef _WIN32
+/**
+ * The layout agrees with the SDK's definition.
+ */
+BOOST_AUTO_TEST_CASE( layout_matches_sdk )
+{
+    vector<BYTE> buffer = cida();
+    const CIDA* sdk = reinterpret_cast<const CIDA*>(&buffer[0]);
+
+    BOOST_CHECK_EQUAL(sdk->cidl, 3U);
+    BOOST_CHECK(
+        binary_equal_pidls(
+            reinterpret_cast<PCIDLIST_ABSOLUTE>(
+                &buffer[sdk->aoffset[0]]), parent()));
+}
+#endif
+
+/**
+ * Reading gives back views of the PIDLs in place.
+ */
+BOOST_AUTO_TEST_CASE( round_trip )
+{
+    vector<BYTE> buffer = cida();
+    cida_view cida(&buffer[0], buffer.size());
+
+    BOOST_REQUIRE_EQUAL(cida.size(), 3U);
+    BOOST_CHECK(cida.parent() == apidl_view(parent()));
+    BOOST_CHECK_EQUAL(cida.parent().item_count(), 2U);
+
+    for (size_t i = 0; i < cida.size(); ++i)
+    {
+        BOOST_CHECK(cida[i] == pidl_view(children()[i]));
+        BOOST_CHECK_EQUAL(cida[i].item_count(), 1U);
+
+        const BYTE* data = reinterpret_cast<const BYTE*>(cida[i].data());
+        BOOST_CHECK(data > &buffer[0] && data < &buffer[0] + buffer.size());
+    }
+
+    BOOST_CHECK_THROW(cida.at(3), std::out_of_range);
+
+    size_t i = 0;
+    for (cida_view::const_iterator it = cida.begin(); it != cida.end();
+         ++it, ++i)
+    {
+        BOOST_CHECK(*it == pidl_view(children()[i]));
+    }
+    BOOST_CHECK_EQUAL(i, 3U);
+}
+
+/**
+ * Wrappers and views can be written as well as raw PIDLs.
+ */
+BOOST_AUTO_TEST_CASE( write_wrappers )
+{
+    apidl_t wrapped_parent(parent());
+    vector<cpidl_t> wrapped(children().begin(), children().end());
+
+    vector<BYTE> buffer(
+        cida_size(wrapped_parent, wrapped.begin(), wrapped.end()));
+    BOOST_CHECK_EQUAL(
+        write_cida(
+            &buffer[0], buffer.size(), apidl_view(wrapped_parent),
+            wrapped.begin(), wrapped.end()),
+        buffer.size());
+
+    BOOST_CHECK(buffer == cida());
+}
+
+/**
+ * A selection can have no children.
+ */
+BOOST_AUTO_TEST_CASE( no_children )
+{
+    vector<const IDCHILD*> none;
+    vector<BYTE> buffer(cida_size(parent(), none.begin(), none.end()));
+    write_cida(&buffer[0], buffer.size(), parent(), none.begin(), none.end());
+
+    cida_view cida(&buffer[0], buffer.size());
+    BOOST_CHECK(cida.empty());
+    BOOST_CHECK(cida.begin() == cida.end());
+    BOOST_CHECK(cida.parent() == apidl_view(parent()));
+}
+
+/**
+ * Writing never goes past the end of the buffer.
+ */
+BOOST_AUTO_TEST_CASE( write_too_small )
+{
+    size_t size = cida_size(parent(), children().begin(), children().end());
+
+    // Guard bytes after the space we say is available
+    vector<BYTE> buffer(size + 16, 0xcc);
+    for (size_t available = 0; available < size; ++available)
+    {
+        BOOST_CHECK_THROW(
+            write_cida(
+                &buffer[0], available, parent(), children().begin(),
+                children().end()),
+            std::length_error);
+        for (size_t i = available; i < buffer.size(); ++i)
+        {
+            BOOST_REQUIRE_EQUAL(buffer[i], 0xcc);
+        }
+    }
+}
+
+/**
+ * Truncating a CIDA anywhere is detected, whether at creation or when the
+ * cut-off PIDL is read.
+ */
+BOOST_AUTO_TEST_CASE( read_truncated )
+{
+    vector<BYTE> buffer = cida();
+    for (size_t size = 0; size < buffer.size(); ++size)
+    {
+        vector<BYTE> truncated(buffer.begin(), buffer.begin() + size);
+        const BYTE* data = (size) ? &truncated[0] : NULL;
+
+        bool detected = false;
+        try
+        {
+            cida_view cida(data, size);
+            cida.parent();
+            for (size_t i = 0; i < cida.size(); ++i)
+            {
+                cida[i];
+            }
+        }
+        catch (const std::invalid_argument&)
+        {
+            detected = true;
+        }
+        BOOST_CHECK_MESSAGE(detected, "Truncated to " << size << " bytes");
+    }
+}
+
+BOOST_AUTO_TEST_CASE( read_bad_count )
+{
+    vector<BYTE> buffer = cida();
+    set_uint(buffer, 0, 0xffffffff);
+    BOOST_CHECK_THROW(
+        cida_view(&buffer[0], buffer.size()), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE( read_bad_offset )
+{
+    vector<BYTE> buffer = cida();
+    set_uint(buffer, 3, static_cast<UINT>(buffer.size()));
+    BOOST_CHECK_THROW(
+        cida_view(&buffer[0], buffer.size()), std::invalid_argument);
+}
+
+/**
+ * An item claiming to be smaller than its own size field is rejected
+ * rather than looping forever.
+ */
+BOOST_AUTO_TEST_CASE( read_bad_item )
+{
+    vector<BYTE> buffer = cida();
+    size_t offset = uint_at(buffer, 2);
+    USHORT cb = 1;
+    std::memcpy(&buffer[offset], &cb, sizeof(cb));
+
+    cida_view cida(&buffer[0], buffer.size());
+    BOOST_CHECK_THROW(cida[0], std::invalid_argument);
+    BOOST_CHECK(cida[1] == pidl_view(children()[1]));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,292 @@
+/**
+    @file
+
+    Unit tests for the allocation-counting PIDL allocator.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#include "pidl_fixtures.hpp" // pidl_fixture, binary_equal_pidls
+
+#include <washer/shell/counting_alloc.hpp> // test subject
+#include <washer/shell/pidl_arena.hpp> // pidl_arena, arena_alloc
+#include <washer/shell/pidl_split.hpp> // basic_split_pidl
+#include <washer/shell/shared_pidl.hpp> // basic_shared_pidl
+
+#include <boost/test/unit_test.hpp>
+#include <boost/thread/thread.hpp> // thread
+
+#include <string>
+#include <vector>
+
+using namespace washer::shell::pidl;
+
+using washer::test::binary_equal_pidls;
+using washer::test::pidl_fixture;
+
+using std::string;
+using std::vector;
+
+namespace {
+
+    typedef ITEMIDLIST_ABSOLUTE IDABSOLUTE;
+    typedef ITEMIDLIST_RELATIVE IDRELATIVE;
+    typedef ITEMID_CHILD IDCHILD;
+
+    typedef counting_alloc<IDABSOLUTE, newdelete_alloc<IDABSOLUTE> >
+        counting_ahalloc;
+
+    typedef basic_pidl<IDABSOLUTE, counting_ahalloc> counted_apidl;
+    typedef basic_pidl<
+        IDRELATIVE, counting_ahalloc::rebind<IDRELATIVE>::other>
+        counted_pidl;
+
+    vector<string> three_items()
+    {
+        vector<string> items;
+        items.push_back("first");
+        items.push_back("second item");
+        items.push_back("third");
+        return items;
+    }
+
+    void allocate_on_other_thread(allocation_stats* result)
+    {
+        allocation_probe probe;
+        counting_ahalloc().deallocate(counting_ahalloc().allocate(10));
+        *result = probe.stats();
+    }
+}
+
+BOOST_FIXTURE_TEST_SUITE(counting_alloc_tests, pidl_fixture)
+
+BOOST_AUTO_TEST_CASE( counts_allocate_and_deallocate )
+{
+    allocation_probe probe;
+    counting_ahalloc alloc;
+
+    IDABSOLUTE* mem = alloc.allocate(30);
+    BOOST_CHECK_EQUAL(probe.stats().allocations, 1U);
+    BOOST_CHECK_EQUAL(probe.stats().bytes_allocated, 30U);
+    BOOST_CHECK_EQUAL(probe.stats().live_bytes(), 30);
+
+    alloc.deallocate(mem);
+    allocation_stats stats = probe.stats();
+    BOOST_CHECK_EQUAL(stats.deallocations, 1U);
+    BOOST_CHECK_EQUAL(stats.bytes_deallocated, 30U);
+    BOOST_CHECK_EQUAL(stats.live_bytes(), 0);
+    BOOST_CHECK_EQUAL(stats.live_allocations(), 0);
+    BOOST_CHECK_EQUAL(stats.peak_live_bytes, 30U);
+}
+
+BOOST_AUTO_TEST_CASE( deallocate_null )
+{
+    allocation_probe probe;
+    counting_ahalloc().deallocate(NULL);
+    BOOST_CHECK_EQUAL(probe.stats().deallocations, 0U);
+}
+
+/**
+ * The peak is the highest point reached, not the total allocated.
+ */
+BOOST_AUTO_TEST_CASE( peak_live_bytes )
+{
+    counting_ahalloc alloc;
+    allocation_probe probe;
+
+    IDABSOLUTE* first = alloc.allocate(100);
+    IDABSOLUTE* second = alloc.allocate(50);
+    alloc.deallocate(first);
+    IDABSOLUTE* third = alloc.allocate(70);
+    alloc.deallocate(second);
+    alloc.deallocate(third);
+
+    allocation_stats stats = probe.stats();
+    BOOST_CHECK_EQUAL(stats.bytes_allocated, 220U);
+    BOOST_CHECK_EQUAL(stats.peak_live_bytes, 150U);
+}
+
+/**
+ * A probe's peak is measured from where live bytes stood when it began
+ * and an inner probe doesn't hide the peak from an outer one.
+ */
+BOOST_AUTO_TEST_CASE( nested_probes )
+{
+    counting_ahalloc alloc;
+    allocation_probe outer;
+
+    IDABSOLUTE* held = alloc.allocate(40);
+    {
+        allocation_probe inner;
+        alloc.deallocate(alloc.allocate(100));
+
+        BOOST_CHECK_EQUAL(inner.stats().allocations, 1U);
+        BOOST_CHECK_EQUAL(inner.stats().peak_live_bytes, 100U);
+    }
+    alloc.deallocate(held);
+
+    allocation_stats stats = outer.stats();
+    BOOST_CHECK_EQUAL(stats.allocations, 2U);
+    BOOST_CHECK_EQUAL(stats.peak_live_bytes, 140U);
+}
+
+/**
+ * Each thread's allocations are counted separately.
+ */
+BOOST_AUTO_TEST_CASE( counted_per_thread )
+{
+    allocation_probe probe;
+    allocation_stats other_stats;
+
+    boost::thread other(allocate_on_other_thread, &other_stats);
+    other.join();
+
+    BOOST_CHECK_EQUAL(other_stats.allocations, 1U);
+    BOOST_CHECK_EQUAL(other_stats.bytes_allocated, 10U);
+    BOOST_CHECK_EQUAL(probe.stats().allocations, 0U);
+}
+
+BOOST_AUTO_TEST_CASE( thread_totals_include_probes )
+{
+    allocation_stats before = thread_allocation_stats();
+    counting_ahalloc().deallocate(counting_ahalloc().allocate(8));
+    allocation_stats after = thread_allocation_stats();
+
+    BOOST_CHECK_EQUAL(after.allocations, before.allocations + 1);
+    BOOST_CHECK_EQUAL(after.deallocations, before.deallocations + 1);
+    BOOST_CHECK_GE(after.peak_live_bytes, 8U);
+}
+
+BOOST_AUTO_TEST_CASE( pidl_budgets )
+{
+    const IDABSOLUTE* raw = fake_pidl<IDABSOLUTE>(three_items());
+    counted_apidl pidl(raw);
+    counted_pidl tail(fake_pidl<IDRELATIVE>("fourth"));
+
+    {
+        allocation_probe probe;
+        counted_apidl copy(pidl);
+        BOOST_CHECK_EQUAL(probe.stats().allocations, 1U);
+        BOOST_CHECK_EQUAL(probe.stats().bytes_allocated, pidl.size());
+    }
+
+    {
+        allocation_probe probe;
+        counted_apidl joined = pidl + tail;
+        BOOST_CHECK_EQUAL(probe.stats().allocations, 1U);
+    }
+
+    {
+        allocation_probe probe;
+        counted_apidl joined = pidl + tail.get();
+        BOOST_CHECK_EQUAL(probe.stats().allocations, 1U);
+    }
+
+    {
+        allocation_probe probe;
+        counted_apidl parent = pidl.parent();
+        BOOST_CHECK_EQUAL(probe.stats().allocations, 1U);
+        BOOST_CHECK_LT(probe.stats().bytes_allocated, pidl.size());
+    }
+
+    {
+        allocation_probe probe;
+        pidl.split();
+        BOOST_CHECK_EQUAL(probe.stats().allocations, 0U);
+    }
+
+    {
+        allocation_probe probe;
+        basic_split_pidl<IDABSOLUTE, counting_ahalloc> split(pidl);
+        BOOST_CHECK_EQUAL(probe.stats().allocations, 1U);
+    }
+}
+
+/**
+ * Growing a PIDL in place reallocates only when out of capacity.
+ */
+BOOST_AUTO_TEST_CASE( append_with_reserve_budget )
+{
+    counted_pidl pidl;
+    pidl.reserve(256);
+
+    allocation_probe probe;
+    for (int i = 0; i < 5; ++i)
+    {
+        pidl.append(fake_pidl<IDRELATIVE>("item"));
+    }
+    BOOST_CHECK_EQUAL(probe.stats().allocations, 0U);
+    BOOST_CHECK_EQUAL(pidl.item_count(), 5U);
+}
+
+BOOST_AUTO_TEST_CASE( shared_pidl_copies_dont_allocate )
+{
+    basic_shared_pidl<IDABSOLUTE, counting_ahalloc> shared(
+        counted_apidl(fake_pidl<IDABSOLUTE>(three_items())));
+
+    allocation_probe probe;
+    vector< basic_shared_pidl<IDABSOLUTE, counting_ahalloc> > copies(
+        10, shared);
+    BOOST_CHECK_EQUAL(shared.use_count(), 11);
+    // Only the vector's own storage, which isn't counted
+    BOOST_CHECK_EQUAL(probe.stats().allocations, 0U);
+}
+
+/**
+ * Wrapping a stateful allocator passes its state through.
+ */
+BOOST_AUTO_TEST_CASE( wraps_arena )
+{
+    typedef counting_alloc<IDABSOLUTE, arena_alloc<IDABSOLUTE> >
+        counting_arena_alloc;
+
+    pidl_arena arena;
+    allocation_probe probe;
+    {
+        basic_pidl<IDABSOLUTE, counting_arena_alloc> pidl(
+            fake_pidl<IDABSOLUTE>(three_items()),
+            counting_arena_alloc(arena_alloc<IDABSOLUTE>(arena)));
+
+        BOOST_CHECK(
+            binary_equal_pidls(
+                pidl.get(), fake_pidl<IDABSOLUTE>(three_items())));
+        BOOST_CHECK(pidl.get_allocator().inner() ==
+                    arena_alloc<IDABSOLUTE>(arena));
+    }
+
+    BOOST_CHECK_EQUAL(probe.stats().allocations, 1U);
+    BOOST_CHECK_GT(arena.bytes_allocated(), 0U);
+}
+
+BOOST_AUTO_TEST_CASE( rebound_allocators_equal )
+{
+    counting_ahalloc alloc;
+    counting_ahalloc::rebind<IDCHILD>::other child(alloc);
+    BOOST_CHECK(alloc == child);
+    BOOST_CHECK(!(alloc != child));
+}
+
+BOOST_AUTO_TEST_SUITE_END();
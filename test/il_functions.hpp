@@ -0,0 +1,157 @@
+/**
+    @file
+
+    Shell IL* functions used as a reference by the PIDL tests.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#ifndef WASHER_TEST_IL_FUNCTIONS_HPP
+#define WASHER_TEST_IL_FUNCTIONS_HPP
+#pragma once
+
+#ifdef _WIN32
+
+#include <ShlObj.h> // ILClone etc.
+
+#else
+
+#include <washer/shell/itemidlist.hpp> // Raw PIDL types
+
+#include <cstdlib> // malloc, free
+#include <cstring> // memcpy
+
+/**
+ * @name  Reference IL* functions
+ *
+ * The PIDL tests check washer's PIDL manipulation against the shell's own
+ * IL* functions.  Those only exist on Windows so, elsewhere, these stand in
+ * for them.  They are deliberately naive, walking the list byte-by-byte
+ * exactly as the documentation describes, so that they share as little as
+ * possible with the code under test.
+ *
+ * PIDLs they return are allocated with malloc and must be freed with ILFree.
+ */
+// @{
+
+namespace washer {
+namespace test {
+namespace detail {
+
+    inline USHORT item_size(const void* item)
+    {
+        USHORT cb;
+        std::memcpy(&cb, item, sizeof(cb));
+        return cb;
+    }
+
+}}} // namespace washer::test::detail
+
+inline UINT ILGetSize(PCUIDLIST_RELATIVE pidl)
+{
+    if (!pidl)
+        return 0;
+
+    const BYTE* item = reinterpret_cast<const BYTE*>(pidl);
+    UINT size = sizeof(USHORT);
+    while (USHORT cb = washer::test::detail::item_size(item))
+    {
+        size += cb;
+        item += cb;
+    }
+
+    return size;
+}
+
+inline PIDLIST_RELATIVE ILClone(PCUIDLIST_RELATIVE pidl)
+{
+    if (!pidl)
+        return NULL;
+
+    UINT size = ILGetSize(pidl);
+    void* clone = std::malloc(size);
+    if (clone)
+        std::memcpy(clone, pidl, size);
+    return static_cast<PIDLIST_RELATIVE>(clone);
+}
+
+inline PIDLIST_ABSOLUTE ILCombine(
+    PCIDLIST_ABSOLUTE pidl1, PCUIDLIST_RELATIVE pidl2)
+{
+    if (!pidl1 && !pidl2)
+        return NULL;
+    if (!pidl1)
+        return static_cast<PIDLIST_ABSOLUTE>(ILClone(pidl2));
+    if (!pidl2)
+        return static_cast<PIDLIST_ABSOLUTE>(ILClone(pidl1));
+
+    UINT size1 = ILGetSize(pidl1) - sizeof(USHORT);
+    UINT size2 = ILGetSize(pidl2);
+    BYTE* combined = static_cast<BYTE*>(std::malloc(size1 + size2));
+    if (combined)
+    {
+        std::memcpy(combined, pidl1, size1);
+        std::memcpy(combined + size1, pidl2, size2);
+    }
+    return reinterpret_cast<PIDLIST_ABSOLUTE>(combined);
+}
+
+inline PUITEMID_CHILD ILFindLastID(PCUIDLIST_RELATIVE pidl)
+{
+    const BYTE* item = reinterpret_cast<const BYTE*>(pidl);
+    const BYTE* last = item;
+    while (USHORT cb = washer::test::detail::item_size(item))
+    {
+        last = item;
+        item += cb;
+    }
+
+    return reinterpret_cast<PUITEMID_CHILD>(const_cast<BYTE*>(last));
+}
+
+inline bool ILRemoveLastID(PUIDLIST_RELATIVE pidl)
+{
+    if (!pidl)
+        return false;
+
+    PUITEMID_CHILD last = ILFindLastID(pidl);
+    if (last->mkid.cb == 0)
+        return false;
+
+    last->mkid.cb = 0;
+    return true;
+}
+
+inline void ILFree(PIDLIST_RELATIVE pidl)
+{
+    std::free(pidl);
+}
+
+// @}
+
+#endif
+
+#endif
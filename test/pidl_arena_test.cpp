@@ -0,0 +1,247 @@
+/**
+    @file
+
+    Unit tests for arena-allocated PIDLs.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#include "pidl_fixtures.hpp" // pidl_fixture, binary_equal_pidls
+
+#include <washer/shell/pidl_arena.hpp> // test subject
+
+#include <boost/mpl/list.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_case_template.hpp>
+
+#include <stdexcept> // logic_error
+#include <string>
+#include <vector>
+
+using namespace washer::shell::pidl;
+
+using washer::test::binary_equal_pidls;
+using washer::test::pidl_fixture;
+
+using std::string;
+using std::vector;
+
+namespace {
+
+    typedef ITEMIDLIST_RELATIVE IDRELATIVE;
+    typedef ITEMIDLIST_ABSOLUTE IDABSOLUTE;
+    typedef ITEMID_CHILD IDCHILD;
+
+    typedef boost::mpl::list<IDRELATIVE, IDABSOLUTE, IDCHILD> pidl_types;
+    typedef boost::mpl::list<IDRELATIVE, IDABSOLUTE> adult_pidl_types;
+
+    template<typename T>
+    struct arena_pidl
+    {
+        typedef basic_pidl<T, arena_alloc<T> > type;
+    };
+
+    /**
+     * Was the PIDL allocated from the arena?
+     */
+    template<typename T, typename Alloc>
+    bool from_arena(const basic_pidl<T, Alloc>& pidl, const pidl_arena& arena)
+    {
+        return pidl.get_allocator().arena() == &arena;
+    }
+}
+
+BOOST_FIXTURE_TEST_SUITE(pidl_arena_tests, pidl_fixture)
+
+/**
+ * PIDLs are allocated one after another from the arena's block.
+ */
+BOOST_AUTO_TEST_CASE( bump_allocation )
+{
+    pidl_arena arena;
+
+    void* first = arena.allocate(10);
+    void* second = arena.allocate(3);
+    void* third = arena.allocate(1);
+
+    BOOST_CHECK_EQUAL(
+        static_cast<BYTE*>(second) - static_cast<BYTE*>(first), 16);
+    BOOST_CHECK_EQUAL(
+        static_cast<BYTE*>(third) - static_cast<BYTE*>(second), 8);
+    BOOST_CHECK_EQUAL(arena.bytes_allocated(), 32U);
+    BOOST_CHECK_EQUAL(arena.block_count(), 1U);
+}
+
+/**
+ * Filling a block moves on to a new one.  Releasing keeps only the first,
+ * which is reused.
+ */
+BOOST_AUTO_TEST_CASE( blocks )
+{
+    pidl_arena arena(64);
+
+    void* first = arena.allocate(32);
+    arena.allocate(32);
+    arena.allocate(32);
+    BOOST_CHECK_EQUAL(arena.block_count(), 2U);
+
+    arena.allocate(1000);
+    BOOST_CHECK_EQUAL(arena.block_count(), 3U);
+
+    arena.release();
+    BOOST_CHECK_EQUAL(arena.block_count(), 1U);
+    BOOST_CHECK_EQUAL(arena.bytes_allocated(), 0U);
+
+    BOOST_CHECK_EQUAL(arena.allocate(32), first);
+    BOOST_CHECK_EQUAL(arena.block_count(), 1U);
+}
+
+/**
+ * An allocator without an arena can't allocate.
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE( no_arena, T, pidl_types )
+{
+    typename arena_pidl<T>::type pidl;
+    BOOST_CHECK(!pidl);
+    BOOST_CHECK_THROW(pidl = fake_pidl<T>("item"), std::logic_error);
+}
+
+/**
+ * Wrappers copy PIDLs into the arena they are given.
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE( create, T, pidl_types )
+{
+    pidl_arena arena;
+    const T* raw = fake_pidl<T>("item");
+
+    typename arena_pidl<T>::type pidl(raw, arena_alloc<T>(arena));
+
+    BOOST_CHECK(from_arena(pidl, arena));
+    BOOST_CHECK(binary_equal_pidls(pidl.get(), raw));
+    BOOST_CHECK_EQUAL(arena.bytes_allocated(), 8U);
+}
+
+/**
+ * Copies share the original's arena.  Assigning copies into the target's
+ * own arena.
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE( copy, T, pidl_types )
+{
+    pidl_arena arena;
+    pidl_arena other_arena;
+    const T* raw = fake_pidl<T>("item");
+
+    typename arena_pidl<T>::type pidl(raw, arena_alloc<T>(arena));
+    typename arena_pidl<T>::type copy(pidl);
+    BOOST_CHECK(from_arena(copy, arena));
+    BOOST_CHECK(binary_equal_pidls(copy.get(), raw));
+
+    typename arena_pidl<T>::type assigned((arena_alloc<T>(other_arena)));
+    assigned = pidl;
+    BOOST_CHECK(from_arena(assigned, other_arena));
+    BOOST_CHECK(binary_equal_pidls(assigned.get(), raw));
+    BOOST_CHECK_EQUAL(other_arena.bytes_allocated(), 8U);
+}
+
+/**
+ * Swapping wrappers from different arenas exchanges the PIDLs and the
+ * arenas without copying.
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE( swap_arenas, T, pidl_types )
+{
+    pidl_arena arena;
+    pidl_arena other_arena;
+
+    typename arena_pidl<T>::type pidl(
+        fake_pidl<T>("item"), arena_alloc<T>(arena));
+    typename arena_pidl<T>::type other(
+        fake_pidl<T>("meti"), arena_alloc<T>(other_arena));
+
+    const T* raw = pidl.get();
+    const T* other_raw = other.get();
+
+    pidl.swap(other);
+
+    BOOST_CHECK_EQUAL(pidl.get(), other_raw);
+    BOOST_CHECK_EQUAL(other.get(), raw);
+    BOOST_CHECK(from_arena(pidl, other_arena));
+    BOOST_CHECK(from_arena(other, arena));
+    BOOST_CHECK_EQUAL(arena.bytes_allocated(), 8U);
+    BOOST_CHECK_EQUAL(other_arena.bytes_allocated(), 8U);
+}
+
+/**
+ * PIDLs derived from an arena PIDL come from the same arena.
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE( derived_pidls, T, adult_pidl_types )
+{
+    pidl_arena arena;
+
+    typename arena_pidl<T>::type pidl(
+        fake_pidl<T>("one", "two"), arena_alloc<T>(arena));
+
+    BOOST_CHECK(from_arena(pidl.parent(), arena));
+    BOOST_CHECK(from_arena(pidl.last_item(), arena));
+    BOOST_CHECK(from_arena(pidl + pidl.last_item(), arena));
+    BOOST_CHECK(from_arena(pidl + fake_pidl<IDCHILD>("three"), arena));
+
+    typename arena_pidl<IDRELATIVE>::type relative = pidl.last_item();
+    BOOST_CHECK(from_arena(relative, arena));
+
+    pidl += fake_pidl<IDCHILD>("three");
+    BOOST_CHECK(from_arena(pidl, arena));
+    BOOST_CHECK_EQUAL(pidl.item_count(), 3U);
+}
+
+/**
+ * Releasing the arena after its PIDLs are gone lets a new batch reuse
+ * the memory.
+ */
+BOOST_AUTO_TEST_CASE( batch )
+{
+    pidl_arena arena;
+    const IDCHILD* raw = fake_pidl<IDCHILD>("child");
+
+    for (int batch = 0; batch < 3; ++batch)
+    {
+        {
+            vector<arena_cpidl_t> children(
+                1000, arena_cpidl_t(arena_alloc<IDCHILD>(arena)));
+            for (size_t i = 0; i < children.size(); ++i)
+            {
+                children[i] = raw;
+            }
+
+            BOOST_CHECK(binary_equal_pidls(children.back().get(), raw));
+            BOOST_CHECK_EQUAL(arena.bytes_allocated(), 1000U * 16U);
+        }
+
+        arena.release();
+        BOOST_CHECK_EQUAL(arena.block_count(), 1U);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,261 @@
+/**
+    @file
+
+    Tests for PIDL arrays.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#include "pidl_fixtures.hpp" // pidl_fixture, binary_equal_pidls, heap_pidl
+
+#include <washer/shell/pidl_array.hpp> // test subject
+
+#include <boost/move/move.hpp> // boost::move
+#include <boost/test/unit_test.hpp>
+
+#include <stdexcept> // invalid_argument, out_of_range
+#include <string>
+#include <vector>
+
+using namespace washer::shell::pidl;
+
+using washer::test::binary_equal_pidls;
+using washer::test::heap_pidl;
+using washer::test::pidl_fixture;
+
+using std::string;
+using std::vector;
+
+namespace {
+
+    typedef ITEMIDLIST_RELATIVE IDRELATIVE;
+    typedef ITEMIDLIST_ABSOLUTE IDABSOLUTE;
+    typedef ITEMID_CHILD IDCHILD;
+
+    typedef heap_pidl<IDCHILD>::type chpidl_t;
+    typedef basic_packed_pidl_array<IDCHILD, newdelete_alloc<IDCHILD> >
+        heap_packed_array;
+
+    class array_fixture : public pidl_fixture
+    {
+    public:
+
+        array_fixture()
+        {
+            const char* names[] = { "one", "two", "three", "four" };
+            for (size_t i = 0; i < 4; ++i)
+            {
+                m_children.push_back(fake_pidl<IDCHILD>(names[i]));
+            }
+        }
+
+        const vector<const IDCHILD*>& children() const
+        {
+            return m_children;
+        }
+
+        /**
+         * Check the array holds copies of the children, in order.
+         */
+        template<typename Array>
+        void check_children(const Array& array)
+        {
+            BOOST_REQUIRE_EQUAL(array.size(), m_children.size());
+            for (size_t i = 0; i < m_children.size(); ++i)
+            {
+                BOOST_CHECK(binary_equal_pidls(array[i], m_children[i]));
+                BOOST_CHECK(array[i] != m_children[i]);
+                BOOST_CHECK(array.as_array()[i] == array[i]);
+            }
+        }
+
+    private:
+        vector<const IDCHILD*> m_children;
+    };
+}
+
+BOOST_FIXTURE_TEST_SUITE(pidl_array_tests, array_fixture)
+
+/**
+ * The unpacked array points at the wrappers' PIDLs.
+ */
+BOOST_AUTO_TEST_CASE( wrapper_array )
+{
+    vector<chpidl_t> wrapped(children().begin(), children().end());
+    pidl_array<chpidl_t> array(wrapped.begin(), wrapped.end());
+
+    BOOST_REQUIRE_EQUAL(array.size(), 4U);
+    for (size_t i = 0; i < 4; ++i)
+    {
+        BOOST_CHECK(array.as_array()[i] == wrapped[i].get());
+    }
+}
+
+BOOST_AUTO_TEST_CASE( empty_packed )
+{
+    packed_cpidl_array array;
+    BOOST_CHECK(array.empty());
+    BOOST_CHECK(array.as_array() == NULL);
+    BOOST_CHECK(array.begin() == array.end());
+    BOOST_CHECK_THROW(array.at(0), std::out_of_range);
+
+    vector<const IDCHILD*> none;
+    packed_cpidl_array from_empty_range(none.begin(), none.end());
+    BOOST_CHECK(from_empty_range.empty());
+    BOOST_CHECK(from_empty_range.as_array() == NULL);
+}
+
+/**
+ * The packed array owns copies of the PIDLs so the originals can go.
+ */
+BOOST_AUTO_TEST_CASE( packed_from_raw )
+{
+    heap_packed_array array(children().begin(), children().end());
+    check_children(array);
+    BOOST_CHECK_THROW(array.at(4), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE( packed_outlives_wrappers )
+{
+    packed_cpidl_array* array;
+    {
+        vector<chpidl_t> wrapped(children().begin(), children().end());
+        array = new packed_cpidl_array(wrapped.begin(), wrapped.end());
+    }
+
+    check_children(*array);
+    delete array;
+}
+
+/**
+ * The PIDLs are laid out one after another.
+ */
+BOOST_AUTO_TEST_CASE( packed_contiguous )
+{
+    vector<cpidl_view> views(children().begin(), children().end());
+    packed_cpidl_array array(views.begin(), views.end());
+
+    check_children(array);
+    for (size_t i = 1; i < array.size(); ++i)
+    {
+        const BYTE* previous = reinterpret_cast<const BYTE*>(array[i - 1]);
+        BOOST_CHECK(
+            previous + array.view(i - 1).size() ==
+            reinterpret_cast<const BYTE*>(array[i]));
+    }
+}
+
+/**
+ * Views know their size without measuring.
+ */
+BOOST_AUTO_TEST_CASE( packed_views )
+{
+    vector<const IDRELATIVE*> pidls;
+    pidls.push_back(fake_pidl<IDRELATIVE>("a", "bb"));
+    pidls.push_back(empty_pidl<IDRELATIVE>());
+    pidls.push_back(fake_pidl<IDCHILD>("ccc"));
+
+    packed_pidl_array array(pidls.begin(), pidls.end());
+
+    BOOST_REQUIRE_EQUAL(array.size(), 3U);
+    for (size_t i = 0; i < 3; ++i)
+    {
+        BOOST_CHECK_EQUAL(array.view(i).size(), raw_pidl::size(pidls[i]));
+        BOOST_CHECK(binary_equal_pidls(array.view(i).data(), pidls[i]));
+    }
+    BOOST_CHECK_EQUAL(array.view(0).item_count(), 2U);
+    BOOST_CHECK(array.view(1).empty());
+    BOOST_CHECK_EQUAL(array.view(2).item_count(), 1U);
+}
+
+/**
+ * Iteration runs over the pointer array.
+ */
+BOOST_AUTO_TEST_CASE( packed_iterate )
+{
+    packed_cpidl_array array(children().begin(), children().end());
+
+    BOOST_CHECK_EQUAL(array.end() - array.begin(), 4);
+    size_t i = 0;
+    for (packed_cpidl_array::const_iterator it = array.begin();
+         it != array.end(); ++it, ++i)
+    {
+        BOOST_CHECK(binary_equal_pidls(*it, children()[i]));
+    }
+}
+
+/**
+ * Copies have their own block whose pointers point into it.
+ */
+BOOST_AUTO_TEST_CASE( packed_copy )
+{
+    heap_packed_array original(children().begin(), children().end());
+    heap_packed_array copy(original);
+
+    check_children(copy);
+    BOOST_CHECK(copy.as_array() != original.as_array());
+    for (size_t i = 0; i < copy.size(); ++i)
+    {
+        BOOST_CHECK(copy[i] != original[i]);
+    }
+
+    heap_packed_array assigned;
+    assigned = copy;
+    check_children(assigned);
+}
+
+BOOST_AUTO_TEST_CASE( packed_move )
+{
+    heap_packed_array original(children().begin(), children().end());
+    const heap_packed_array::value_type* pointers = original.as_array();
+
+    heap_packed_array moved(boost::move(original));
+    BOOST_CHECK(original.empty());
+    BOOST_CHECK(moved.as_array() == pointers);
+
+    heap_packed_array assigned;
+    assigned = boost::move(moved);
+    BOOST_CHECK(moved.empty());
+    BOOST_CHECK(assigned.as_array() == pointers);
+    check_children(assigned);
+}
+
+/**
+ * Child arrays only take single items.
+ */
+BOOST_AUTO_TEST_CASE( packed_child_type_check )
+{
+    vector<cpidl_view> views;
+    views.push_back(cpidl_view(children()[0]));
+    const IDRELATIVE* two = fake_pidl<IDRELATIVE>("x", "y");
+    views.push_back(cpidl_view(
+        reinterpret_cast<const IDCHILD*>(two), raw_pidl::size(two) - 2, 2));
+
+    BOOST_CHECK_THROW(
+        heap_packed_array(views.begin(), views.end()), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,282 @@
+/**
+    @file
+
+    Tests for joining a parent PIDL to many children at once.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#include "pidl_fixtures.hpp" // pidl_fixture, binary_equal_pidls, heap_pidl
+
+#include <washer/shell/pidl_arena.hpp> // pidl_arena, arena_alloc
+#include <washer/shell/pidl_batch.hpp> // test subject
+
+#include <boost/move/move.hpp> // boost::move
+#include <boost/test/unit_test.hpp>
+
+#include <stdexcept> // out_of_range
+#include <string>
+#include <vector>
+
+using namespace washer::shell::pidl;
+
+using washer::test::binary_equal_pidls;
+using washer::test::heap_pidl;
+using washer::test::pidl_fixture;
+
+using std::string;
+using std::vector;
+
+namespace {
+
+    typedef ITEMIDLIST_RELATIVE IDRELATIVE;
+    typedef ITEMIDLIST_ABSOLUTE IDABSOLUTE;
+    typedef ITEMID_CHILD IDCHILD;
+
+    class batch_fixture : public pidl_fixture
+    {
+    public:
+
+        batch_fixture()
+        {
+            m_parent = fake_pidl<IDABSOLUTE>("folder", "subfolder");
+
+            const char* names[] = { "a", "second", "3rd child" };
+            for (size_t i = 0; i < 3; ++i)
+            {
+                m_children.push_back(fake_pidl<IDCHILD>(names[i]));
+            }
+        }
+
+        const IDABSOLUTE* parent() const
+        {
+            return m_parent;
+        }
+
+        const vector<const IDCHILD*>& children() const
+        {
+            return m_children;
+        }
+
+        /**
+         * Check a batch holds the same PIDLs as joining each child with +.
+         */
+        template<typename Batch>
+        void check_joined(const Batch& batch)
+        {
+            BOOST_REQUIRE_EQUAL(batch.size(), m_children.size());
+            for (size_t i = 0; i < m_children.size(); ++i)
+            {
+                apidl_t expected = apidl_t(m_parent) + m_children[i];
+                BOOST_CHECK(binary_equal_pidls(batch.get(i), expected.get()));
+                BOOST_CHECK(batch[i].data() == batch.get(i));
+                BOOST_CHECK_EQUAL(batch[i].size(), expected.size());
+                BOOST_CHECK_EQUAL(batch[i].item_count(), 3U);
+            }
+        }
+
+    private:
+        const IDABSOLUTE* m_parent;
+        vector<const IDCHILD*> m_children;
+    };
+}
+
+BOOST_FIXTURE_TEST_SUITE(pidl_batch_tests, batch_fixture)
+
+BOOST_AUTO_TEST_CASE( empty_batch )
+{
+    apidl_batch batch;
+    BOOST_CHECK(batch.empty());
+    BOOST_CHECK_EQUAL(batch.size(), 0U);
+    BOOST_CHECK(batch.begin() == batch.end());
+    BOOST_CHECK_THROW(batch.at(0), std::out_of_range);
+}
+
+/**
+ * Each result is the parent followed by one child, null-terminated.
+ */
+BOOST_AUTO_TEST_CASE( join_raw )
+{
+    apidl_batch batch = join_all(
+        parent(), children().begin(), children().end());
+
+    check_joined(batch);
+}
+
+BOOST_AUTO_TEST_CASE( join_wrappers )
+{
+    apidl_t wrapped_parent(parent());
+    vector<cpidl_t> wrapped_children(children().begin(), children().end());
+
+    apidl_batch batch = join_all(
+        wrapped_parent, wrapped_children.begin(), wrapped_children.end());
+
+    check_joined(batch);
+}
+
+BOOST_AUTO_TEST_CASE( join_views )
+{
+    vector<cpidl_view> child_views(children().begin(), children().end());
+
+    apidl_batch batch = join_all(
+        apidl_view(parent()), child_views.begin(), child_views.end());
+
+    check_joined(batch);
+}
+
+/**
+ * All the results live in one block: the PIDLs follow each other.
+ */
+BOOST_AUTO_TEST_CASE( contiguous )
+{
+    apidl_batch batch = join_all(
+        parent(), children().begin(), children().end());
+
+    for (size_t i = 1; i < batch.size(); ++i)
+    {
+        const BYTE* previous = reinterpret_cast<const BYTE*>(batch.get(i - 1));
+        const BYTE* current = reinterpret_cast<const BYTE*>(batch.get(i));
+        BOOST_CHECK(previous + batch[i - 1].size() == current);
+    }
+
+    size_t pidl_bytes = 0;
+    for (size_t i = 0; i < batch.size(); ++i)
+    {
+        pidl_bytes += batch[i].size();
+    }
+    BOOST_CHECK_GT(batch.allocated_bytes(), pidl_bytes);
+}
+
+/**
+ * Iteration visits the results in the order of the children.
+ */
+BOOST_AUTO_TEST_CASE( iterate )
+{
+    apidl_batch batch = join_all(
+        parent(), children().begin(), children().end());
+
+    size_t i = 0;
+    for (apidl_batch::const_iterator it = batch.begin(); it != batch.end();
+         ++it, ++i)
+    {
+        BOOST_CHECK((*it).data() == batch.get(i));
+    }
+    BOOST_CHECK_EQUAL(i, 3U);
+    BOOST_CHECK_EQUAL(batch.end() - batch.begin(), 3);
+    BOOST_CHECK((*(batch.end() - 1)).data() == batch.get(2));
+
+    // Results can be copied out to outlive the batch
+    apidl_t copy(batch[1]);
+    BOOST_CHECK(binary_equal_pidls(copy.get(), batch.get(1)));
+}
+
+/**
+ * An empty or NULL parent gives copies of the children.
+ */
+BOOST_AUTO_TEST_CASE( join_to_empty_parent )
+{
+    apidl_batch from_empty = join_all(
+        empty_pidl<IDABSOLUTE>(), children().begin(), children().end());
+    apidl_batch from_null(
+        static_cast<const IDABSOLUTE*>(NULL),
+        children().begin(), children().end());
+
+    for (size_t i = 0; i < children().size(); ++i)
+    {
+        BOOST_CHECK(binary_equal_pidls(from_empty.get(i), children()[i]));
+        BOOST_CHECK(binary_equal_pidls(from_null.get(i), children()[i]));
+        BOOST_CHECK_EQUAL(from_empty[i].item_count(), 1U);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( join_no_children )
+{
+    vector<const IDCHILD*> none;
+    apidl_batch batch = join_all(parent(), none.begin(), none.end());
+
+    BOOST_CHECK(batch.empty());
+    BOOST_CHECK(batch.begin() == batch.end());
+}
+
+/**
+ * Joining to a relative parent produces relative PIDLs.
+ */
+BOOST_AUTO_TEST_CASE( join_relative )
+{
+    const IDRELATIVE* relative = fake_pidl<IDRELATIVE>("rel");
+    vector<const IDRELATIVE*> tails;
+    tails.push_back(fake_pidl<IDRELATIVE>("x", "y"));
+
+    pidl_batch batch = join_all(relative, tails.begin(), tails.end());
+
+    pidl_t expected = pidl_t(relative) + tails[0];
+    BOOST_CHECK(binary_equal_pidls(batch.get(0), expected.get()));
+    BOOST_CHECK_EQUAL(batch[0].item_count(), 3U);
+}
+
+/**
+ * Moving hands over the block.
+ */
+BOOST_AUTO_TEST_CASE( move )
+{
+    apidl_batch batch = join_all(
+        parent(), children().begin(), children().end());
+    const IDABSOLUTE* first = batch.get(0);
+
+    apidl_batch moved(boost::move(batch));
+    BOOST_CHECK(batch.empty());
+    BOOST_CHECK(moved.get(0) == first);
+
+    apidl_batch assigned;
+    assigned = boost::move(moved);
+    BOOST_CHECK(moved.empty());
+    BOOST_CHECK(assigned.get(0) == first);
+    check_joined(assigned);
+}
+
+/**
+ * The block comes from the parent's allocator.
+ */
+BOOST_AUTO_TEST_CASE( parent_allocator )
+{
+    heap_pidl<IDABSOLUTE>::type heap_parent(parent());
+    check_joined(
+        join_all(heap_parent, children().begin(), children().end()));
+
+    pidl_arena arena;
+    basic_pidl<IDABSOLUTE, arena_alloc<IDABSOLUTE> > arena_parent(
+        parent(), arena_alloc<IDABSOLUTE>(arena));
+    size_t before = arena.bytes_allocated();
+
+    basic_pidl_batch<IDABSOLUTE, arena_alloc<IDABSOLUTE> > batch = join_all(
+        arena_parent, children().begin(), children().end());
+
+    check_joined(batch);
+    BOOST_CHECK(batch.get_allocator().arena() == &arena);
+    BOOST_CHECK_GE(arena.bytes_allocated() - before, batch.allocated_bytes());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
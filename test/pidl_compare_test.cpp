@@ -0,0 +1,324 @@
+/**
+    @file
+
+    Tests for PIDL equality, ordering and hashing.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#include "pidl_fixtures.hpp" // pidl_fixture, heap_pidl
+
+#include <washer/shell/pidl_compare.hpp> // test subject
+
+#include <boost/functional/hash.hpp> // hash
+#include <boost/mpl/list.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_case_template.hpp>
+#include <boost/unordered_set.hpp>
+
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace washer::shell::pidl;
+
+using washer::test::heap_pidl;
+using washer::test::pidl_fixture;
+
+using std::string;
+using std::vector;
+
+namespace {
+
+    typedef ITEMIDLIST_RELATIVE IDRELATIVE;
+    typedef ITEMIDLIST_ABSOLUTE IDABSOLUTE;
+    typedef ITEMID_CHILD IDCHILD;
+
+    typedef boost::mpl::list<IDRELATIVE, IDABSOLUTE, IDCHILD> pidl_types;
+
+    vector<string> items(const string& a, const string& b, const string& c)
+    {
+        vector<string> v;
+        v.push_back(a);
+        v.push_back(b);
+        v.push_back(c);
+        return v;
+    }
+
+    int sign(int value)
+    {
+        return (value > 0) - (value < 0);
+    }
+}
+
+BOOST_FIXTURE_TEST_SUITE(pidl_compare_tests, pidl_fixture)
+
+/**
+ * Separately-allocated copies of the same bytes are equal.
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE( equal_by_value, T, pidl_types )
+{
+    typename heap_pidl<T>::type pidl1(fake_pidl<T>("item"));
+    typename heap_pidl<T>::type pidl2(fake_pidl<T>("item"));
+
+    BOOST_REQUIRE(pidl1.get() != pidl2.get());
+    BOOST_CHECK(pidl1 == pidl2);
+    BOOST_CHECK(!(pidl1 != pidl2));
+    BOOST_CHECK(!(pidl1 < pidl2));
+    BOOST_CHECK(!(pidl2 < pidl1));
+    BOOST_CHECK(pidl1 <= pidl2);
+    BOOST_CHECK(pidl1 >= pidl2);
+    BOOST_CHECK_EQUAL(compare(pidl1, pidl2), 0);
+}
+
+/**
+ * PIDLs differing in any byte are unequal.
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE( unequal_contents, T, pidl_types )
+{
+    typename heap_pidl<T>::type pidl1(fake_pidl<T>("item"));
+    typename heap_pidl<T>::type pidl2(fake_pidl<T>("itex"));
+
+    BOOST_CHECK(pidl1 != pidl2);
+    BOOST_CHECK(!(pidl1 == pidl2));
+}
+
+/**
+ * NULL and empty PIDLs have no items so are equal.
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE( null_equals_empty, T, pidl_types )
+{
+    typename heap_pidl<T>::type null_pidl;
+    typename heap_pidl<T>::type empty(empty_pidl<T>());
+
+    BOOST_CHECK(null_pidl == empty);
+    BOOST_CHECK_EQUAL(compare(null_pidl, empty), 0);
+    BOOST_CHECK_EQUAL(hash_value(null_pidl), hash_value(empty));
+    BOOST_CHECK(raw_pidl::equal(null_pidl.get(), empty.get()));
+}
+
+/**
+ * Wrappers of different PIDL types and allocators compare by bytes.
+ */
+BOOST_AUTO_TEST_CASE( compare_mixed_types )
+{
+    heap_pidl<IDABSOLUTE>::type absolute(fake_pidl<IDABSOLUTE>("item"));
+    cpidl_t child(fake_pidl<IDCHILD>("item"));
+
+    BOOST_CHECK(absolute == child);
+    BOOST_CHECK(child == absolute);
+}
+
+/**
+ * The ordering is lexicographical by byte so a PIDL sorts before the PIDLs
+ * that extend it and after any PIDL with a smaller byte at the first
+ * difference.
+ */
+BOOST_AUTO_TEST_CASE( ordering )
+{
+    apidl_t a(fake_pidl<IDABSOLUTE>("a"));
+    apidl_t ab(fake_pidl<IDABSOLUTE>("a", "b"));
+    apidl_t b(fake_pidl<IDABSOLUTE>("b"));
+    apidl_t empty(empty_pidl<IDABSOLUTE>());
+
+    BOOST_CHECK(empty < a);
+    BOOST_CHECK(a < ab);
+    BOOST_CHECK(ab < b);
+    BOOST_CHECK(a < b);
+    BOOST_CHECK(b > ab);
+    BOOST_CHECK(a <= ab);
+    BOOST_CHECK(b >= a);
+
+    BOOST_CHECK_LT(compare(a, ab), 0);
+    BOOST_CHECK_GT(compare(b, ab), 0);
+}
+
+/**
+ * Comparing raw PIDLs gives the same answers as comparing wrappers.
+ */
+BOOST_AUTO_TEST_CASE( raw_matches_wrapped )
+{
+    const IDRELATIVE* raws[] = {
+        empty_pidl<IDRELATIVE>(),
+        fake_pidl<IDRELATIVE>("a"),
+        fake_pidl<IDRELATIVE>("a", "b"),
+        fake_pidl<IDRELATIVE>("ab"),
+        fake_pidl<IDRELATIVE>("b"),
+        fake_pidl<IDRELATIVE>(items("a", "b", "c"))
+    };
+    const size_t count = sizeof(raws) / sizeof(raws[0]);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        for (size_t j = 0; j < count; ++j)
+        {
+            pidl_t lhs(raws[i]);
+            pidl_t rhs(raws[j]);
+
+            BOOST_CHECK_EQUAL(
+                sign(raw_pidl::compare(raws[i], raws[j])),
+                sign(compare(lhs, rhs)));
+            BOOST_CHECK_EQUAL(raw_pidl::equal(raws[i], raws[j]), lhs == rhs);
+            BOOST_CHECK_EQUAL(raw_pidl::equal(raws[i], raws[j]), i == j);
+            BOOST_CHECK_EQUAL(
+                sign(raw_pidl::compare(raws[i], raws[j])),
+                sign(compare(view(raws[i]), view(raws[j]))));
+        }
+    }
+}
+
+/**
+ * Equal PIDLs hash equally whether raw, wrapped or viewed.
+ */
+BOOST_AUTO_TEST_CASE( hash_matches_equality )
+{
+    const IDABSOLUTE* raw1 = fake_pidl<IDABSOLUTE>(items("a", "bc", "def"));
+    const IDABSOLUTE* raw2 = fake_pidl<IDABSOLUTE>(items("a", "bc", "def"));
+    apidl_t pidl(raw1);
+
+    BOOST_CHECK_EQUAL(raw_pidl::hash(raw1), raw_pidl::hash(raw2));
+    BOOST_CHECK_EQUAL(raw_pidl::hash(raw1), hash_value(pidl));
+    BOOST_CHECK_EQUAL(raw_pidl::hash(raw1), hash_value(view(pidl)));
+    BOOST_CHECK_EQUAL(raw_pidl::hash(raw1), pidl_hash()(raw2));
+}
+
+/**
+ * The hash looks at every byte, including those after the last whole word.
+ */
+BOOST_AUTO_TEST_CASE( hash_covers_every_byte )
+{
+    for (size_t length = 1; length < 20; ++length)
+    {
+        string text(length, 'x');
+        std::size_t original = raw_pidl::hash(fake_pidl<IDCHILD>(text));
+
+        for (size_t i = 0; i < length; ++i)
+        {
+            string changed = text;
+            changed[i] = 'y';
+            BOOST_CHECK_NE(
+                raw_pidl::hash(fake_pidl<IDCHILD>(changed)), original);
+        }
+    }
+}
+
+/**
+ * The hash depends on the length so a PIDL of zero bytes doesn't collide
+ * with a shorter one.
+ */
+BOOST_AUTO_TEST_CASE( hash_covers_length )
+{
+    BOOST_CHECK_NE(
+        raw_pidl::hash(fake_pidl<IDCHILD>(string(3, '\0'))),
+        raw_pidl::hash(fake_pidl<IDCHILD>(string(4, '\0'))));
+}
+
+/**
+ * An iterator range covers the items it spans, not the rest of the list.
+ */
+BOOST_AUTO_TEST_CASE( iterator_ranges )
+{
+    const IDRELATIVE* whole = fake_pidl<IDRELATIVE>(items("a", "b", "c"));
+    const IDRELATIVE* bc = fake_pidl<IDRELATIVE>("b", "c");
+    const IDRELATIVE* b = fake_pidl<IDRELATIVE>("b");
+
+    raw_pidl_iterator first(whole);
+    raw_pidl_iterator second = first;
+    ++second;
+    raw_pidl_iterator third = second;
+    ++third;
+
+    raw_pidl_iterator bc_first(bc);
+    raw_pidl_iterator b_first(b);
+    raw_pidl_iterator end;
+
+    BOOST_CHECK(equal(second, end, bc_first, end));
+    BOOST_CHECK(equal(second, third, b_first, end));
+    BOOST_CHECK(!equal(first, third, bc_first, end));
+    BOOST_CHECK_EQUAL(compare(second, end, bc_first, end), 0);
+    BOOST_CHECK_LT(compare(second, third, bc_first, end), 0);
+
+    BOOST_CHECK_EQUAL(hash(second, end), raw_pidl::hash(bc));
+    BOOST_CHECK_EQUAL(hash(second, third), raw_pidl::hash(b));
+    BOOST_CHECK_EQUAL(hash(end, end), raw_pidl::hash(empty_pidl<IDRELATIVE>()));
+}
+
+/**
+ * boost::hash and, where available, std::hash agree with the PIDL hash.
+ */
+BOOST_AUTO_TEST_CASE( standard_hashers )
+{
+    apidl_t pidl(fake_pidl<IDABSOLUTE>("a", "b"));
+    apidl_view pidl_view(pidl);
+
+    BOOST_CHECK_EQUAL(boost::hash<apidl_t>()(pidl), hash_value(pidl));
+    BOOST_CHECK_EQUAL(boost::hash<apidl_view>()(pidl_view), hash_value(pidl));
+
+#ifndef BOOST_NO_CXX11_HDR_FUNCTIONAL
+    BOOST_CHECK_EQUAL(std::hash<apidl_t>()(pidl), hash_value(pidl));
+    BOOST_CHECK_EQUAL(std::hash<apidl_view>()(pidl_view), hash_value(pidl));
+#endif
+}
+
+/**
+ * Wrappers can key hashed and sorted containers, which then deduplicate
+ * separate copies of a PIDL.
+ */
+BOOST_AUTO_TEST_CASE( containers )
+{
+    boost::unordered_set<apidl_t> hashed;
+    std::set<apidl_t> sorted;
+
+    for (int i = 0; i < 3; ++i)
+    {
+        hashed.insert(apidl_t(fake_pidl<IDABSOLUTE>("a")));
+        hashed.insert(apidl_t(fake_pidl<IDABSOLUTE>("b")));
+        sorted.insert(apidl_t(fake_pidl<IDABSOLUTE>("b")));
+        sorted.insert(apidl_t(fake_pidl<IDABSOLUTE>("a")));
+    }
+
+    BOOST_CHECK_EQUAL(hashed.size(), 2U);
+    BOOST_CHECK_EQUAL(sorted.size(), 2U);
+    BOOST_CHECK(*sorted.begin() == apidl_t(fake_pidl<IDABSOLUTE>("a")));
+}
+
+/**
+ * The function objects take raw PIDLs and wrappers interchangeably.
+ */
+BOOST_AUTO_TEST_CASE( function_objects )
+{
+    const IDABSOLUTE* raw = fake_pidl<IDABSOLUTE>("a");
+    apidl_t pidl(fake_pidl<IDABSOLUTE>("a"));
+    apidl_t later(fake_pidl<IDABSOLUTE>("b"));
+
+    BOOST_CHECK(pidl_equal_to()(raw, pidl));
+    BOOST_CHECK(pidl_equal_to()(pidl, view(raw)));
+    BOOST_CHECK(pidl_less()(raw, later));
+    BOOST_CHECK(!pidl_less()(later, raw));
+    BOOST_CHECK_EQUAL(pidl_hash()(raw), pidl_hash()(pidl));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,355 @@
+/**
+    @file
+
+    Unit tests for the concurrent PIDL-keyed hash map.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#include "pidl_fixtures.hpp" // pidl_fixture
+
+#include <washer/shell/pidl_concurrent_map.hpp> // test subject
+
+#include <boost/lexical_cast.hpp> // lexical_cast
+#include <boost/shared_ptr.hpp> // shared_ptr
+#include <boost/test/unit_test.hpp>
+#include <boost/thread/thread.hpp> // thread_group
+
+#include <stdexcept> // runtime_error
+#include <string>
+#include <vector>
+
+using namespace washer::shell::pidl;
+
+using washer::test::heap_pidl;
+using washer::test::idlist_bytes;
+using washer::test::pidl_fixture;
+
+using boost::lexical_cast;
+using boost::optional;
+
+using std::string;
+using std::vector;
+
+namespace {
+
+    typedef ITEMIDLIST_ABSOLUTE IDABSOLUTE;
+    typedef basic_concurrent_pidl_map<IDABSOLUTE, int> apidl_int_map;
+
+    const IDABSOLUTE* as_apidl(const vector<BYTE>& bytes)
+    {
+        return reinterpret_cast<const IDABSOLUTE*>(&bytes[0]);
+    }
+
+    vector< vector<BYTE> > numbered_pidls(size_t count)
+    {
+        vector< vector<BYTE> > pidls;
+        for (size_t i = 0; i < count; ++i)
+        {
+            vector<string> items;
+            items.push_back("folder");
+            items.push_back(lexical_cast<string>(i));
+            pidls.push_back(idlist_bytes(items));
+        }
+        return pidls;
+    }
+
+    struct constant_factory
+    {
+        constant_factory(int value, int& calls)
+            : m_value(value), m_calls(calls) {}
+
+        int operator()() const
+        {
+            ++m_calls;
+            return m_value;
+        }
+
+    private:
+        int m_value;
+        int& m_calls;
+    };
+
+    struct throwing_factory
+    {
+        int operator()() const
+        {
+            BOOST_THROW_EXCEPTION(std::runtime_error("factory failed"));
+        }
+    };
+
+    /**
+     * Look up every PIDL over and over, adding the missing ones through
+     * find_or_insert and occasionally replacing one, and check each value
+     * found is the one that belongs to its PIDL.
+     */
+    class caching_worker
+    {
+    public:
+        caching_worker(
+            apidl_int_map& map, const vector< vector<BYTE> >& pidls,
+            size_t seed, bool& mismatch)
+            : m_map(map), m_pidls(pidls), m_seed(seed), m_mismatch(mismatch)
+        {}
+
+        void operator()() const
+        {
+            int calls = 0;
+            for (size_t round = 0; round < 100; ++round)
+            {
+                for (size_t i = 0; i < m_pidls.size(); ++i)
+                {
+                    size_t key = (i + m_seed) % m_pidls.size();
+                    const IDABSOLUTE* pidl = as_apidl(m_pidls[key]);
+                    int expected = static_cast<int>(key);
+
+                    if (m_map.find_or_insert(
+                            pidl, constant_factory(expected, calls))
+                        != expected)
+                        m_mismatch = true;
+
+                    if ((round + i) % 13 == 0)
+                        m_map.insert_or_assign(pidl, expected);
+
+                    optional<int> found = m_map.find(pidl);
+                    if (!found || *found != expected)
+                        m_mismatch = true;
+                }
+            }
+        }
+
+    private:
+        apidl_int_map& m_map;
+        const vector< vector<BYTE> >& m_pidls;
+        size_t m_seed;
+        bool& m_mismatch;
+    };
+}
+
+BOOST_FIXTURE_TEST_SUITE(pidl_concurrent_map_tests, pidl_fixture)
+
+BOOST_AUTO_TEST_CASE( empty_map )
+{
+    apidl_int_map map;
+
+    BOOST_CHECK(map.empty());
+    BOOST_CHECK_EQUAL(map.size(), 0U);
+    BOOST_CHECK(!map.find(fake_pidl<IDABSOLUTE>("a")));
+    BOOST_CHECK(!map.contains(fake_pidl<IDABSOLUTE>("a")));
+    BOOST_CHECK(!map.erase(fake_pidl<IDABSOLUTE>("a")));
+}
+
+/**
+ * Insert only adds a value for a key that doesn't have one yet.
+ */
+BOOST_AUTO_TEST_CASE( insert )
+{
+    apidl_int_map map;
+
+    BOOST_CHECK(map.insert(fake_pidl<IDABSOLUTE>("a", "b"), 1));
+    BOOST_CHECK(map.insert(fake_pidl<IDABSOLUTE>("a"), 2));
+    BOOST_CHECK(!map.insert(fake_pidl<IDABSOLUTE>("a", "b"), 3));
+
+    BOOST_CHECK_EQUAL(map.size(), 2U);
+    BOOST_CHECK_EQUAL(*map.find(fake_pidl<IDABSOLUTE>("a", "b")), 1);
+    BOOST_CHECK_EQUAL(*map.find(fake_pidl<IDABSOLUTE>("a")), 2);
+    BOOST_CHECK(!map.find(fake_pidl<IDABSOLUTE>("b")));
+}
+
+BOOST_AUTO_TEST_CASE( insert_or_assign )
+{
+    apidl_int_map map;
+
+    BOOST_CHECK(map.insert_or_assign(fake_pidl<IDABSOLUTE>("a"), 1));
+    BOOST_CHECK(!map.insert_or_assign(fake_pidl<IDABSOLUTE>("a"), 2));
+
+    BOOST_CHECK_EQUAL(map.size(), 1U);
+    BOOST_CHECK_EQUAL(*map.find(fake_pidl<IDABSOLUTE>("a")), 2);
+}
+
+/**
+ * The empty PIDL is a key like any other.
+ */
+BOOST_AUTO_TEST_CASE( empty_pidl_key )
+{
+    apidl_int_map map;
+
+    BOOST_CHECK(map.insert(empty_pidl<IDABSOLUTE>(), 7));
+    BOOST_CHECK(map.insert(fake_pidl<IDABSOLUTE>("a"), 8));
+
+    BOOST_CHECK_EQUAL(*map.find(empty_pidl<IDABSOLUTE>()), 7);
+    BOOST_CHECK(map.erase(empty_pidl<IDABSOLUTE>()));
+    BOOST_CHECK(!map.contains(empty_pidl<IDABSOLUTE>()));
+    BOOST_CHECK(map.contains(fake_pidl<IDABSOLUTE>("a")));
+}
+
+/**
+ * Keys can be given as raw PIDLs, wrappers, views or a more derived PIDL
+ * type and all find the same entry.
+ */
+BOOST_AUTO_TEST_CASE( any_key_form )
+{
+    basic_concurrent_pidl_map<ITEMIDLIST_RELATIVE, int> map;
+
+    heap_pidl<ITEMIDLIST_RELATIVE>::type wrapper(
+        fake_pidl<ITEMIDLIST_RELATIVE>("a", "b"));
+    map.insert(wrapper, 1);
+
+    BOOST_CHECK_EQUAL(
+        *map.find(fake_pidl<ITEMIDLIST_RELATIVE>("a", "b")), 1);
+    BOOST_CHECK_EQUAL(
+        *map.find(basic_pidl_view<ITEMIDLIST_RELATIVE>(wrapper)), 1);
+    BOOST_CHECK(!map.insert(fake_pidl<ITEMIDLIST_ABSOLUTE>("a", "b"), 2));
+
+    BOOST_CHECK(map.insert(fake_pidl<ITEMID_CHILD>("a"), 3));
+    BOOST_CHECK_EQUAL(*map.find(fake_pidl<ITEMIDLIST_RELATIVE>("a")), 3);
+}
+
+BOOST_AUTO_TEST_CASE( erase )
+{
+    apidl_int_map map;
+    map.insert(fake_pidl<IDABSOLUTE>("a"), 1);
+    map.insert(fake_pidl<IDABSOLUTE>("b"), 2);
+
+    BOOST_CHECK(map.erase(fake_pidl<IDABSOLUTE>("a")));
+    BOOST_CHECK(!map.erase(fake_pidl<IDABSOLUTE>("a")));
+
+    BOOST_CHECK_EQUAL(map.size(), 1U);
+    BOOST_CHECK(!map.contains(fake_pidl<IDABSOLUTE>("a")));
+    BOOST_CHECK_EQUAL(*map.find(fake_pidl<IDABSOLUTE>("b")), 2);
+}
+
+/**
+ * Entries survive the shards growing and all go away on clear.
+ */
+BOOST_AUTO_TEST_CASE( many_entries )
+{
+    vector< vector<BYTE> > pidls = numbered_pidls(5000);
+    apidl_int_map map;
+
+    for (size_t i = 0; i < pidls.size(); ++i)
+    {
+        BOOST_REQUIRE(map.insert(as_apidl(pidls[i]), static_cast<int>(i)));
+    }
+    BOOST_CHECK_EQUAL(map.size(), pidls.size());
+
+    for (size_t i = 0; i < pidls.size(); ++i)
+    {
+        optional<int> found = map.find(as_apidl(pidls[i]));
+        BOOST_REQUIRE(found);
+        BOOST_CHECK_EQUAL(*found, static_cast<int>(i));
+    }
+
+    map.clear();
+    BOOST_CHECK(map.empty());
+    BOOST_CHECK(!map.contains(as_apidl(pidls[0])));
+}
+
+/**
+ * find_or_insert only calls the factory when the key is missing.
+ */
+BOOST_AUTO_TEST_CASE( find_or_insert )
+{
+    apidl_int_map map;
+    int calls = 0;
+
+    BOOST_CHECK_EQUAL(
+        map.find_or_insert(
+            fake_pidl<IDABSOLUTE>("a"), constant_factory(1, calls)), 1);
+    BOOST_CHECK_EQUAL(
+        map.find_or_insert(
+            fake_pidl<IDABSOLUTE>("a"), constant_factory(2, calls)), 1);
+
+    BOOST_CHECK_EQUAL(calls, 1);
+    BOOST_CHECK_EQUAL(map.size(), 1U);
+}
+
+/**
+ * A factory that throws leaves the map unchanged.
+ */
+BOOST_AUTO_TEST_CASE( find_or_insert_throws )
+{
+    apidl_int_map map;
+
+    BOOST_CHECK_THROW(
+        map.find_or_insert(fake_pidl<IDABSOLUTE>("a"), throwing_factory()),
+        std::runtime_error);
+    BOOST_CHECK(map.empty());
+}
+
+/**
+ * Values are destroyed when erased, replaced or when the map goes away.
+ */
+BOOST_AUTO_TEST_CASE( value_lifetime )
+{
+    boost::shared_ptr<int> first(new int(1));
+    boost::shared_ptr<int> second(new int(2));
+
+    {
+        basic_concurrent_pidl_map<IDABSOLUTE, boost::shared_ptr<int> > map;
+        map.insert(fake_pidl<IDABSOLUTE>("a"), first);
+        map.insert(fake_pidl<IDABSOLUTE>("b"), first);
+        BOOST_CHECK_EQUAL(first.use_count(), 3);
+
+        map.insert_or_assign(fake_pidl<IDABSOLUTE>("a"), second);
+        BOOST_CHECK_EQUAL(first.use_count(), 2);
+
+        map.erase(fake_pidl<IDABSOLUTE>("b"));
+        BOOST_CHECK_EQUAL(first.use_count(), 1);
+        BOOST_CHECK_EQUAL(second.use_count(), 2);
+    }
+
+    BOOST_CHECK_EQUAL(second.use_count(), 1);
+}
+
+/**
+ * Threads filling and reading the same cache always see the value that
+ * belongs to the key.
+ */
+BOOST_AUTO_TEST_CASE( concurrent_use )
+{
+    vector< vector<BYTE> > pidls = numbered_pidls(256);
+    apidl_int_map map;
+
+    const size_t thread_count = 4;
+    bool mismatches[thread_count] = { false };
+
+    boost::thread_group threads;
+    for (size_t t = 0; t < thread_count; ++t)
+    {
+        threads.create_thread(
+            caching_worker(map, pidls, t * 61, mismatches[t]));
+    }
+    threads.join_all();
+
+    for (size_t t = 0; t < thread_count; ++t)
+    {
+        BOOST_CHECK(!mismatches[t]);
+    }
+    BOOST_CHECK_EQUAL(map.size(), pidls.size());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
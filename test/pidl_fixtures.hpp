@@ -0,0 +1,172 @@
+/**
+    @file
+
+    Fake PIDLs for tests.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#ifndef WASHER_TEST_PIDL_FIXTURES_HPP
+#define WASHER_TEST_PIDL_FIXTURES_HPP
+#pragma once
+
+#include <washer/shell/pidl.hpp> // basic_pidl, newdelete_alloc, raw_pidl
+
+#include <boost/numeric/conversion/cast.hpp> // numeric_cast
+#include <boost/test/unit_test.hpp> // predicate_result
+
+#include <cstddef> // size_t
+#include <cstring> // memcpy
+#include <list>
+#include <string>
+#include <vector>
+
+namespace washer {
+namespace test {
+
+/**
+ * PIDL wrapper type using new/delete so that leaks are detected.
+ */
+template<typename T>
+struct heap_pidl
+{
+    typedef washer::shell::pidl::basic_pidl<
+        T, washer::shell::pidl::newdelete_alloc<T> > type;
+};
+
+/**
+ * Bytes of an ITEMIDLIST whose items contain the given strings.
+ *
+ * Each string becomes the payload of one item.  The list is null-terminated.
+ */
+inline std::vector<BYTE> idlist_bytes(const std::vector<std::string>& items)
+{
+    std::vector<BYTE> buffer;
+    for (std::vector<std::string>::const_iterator it = items.begin();
+         it != items.end(); ++it)
+    {
+        USHORT cb = boost::numeric_cast<USHORT>(sizeof(USHORT) + it->size());
+        size_t offset = buffer.size();
+        buffer.resize(offset + cb);
+        std::memcpy(&buffer[offset], &cb, sizeof(cb));
+        std::memcpy(&buffer[offset + sizeof(USHORT)], it->data(), it->size());
+    }
+
+    buffer.resize(buffer.size() + sizeof(USHORT), 0);
+    return buffer;
+}
+
+/**
+ * Fixture handing out raw PIDLs that stay valid until the end of the test.
+ */
+class pidl_fixture
+{
+public:
+
+    /**
+     * Raw PIDL whose items contain the given strings.
+     */
+    template<typename T>
+    const T* fake_pidl(const std::vector<std::string>& items)
+    {
+        m_pidls.push_back(idlist_bytes(items));
+        return reinterpret_cast<const T*>(&m_pidls.back()[0]);
+    }
+
+    /**
+     * Raw single-item PIDL containing the given string.
+     */
+    template<typename T>
+    const T* fake_pidl(const std::string& item)
+    {
+        return fake_pidl<T>(std::vector<std::string>(1, item));
+    }
+
+    /**
+     * Raw two-item PIDL containing the given strings.
+     */
+    template<typename T>
+    const T* fake_pidl(const std::string& first, const std::string& second)
+    {
+        std::vector<std::string> items;
+        items.push_back(first);
+        items.push_back(second);
+        return fake_pidl<T>(items);
+    }
+
+    /**
+     * Raw PIDL that contains only the null-terminator.
+     */
+    template<typename T>
+    const T* empty_pidl()
+    {
+        return fake_pidl<T>(std::vector<std::string>());
+    }
+
+private:
+    std::list< std::vector<BYTE> > m_pidls;
+};
+
+/**
+ * Compare two PIDLs as a sequence of bytes.
+ *
+ * On mismatch, reports the sizes and the offset of the first differing byte.
+ */
+inline boost::test_tools::predicate_result binary_equal_pidls(
+    const ITEMIDLIST_RELATIVE* pidl1, const ITEMIDLIST_RELATIVE* pidl2)
+{
+    namespace raw_pidl = washer::shell::pidl::raw_pidl;
+
+    size_t lhs_size = raw_pidl::size(pidl1);
+    size_t rhs_size = raw_pidl::size(pidl2);
+    const BYTE* lhs = reinterpret_cast<const BYTE*>(pidl1);
+    const BYTE* rhs = reinterpret_cast<const BYTE*>(pidl2);
+
+    boost::test_tools::predicate_result result(true);
+    if (lhs_size != rhs_size)
+    {
+        result = false;
+        result.message()
+            << "PIDL sizes differ [" << lhs_size << " != " << rhs_size << "]";
+        return result;
+    }
+
+    for (size_t i = 0; i < lhs_size; ++i)
+    {
+        if (lhs[i] != rhs[i])
+        {
+            result = false;
+            result.message() << "PIDLs differ at byte " << i;
+            return result;
+        }
+    }
+
+    return result;
+}
+
+}} // namespace washer::test
+
+#endif
@@ -0,0 +1,317 @@
+/**
+    @file
+
+    Unit tests for the sorted flat PIDL set and map.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#include "pidl_fixtures.hpp" // pidl_fixture, binary_equal_pidls, heap_pidl
+
+#include <washer/shell/pidl_flat_set.hpp> // test subject
+
+#include <boost/test/unit_test.hpp>
+
+#include <set>
+#include <string>
+#include <utility> // make_pair, pair
+#include <vector>
+
+using namespace washer::shell::pidl;
+
+using washer::test::binary_equal_pidls;
+using washer::test::heap_pidl;
+using washer::test::pidl_fixture;
+
+using std::make_pair;
+using std::pair;
+using std::string;
+using std::vector;
+
+namespace {
+
+    typedef ITEMIDLIST_ABSOLUTE IDABSOLUTE;
+    typedef ITEMIDLIST_RELATIVE IDRELATIVE;
+    typedef ITEMID_CHILD IDCHILD;
+
+    typedef basic_pidl_flat_set<IDCHILD, newdelete_alloc<IDCHILD> >
+        child_set;
+    typedef basic_pidl_flat_map<IDCHILD, int, newdelete_alloc<IDCHILD> >
+        child_map;
+
+    /**
+     * Set of single-item PIDLs named by the characters of @a names.
+     */
+    child_set set_of(pidl_fixture& fixture, const string& names)
+    {
+        vector<const IDCHILD*> pidls;
+        for (size_t i = 0; i < names.size(); ++i)
+        {
+            pidls.push_back(
+                fixture.fake_pidl<IDCHILD>(string(1, names[i])));
+        }
+        return child_set(pidls.begin(), pidls.end());
+    }
+
+    /**
+     * The sorted set's elements match those of a std::set of the same
+     * names, which sorts the same way for these single-byte items.
+     */
+    void check_names(
+        pidl_fixture& fixture, const child_set& set, const string& names)
+    {
+        std::set<char> expected(names.begin(), names.end());
+        BOOST_REQUIRE_EQUAL(set.size(), expected.size());
+
+        size_t i = 0;
+        for (std::set<char>::const_iterator it = expected.begin();
+             it != expected.end(); ++it, ++i)
+        {
+            BOOST_CHECK(
+                binary_equal_pidls(
+                    set[i].get(),
+                    fixture.fake_pidl<IDCHILD>(string(1, *it))));
+        }
+    }
+}
+
+BOOST_FIXTURE_TEST_SUITE(pidl_flat_set_tests, pidl_fixture)
+
+BOOST_AUTO_TEST_CASE( empty_set )
+{
+    child_set set;
+    BOOST_CHECK(set.empty());
+    BOOST_CHECK_EQUAL(set.size(), 0U);
+    BOOST_CHECK(set.begin() == set.end());
+    BOOST_CHECK(!set.contains(fake_pidl<IDCHILD>("a")));
+}
+
+/**
+ * Building from a range sorts it and drops the duplicates.
+ */
+BOOST_AUTO_TEST_CASE( bulk_construction )
+{
+    child_set set = set_of(*this, "dbadcab");
+    check_names(*this, set, "abcd");
+}
+
+/**
+ * Longer PIDLs sharing a prefix order after it.
+ */
+BOOST_AUTO_TEST_CASE( order_by_bytes )
+{
+    vector<const IDRELATIVE*> pidls;
+    pidls.push_back(fake_pidl<IDRELATIVE>("folder", "file"));
+    pidls.push_back(fake_pidl<IDRELATIVE>("folder"));
+    pidls.push_back(empty_pidl<IDRELATIVE>());
+
+    basic_pidl_flat_set<IDRELATIVE> set(pidls.begin(), pidls.end());
+    BOOST_REQUIRE_EQUAL(set.size(), 3U);
+    BOOST_CHECK(set[0].empty());
+    BOOST_CHECK(binary_equal_pidls(set[1].get(), pidls[1]));
+    BOOST_CHECK(binary_equal_pidls(set[2].get(), pidls[0]));
+}
+
+BOOST_AUTO_TEST_CASE( lookup_by_any_pidl )
+{
+    child_set set = set_of(*this, "bdf");
+
+    const IDCHILD* raw = fake_pidl<IDCHILD>("d");
+    heap_pidl<IDCHILD>::type wrapper(raw);
+
+    BOOST_CHECK(set.contains(raw));
+    BOOST_CHECK(set.contains(wrapper));
+    BOOST_CHECK(set.contains(cpidl_view(raw)));
+    BOOST_CHECK_EQUAL(set.count(raw), 1U);
+    BOOST_CHECK(binary_equal_pidls(set.find(raw)->get(), raw));
+
+    BOOST_CHECK(!set.contains(fake_pidl<IDCHILD>("c")));
+    BOOST_CHECK(set.find(fake_pidl<IDCHILD>("g")) == set.end());
+    BOOST_CHECK(set.lower_bound(fake_pidl<IDCHILD>("c")) == set.begin() + 1);
+}
+
+BOOST_AUTO_TEST_CASE( insert )
+{
+    child_set set = set_of(*this, "bd");
+
+    pair<child_set::const_iterator, bool> result =
+        set.insert(fake_pidl<IDCHILD>("c"));
+    BOOST_CHECK(result.second);
+    BOOST_CHECK(result.first == set.begin() + 1);
+
+    result = set.insert(heap_pidl<IDCHILD>::type(fake_pidl<IDCHILD>("c")));
+    BOOST_CHECK(!result.second);
+    BOOST_CHECK(result.first == set.begin() + 1);
+
+    set.insert(fake_pidl<IDCHILD>("a"));
+    set.insert(fake_pidl<IDCHILD>("e"));
+    check_names(*this, set, "abcde");
+}
+
+/**
+ * Child PIDLs can be added to a set of relative PIDLs.
+ */
+BOOST_AUTO_TEST_CASE( insert_upcast )
+{
+    basic_pidl_flat_set<IDRELATIVE> set;
+    set.insert(fake_pidl<IDCHILD>("child"));
+    set.insert(fake_pidl<IDRELATIVE>("folder", "file"));
+
+    BOOST_CHECK_EQUAL(set.size(), 2U);
+    BOOST_CHECK(set.contains(fake_pidl<IDCHILD>("child")));
+}
+
+BOOST_AUTO_TEST_CASE( erase )
+{
+    child_set set = set_of(*this, "abcd");
+
+    BOOST_CHECK_EQUAL(set.erase(fake_pidl<IDCHILD>("b")), 1U);
+    BOOST_CHECK_EQUAL(set.erase(fake_pidl<IDCHILD>("b")), 0U);
+    check_names(*this, set, "acd");
+
+    child_set::const_iterator next = set.erase(set.begin());
+    BOOST_CHECK(next == set.begin());
+    check_names(*this, set, "cd");
+
+    set.clear();
+    BOOST_CHECK(set.empty());
+}
+
+BOOST_AUTO_TEST_CASE( set_operations )
+{
+    child_set lhs = set_of(*this, "abcf");
+    child_set rhs = set_of(*this, "bdfg");
+
+    check_names(*this, set_union(lhs, rhs), "abcdfg");
+    check_names(*this, set_intersection(lhs, rhs), "bf");
+    check_names(*this, set_difference(lhs, rhs), "ac");
+    check_names(*this, set_difference(rhs, lhs), "dg");
+}
+
+BOOST_AUTO_TEST_CASE( set_operations_with_empty )
+{
+    child_set set = set_of(*this, "ab");
+    child_set empty;
+
+    BOOST_CHECK(set_union(set, empty) == set);
+    BOOST_CHECK(set_union(empty, set) == set);
+    BOOST_CHECK(set_intersection(set, empty).empty());
+    BOOST_CHECK(set_difference(set, empty) == set);
+    BOOST_CHECK(set_difference(empty, set).empty());
+}
+
+BOOST_AUTO_TEST_CASE( equality_and_swap )
+{
+    child_set first = set_of(*this, "abc");
+    child_set second = set_of(*this, "cba");
+    child_set third = set_of(*this, "ab");
+
+    BOOST_CHECK(first == second);
+    BOOST_CHECK(first != third);
+
+    swap(first, third);
+    check_names(*this, first, "ab");
+    check_names(*this, third, "abc");
+}
+
+BOOST_AUTO_TEST_CASE( copy_is_independent )
+{
+    child_set original = set_of(*this, "ab");
+    child_set copy(original);
+
+    copy.insert(fake_pidl<IDCHILD>("c"));
+    BOOST_CHECK_EQUAL(original.size(), 2U);
+    BOOST_CHECK_EQUAL(copy.size(), 3U);
+    BOOST_CHECK(original[0].get() != copy[0].get());
+}
+
+/**
+ * A copy's lookups use its own PIDLs, not those of the set it was copied
+ * from.
+ */
+BOOST_AUTO_TEST_CASE( copy_outlives_original )
+{
+    child_set copy;
+    {
+        child_set original = set_of(*this, "abc");
+        copy = original;
+    }
+
+    BOOST_CHECK(copy.contains(fake_pidl<IDCHILD>("b")));
+    copy.insert(fake_pidl<IDCHILD>("d"));
+    check_names(*this, copy, "abcd");
+}
+
+BOOST_AUTO_TEST_SUITE_END();
+
+BOOST_FIXTURE_TEST_SUITE(pidl_flat_map_tests, pidl_fixture)
+
+/**
+ * The first value given for a repeated key is the one kept.
+ */
+BOOST_AUTO_TEST_CASE( map_bulk_construction )
+{
+    vector< pair<const IDCHILD*, int> > entries;
+    entries.push_back(make_pair(fake_pidl<IDCHILD>("c"), 3));
+    entries.push_back(make_pair(fake_pidl<IDCHILD>("a"), 1));
+    entries.push_back(make_pair(fake_pidl<IDCHILD>("c"), 30));
+    entries.push_back(make_pair(fake_pidl<IDCHILD>("b"), 2));
+
+    child_map map(entries.begin(), entries.end());
+    BOOST_REQUIRE_EQUAL(map.size(), 3U);
+    BOOST_CHECK_EQUAL(map.value(0), 1);
+    BOOST_CHECK_EQUAL(map.value(1), 2);
+    BOOST_CHECK_EQUAL(map.value(2), 3);
+    BOOST_CHECK(binary_equal_pidls(map.key(2).get(), entries[0].first));
+    check_names(*this, map.keys(), "abc");
+}
+
+BOOST_AUTO_TEST_CASE( map_find_insert_erase )
+{
+    child_map map;
+    BOOST_CHECK(map.find(fake_pidl<IDCHILD>("a")) == NULL);
+
+    BOOST_CHECK(map.insert(fake_pidl<IDCHILD>("b"), 2).second);
+    BOOST_CHECK(map.insert(fake_pidl<IDCHILD>("a"), 1).second);
+    BOOST_CHECK(!map.insert(fake_pidl<IDCHILD>("a"), 10).second);
+
+    BOOST_REQUIRE(map.find(fake_pidl<IDCHILD>("a")) != NULL);
+    BOOST_CHECK_EQUAL(*map.find(fake_pidl<IDCHILD>("a")), 1);
+    BOOST_CHECK_EQUAL(map.value(1), 2);
+
+    map[fake_pidl<IDCHILD>("c")] = 3;
+    map[fake_pidl<IDCHILD>("a")] += 5;
+    BOOST_CHECK_EQUAL(map.value(0), 6);
+    BOOST_CHECK_EQUAL(map.value(2), 3);
+
+    BOOST_CHECK_EQUAL(map.erase(fake_pidl<IDCHILD>("b")), 1U);
+    BOOST_CHECK_EQUAL(map.erase(fake_pidl<IDCHILD>("b")), 0U);
+    BOOST_CHECK_EQUAL(map.size(), 2U);
+    BOOST_CHECK_EQUAL(map.value(1), 3);
+    BOOST_CHECK(!map.contains(fake_pidl<IDCHILD>("b")));
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,254 @@
+/**
+    @file
+
+    Unit tests for front-coded PIDL lists.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#include "pidl_fixtures.hpp" // pidl_fixture, binary_equal_pidls, heap_pidl
+
+#include <washer/shell/pidl_front_coded.hpp> // test subject
+
+#include <boost/lexical_cast.hpp> // lexical_cast
+#include <boost/test/unit_test.hpp>
+
+#include <stdexcept> // out_of_range, invalid_argument
+#include <string>
+#include <vector>
+
+using namespace washer::shell::pidl;
+
+using washer::test::binary_equal_pidls;
+using washer::test::heap_pidl;
+using washer::test::pidl_fixture;
+
+using boost::lexical_cast;
+
+using std::string;
+using std::vector;
+
+namespace {
+
+    typedef ITEMIDLIST_ABSOLUTE IDABSOLUTE;
+    typedef ITEMIDLIST_RELATIVE IDRELATIVE;
+    typedef ITEMID_CHILD IDCHILD;
+
+    typedef basic_front_coded_pidl_list<
+        IDABSOLUTE, newdelete_alloc<IDABSOLUTE> > apidl_list;
+
+    /**
+     * Absolute PIDLs for @a count files in each of @a folders folders,
+     * grouped by folder as a listing would be.
+     */
+    vector<const IDABSOLUTE*> listing(
+        pidl_fixture& fixture, size_t folders, size_t count)
+    {
+        vector<const IDABSOLUTE*> pidls;
+        for (size_t f = 0; f < folders; ++f)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                vector<string> items;
+                items.push_back("C:\\");
+                items.push_back("Users");
+                items.push_back("folder " + lexical_cast<string>(f));
+                items.push_back("file " + lexical_cast<string>(i));
+                pidls.push_back(fixture.fake_pidl<IDABSOLUTE>(items));
+            }
+        }
+        return pidls;
+    }
+
+    void check_entries(
+        const apidl_list& list, const vector<const IDABSOLUTE*>& pidls)
+    {
+        BOOST_REQUIRE_EQUAL(list.size(), pidls.size());
+
+        size_t i = 0;
+        for (apidl_list::const_iterator it = list.begin();
+             it != list.end(); ++it, ++i)
+        {
+            BOOST_CHECK(
+                binary_equal_pidls(
+                    heap_pidl<IDABSOLUTE>::type(*it).get(), pidls[i]));
+            BOOST_CHECK_EQUAL(
+                it->item_count(), raw_pidl::measure(pidls[i]).item_count);
+        }
+        BOOST_CHECK_EQUAL(i, pidls.size());
+
+        for (i = 0; i < pidls.size(); ++i)
+        {
+            BOOST_CHECK(binary_equal_pidls(list[i].get(), pidls[i]));
+        }
+    }
+}
+
+BOOST_FIXTURE_TEST_SUITE(pidl_front_coded_tests, pidl_fixture)
+
+BOOST_AUTO_TEST_CASE( empty_list )
+{
+    apidl_list list;
+    BOOST_CHECK(list.empty());
+    BOOST_CHECK_EQUAL(list.size(), 0U);
+    BOOST_CHECK(list.begin() == list.end());
+    BOOST_CHECK_EQUAL(list.encoded_bytes(), 0U);
+    BOOST_CHECK_THROW(list.at(0), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE( round_trip )
+{
+    vector<const IDABSOLUTE*> pidls = listing(*this, 3, 20);
+    apidl_list list(pidls.begin(), pidls.end());
+    check_entries(list, pidls);
+}
+
+/**
+ * Every entry stored in full is the same as no front coding.
+ */
+BOOST_AUTO_TEST_CASE( restart_every_entry )
+{
+    vector<const IDABSOLUTE*> pidls = listing(*this, 2, 5);
+    apidl_list list(pidls.begin(), pidls.end(), 1);
+    check_entries(list, pidls);
+}
+
+BOOST_AUTO_TEST_CASE( zero_restart_interval )
+{
+    BOOST_CHECK_THROW(apidl_list(0), std::invalid_argument);
+}
+
+/**
+ * Siblings are stored in much less space than the PIDLs themselves.
+ */
+BOOST_AUTO_TEST_CASE( shared_prefixes_compress )
+{
+    vector<const IDABSOLUTE*> pidls = listing(*this, 2, 100);
+
+    size_t raw_bytes = 0;
+    for (size_t i = 0; i < pidls.size(); ++i)
+    {
+        raw_bytes += raw_pidl::size(pidls[i]);
+    }
+
+    apidl_list list(pidls.begin(), pidls.end());
+    BOOST_CHECK_LT(list.encoded_bytes() * 3, raw_bytes);
+
+    apidl_list uncompressed(pidls.begin(), pidls.end(), 1);
+    BOOST_CHECK_GT(uncompressed.encoded_bytes(), raw_bytes);
+}
+
+/**
+ * Streaming appends are readable straight away, including entries
+ * that share nothing with the one before.
+ */
+BOOST_AUTO_TEST_CASE( streaming_append )
+{
+    vector<const IDABSOLUTE*> pidls;
+    apidl_list list(4);
+
+    for (size_t i = 0; i < 10; ++i)
+    {
+        const IDABSOLUTE* pidl = (i % 3 == 0) ?
+            fake_pidl<IDABSOLUTE>("drive " + lexical_cast<string>(i)) :
+            fake_pidl<IDABSOLUTE>("drive", "file " + lexical_cast<string>(i));
+        pidls.push_back(pidl);
+
+        if (i % 2)
+            list.push_back(heap_pidl<IDABSOLUTE>::type(pidl));
+        else
+            list.push_back(pidl);
+
+        BOOST_CHECK(binary_equal_pidls(list.at(i).get(), pidl));
+    }
+
+    check_entries(list, pidls);
+}
+
+/**
+ * An entry that is a prefix of the one before shares all of its bytes.
+ */
+BOOST_AUTO_TEST_CASE( prefix_of_previous )
+{
+    vector<const IDABSOLUTE*> pidls;
+    pidls.push_back(fake_pidl<IDABSOLUTE>("folder", "file"));
+    pidls.push_back(fake_pidl<IDABSOLUTE>("folder"));
+    pidls.push_back(empty_pidl<IDABSOLUTE>());
+    pidls.push_back(fake_pidl<IDABSOLUTE>("folder", "other"));
+
+    apidl_list list(pidls.begin(), pidls.end());
+    check_entries(list, pidls);
+    BOOST_CHECK(list[2].empty());
+}
+
+BOOST_AUTO_TEST_CASE( decode_into_buffer )
+{
+    vector<const IDABSOLUTE*> pidls = listing(*this, 1, 40);
+    apidl_list list(pidls.begin(), pidls.end());
+
+    vector<BYTE> buffer;
+    for (size_t i = pidls.size(); i-- > 0; )
+    {
+        basic_pidl_view<IDABSOLUTE> view = list.decode(i, buffer);
+        BOOST_CHECK(binary_equal_pidls(view.data(), pidls[i]));
+        BOOST_CHECK_EQUAL(view.item_count(), 4U);
+    }
+}
+
+/**
+ * Child PIDLs can be added to a list of relative PIDLs.
+ */
+BOOST_AUTO_TEST_CASE( upcast_children )
+{
+    basic_front_coded_pidl_list<IDRELATIVE> list;
+    list.push_back(fake_pidl<IDCHILD>("child"));
+    list.push_back(fake_pidl<IDRELATIVE>("child", "grandchild"));
+
+    BOOST_CHECK(
+        binary_equal_pidls(list[0].get(), fake_pidl<IDRELATIVE>("child")));
+    BOOST_CHECK_EQUAL(list[1].item_count(), 2U);
+}
+
+BOOST_AUTO_TEST_CASE( clear_and_swap )
+{
+    vector<const IDABSOLUTE*> pidls = listing(*this, 1, 5);
+    apidl_list list(pidls.begin(), pidls.end());
+    apidl_list other(8);
+
+    swap(list, other);
+    BOOST_CHECK(list.empty());
+    BOOST_CHECK_EQUAL(list.restart_interval(), 8U);
+    check_entries(other, pidls);
+
+    other.clear();
+    BOOST_CHECK(other.empty());
+    BOOST_CHECK_EQUAL(other.encoded_bytes(), 0U);
+
+    other.push_back(pidls[3]);
+    BOOST_CHECK(binary_equal_pidls(other[0].get(), pidls[3]));
+}
+
+BOOST_AUTO_TEST_SUITE_END();
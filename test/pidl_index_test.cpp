@@ -0,0 +1,258 @@
+/**
+    @file
+
+    Tests for the random-access PIDL index.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#include "pidl_fixtures.hpp" // pidl_fixture, binary_equal_pidls
+
+#include <washer/shell/pidl_index.hpp> // test subject
+#include <washer/shell/pidl_iterator.hpp> // raw_pidl_iterator
+
+#include <boost/mpl/list.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_case_template.hpp>
+
+#include <algorithm> // lower_bound
+#include <iterator> // distance
+#include <stdexcept> // out_of_range
+#include <string>
+#include <vector>
+
+using namespace washer::shell::pidl;
+
+using washer::test::binary_equal_pidls;
+using washer::test::pidl_fixture;
+
+using std::string;
+using std::vector;
+
+namespace {
+
+    typedef ITEMIDLIST_RELATIVE IDRELATIVE;
+    typedef ITEMIDLIST_ABSOLUTE IDABSOLUTE;
+
+    typedef boost::mpl::list<IDRELATIVE, IDABSOLUTE> adult_pidl_types;
+
+    vector<string> items(size_t count)
+    {
+        vector<string> result;
+        for (size_t i = 0; i < count; ++i)
+        {
+            // Different lengths so offsets aren't multiples of each other
+            result.push_back(string(i + 1, static_cast<char>('a' + i)));
+        }
+        return result;
+    }
+
+    string text_of(const cpidl_view& item)
+    {
+        BOOST_REQUIRE_EQUAL(item.item_count(), 1U);
+        return string(
+            reinterpret_cast<const char*>(item.data()->mkid.abID),
+            item.item_bytes() - sizeof(USHORT));
+    }
+
+    struct text_less
+    {
+        bool operator()(const cpidl_view& item, const string& text) const
+        {
+            return text_of(item) < text;
+        }
+    };
+}
+
+BOOST_FIXTURE_TEST_SUITE(pidl_index_tests, pidl_fixture)
+
+BOOST_AUTO_TEST_CASE( default_index )
+{
+    pidl_index index;
+    BOOST_CHECK(index.empty());
+    BOOST_CHECK_EQUAL(index.item_count(), 0U);
+    BOOST_CHECK(index.begin() == index.end());
+    BOOST_CHECK(index.rbegin() == index.rend());
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( index_empty_pidl, T, adult_pidl_types )
+{
+    basic_pidl_index<T> index(empty_pidl<T>());
+    BOOST_CHECK(index.empty());
+    BOOST_CHECK(index.begin() == index.end());
+    BOOST_CHECK_EQUAL(index.offset(0), 0U);
+    BOOST_CHECK_THROW(index.at(0), std::out_of_range);
+    BOOST_CHECK_THROW(index.back(), std::out_of_range);
+}
+
+/**
+ * Each item is a view into the original PIDL at the right offset.
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE( subscript, T, adult_pidl_types )
+{
+    const T* pidl = fake_pidl<T>(items(4));
+    basic_pidl_index<T> index(pidl);
+
+    BOOST_REQUIRE_EQUAL(index.item_count(), 4U);
+
+    const BYTE* start = reinterpret_cast<const BYTE*>(pidl);
+    size_t offset = 0;
+    for (size_t i = 0; i < 4; ++i)
+    {
+        BOOST_CHECK_EQUAL(index.offset(i), offset);
+        BOOST_CHECK(
+            reinterpret_cast<const BYTE*>(index[i].data()) == start + offset);
+        BOOST_CHECK_EQUAL(text_of(index[i]), items(4)[i]);
+        offset += sizeof(USHORT) + i + 1;
+    }
+    BOOST_CHECK_EQUAL(index.offset(4), offset);
+
+    BOOST_CHECK_EQUAL(text_of(index.front()), "a");
+    BOOST_CHECK_EQUAL(text_of(index.back()), "dddd");
+    BOOST_CHECK_EQUAL(text_of(index.at(2)), "ccc");
+    BOOST_CHECK_THROW(index.at(4), std::out_of_range);
+}
+
+/**
+ * The last item is followed by the terminator so can be copied.
+ */
+BOOST_AUTO_TEST_CASE( last_item_terminated )
+{
+    const IDABSOLUTE* pidl = fake_pidl<IDABSOLUTE>(items(3));
+    apidl_index index(pidl);
+
+    PCUITEMID_CHILD last = raw_pidl::last(pidl);
+    BOOST_CHECK(binary_equal_pidls(index.back().data(), last));
+    BOOST_CHECK(binary_equal_pidls(cpidl_t(index.back()).get(), last));
+
+    // Middle items are copied alone
+    cpidl_t middle(index[1]);
+    BOOST_CHECK_EQUAL(middle.item_count(), 1U);
+    BOOST_CHECK_EQUAL(text_of(view(middle)), "bb");
+}
+
+/**
+ * Iteration visits the same items as raw_pidl_iterator, in order.
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE( iterate_forward, T, adult_pidl_types )
+{
+    const T* pidl = fake_pidl<T>(items(5));
+    basic_pidl_index<T> index(pidl);
+
+    raw_pidl_iterator raw(pidl);
+    typename basic_pidl_index<T>::const_iterator it = index.begin();
+    for (; it != index.end(); ++it, ++raw)
+    {
+        BOOST_CHECK((*it).data() == reinterpret_cast<PCUITEMID_CHILD>(*raw));
+    }
+    BOOST_CHECK(raw == raw_pidl_iterator());
+    BOOST_CHECK_EQUAL(std::distance(index.begin(), index.end()), 5);
+}
+
+BOOST_AUTO_TEST_CASE( iterate_backward )
+{
+    apidl_index index(fake_pidl<IDABSOLUTE>(items(4)));
+
+    vector<string> seen;
+    for (apidl_index::const_reverse_iterator it = index.rbegin();
+         it != index.rend(); ++it)
+    {
+        seen.push_back(text_of(*it));
+    }
+
+    BOOST_REQUIRE_EQUAL(seen.size(), 4U);
+    BOOST_CHECK_EQUAL(seen[0], "dddd");
+    BOOST_CHECK_EQUAL(seen[3], "a");
+
+    apidl_index::const_iterator it = index.end();
+    --it;
+    BOOST_CHECK_EQUAL(text_of(*it), "dddd");
+    BOOST_CHECK_EQUAL(it.position(), 3U);
+}
+
+/**
+ * Iterators support random-access arithmetic.
+ */
+BOOST_AUTO_TEST_CASE( random_access )
+{
+    pidl_index index(fake_pidl<IDRELATIVE>(items(6)));
+
+    pidl_index::const_iterator it = index.begin() + 4;
+    BOOST_CHECK_EQUAL(text_of(*it), "eeeee");
+    BOOST_CHECK_EQUAL(text_of(it[-2]), "ccc");
+    BOOST_CHECK_EQUAL(text_of(*(it - 3)), "bb");
+    BOOST_CHECK_EQUAL(index.end() - it, 2);
+    BOOST_CHECK(index.begin() < it);
+
+    it += 2;
+    BOOST_CHECK(it == index.end());
+
+    // Items are in order so can be binary searched
+    pidl_index::const_iterator found = std::lower_bound(
+        index.begin(), index.end(), string("dddd"), text_less());
+    BOOST_CHECK_EQUAL(found.position(), 3U);
+}
+
+/**
+ * Prefixes and suffixes match those taken from a view.
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE( sub_lists, T, adult_pidl_types )
+{
+    const T* pidl = fake_pidl<T>(items(5));
+    basic_pidl_index<T> index(pidl);
+    basic_pidl_view<T> whole(pidl);
+
+    BOOST_CHECK(index.view() == whole);
+    for (size_t n = 0; n <= 5; ++n)
+    {
+        BOOST_CHECK(index.prefix(n) == whole.prefix(n));
+        BOOST_CHECK(index.suffix(n) == whole.suffix(n));
+        BOOST_CHECK_EQUAL(index.prefix(n).item_count(), n);
+        BOOST_CHECK_EQUAL(index.suffix(n).item_count(), n);
+    }
+
+    BOOST_CHECK_THROW(index.prefix(6), std::out_of_range);
+    BOOST_CHECK_THROW(index.suffix(6), std::out_of_range);
+}
+
+/**
+ * A wrapper's PIDL can be indexed in place.
+ */
+BOOST_AUTO_TEST_CASE( index_wrapper )
+{
+    apidl_t pidl(fake_pidl<IDABSOLUTE>(items(3)));
+    apidl_index index(pidl);
+
+    BOOST_CHECK_EQUAL(index.item_count(), 3U);
+    BOOST_CHECK(index.view().data() == pidl.get());
+    BOOST_CHECK_EQUAL(text_of(index[2]), "ccc");
+
+    // A relative index of an absolute PIDL
+    pidl_index relative(pidl);
+    BOOST_CHECK_EQUAL(relative.item_count(), 3U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
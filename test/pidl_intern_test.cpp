@@ -0,0 +1,327 @@
+/**
+    @file
+
+    Tests for PIDL interning.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#include "pidl_fixtures.hpp" // pidl_fixture, binary_equal_pidls
+
+#include <washer/shell/pidl_intern.hpp> // test subject
+
+#include <boost/functional/hash.hpp> // hash
+#include <boost/lexical_cast.hpp> // lexical_cast
+#include <boost/move/move.hpp> // move
+#include <boost/test/unit_test.hpp>
+#include <boost/thread/thread.hpp> // thread_group
+
+#include <string>
+#include <vector>
+
+using namespace washer::shell::pidl;
+
+using washer::test::binary_equal_pidls;
+using washer::test::idlist_bytes;
+using washer::test::pidl_fixture;
+
+using boost::lexical_cast;
+
+using std::string;
+using std::vector;
+
+namespace {
+
+    typedef ITEMIDLIST_ABSOLUTE IDABSOLUTE;
+
+    /**
+     * Intern the same set of PIDLs over and over, holding on to a handful
+     * of the handles for a while, and check every handle matches the
+     * handle the main thread interned for the same PIDL.
+     */
+    class interning_worker
+    {
+    public:
+        interning_worker(
+            apidl_intern_table& table, const vector< vector<BYTE> >& pidls,
+            const vector<interned_apidl>& expected, bool& mismatch)
+            : m_table(table), m_pidls(pidls), m_expected(expected),
+              m_mismatch(mismatch) {}
+
+        void operator()() const
+        {
+            vector<interned_apidl> held;
+            for (size_t round = 0; round < 200; ++round)
+            {
+                for (size_t i = 0; i < m_pidls.size(); ++i)
+                {
+                    interned_apidl handle = m_table.intern(
+                        reinterpret_cast<const IDABSOLUTE*>(&m_pidls[i][0]));
+                    if (handle != m_expected[i])
+                        m_mismatch = true;
+
+                    if ((round + i) % 7 == 0)
+                        held.push_back(handle);
+                }
+
+                if (held.size() > 50)
+                    held.clear();
+            }
+        }
+
+    private:
+        apidl_intern_table& m_table;
+        const vector< vector<BYTE> >& m_pidls;
+        const vector<interned_apidl>& m_expected;
+        bool& m_mismatch;
+    };
+}
+
+BOOST_FIXTURE_TEST_SUITE(pidl_intern_tests, pidl_fixture)
+
+/**
+ * Interning equal PIDLs returns the same handle to a single copy.
+ */
+BOOST_AUTO_TEST_CASE( duplicates_share )
+{
+    apidl_intern_table table;
+
+    interned_apidl first = table.intern(fake_pidl<IDABSOLUTE>("a", "b"));
+    interned_apidl second = table.intern(fake_pidl<IDABSOLUTE>("a", "b"));
+
+    BOOST_CHECK(first == second);
+    BOOST_CHECK_EQUAL(first.get(), second.get());
+    BOOST_CHECK_EQUAL(table.size(), 1U);
+}
+
+/**
+ * Different PIDLs get different handles.
+ */
+BOOST_AUTO_TEST_CASE( distinct_pidls )
+{
+    apidl_intern_table table;
+
+    interned_apidl a = table.intern(fake_pidl<IDABSOLUTE>("a"));
+    interned_apidl ab = table.intern(fake_pidl<IDABSOLUTE>("a", "b"));
+
+    BOOST_CHECK(a != ab);
+    BOOST_CHECK((a < ab) != (ab < a));
+    BOOST_CHECK_EQUAL(table.size(), 2U);
+}
+
+/**
+ * The handle holds a faithful, terminated copy of the PIDL.
+ */
+BOOST_AUTO_TEST_CASE( contents )
+{
+    apidl_intern_table table;
+    const IDABSOLUTE* raw = fake_pidl<IDABSOLUTE>("first", "second");
+
+    interned_apidl handle = table.intern(raw);
+
+    BOOST_CHECK(handle.get() != raw);
+    BOOST_CHECK(binary_equal_pidls(handle.get(), raw));
+    BOOST_CHECK_EQUAL(handle.size(), raw_pidl::size(raw));
+    BOOST_CHECK_EQUAL(handle.item_count(), 2U);
+    BOOST_CHECK(!handle.empty());
+    BOOST_CHECK_EQUAL(table.bytes(), raw_pidl::size(raw));
+}
+
+/**
+ * Wrappers, views and raw PIDLs with the same contents intern to the same
+ * entry.
+ */
+BOOST_AUTO_TEST_CASE( intern_any_form )
+{
+    apidl_intern_table table;
+    const IDABSOLUTE* raw = fake_pidl<IDABSOLUTE>("a", "b");
+    apidl_t pidl(fake_pidl<IDABSOLUTE>("a", "b"));
+
+    interned_apidl from_raw = table.intern(raw);
+    interned_apidl from_wrapper = table.intern(pidl);
+    interned_apidl from_view = table.intern(view(pidl));
+
+    BOOST_CHECK(from_raw == from_wrapper);
+    BOOST_CHECK(from_raw == from_view);
+    BOOST_CHECK_EQUAL(table.size(), 1U);
+}
+
+/**
+ * A NULL PIDL interns to a NULL handle but an empty PIDL is a real entry.
+ */
+BOOST_AUTO_TEST_CASE( null_and_empty )
+{
+    apidl_intern_table table;
+
+    interned_apidl null_handle = table.intern(apidl_t());
+    interned_apidl empty = table.intern(empty_pidl<IDABSOLUTE>());
+
+    BOOST_CHECK(!null_handle);
+    BOOST_CHECK(null_handle.get() == NULL);
+    BOOST_CHECK_EQUAL(null_handle.size(), 0U);
+    BOOST_CHECK(null_handle == interned_apidl());
+
+    BOOST_CHECK(!!empty);
+    BOOST_CHECK(empty.empty());
+    BOOST_CHECK_EQUAL(empty.size(), sizeof(USHORT));
+    BOOST_CHECK_EQUAL(table.size(), 1U);
+}
+
+/**
+ * The entry stays in the table while any copy of a handle to it is alive
+ * and goes when the last one does.
+ */
+BOOST_AUTO_TEST_CASE( released_with_last_handle )
+{
+    apidl_intern_table table;
+
+    {
+        interned_apidl handle = table.intern(fake_pidl<IDABSOLUTE>("a"));
+        {
+            interned_apidl copy = handle;
+            interned_apidl assigned;
+            assigned = copy;
+            BOOST_CHECK(assigned == handle);
+        }
+        BOOST_CHECK_EQUAL(table.size(), 1U);
+    }
+
+    BOOST_CHECK_EQUAL(table.size(), 0U);
+    BOOST_CHECK_EQUAL(table.bytes(), 0U);
+
+    interned_apidl again = table.intern(fake_pidl<IDABSOLUTE>("a"));
+    BOOST_CHECK(binary_equal_pidls(again.get(), fake_pidl<IDABSOLUTE>("a")));
+    BOOST_CHECK_EQUAL(table.size(), 1U);
+}
+
+/**
+ * Moving a handle transfers the reference rather than adding one.
+ */
+BOOST_AUTO_TEST_CASE( move )
+{
+    apidl_intern_table table;
+
+    interned_apidl handle = table.intern(fake_pidl<IDABSOLUTE>("a"));
+    const IDABSOLUTE* raw = handle.get();
+
+    interned_apidl moved(boost::move(handle));
+    BOOST_CHECK(!handle);
+    BOOST_CHECK_EQUAL(moved.get(), raw);
+
+    interned_apidl assigned;
+    assigned = boost::move(moved);
+    BOOST_CHECK(!moved);
+    BOOST_CHECK_EQUAL(assigned.get(), raw);
+
+    assigned = interned_apidl();
+    BOOST_CHECK_EQUAL(table.size(), 0U);
+}
+
+/**
+ * Handles hash the same as the wrapper they were interned from so they can
+ * share hashed containers with it.
+ */
+BOOST_AUTO_TEST_CASE( hash )
+{
+    apidl_intern_table table;
+    apidl_t pidl(fake_pidl<IDABSOLUTE>("a", "b"));
+
+    interned_apidl handle = table.intern(pidl);
+
+    BOOST_CHECK_EQUAL(hash_value(handle), hash_value(pidl));
+    BOOST_CHECK_EQUAL(boost::hash<interned_apidl>()(handle), hash_value(pidl));
+    BOOST_CHECK_EQUAL(
+        hash_value(interned_apidl()), hash_value(apidl_t()));
+
+#ifndef BOOST_NO_CXX11_HDR_FUNCTIONAL
+    BOOST_CHECK_EQUAL(std::hash<interned_apidl>()(handle), hash_value(pidl));
+#endif
+}
+
+/**
+ * An interned PIDL can be viewed in place.
+ */
+BOOST_AUTO_TEST_CASE( view_interned )
+{
+    apidl_intern_table table;
+    interned_apidl handle = table.intern(fake_pidl<IDABSOLUTE>("a", "bc"));
+
+    apidl_view v = view(handle);
+    BOOST_CHECK_EQUAL(v.data(), handle.get());
+    BOOST_CHECK_EQUAL(v.size(), handle.size());
+    BOOST_CHECK_EQUAL(v.item_count(), 2U);
+
+    BOOST_CHECK(!view(interned_apidl()));
+}
+
+/**
+ * Threads interning the same PIDLs at the same time as each other, and as
+ * handles are being dropped, all agree on the handles and leave nothing
+ * behind.
+ */
+BOOST_AUTO_TEST_CASE( concurrent )
+{
+    apidl_intern_table table;
+
+    vector< vector<BYTE> > pidls;
+    for (size_t i = 0; i < 64; ++i)
+    {
+        vector<string> items;
+        items.push_back("folder");
+        items.push_back(lexical_cast<string>(i));
+        pidls.push_back(idlist_bytes(items));
+    }
+
+    {
+        vector<interned_apidl> expected;
+        for (size_t i = 0; i < pidls.size(); ++i)
+        {
+            expected.push_back(table.intern(
+                reinterpret_cast<const IDABSOLUTE*>(&pidls[i][0])));
+        }
+
+        const size_t thread_count = 4;
+        bool mismatches[thread_count] = { false };
+
+        boost::thread_group threads;
+        for (size_t t = 0; t < thread_count; ++t)
+        {
+            threads.create_thread(
+                interning_worker(table, pidls, expected, mismatches[t]));
+        }
+        threads.join_all();
+
+        for (size_t t = 0; t < thread_count; ++t)
+        {
+            BOOST_CHECK(!mismatches[t]);
+        }
+        BOOST_CHECK_EQUAL(table.size(), pidls.size());
+    }
+
+    BOOST_CHECK_EQUAL(table.size(), 0U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -29,21 +29,25 @@
     @endif
 */
 
-#include "wchar_output.hpp" // wstring output
+#include "pidl_fixtures.hpp" // binary_equal_pidls
 
 #include <washer/shell/pidl_iterator.hpp> // test subject
 
+#ifdef _WIN32
+#include "wchar_output.hpp" // wstring output
+
 #include <washer/shell/shell.hpp> // special_folder_pidl
+#endif
 
 #include <boost/numeric/conversion/cast.hpp> // numeric_cast
 #include <boost/test/unit_test.hpp>
 
-#include <algorithm> // copy
+#include <algorithm> // copy, equal
 #include <cstring> // strlen
 #include <vector>
 
 using namespace washer::shell::pidl;
-using washer::shell::special_folder_pidl;
+using washer::test::binary_equal_pidls;
 
 using boost::numeric_cast;
 using boost::test_tools::predicate_result;
@@ -54,6 +58,22 @@ using std::vector;
 
 namespace {
 
+    /**
+     * PIDL of the root of the shell namespace.
+     *
+     * Outside Windows there is no shell to ask but the desktop is, by
+     * definition, the empty absolute PIDL.
+     */
+    apidl_t desktop_pidl()
+    {
+#ifdef _WIN32
+        return washer::shell::special_folder_pidl(CSIDL_DESKTOP);
+#else
+        const SHITEMID terminator = SHITEMID();
+        return apidl_t(reinterpret_cast<PCIDLIST_ABSOLUTE>(&terminator));
+#endif
+    }
+
     /**
      * Create a dummy PIDL using some predefined text that we can later
      * use to compare with.
@@ -65,12 +85,16 @@ namespace {
             sizeof(USHORT) + strlen(text.c_str()) + sizeof(SHITEMID);
         vector<char> buffer(pidl_length, '\0');
 
+#ifdef _MSC_VER
 #pragma warning(push)
 #pragma warning(disable : 4996)
+#endif
         copy(
             text.c_str(), text.c_str() + strlen(text.c_str()),
             &buffer[sizeof(USHORT)]);
+#ifdef _MSC_VER
 #pragma warning(pop)
+#endif
 
         PUITEMID_CHILD pidl = reinterpret_cast<PUITEMID_CHILD>(&buffer[0]);
         pidl->mkid.cb = numeric_cast<USHORT>(pidl_length - sizeof(SHITEMID));
@@ -87,9 +111,18 @@ namespace {
             (pidl->mkid.cb < sizeof(USHORT)) ?
                 0 : pidl->mkid.cb - sizeof(USHORT);
         const char* data = reinterpret_cast<const char*>(pidl) + sizeof(USHORT);
-        return boost::test_tools::tt_detail::equal_coll_impl(
-            data, data + data_length, text.c_str(),
-            text.c_str() + strlen(text.c_str()));
+
+        predicate_result result(true);
+        if (data_length != text.size() ||
+            !std::equal(data, data + data_length, text.begin()))
+        {
+            result = false;
+            result.message()
+                << "PIDL text [" << std::string(data, data_length)
+                << " != " << text << "]";
+        }
+
+        return result;
     }
 
     predicate_result pidl_matches_text(
@@ -116,7 +149,7 @@ BOOST_AUTO_TEST_CASE( default_construct )
  */
 BOOST_AUTO_TEST_CASE( desktop_root )
 {
-    apidl_t desktop = special_folder_pidl(CSIDL_DESKTOP);
+    apidl_t desktop = desktop_pidl();
     raw_pidl_iterator it(desktop.get());
     BOOST_CHECK(it == raw_pidl_iterator());
     BOOST_CHECK_EQUAL(std::distance(it, raw_pidl_iterator()), 0);
@@ -243,7 +276,7 @@ BOOST_AUTO_TEST_CASE( default_construct )
  */
 BOOST_AUTO_TEST_CASE( desktop_root )
 {
-    apidl_t desktop = special_folder_pidl(CSIDL_DESKTOP);
+    apidl_t desktop = desktop_pidl();
     pidl_iterator it(desktop);
     BOOST_CHECK(it == pidl_iterator());
     BOOST_CHECK_EQUAL(std::distance(it, pidl_iterator()), 0);
@@ -369,7 +402,7 @@ BOOST_AUTO_TEST_CASE( iterator_returns_single_items )
         q += *it++;
     }
 
-    BOOST_CHECK(::ILIsEqual(p.get(), q.get()));
+    BOOST_CHECK(binary_equal_pidls(p.get(), q.get()));
 }
 
 /**
@@ -0,0 +1,155 @@
+/**
+    @file
+
+    Unit tests for compile-time PIDL literals.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#include "pidl_fixtures.hpp" // pidl_fixture, binary_equal_pidls, heap_pidl
+
+#include <washer/shell/pidl_literal.hpp> // test subject
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstring> // memcmp
+
+using namespace washer::shell::pidl;
+
+using washer::test::binary_equal_pidls;
+using washer::test::heap_pidl;
+using washer::test::pidl_fixture;
+
+namespace {
+
+    typedef ITEMIDLIST_ABSOLUTE IDABSOLUTE;
+    typedef ITEMIDLIST_RELATIVE IDRELATIVE;
+    typedef ITEMID_CHILD IDCHILD;
+
+    typedef idlist_literal<
+        literal_bytes<3>, idlist_literal< literal_bytes<5> > > two_items;
+
+    /**
+     * Same bytes as fake_pidl("abc", "hello").
+     */
+    const two_items abc_hello = {
+        WASHER_PIDL_LITERAL_ITEM(literal_bytes<3>, { { 'a', 'b', 'c' } }),
+        {
+            WASHER_PIDL_LITERAL_ITEM(
+                literal_bytes<5>, { { 'h', 'e', 'l', 'l', 'o' } }),
+            WASHER_PIDL_LITERAL_END
+        }
+    };
+
+#pragma pack(push, 1)
+    /**
+     * Payload shaped like the items of a virtual folder.
+     */
+    struct folder_item
+    {
+        BYTE type;
+        unsigned int id;
+        char name[4];
+    };
+#pragma pack(pop)
+
+    typedef idlist_literal<folder_item> folder_layout;
+
+    const folder_layout folder = {
+        WASHER_PIDL_LITERAL_ITEM(
+            folder_item, { 0x1F, 0x01020304, { 'r', 'o', 'o', 't' } }),
+        WASHER_PIDL_LITERAL_END
+    };
+
+    const idlist_literal_end empty_literal = WASHER_PIDL_LITERAL_END;
+}
+
+BOOST_FIXTURE_TEST_SUITE(pidl_literal_tests, pidl_fixture)
+
+BOOST_AUTO_TEST_CASE( layout_matches_runtime_pidl )
+{
+    const IDABSOLUTE* pidl = literal_pidl<IDABSOLUTE>(abc_hello);
+
+    BOOST_CHECK(
+        binary_equal_pidls(pidl, fake_pidl<IDABSOLUTE>("abc", "hello")));
+    BOOST_CHECK_EQUAL(
+        static_cast<const void*>(pidl), static_cast<const void*>(&abc_hello));
+    BOOST_CHECK_EQUAL(sizeof(two_items), 2U + 3U + 2U + 5U + 2U);
+}
+
+BOOST_AUTO_TEST_CASE( item_count_is_compile_time )
+{
+    BOOST_STATIC_ASSERT(literal_item_count<two_items>::value == 2);
+    BOOST_STATIC_ASSERT(literal_item_count<folder_layout>::value == 1);
+    BOOST_STATIC_ASSERT(literal_item_count<idlist_literal_end>::value == 0);
+    BOOST_CHECK(true);
+}
+
+BOOST_AUTO_TEST_CASE( view )
+{
+    basic_pidl_view<IDRELATIVE> view = literal_view<IDRELATIVE>(abc_hello);
+
+    BOOST_CHECK_EQUAL(view.item_count(), 2U);
+    BOOST_CHECK_EQUAL(view.size(), sizeof(two_items));
+    BOOST_CHECK(
+        binary_equal_pidls(view.data(), fake_pidl<IDRELATIVE>("abc", "hello")));
+    BOOST_CHECK_EQUAL(view.last().item_count(), 1U);
+}
+
+BOOST_AUTO_TEST_CASE( clone_into_wrapper )
+{
+    heap_pidl<IDABSOLUTE>::type pidl(literal_view<IDABSOLUTE>(abc_hello));
+
+    BOOST_CHECK(pidl.get() != literal_pidl<IDABSOLUTE>(abc_hello));
+    BOOST_CHECK(
+        binary_equal_pidls(
+            pidl.get(), literal_pidl<IDABSOLUTE>(abc_hello)));
+    BOOST_CHECK_EQUAL(pidl.item_count(), 2U);
+}
+
+BOOST_AUTO_TEST_CASE( struct_payload )
+{
+    basic_pidl_view<IDCHILD> view = literal_view<IDCHILD>(folder);
+    BOOST_CHECK_EQUAL(view.item_count(), 1U);
+    BOOST_CHECK_EQUAL(
+        raw_pidl::size(view.data()), sizeof(USHORT) * 2 + 9U);
+
+    const BYTE* bytes = reinterpret_cast<const BYTE*>(view.data());
+    BOOST_CHECK_EQUAL(bytes[2], 0x1F);
+    BOOST_CHECK_EQUAL(std::memcmp(bytes + 7, "root", 4), 0);
+}
+
+BOOST_AUTO_TEST_CASE( empty )
+{
+    basic_pidl_view<IDABSOLUTE> view =
+        literal_view<IDABSOLUTE>(empty_literal);
+
+    BOOST_CHECK(view.empty());
+    BOOST_CHECK(
+        binary_equal_pidls(view.data(), empty_pidl<IDABSOLUTE>()));
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,333 @@
+/**
+    @file
+
+    Unit tests for parsing PIDLs from untrusted buffers.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#include "pidl_fixtures.hpp" // idlist_bytes
+
+#include <washer/shell/pidl_parse.hpp> // test subject
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstring> // memcpy
+#include <stdexcept> // invalid_argument
+#include <string>
+#include <vector>
+
+using namespace washer::shell::pidl;
+
+using washer::test::idlist_bytes;
+
+using std::string;
+using std::vector;
+
+namespace {
+
+    typedef ITEMIDLIST_RELATIVE IDRELATIVE;
+    typedef ITEMIDLIST_ABSOLUTE IDABSOLUTE;
+
+    vector<BYTE> items(const string& first, const string& second)
+    {
+        vector<string> names;
+        names.push_back(first);
+        names.push_back(second);
+        return idlist_bytes(names);
+    }
+
+    void set_cb(vector<BYTE>& buffer, size_t offset, USHORT cb)
+    {
+        std::memcpy(&buffer[offset], &cb, sizeof(cb));
+    }
+
+    /**
+     * Minimal linear congruential generator so the fuzz cases are the same
+     * on every run and platform.
+     */
+    class lcg
+    {
+    public:
+        explicit lcg(unsigned long seed) : m_state(seed) {}
+
+        unsigned long operator()(unsigned long bound)
+        {
+            m_state = (m_state * 1103515245UL + 12345UL) & 0x7fffffffUL;
+            return (m_state >> 8) % bound;
+        }
+
+    private:
+        unsigned long m_state;
+    };
+
+    /**
+     * Parse the buffer and, if the parser accepts it, check the view it
+     * returns is consistent with the buffer.
+     */
+    parse_status check_parse(const vector<BYTE>& buffer)
+    {
+        const BYTE* data = (buffer.empty()) ? NULL : &buffer[0];
+
+        apidl_view view;
+        parse_status status = parse_pidl(data, buffer.size(), view);
+        if (status != parse_ok)
+        {
+            BOOST_CHECK(!view.data());
+            return status;
+        }
+
+        BOOST_REQUIRE(view.data() == reinterpret_cast<const IDABSOLUTE*>(data));
+        BOOST_REQUIRE_LE(view.item_bytes() + sizeof(USHORT), buffer.size());
+
+        // Walk it again the trusting way now that it is known to be safe
+        size_t bytes = 0;
+        size_t count = 0;
+        for (;;)
+        {
+            USHORT cb;
+            std::memcpy(&cb, data + bytes, sizeof(cb));
+            if (cb == 0)
+                break;
+            bytes += cb;
+            ++count;
+        }
+        BOOST_CHECK_EQUAL(bytes, view.item_bytes());
+        BOOST_CHECK_EQUAL(count, view.item_count());
+
+        return status;
+    }
+}
+
+BOOST_AUTO_TEST_SUITE(pidl_parse_tests)
+
+BOOST_AUTO_TEST_CASE( parse_valid )
+{
+    vector<BYTE> buffer = items("hello", "world");
+
+    apidl_view view;
+    BOOST_CHECK_EQUAL(
+        parse_pidl(&buffer[0], buffer.size(), view), parse_ok);
+    BOOST_CHECK(view.data() == reinterpret_cast<const IDABSOLUTE*>(&buffer[0]));
+    BOOST_CHECK_EQUAL(view.item_count(), 2U);
+    BOOST_CHECK_EQUAL(view.item_bytes(), buffer.size() - sizeof(USHORT));
+}
+
+BOOST_AUTO_TEST_CASE( parse_empty_pidl )
+{
+    vector<BYTE> buffer = idlist_bytes(vector<string>());
+
+    pidl_view view;
+    BOOST_CHECK_EQUAL(
+        parse_pidl(&buffer[0], buffer.size(), view), parse_ok);
+    BOOST_CHECK(view.data());
+    BOOST_CHECK(view.empty());
+    BOOST_CHECK_EQUAL(view.item_count(), 0U);
+}
+
+/**
+ * The buffer may be bigger than the PIDL it holds.
+ */
+BOOST_AUTO_TEST_CASE( parse_ignores_trailing_bytes )
+{
+    vector<BYTE> buffer = items("hello", "world");
+    size_t pidl_size = buffer.size();
+    buffer.resize(pidl_size + 7, 0xCC);
+
+    pidl_view view;
+    BOOST_CHECK_EQUAL(
+        parse_pidl(&buffer[0], buffer.size(), view), parse_ok);
+    BOOST_CHECK_EQUAL(view.item_bytes(), pidl_size - sizeof(USHORT));
+}
+
+BOOST_AUTO_TEST_CASE( parse_empty_buffer )
+{
+    pidl_view view;
+    size_t error_offset = 99;
+    BOOST_CHECK_EQUAL(
+        parse_pidl(NULL, 0, view, &error_offset), parse_truncated);
+    BOOST_CHECK_EQUAL(error_offset, 0U);
+}
+
+BOOST_AUTO_TEST_CASE( parse_missing_terminator )
+{
+    vector<BYTE> buffer = items("hello", "world");
+    buffer.resize(buffer.size() - sizeof(USHORT));
+
+    pidl_view view;
+    size_t error_offset = 0;
+    BOOST_CHECK_EQUAL(
+        parse_pidl(&buffer[0], buffer.size(), view, &error_offset),
+        parse_truncated);
+    BOOST_CHECK_EQUAL(error_offset, sizeof(USHORT) + 5);
+}
+
+BOOST_AUTO_TEST_CASE( parse_half_terminator )
+{
+    vector<BYTE> buffer = items("hello", "world");
+    buffer.resize(buffer.size() - 1);
+
+    pidl_view view;
+    BOOST_CHECK_EQUAL(
+        parse_pidl(&buffer[0], buffer.size(), view), parse_truncated);
+}
+
+BOOST_AUTO_TEST_CASE( parse_item_overruns_buffer )
+{
+    vector<BYTE> buffer = items("hello", "world");
+    set_cb(buffer, 0, static_cast<USHORT>(buffer.size() + 1));
+
+    pidl_view view;
+    size_t error_offset = 99;
+    BOOST_CHECK_EQUAL(
+        parse_pidl(&buffer[0], buffer.size(), view, &error_offset),
+        parse_truncated);
+    BOOST_CHECK_EQUAL(error_offset, 0U);
+}
+
+/**
+ * An item whose cb is 1 can't hold its own size field and would stop a
+ * trusting walk from making progress.
+ */
+BOOST_AUTO_TEST_CASE( parse_undersized_item )
+{
+    vector<BYTE> buffer = items("hello", "world");
+    size_t second = sizeof(USHORT) + 5;
+    set_cb(buffer, second, 1);
+
+    pidl_view view;
+    size_t error_offset = 0;
+    BOOST_CHECK_EQUAL(
+        parse_pidl(&buffer[0], buffer.size(), view, &error_offset),
+        parse_bad_item_size);
+    BOOST_CHECK_EQUAL(error_offset, second);
+}
+
+BOOST_AUTO_TEST_CASE( parse_child_type )
+{
+    vector<BYTE> one = idlist_bytes(vector<string>(1, "hello"));
+    vector<BYTE> two = items("hello", "world");
+
+    cpidl_view view;
+    BOOST_CHECK_EQUAL(parse_pidl(&one[0], one.size(), view), parse_ok);
+    BOOST_CHECK_EQUAL(view.item_count(), 1U);
+
+    BOOST_CHECK_EQUAL(
+        parse_pidl(&two[0], two.size(), view), parse_wrong_type);
+}
+
+/**
+ * A failed parse must leave the caller's view alone.
+ */
+BOOST_AUTO_TEST_CASE( parse_failure_leaves_result )
+{
+    vector<BYTE> good = items("hello", "world");
+    vector<BYTE> bad(good.begin(), good.end() - 1);
+
+    pidl_view view;
+    parse_pidl(&good[0], good.size(), view);
+    BOOST_CHECK_EQUAL(
+        parse_pidl(&bad[0], bad.size(), view), parse_truncated);
+    BOOST_CHECK(view.data() == reinterpret_cast<const IDRELATIVE*>(&good[0]));
+}
+
+BOOST_AUTO_TEST_CASE( validate )
+{
+    vector<BYTE> buffer = items("hello", "world");
+
+    apidl_view view = validate_pidl<IDABSOLUTE>(&buffer[0], buffer.size());
+    BOOST_CHECK_EQUAL(view.item_count(), 2U);
+
+    BOOST_CHECK_THROW(
+        validate_pidl<IDABSOLUTE>(&buffer[0], buffer.size() - 1),
+        std::invalid_argument);
+    BOOST_CHECK_THROW(
+        validate_pidl<ITEMID_CHILD>(&buffer[0], buffer.size()),
+        std::invalid_argument);
+}
+
+/**
+ * Every prefix of a valid PIDL short of the whole thing is truncated.
+ */
+BOOST_AUTO_TEST_CASE( every_truncation )
+{
+    vector<string> names;
+    names.push_back("a");
+    names.push_back("");
+    names.push_back("longer item");
+    vector<BYTE> buffer = idlist_bytes(names);
+
+    for (size_t size = 0; size < buffer.size(); ++size)
+    {
+        vector<BYTE> truncated(buffer.begin(), buffer.begin() + size);
+        BOOST_CHECK_EQUAL(check_parse(truncated), parse_truncated);
+    }
+
+    BOOST_CHECK_EQUAL(check_parse(buffer), parse_ok);
+}
+
+/**
+ * Random mutations of a valid PIDL and random garbage must never produce
+ * a view that disagrees with the buffer.
+ */
+BOOST_AUTO_TEST_CASE( fuzz )
+{
+    vector<string> names;
+    names.push_back("one");
+    names.push_back("two");
+    names.push_back("three");
+    vector<BYTE> original = idlist_bytes(names);
+
+    lcg random(0x5eed);
+    size_t accepted = 0;
+    for (int i = 0; i < 5000; ++i)
+    {
+        vector<BYTE> buffer;
+        if (i % 2)
+        {
+            buffer = original;
+            unsigned long mutations = random(4) + 1;
+            for (unsigned long m = 0; m < mutations; ++m)
+                buffer[random(buffer.size())] =
+                    static_cast<BYTE>(random(256));
+            buffer.resize(random(buffer.size() + 1));
+        }
+        else
+        {
+            buffer.resize(random(16));
+            for (size_t b = 0; b < buffer.size(); ++b)
+                buffer[b] = static_cast<BYTE>(random(8));
+        }
+
+        if (check_parse(buffer) == parse_ok)
+            ++accepted;
+    }
+
+    // Make sure the generator isn't so hostile nothing ever parses
+    BOOST_CHECK_GT(accepted, 0U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
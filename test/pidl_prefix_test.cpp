@@ -0,0 +1,265 @@
+/**
+    @file
+
+    Tests for common prefixes of PIDLs.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#include "pidl_fixtures.hpp" // pidl_fixture, binary_equal_pidls
+
+#include <washer/shell/pidl_prefix.hpp> // test subject
+
+#include <boost/test/unit_test.hpp>
+
+#include <iterator> // back_inserter
+#include <stdexcept> // invalid_argument
+#include <string>
+#include <vector>
+
+using namespace washer::shell::pidl;
+
+using washer::test::binary_equal_pidls;
+using washer::test::pidl_fixture;
+
+using std::string;
+using std::vector;
+
+namespace {
+
+    typedef ITEMIDLIST_RELATIVE IDRELATIVE;
+    typedef ITEMIDLIST_ABSOLUTE IDABSOLUTE;
+
+    class prefix_fixture : public pidl_fixture
+    {
+    public:
+
+        /**
+         * Absolute PIDL from slash-separated item names.
+         */
+        const IDABSOLUTE* path(const string& text)
+        {
+            vector<string> items;
+            string::size_type start = 0;
+            while (start < text.size())
+            {
+                string::size_type end = text.find('/', start);
+                if (end == string::npos)
+                    end = text.size();
+                items.push_back(text.substr(start, end - start));
+                start = end + 1;
+            }
+
+            return fake_pidl<IDABSOLUTE>(items);
+        }
+
+        /**
+         * Does the view hold exactly the items of the given path?
+         */
+        template<typename T>
+        bool is_path(const basic_pidl_view<T>& view, const string& text)
+        {
+            return view == basic_pidl_view<T>(
+                reinterpret_cast<const T*>(path(text)));
+        }
+    };
+}
+
+BOOST_FIXTURE_TEST_SUITE(pidl_prefix_tests, prefix_fixture)
+
+BOOST_AUTO_TEST_CASE( empty_range )
+{
+    vector<const IDABSOLUTE*> none;
+    apidl_view prefix = common_prefix(none.begin(), none.end());
+    BOOST_CHECK(!prefix);
+}
+
+/**
+ * The prefix of one PIDL is all of it.
+ */
+BOOST_AUTO_TEST_CASE( single )
+{
+    vector<const IDABSOLUTE*> pidls(1, path("a/b/c"));
+    apidl_view prefix = common_prefix(pidls.begin(), pidls.end());
+
+    BOOST_CHECK(is_path(prefix, "a/b/c"));
+    BOOST_CHECK(prefix.data() == pidls[0]);
+}
+
+/**
+ * The prefix is the deepest folder containing all the PIDLs.
+ */
+BOOST_AUTO_TEST_CASE( siblings )
+{
+    vector<const IDABSOLUTE*> pidls;
+    pidls.push_back(path("root/folder/one"));
+    pidls.push_back(path("root/folder/two"));
+    pidls.push_back(path("root/folder/sub/three"));
+
+    apidl_view prefix = common_prefix(pidls.begin(), pidls.end());
+
+    BOOST_CHECK(is_path(prefix, "root/folder"));
+    BOOST_CHECK_EQUAL(prefix.item_count(), 2U);
+    BOOST_CHECK(prefix.data() == pidls[0]);
+}
+
+/**
+ * A PIDL that is an ancestor of the others is the prefix.
+ */
+BOOST_AUTO_TEST_CASE( ancestor_in_set )
+{
+    vector<const IDABSOLUTE*> pidls;
+    pidls.push_back(path("root/folder/one"));
+    pidls.push_back(path("root/folder"));
+    pidls.push_back(path("root/folder/two/deeper"));
+
+    BOOST_CHECK(
+        is_path(common_prefix(pidls.begin(), pidls.end()), "root/folder"));
+}
+
+/**
+ * Items that share leading bytes are not a common prefix: only whole
+ * items count.
+ */
+BOOST_AUTO_TEST_CASE( whole_items_only )
+{
+    vector<const IDABSOLUTE*> pidls;
+    pidls.push_back(path("root/abcdefghijklmnop1"));
+    pidls.push_back(path("root/abcdefghijklmnop2"));
+    pidls.push_back(path("root/abcdefghijklmnop"));
+
+    BOOST_CHECK(is_path(common_prefix(pidls.begin(), pidls.end()), "root"));
+
+    // Same bytes, different item boundaries
+    vector<const IDABSOLUTE*> shifted;
+    shifted.push_back(path("abcdefghij/k"));
+    shifted.push_back(path("abcdefghijk"));
+    apidl_view prefix = common_prefix(shifted.begin(), shifted.end());
+    BOOST_CHECK(prefix.empty());
+}
+
+BOOST_AUTO_TEST_CASE( nothing_in_common )
+{
+    vector<const IDABSOLUTE*> pidls;
+    pidls.push_back(path("x/y"));
+    pidls.push_back(path("z/y"));
+
+    apidl_view prefix = common_prefix(pidls.begin(), pidls.end());
+    BOOST_CHECK(prefix.empty());
+    BOOST_CHECK(!!prefix);
+}
+
+/**
+ * Wrappers and views work as elements.
+ */
+BOOST_AUTO_TEST_CASE( wrappers_and_views )
+{
+    vector<apidl_t> wrapped;
+    wrapped.push_back(apidl_t(path("a/b/c")));
+    wrapped.push_back(apidl_t(path("a/b/d")));
+    BOOST_CHECK(is_path(common_prefix(wrapped.begin(), wrapped.end()), "a/b"));
+
+    vector<apidl_view> views(wrapped.begin(), wrapped.end());
+    BOOST_CHECK(is_path(common_prefix(views.begin(), views.end()), "a/b"));
+}
+
+/**
+ * Long items are compared a word at a time; a difference anywhere in them
+ * is found.
+ */
+BOOST_AUTO_TEST_CASE( long_items )
+{
+    string long_item(100, 'x');
+    for (size_t i = 0; i < long_item.size(); ++i)
+    {
+        string different = long_item;
+        different[i] = 'y';
+
+        vector<const IDABSOLUTE*> pidls;
+        pidls.push_back(path("root/" + long_item + "/leaf"));
+        pidls.push_back(path("root/" + different + "/leaf"));
+
+        BOOST_CHECK_MESSAGE(
+            is_path(common_prefix(pidls.begin(), pidls.end()), "root"),
+            "Differing at byte " << i);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( relative )
+{
+    const IDABSOLUTE* pidl = path("a/b/c/d");
+    pidl_view rest = relative_to(view(path("a/b")), pidl);
+
+    BOOST_CHECK_EQUAL(rest.item_count(), 2U);
+    BOOST_CHECK(
+        binary_equal_pidls(
+            rest.data(), reinterpret_cast<const IDRELATIVE*>(
+                path("c/d"))));
+
+    BOOST_CHECK(relative_to(view(pidl), pidl).empty());
+    BOOST_CHECK_EQUAL(
+        relative_to(view(empty_pidl<IDABSOLUTE>()), pidl).item_count(), 4U);
+}
+
+BOOST_AUTO_TEST_CASE( relative_not_prefix )
+{
+    const IDABSOLUTE* pidl = path("a/b/c");
+    BOOST_CHECK_THROW(
+        relative_to(view(path("a/x")), pidl), std::invalid_argument);
+    BOOST_CHECK_THROW(
+        relative_to(view(path("a/b/c/d")), pidl), std::invalid_argument);
+}
+
+/**
+ * Splitting gives the prefix and each PIDL relative to it, in place.
+ */
+BOOST_AUTO_TEST_CASE( split )
+{
+    vector<const IDABSOLUTE*> pidls;
+    pidls.push_back(path("root/folder/one"));
+    pidls.push_back(path("root/folder/two/three"));
+    pidls.push_back(path("root/folder"));
+
+    vector<pidl_view> relatives;
+    apidl_view prefix = split_common_prefix(
+        pidls.begin(), pidls.end(), std::back_inserter(relatives));
+
+    BOOST_CHECK(is_path(prefix, "root/folder"));
+    BOOST_REQUIRE_EQUAL(relatives.size(), 3U);
+    BOOST_CHECK(is_path(relatives[0], "one"));
+    BOOST_CHECK(is_path(relatives[1], "two/three"));
+    BOOST_CHECK(relatives[2].empty());
+
+    for (size_t i = 0; i < pidls.size(); ++i)
+    {
+        const BYTE* start = reinterpret_cast<const BYTE*>(pidls[i]);
+        BOOST_CHECK(
+            reinterpret_cast<const BYTE*>(relatives[i].data()) ==
+            start + prefix.item_bytes());
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
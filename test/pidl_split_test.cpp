@@ -0,0 +1,219 @@
+/**
+    @file
+
+    Unit tests for splitting PIDLs into parent and last item.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#include "pidl_fixtures.hpp" // pidl_fixture, binary_equal_pidls, heap_pidl
+
+#include <washer/shell/pidl_split.hpp> // test subject
+
+#include <boost/move/move.hpp> // move
+#include <boost/mpl/list.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_case_template.hpp>
+
+#include <stdexcept> // logic_error
+#include <string>
+#include <vector>
+
+using namespace washer::shell::pidl;
+
+using washer::test::binary_equal_pidls;
+using washer::test::heap_pidl;
+using washer::test::pidl_fixture;
+
+using std::string;
+using std::vector;
+
+namespace {
+
+    typedef ITEMIDLIST_RELATIVE IDRELATIVE;
+    typedef ITEMIDLIST_ABSOLUTE IDABSOLUTE;
+    typedef ITEMID_CHILD IDCHILD;
+
+    typedef boost::mpl::list<IDRELATIVE, IDABSOLUTE> adult_pidl_types;
+
+    vector<string> three_items()
+    {
+        vector<string> items;
+        items.push_back("first");
+        items.push_back("second item");
+        items.push_back("third");
+        return items;
+    }
+
+    /**
+     * Check a split matches what parent() and last_item() give.
+     */
+    template<typename T>
+    void check_split(const basic_split_view<T>& split, const T* pidl)
+    {
+        typename heap_pidl<T>::type wrapper(pidl);
+
+        BOOST_CHECK(
+            binary_equal_pidls(
+                typename heap_pidl<T>::type(split.parent).get(),
+                wrapper.parent().get()));
+        BOOST_CHECK_EQUAL(
+            split.parent.item_count(), wrapper.item_count() - 1);
+        BOOST_CHECK(
+            binary_equal_pidls(split.child.data(), wrapper.last_item().get()));
+        BOOST_CHECK_EQUAL(split.child.item_count(), 1U);
+    }
+}
+
+BOOST_FIXTURE_TEST_SUITE(pidl_split_tests, pidl_fixture)
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( split_wrapper, T, adult_pidl_types )
+{
+    const T* raw = fake_pidl<T>(three_items());
+    typename heap_pidl<T>::type pidl(raw);
+
+    basic_split_view<T> split = pidl.split();
+    BOOST_CHECK_EQUAL(split.parent.data(), pidl.get());
+    check_split(split, raw);
+}
+
+/**
+ * A wrapper that hasn't been measured yet, because it attached to its
+ * PIDL, measures itself to split.
+ */
+BOOST_AUTO_TEST_CASE( split_attached_wrapper )
+{
+    const IDABSOLUTE* raw = fake_pidl<IDABSOLUTE>(three_items());
+    heap_pidl<IDABSOLUTE>::type source(raw);
+
+    heap_pidl<IDABSOLUTE>::type pidl;
+    pidl.attach(source.detach());
+
+    check_split(pidl.split(), raw);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( split_view, T, adult_pidl_types )
+{
+    const T* raw = fake_pidl<T>(three_items());
+
+    basic_split_view<T> split = basic_pidl_view<T>(raw).split();
+    BOOST_CHECK_EQUAL(split.parent.data(), raw);
+    check_split(split, raw);
+}
+
+BOOST_AUTO_TEST_CASE( split_single_item )
+{
+    const IDABSOLUTE* raw = fake_pidl<IDABSOLUTE>("only");
+
+    basic_split_view<IDABSOLUTE> split = apidl_view(raw).split();
+    BOOST_CHECK(split.parent.empty());
+    BOOST_CHECK_EQUAL(split.parent.data(), raw);
+    BOOST_CHECK(binary_equal_pidls(split.child.data(), raw));
+}
+
+BOOST_AUTO_TEST_CASE( split_empty )
+{
+    heap_pidl<IDABSOLUTE>::type empty(empty_pidl<IDABSOLUTE>());
+    heap_pidl<IDABSOLUTE>::type null;
+
+    BOOST_CHECK_THROW(empty.split(), std::logic_error);
+    BOOST_CHECK_THROW(null.split(), std::logic_error);
+    BOOST_CHECK_THROW(apidl_view(empty).split(), std::logic_error);
+    BOOST_CHECK_THROW(
+        split_apidl(empty_pidl<IDABSOLUTE>()), std::logic_error);
+}
+
+/**
+ * The owning split's PIDLs are both null-terminated so can be used as raw
+ * PIDLs.
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE( owning_split, T, adult_pidl_types )
+{
+    const T* raw = fake_pidl<T>(three_items());
+    typename heap_pidl<T>::type wrapper(raw);
+
+    basic_split_pidl<T, newdelete_alloc<T> > split(raw);
+
+    BOOST_CHECK(
+        binary_equal_pidls(split.get_parent(), wrapper.parent().get()));
+    BOOST_CHECK(
+        binary_equal_pidls(split.get_child(), wrapper.last_item().get()));
+    BOOST_CHECK_EQUAL(split.parent().item_count(), 2U);
+    BOOST_CHECK_EQUAL(split.child().item_count(), 1U);
+    BOOST_CHECK_EQUAL(
+        split.allocated_bytes(),
+        wrapper.parent().size() + wrapper.last_item().size());
+}
+
+BOOST_AUTO_TEST_CASE( owning_split_of_wrapper_and_view )
+{
+    const IDABSOLUTE* raw = fake_pidl<IDABSOLUTE>(three_items());
+    heap_pidl<IDABSOLUTE>::type wrapper(raw);
+
+    basic_split_pidl<IDABSOLUTE, newdelete_alloc<IDABSOLUTE> > from_wrapper(
+        wrapper);
+    apidl_view view(raw);
+    basic_split_pidl<IDABSOLUTE, newdelete_alloc<IDABSOLUTE> > from_view(
+        view);
+
+    BOOST_CHECK(
+        binary_equal_pidls(
+            from_wrapper.get_parent(), wrapper.parent().get()));
+    BOOST_CHECK(
+        binary_equal_pidls(from_view.get_parent(), wrapper.parent().get()));
+    BOOST_CHECK(
+        binary_equal_pidls(from_view.get_child(), wrapper.last_item().get()));
+}
+
+BOOST_AUTO_TEST_CASE( owning_split_single_item )
+{
+    const IDABSOLUTE* raw = fake_pidl<IDABSOLUTE>("only");
+
+    basic_split_pidl<IDABSOLUTE, newdelete_alloc<IDABSOLUTE> > split(raw);
+    BOOST_CHECK(split.parent().empty());
+    BOOST_CHECK(
+        binary_equal_pidls(split.get_parent(), empty_pidl<IDABSOLUTE>()));
+    BOOST_CHECK(binary_equal_pidls(split.get_child(), raw));
+}
+
+BOOST_AUTO_TEST_CASE( owning_split_move )
+{
+    typedef basic_split_pidl<IDABSOLUTE, newdelete_alloc<IDABSOLUTE> >
+        split_type;
+
+    split_type split(fake_pidl<IDABSOLUTE>(three_items()));
+    const IDABSOLUTE* parent = split.get_parent();
+
+    split_type moved(boost::move(split));
+    BOOST_CHECK_EQUAL(moved.get_parent(), parent);
+    BOOST_CHECK(!split.get_parent());
+
+    split_type other(fake_pidl<IDABSOLUTE>("other"));
+    other = boost::move(moved);
+    BOOST_CHECK_EQUAL(other.get_parent(), parent);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,308 @@
+/**
+    @file
+
+    Unit tests for the memory-mapped PIDL store.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#include "pidl_fixtures.hpp" // pidl_fixture, binary_equal_pidls
+
+#include <washer/shell/pidl_store.hpp> // test subject
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstdio> // remove
+#include <cstring> // memcpy
+#include <fstream> // ifstream, ofstream
+#include <iterator> // istreambuf_iterator
+#include <stdexcept> // runtime_error, out_of_range
+#include <string>
+#include <vector>
+
+using namespace washer::shell::pidl;
+
+using washer::test::binary_equal_pidls;
+using washer::test::pidl_fixture;
+
+using std::string;
+using std::vector;
+
+namespace {
+
+    typedef ITEMIDLIST_RELATIVE IDRELATIVE;
+
+    const char* store_file = "washer_pidl_store_test.tmp";
+
+    class store_fixture : public pidl_fixture
+    {
+    public:
+
+        ~store_fixture()
+        {
+            std::remove(store_file);
+        }
+
+        vector<BYTE> file_bytes()
+        {
+            std::ifstream file(store_file, std::ios::binary);
+            return vector<BYTE>(
+                (std::istreambuf_iterator<char>(file)),
+                std::istreambuf_iterator<char>());
+        }
+
+        void replace_file(const vector<BYTE>& bytes)
+        {
+            std::ofstream file(
+                store_file, std::ios::binary | std::ios::trunc);
+            file.write(
+                reinterpret_cast<const char*>(&bytes[0]), bytes.size());
+        }
+
+        /**
+         * Write a store of the PIDLs "one", "two/three" and "four" with
+         * their names as metadata.
+         */
+        void write_sample()
+        {
+            pidl_store_writer writer(store_file);
+            writer.push_back(fake_pidl<IDRELATIVE>("one"), "1", 1);
+            writer.push_back(
+                fake_pidl<IDRELATIVE>("two", "three"), "23", 2);
+            writer.push_back(fake_pidl<IDRELATIVE>("four"));
+            writer.commit();
+        }
+    };
+
+    string metadata_string(const boost::iterator_range<const BYTE*>& range)
+    {
+        return string(range.begin(), range.end());
+    }
+}
+
+BOOST_FIXTURE_TEST_SUITE(pidl_store_tests, store_fixture)
+
+BOOST_AUTO_TEST_CASE( round_trip )
+{
+    write_sample();
+
+    mapped_pidl_store store(store_file);
+    const pidl_store_view& view = store.view();
+
+    BOOST_REQUIRE_EQUAL(view.size(), 3U);
+    BOOST_CHECK(!view.empty());
+
+    BOOST_CHECK(
+        binary_equal_pidls(view[0].data(), fake_pidl<IDRELATIVE>("one")));
+    BOOST_CHECK(
+        binary_equal_pidls(
+            view[1].data(), fake_pidl<IDRELATIVE>("two", "three")));
+    BOOST_CHECK(
+        binary_equal_pidls(view[2].data(), fake_pidl<IDRELATIVE>("four")));
+    BOOST_CHECK_EQUAL(view[1].item_count(), 2U);
+
+    BOOST_CHECK_EQUAL(metadata_string(view.metadata(0)), "1");
+    BOOST_CHECK_EQUAL(metadata_string(view.metadata(1)), "23");
+    BOOST_CHECK(view.metadata(2).empty());
+}
+
+BOOST_AUTO_TEST_CASE( iterate )
+{
+    write_sample();
+
+    mapped_pidl_store store(store_file);
+
+    size_t items = 0;
+    for (pidl_store_view::const_iterator it = store.view().begin();
+         it != store.view().end(); ++it)
+    {
+        items += it->item_count();
+    }
+    BOOST_CHECK_EQUAL(items, 4U);
+    BOOST_CHECK_EQUAL(store.view().end() - store.view().begin(), 3);
+}
+
+BOOST_AUTO_TEST_CASE( empty_store )
+{
+    pidl_store_writer writer(store_file);
+    writer.commit();
+
+    mapped_pidl_store store(store_file);
+    BOOST_CHECK(store.view().empty());
+    BOOST_CHECK(store.view().begin() == store.view().end());
+}
+
+BOOST_AUTO_TEST_CASE( at )
+{
+    write_sample();
+
+    mapped_pidl_store store(store_file);
+    BOOST_CHECK_EQUAL(store.view().at(2).item_count(), 1U);
+    BOOST_CHECK_THROW(store.view().at(3), std::out_of_range);
+}
+
+/**
+ * Readers must not see a store that was never committed.
+ */
+BOOST_AUTO_TEST_CASE( uncommitted )
+{
+    {
+        pidl_store_writer writer(store_file);
+        writer.push_back(fake_pidl<IDRELATIVE>("one"));
+    }
+
+    BOOST_CHECK_THROW(
+        mapped_pidl_store(store_file, verify_checksum), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE( commit_twice )
+{
+    pidl_store_writer writer(store_file);
+    writer.push_back(fake_pidl<IDRELATIVE>("one"));
+    writer.commit();
+
+    {
+        mapped_pidl_store store(store_file);
+        BOOST_CHECK_EQUAL(store.view().size(), 1U);
+    }
+
+    writer.push_back(fake_pidl<IDRELATIVE>("two"));
+    writer.commit();
+
+    mapped_pidl_store store(store_file);
+    BOOST_REQUIRE_EQUAL(store.view().size(), 2U);
+    BOOST_CHECK(
+        binary_equal_pidls(
+            store.view()[1].data(), fake_pidl<IDRELATIVE>("two")));
+}
+
+BOOST_AUTO_TEST_CASE( append )
+{
+    write_sample();
+
+    {
+        pidl_store_writer writer(store_file, pidl_store_writer::append);
+        BOOST_CHECK_EQUAL(writer.size(), 3U);
+        writer.push_back(fake_pidl<IDRELATIVE>("five"), "5", 1);
+        writer.commit();
+    }
+
+    mapped_pidl_store store(store_file);
+    const pidl_store_view& view = store.view();
+    BOOST_REQUIRE_EQUAL(view.size(), 4U);
+    BOOST_CHECK(
+        binary_equal_pidls(
+            view[1].data(), fake_pidl<IDRELATIVE>("two", "three")));
+    BOOST_CHECK(
+        binary_equal_pidls(view[3].data(), fake_pidl<IDRELATIVE>("five")));
+    BOOST_CHECK_EQUAL(metadata_string(view.metadata(1)), "23");
+    BOOST_CHECK_EQUAL(metadata_string(view.metadata(3)), "5");
+}
+
+BOOST_AUTO_TEST_CASE( append_to_corrupt_store )
+{
+    write_sample();
+    vector<BYTE> bytes = file_bytes();
+    bytes[bytes.size() - 1] ^= 0xFF;
+    replace_file(bytes);
+
+    BOOST_CHECK_THROW(
+        pidl_store_writer(store_file, pidl_store_writer::append),
+        std::runtime_error);
+}
+
+/**
+ * A damaged record is caught by the CRC when verifying, and skipping the
+ * CRC still gives the damaged store's records rather than failing.
+ */
+BOOST_AUTO_TEST_CASE( checksum )
+{
+    write_sample();
+    vector<BYTE> bytes = file_bytes();
+
+    // Change a character of the first item's data
+    bytes[sizeof(detail::store_header) + sizeof(USHORT)] = 'X';
+    replace_file(bytes);
+
+    BOOST_CHECK_THROW(
+        mapped_pidl_store(store_file, verify_checksum), std::runtime_error);
+
+    mapped_pidl_store store(store_file, skip_checksum);
+    BOOST_CHECK(
+        binary_equal_pidls(
+            store.view()[0].data(), fake_pidl<IDRELATIVE>("Xne")));
+}
+
+BOOST_AUTO_TEST_CASE( truncated )
+{
+    write_sample();
+    vector<BYTE> bytes = file_bytes();
+
+    for (size_t size = 0; size < bytes.size(); size += 7)
+    {
+        vector<BYTE> truncated(bytes.begin(), bytes.begin() + size);
+        BOOST_CHECK_THROW(
+            pidl_store_view(
+                (truncated.empty()) ? NULL : &truncated[0], truncated.size(),
+                skip_checksum),
+            std::runtime_error);
+    }
+}
+
+/**
+ * An index entry that points outside the records is caught when the
+ * record is accessed even if the CRC isn't checked.
+ */
+BOOST_AUTO_TEST_CASE( bad_index_entry )
+{
+    write_sample();
+    vector<BYTE> bytes = file_bytes();
+
+    detail::store_header header;
+    std::memcpy(&header, &bytes[0], sizeof(header));
+
+    detail::store_entry entry;
+    BYTE* first_entry = &bytes[static_cast<size_t>(header.index_offset)];
+    std::memcpy(&entry, first_entry, sizeof(entry));
+    entry.pidl_size = 0xFFFF;
+    std::memcpy(first_entry, &entry, sizeof(entry));
+
+    pidl_store_view view(&bytes[0], bytes.size(), skip_checksum);
+    BOOST_CHECK_THROW(view[0], std::runtime_error);
+    BOOST_CHECK_THROW(view.metadata(0), std::runtime_error);
+    BOOST_CHECK_EQUAL(view[1].item_count(), 2U);
+}
+
+BOOST_AUTO_TEST_CASE( child_store_rejects_non_child )
+{
+    write_sample();
+
+    mapped_cpidl_store store(store_file);
+    BOOST_CHECK_EQUAL(store.view()[0].item_count(), 1U);
+    BOOST_CHECK_THROW(store.view()[1], std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,355 @@
+/**
+    @file
+
+    Unit tests for streaming PIDLs to and from bytes.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#include "pidl_fixtures.hpp" // pidl_fixture, binary_equal_pidls, heap_pidl
+
+#include <washer/shell/pidl_stream.hpp> // test subject
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm> // find, min
+#include <cstdio> // remove
+#include <fstream> // ifstream, ofstream
+#include <stdexcept> // runtime_error, invalid_argument
+#include <string>
+#include <vector>
+
+using namespace washer::shell::pidl;
+
+using washer::test::binary_equal_pidls;
+using washer::test::heap_pidl;
+using washer::test::pidl_fixture;
+
+using std::string;
+using std::vector;
+
+namespace {
+
+    typedef ITEMIDLIST_ABSOLUTE IDABSOLUTE;
+    typedef ITEMIDLIST_RELATIVE IDRELATIVE;
+
+    typedef basic_pidl_reader<
+        IDABSOLUTE, memory_byte_source, newdelete_alloc<IDABSOLUTE> >
+        memory_reader;
+
+    const char* stream_file = "washer_pidl_stream_test.tmp";
+
+    /**
+     * Source that hands out at most @a chunk bytes per read, as a pipe or
+     * socket might.
+     */
+    class trickle_source
+    {
+    public:
+
+        trickle_source(const vector<BYTE>& bytes, size_t chunk)
+            : m_source(&bytes[0], bytes.size()), m_chunk(chunk) {}
+
+        size_t read(void* buffer, size_t size)
+        {
+            return m_source.read(buffer, (std::min)(size, m_chunk));
+        }
+
+    private:
+        memory_byte_source m_source;
+        size_t m_chunk;
+    };
+
+    class stream_fixture : public pidl_fixture
+    {
+    public:
+
+        ~stream_fixture()
+        {
+            std::remove(stream_file);
+        }
+
+        /**
+         * A history of PIDLs of different lengths, including an empty one.
+         */
+        vector<const IDABSOLUTE*> history()
+        {
+            vector<const IDABSOLUTE*> pidls;
+            pidls.push_back(fake_pidl<IDABSOLUTE>("desktop"));
+            pidls.push_back(fake_pidl<IDABSOLUTE>("C:\\", "Users"));
+            pidls.push_back(empty_pidl<IDABSOLUTE>());
+
+            vector<string> deep;
+            for (size_t i = 0; i < 20; ++i)
+                deep.push_back(string(i + 1, 'x'));
+            pidls.push_back(fake_pidl<IDABSOLUTE>(deep));
+
+            pidls.push_back(fake_pidl<IDABSOLUTE>("C:\\", "Users"));
+            return pidls;
+        }
+
+        vector<BYTE> written(const vector<const IDABSOLUTE*>& pidls)
+        {
+            vector<BYTE> bytes;
+            vector_byte_sink sink(bytes);
+            pidl_writer<vector_byte_sink> writer(sink);
+            for (size_t i = 0; i < pidls.size(); ++i)
+                writer.write(pidls[i]);
+            writer.flush();
+            return bytes;
+        }
+
+        template<typename Reader>
+        void check_read_back(
+            Reader& reader, const vector<const IDABSOLUTE*>& pidls)
+        {
+            basic_pidl_view<IDABSOLUTE> view;
+            for (size_t i = 0; i < pidls.size(); ++i)
+            {
+                BOOST_REQUIRE(reader.next(view));
+                BOOST_CHECK(binary_equal_pidls(view.data(), pidls[i]));
+                BOOST_CHECK_EQUAL(
+                    view.item_count(),
+                    raw_pidl::measure(pidls[i]).item_count);
+            }
+            BOOST_CHECK(!reader.next(view));
+            BOOST_CHECK_EQUAL(reader.pidls_read(), pidls.size());
+        }
+    };
+}
+
+BOOST_FIXTURE_TEST_SUITE(pidl_stream_tests, stream_fixture)
+
+BOOST_AUTO_TEST_CASE( written_as_concatenated_pidls )
+{
+    vector<const IDABSOLUTE*> pidls;
+    pidls.push_back(fake_pidl<IDABSOLUTE>("a"));
+    pidls.push_back(fake_pidl<IDABSOLUTE>("bc", "d"));
+
+    vector<BYTE> expected;
+    for (size_t i = 0; i < pidls.size(); ++i)
+    {
+        const BYTE* bytes = reinterpret_cast<const BYTE*>(pidls[i]);
+        expected.insert(
+            expected.end(), bytes, bytes + raw_pidl::size(pidls[i]));
+    }
+
+    vector<BYTE> bytes = written(pidls);
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+        bytes.begin(), bytes.end(), expected.begin(), expected.end());
+}
+
+BOOST_AUTO_TEST_CASE( round_trip )
+{
+    vector<const IDABSOLUTE*> pidls = history();
+    vector<BYTE> bytes = written(pidls);
+
+    memory_byte_source source(&bytes[0], bytes.size());
+    memory_reader reader(source);
+    check_read_back(reader, pidls);
+}
+
+/**
+ * Items straddling the reader's buffer are put back together, however
+ * small the buffer and however little each read returns.
+ */
+BOOST_AUTO_TEST_CASE( items_straddle_buffers )
+{
+    vector<const IDABSOLUTE*> pidls = history();
+    vector<BYTE> bytes = written(pidls);
+
+    for (size_t buffer_size = 1; buffer_size < 8; ++buffer_size)
+    {
+        for (size_t chunk = 1; chunk < 4; ++chunk)
+        {
+            trickle_source source(bytes, chunk);
+            basic_pidl_reader<IDABSOLUTE, trickle_source> reader(
+                source, buffer_size);
+            check_read_back(reader, pidls);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( read_into_wrapper )
+{
+    vector<const IDABSOLUTE*> pidls = history();
+    vector<BYTE> bytes = written(pidls);
+
+    memory_byte_source source(&bytes[0], bytes.size());
+    memory_reader reader(source);
+
+    heap_pidl<IDABSOLUTE>::type pidl;
+    for (size_t i = 0; i < pidls.size(); ++i)
+    {
+        BOOST_REQUIRE(reader.read(pidl));
+        BOOST_CHECK(binary_equal_pidls(pidl.get(), pidls[i]));
+    }
+
+    BOOST_CHECK(!reader.read(pidl));
+    BOOST_CHECK(binary_equal_pidls(pidl.get(), pidls.back()));
+}
+
+BOOST_AUTO_TEST_CASE( empty_stream )
+{
+    memory_byte_source source(NULL, 0);
+    memory_reader reader(source);
+
+    basic_pidl_view<IDABSOLUTE> view;
+    BOOST_CHECK(!reader.next(view));
+    BOOST_CHECK_EQUAL(reader.pidls_read(), 0U);
+}
+
+/**
+ * The stream ending anywhere other than between PIDLs is an error.
+ */
+BOOST_AUTO_TEST_CASE( truncated )
+{
+    vector<const IDABSOLUTE*> pidls = history();
+    vector<BYTE> bytes = written(pidls);
+
+    vector<size_t> boundaries(1, 0);
+    for (size_t i = 0; i < pidls.size(); ++i)
+        boundaries.push_back(boundaries.back() + raw_pidl::size(pidls[i]));
+
+    for (size_t length = 1; length < bytes.size(); ++length)
+    {
+        memory_byte_source source(&bytes[0], length);
+        memory_reader reader(source, 3);
+
+        bool between_pidls = std::find(
+            boundaries.begin(), boundaries.end(), length) != boundaries.end();
+
+        basic_pidl_view<IDABSOLUTE> view;
+        if (between_pidls)
+        {
+            BOOST_CHECK_NO_THROW(while (reader.next(view)) {});
+        }
+        else
+        {
+            BOOST_CHECK_THROW(
+                while (reader.next(view)) {}, std::runtime_error);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( invalid_item_size )
+{
+    const BYTE bytes[] = { 1, 0, 0, 0 };
+    memory_byte_source source(bytes, sizeof(bytes));
+    memory_reader reader(source);
+
+    basic_pidl_view<IDABSOLUTE> view;
+    BOOST_CHECK_THROW(reader.next(view), std::runtime_error);
+}
+
+/**
+ * A child reader must not hand back a PIDL with more than one item.
+ */
+BOOST_AUTO_TEST_CASE( child_reader_rejects_multiple_items )
+{
+    vector<const IDABSOLUTE*> pidls;
+    pidls.push_back(fake_pidl<IDABSOLUTE>("single"));
+    pidls.push_back(fake_pidl<IDABSOLUTE>("C:\\", "Users"));
+    vector<BYTE> bytes = written(pidls);
+
+    memory_byte_source source(&bytes[0], bytes.size());
+    basic_pidl_reader<
+        ITEMID_CHILD, memory_byte_source, newdelete_alloc<ITEMID_CHILD> >
+        reader(source);
+
+    basic_pidl_view<ITEMID_CHILD> view;
+    BOOST_CHECK(reader.next(view));
+    BOOST_CHECK_EQUAL(view.item_count(), 1U);
+    BOOST_CHECK_THROW(reader.next(view), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE( size_limit )
+{
+    vector<const IDABSOLUTE*> pidls;
+    pidls.push_back(fake_pidl<IDABSOLUTE>("short"));
+    pidls.push_back(fake_pidl<IDABSOLUTE>(string(100, 'x')));
+    vector<BYTE> bytes = written(pidls);
+
+    memory_byte_source source(&bytes[0], bytes.size());
+    memory_reader reader(source, 16, 64);
+
+    basic_pidl_view<IDABSOLUTE> view;
+    BOOST_CHECK(reader.next(view));
+    BOOST_CHECK_THROW(reader.next(view), std::runtime_error);
+
+    memory_byte_source exact_source(&bytes[0], bytes.size());
+    memory_reader exact(exact_source, 16, raw_pidl::size(pidls[1]));
+    check_read_back(exact, pidls);
+}
+
+BOOST_AUTO_TEST_CASE( invalid_reader_arguments )
+{
+    memory_byte_source source(NULL, 0);
+    BOOST_CHECK_THROW(memory_reader(source, 0), std::invalid_argument);
+    BOOST_CHECK_THROW(memory_reader(source, 16, 1), std::invalid_argument);
+}
+
+/**
+ * PIDLs bigger than the writer's buffer go straight to the sink, in
+ * order with the buffered ones.
+ */
+BOOST_AUTO_TEST_CASE( writer_small_buffer )
+{
+    vector<const IDABSOLUTE*> pidls = history();
+
+    vector<BYTE> bytes;
+    vector_byte_sink sink(bytes);
+    {
+        pidl_writer<vector_byte_sink> writer(sink, 8);
+        for (size_t i = 0; i < pidls.size(); ++i)
+            writer.write(heap_pidl<IDABSOLUTE>::type(pidls[i]));
+        writer.write(static_cast<const IDABSOLUTE*>(NULL));
+        BOOST_CHECK_EQUAL(writer.pidls_written(), pidls.size() + 1);
+    }
+
+    pidls.push_back(empty_pidl<IDABSOLUTE>());
+    BOOST_CHECK(bytes == written(pidls));
+}
+
+BOOST_AUTO_TEST_CASE( file_round_trip )
+{
+    vector<const IDABSOLUTE*> pidls = history();
+    {
+        std::ofstream file(stream_file, std::ios::binary);
+        ostream_byte_sink sink(file);
+        pidl_writer<ostream_byte_sink> writer(sink);
+        for (size_t i = 0; i < pidls.size(); ++i)
+            writer.write(apidl_view(pidls[i]));
+        writer.flush();
+    }
+
+    std::ifstream file(stream_file, std::ios::binary);
+    istream_byte_source source(file);
+    basic_pidl_reader<IDABSOLUTE, istream_byte_source> reader(source, 5);
+    check_read_back(reader, pidls);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
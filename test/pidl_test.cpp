@@ -29,6 +29,9 @@
     @endif
 */
 
+#include "il_functions.hpp" // ILClone etc.
+#include "pidl_fixtures.hpp" // binary_equal_pidls
+
 #include <washer/shell/pidl.hpp>  // test subject
 
 #include <boost/test/unit_test.hpp>
@@ -38,8 +41,7 @@
 #include <boost/shared_ptr.hpp>  // shared_ptr
 #include <boost/numeric/conversion/cast.hpp>  // numeric_cast
 
-#include <ShlObj.h>  // ILClone etc.
-
+#include <cstdlib> // malloc, free
 #include <cstring> // memset, memcpy
 #include <stdexcept> // logic_error
 #include <string>
@@ -50,7 +52,8 @@ using namespace washer::shell::pidl;
 using boost::lexical_cast;
 using boost::numeric_cast;
 using boost::shared_ptr;
-using boost::test_tools::predicate_result;
+
+using washer::test::binary_equal_pidls;
 
 using std::string;
 using std::vector;
@@ -124,8 +127,7 @@ namespace {
             // cache so we build them all as plain PIDLs and just pretend
             // they have a specific type when we return them.
             shared_ptr<ITEMIDLIST> pidl(
-                static_cast<ITEMIDLIST*>(::CoTaskMemAlloc(size)),
-                ::CoTaskMemFree);
+                static_cast<ITEMIDLIST*>(std::malloc(size)), std::free);
             BOOST_REQUIRE(pidl);
 
             m_fake_pidl_cache.push_back(pidl);
@@ -161,23 +163,11 @@ namespace {
 
     int PidlFixture::instance_tag = 0;
 
-
-    /**
-     * Compare two PIDLs as a sequence of bytes.  Display mismatch as though
-     * the were streams of characters.
-     */
-    predicate_result binary_equal_pidls(
-        PCUIDLIST_RELATIVE pidl1, PCUIDLIST_RELATIVE pidl2)
-    {
-        const char* lhs = reinterpret_cast<const char*>(pidl1);
-        const char* rhs = reinterpret_cast<const char*>(pidl2);
-        return boost::test_tools::tt_detail::equal_coll_impl(
-            lhs, lhs + ::ILGetSize(pidl1),
-            rhs, rhs + ::ILGetSize(pidl2));
-    }
 }
 
+#ifdef _MSC_VER
 #pragma region basic_pidl creation tests
+#endif
 BOOST_FIXTURE_TEST_SUITE(basic_pidl_creation_tests, PidlFixture)
 
 /**
@@ -185,7 +175,7 @@ BOOST_FIXTURE_TEST_SUITE(basic_pidl_creation_tests, PidlFixture)
  */
 BOOST_AUTO_TEST_CASE_TEMPLATE( create, T, pidl_types )
 {
-    heap_pidl<T>::type pidl;
+    typename heap_pidl<T>::type pidl;
     BOOST_CHECK(!pidl.get());
     BOOST_CHECK(!pidl);
     BOOST_REQUIRE(pidl.empty());
@@ -196,7 +186,7 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( create, T, pidl_types )
  */
 BOOST_AUTO_TEST_CASE_TEMPLATE( create_null, T, pidl_types )
 {
-    heap_pidl<T>::type pidl(NULL);
+    typename heap_pidl<T>::type pidl(NULL);
     BOOST_CHECK(!pidl.get());
     BOOST_CHECK(!pidl);
     BOOST_REQUIRE(pidl.empty());
@@ -207,7 +197,7 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( create_null, T, pidl_types )
  */
 BOOST_AUTO_TEST_CASE_TEMPLATE( create_non_null, T, pidl_types )
 {
-    heap_pidl<T>::type pidl(fake_pidl<T>());
+    typename heap_pidl<T>::type pidl(fake_pidl<T>());
     BOOST_CHECK(pidl.get());
     BOOST_CHECK(!!pidl);
     BOOST_REQUIRE(!pidl.empty());
@@ -220,16 +210,20 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( create_non_null, T, pidl_types )
 BOOST_AUTO_TEST_CASE_TEMPLATE( create_empty, T, pidl_types )
 {
     SHITEMID empty = {0, {0}};
-    heap_pidl<T>::type pidl(reinterpret_cast<const T*>(&empty));
+    typename heap_pidl<T>::type pidl(reinterpret_cast<const T*>(&empty));
     BOOST_CHECK(pidl.get());
     BOOST_CHECK(!!pidl);
     BOOST_REQUIRE(pidl.empty());
 }
 
 BOOST_AUTO_TEST_SUITE_END()
+#ifdef _MSC_VER
 #pragma endregion
+#endif
 
+#ifdef _MSC_VER
 #pragma region raw PIDL function tests
+#endif
 BOOST_FIXTURE_TEST_SUITE(raw_pidl_func_tests, PidlFixture)
 
 /**
@@ -264,7 +258,8 @@ template<typename T, typename U>
 inline void do_combine_test(const T* pidl1, const U* pidl2)
 {
     shared_ptr<IDRELATIVE> combined_pidl(
-        raw_pidl::combine<newdelete_alloc<IDRELATIVE> >(pidl1, pidl2));
+        raw_pidl::combine<newdelete_alloc<IDRELATIVE> >(pidl1, pidl2),
+        newdelete_alloc<IDRELATIVE>::deallocate);
 
     shared_ptr<IDRELATIVE> expected(
         reinterpret_cast<PIDLIST_RELATIVE>(::ILCombine(
@@ -347,9 +342,13 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( combine_pidl_empty, T, relative_pidl_types )
 }
 
 BOOST_AUTO_TEST_SUITE_END()
+#ifdef _MSC_VER
 #pragma endregion
+#endif
 
+#ifdef _MSC_VER
 #pragma region basic_pidl tests
+#endif
 BOOST_FIXTURE_TEST_SUITE(basic_pidl_tests, PidlFixture)
 
 /**
@@ -361,7 +360,7 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( initialise, T, pidl_types )
 {
     const T* raw = fake_pidl<T>();
 
-    heap_pidl<T>::type pidl(raw);
+    typename heap_pidl<T>::type pidl(raw);
 
     BOOST_REQUIRE(binary_equal_pidls(pidl.get(), raw));
 
@@ -377,7 +376,7 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( initialise_empty, T, pidl_types )
 {
     SHITEMID empty = {0, {0}};
     const T* empty_pidl = reinterpret_cast<const T*>(&empty);
-    heap_pidl<T>::type pidl(empty_pidl);
+    typename heap_pidl<T>::type pidl(empty_pidl);
 
     BOOST_REQUIRE(binary_equal_pidls(pidl.get(), empty_pidl));
 
@@ -393,7 +392,7 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( assign, T, pidl_types )
 {
     const T* raw = fake_pidl<T>();
 
-    heap_pidl<T>::type pidl;
+    typename heap_pidl<T>::type pidl;
     pidl = raw;
 
     BOOST_REQUIRE(binary_equal_pidls(pidl.get(), raw));
@@ -408,8 +407,8 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( assign, T, pidl_types )
  */
 BOOST_AUTO_TEST_CASE_TEMPLATE( copy_construct, T, pidl_types )
 {
-    heap_pidl<T>::type pidl(fake_pidl<T>());
-    heap_pidl<T>::type pidl_copy(pidl);
+    typename heap_pidl<T>::type pidl(fake_pidl<T>());
+    typename heap_pidl<T>::type pidl_copy(pidl);
 
     BOOST_REQUIRE(binary_equal_pidls(pidl.get(), pidl_copy.get()));
 
@@ -423,8 +422,8 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( copy_construct, T, pidl_types )
  */
 BOOST_AUTO_TEST_CASE_TEMPLATE( copy_assign, T, pidl_types )
 {
-    heap_pidl<T>::type pidl(fake_pidl<T>());
-    heap_pidl<T>::type pidl_copy;
+    typename heap_pidl<T>::type pidl(fake_pidl<T>());
+    typename heap_pidl<T>::type pidl_copy;
     pidl_copy = pidl;
 
     BOOST_REQUIRE(binary_equal_pidls(pidl.get(), pidl_copy.get()));
@@ -439,12 +438,12 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( copy_assign, T, pidl_types )
  */
 BOOST_AUTO_TEST_CASE_TEMPLATE( copy_to, T, pidl_types )
 {
-    heap_pidl<T>::type pidl(fake_pidl<T>());
+    typename heap_pidl<T>::type pidl(fake_pidl<T>());
     T* raw;
 
     pidl.copy_to(raw);
 
-    shared_ptr<T> scope(raw);
+    shared_ptr<T> scope(raw, newdelete_alloc<T>::deallocate);
 
     BOOST_REQUIRE(binary_equal_pidls(pidl.get(), raw));
 
@@ -457,9 +456,9 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( copy_to, T, pidl_types )
  */
 BOOST_AUTO_TEST_CASE_TEMPLATE( attach, T, pidl_types )
 {
-    heap_pidl<T>::type pidl;
+    typename heap_pidl<T>::type pidl;
 
-    T* raw = raw_pidl::clone<newdelete_alloc<T>>(fake_pidl<T>());
+    T* raw = raw_pidl::clone<newdelete_alloc<T> >(fake_pidl<T>());
     pidl.attach(raw);
 
     BOOST_REQUIRE_EQUAL(pidl.get(), raw);
@@ -495,7 +494,7 @@ void do_join_test(const T& pidl1, const U& pidl2)
 BOOST_AUTO_TEST_CASE_TEMPLATE( join_rel, T, relative_pidl_types )
 {
     hpidl_t pidl1(fake_pidl<IDRELATIVE>());
-    heap_pidl<T>::type pidl2(fake_pidl<T>());
+    typename heap_pidl<T>::type pidl2(fake_pidl<T>());
 
     do_join_test(pidl1, pidl2);
 }
@@ -506,7 +505,7 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( join_rel, T, relative_pidl_types )
 BOOST_AUTO_TEST_CASE_TEMPLATE( join_child, T, relative_pidl_types )
 {
     chpidl_t pidl1(fake_pidl<IDCHILD>());
-    heap_pidl<T>::type pidl2(fake_pidl<T>());
+    typename heap_pidl<T>::type pidl2(fake_pidl<T>());
 
     do_join_test(pidl1, pidl2);
 }
@@ -527,8 +526,8 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( join_abs, T, relative_pidl_types )
  */
 BOOST_AUTO_TEST_CASE_TEMPLATE( join_null_pidl, T, relative_pidl_types )
 {
-    heap_pidl<T>::type pidl1(NULL);
-    heap_pidl<T>::type pidl2(fake_pidl<T>());
+    typename heap_pidl<T>::type pidl1(NULL);
+    typename heap_pidl<T>::type pidl2(fake_pidl<T>());
 
     do_join_test(pidl1, pidl2);
 }
@@ -538,8 +537,8 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( join_null_pidl, T, relative_pidl_types )
  */
 BOOST_AUTO_TEST_CASE_TEMPLATE( join_pidl_null, T, relative_pidl_types )
 {
-    heap_pidl<T>::type pidl1(fake_pidl<T>());
-    heap_pidl<T>::type pidl2(NULL);
+    typename heap_pidl<T>::type pidl1(fake_pidl<T>());
+    typename heap_pidl<T>::type pidl2(NULL);
 
     do_join_test(pidl1, pidl2);
 }
@@ -550,8 +549,8 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( join_pidl_null, T, relative_pidl_types )
 BOOST_AUTO_TEST_CASE_TEMPLATE( join_empty_pidl, T, relative_pidl_types )
 {
     SHITEMID empty = {0, {0}};
-    heap_pidl<T>::type pidl1 = reinterpret_cast<const T*>(&empty);
-    heap_pidl<T>::type pidl2(fake_pidl<T>());
+    typename heap_pidl<T>::type pidl1 = reinterpret_cast<const T*>(&empty);
+    typename heap_pidl<T>::type pidl2(fake_pidl<T>());
 
     do_join_test(pidl1, pidl2);
 }
@@ -561,9 +560,9 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( join_empty_pidl, T, relative_pidl_types )
  */
 BOOST_AUTO_TEST_CASE_TEMPLATE( join_pidl_empty, T, relative_pidl_types )
 {
-    heap_pidl<T>::type pidl1(fake_pidl<T>());
+    typename heap_pidl<T>::type pidl1(fake_pidl<T>());
     SHITEMID empty = {0, {0}};
-    heap_pidl<T>::type pidl2 = reinterpret_cast<const T*>(&empty);
+    typename heap_pidl<T>::type pidl2 = reinterpret_cast<const T*>(&empty);
 
     do_join_test(pidl1, pidl2);
 }
@@ -600,7 +599,7 @@ void do_append_test(basic_pidl<T, Alloc>& pidl1, const U& pidl2)
 BOOST_AUTO_TEST_CASE_TEMPLATE( append_rel, T, relative_pidl_types )
 {
     hpidl_t pidl1(fake_pidl<IDRELATIVE>());
-    heap_pidl<T>::type pidl2(fake_pidl<T>());
+    typename heap_pidl<T>::type pidl2(fake_pidl<T>());
 
     do_append_test(pidl1, pidl2);
 }
@@ -613,7 +612,7 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( append_rel, T, relative_pidl_types )
 BOOST_AUTO_TEST_CASE_TEMPLATE( append_child, T, relative_pidl_types )
 {
     chpidl_t pidl1(fake_pidl<IDCHILD>());
-    heap_pidl<T>::type pidl2(fake_pidl<T>());
+    typename heap_pidl<T>::type pidl2(fake_pidl<T>());
 
     do_append_test(pidl1, pidl2);
 }
@@ -625,7 +624,7 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( append_child, T, relative_pidl_types )
 BOOST_AUTO_TEST_CASE_TEMPLATE( append_abs, T, relative_pidl_types )
 {
     ahpidl_t pidl1(fake_pidl<IDABSOLUTE>());
-    heap_pidl<T>::type pidl2(fake_pidl<T>());
+    typename heap_pidl<T>::type pidl2(fake_pidl<T>());
 
     do_append_test(pidl1, pidl2);
 }
@@ -636,7 +635,7 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( append_abs, T, relative_pidl_types )
 BOOST_AUTO_TEST_CASE_TEMPLATE( append_null_pidl, T, relative_pidl_types )
 {
     hpidl_t pidl1(NULL);
-    heap_pidl<T>::type pidl2(fake_pidl<T>());
+    typename heap_pidl<T>::type pidl2(fake_pidl<T>());
 
     do_append_test(pidl1, pidl2);
 }
@@ -647,7 +646,7 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( append_null_pidl, T, relative_pidl_types )
 BOOST_AUTO_TEST_CASE_TEMPLATE( append_pidl_null, T, relative_pidl_types )
 {
     hpidl_t pidl1(fake_pidl<T>());
-    heap_pidl<T>::type pidl2(NULL);
+    typename heap_pidl<T>::type pidl2(NULL);
 
     do_append_test(pidl1, pidl2);
 }
@@ -659,7 +658,7 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( append_empty_pidl, T, relative_pidl_types )
 {
     SHITEMID empty = {0, {0}};
     hpidl_t pidl1 = reinterpret_cast<const T*>(&empty);
-    heap_pidl<T>::type pidl2(fake_pidl<T>());
+    typename heap_pidl<T>::type pidl2(fake_pidl<T>());
 
     do_append_test(pidl1, pidl2);
 }
@@ -671,7 +670,7 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( append_pidl_empty, T, relative_pidl_types )
 {
     hpidl_t pidl1(fake_pidl<T>());
     SHITEMID empty = {0, {0}};
-    heap_pidl<T>::type pidl2 = reinterpret_cast<const T*>(&empty);
+    typename heap_pidl<T>::type pidl2 = reinterpret_cast<const T*>(&empty);
 
     do_append_test(pidl1, pidl2);
 }
@@ -703,7 +702,7 @@ void do_parent_test(basic_pidl<T, Alloc>& pidl)
  */
 BOOST_AUTO_TEST_CASE_TEMPLATE( parent_of_compound_pidl, T, adult_pidl_types )
 {
-    heap_pidl<T>::type pidl(fake_pidl<T>());
+    typename heap_pidl<T>::type pidl(fake_pidl<T>());
     pidl += fake_pidl<IDRELATIVE>();
 
     do_parent_test(pidl);
@@ -714,7 +713,7 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( parent_of_compound_pidl, T, adult_pidl_types )
  */
 BOOST_AUTO_TEST_CASE_TEMPLATE( parent_of_simple_pidl, T, pidl_types )
 {
-    heap_pidl<T>::type pidl(fake_pidl<T>());
+    typename heap_pidl<T>::type pidl(fake_pidl<T>());
 
     do_parent_test(pidl);
 }
@@ -725,7 +724,7 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( parent_of_simple_pidl, T, pidl_types )
 BOOST_AUTO_TEST_CASE_TEMPLATE( parent_of_empty_pidl, T, pidl_types )
 {
     SHITEMID empty = {0, {0}};
-    heap_pidl<T>::type pidl = reinterpret_cast<const T*>(&empty);
+    typename heap_pidl<T>::type pidl = reinterpret_cast<const T*>(&empty);
 
     BOOST_CHECK_THROW(pidl.parent(), std::logic_error);
 }
@@ -735,7 +734,7 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( parent_of_empty_pidl, T, pidl_types )
  */
 BOOST_AUTO_TEST_CASE_TEMPLATE( parent_of_null_pidl, T, pidl_types )
 {
-    heap_pidl<T>::type pidl(NULL);
+    typename heap_pidl<T>::type pidl(NULL);
 
     BOOST_CHECK_THROW(pidl.parent(), std::logic_error);
 }
@@ -755,7 +754,7 @@ void do_last_item_test(basic_pidl<T, Alloc>& pidl)
  */
 BOOST_AUTO_TEST_CASE_TEMPLATE( last_item_compound_pidl, T, adult_pidl_types )
 {
-    heap_pidl<T>::type pidl(fake_pidl<T>());
+    typename heap_pidl<T>::type pidl(fake_pidl<T>());
     pidl += fake_pidl<IDRELATIVE>();
 
     do_last_item_test(pidl);
@@ -766,7 +765,7 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( last_item_compound_pidl, T, adult_pidl_types )
  */
 BOOST_AUTO_TEST_CASE_TEMPLATE( last_item_of_simple_pidl, T, pidl_types )
 {
-    heap_pidl<T>::type pidl(fake_pidl<T>());
+    typename heap_pidl<T>::type pidl(fake_pidl<T>());
 
     do_last_item_test(pidl);
 }
@@ -777,7 +776,7 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( last_item_of_simple_pidl, T, pidl_types )
 BOOST_AUTO_TEST_CASE_TEMPLATE( last_item_of_empty_pidl, T, pidl_types )
 {
     SHITEMID empty = {0, {0}};
-    heap_pidl<T>::type pidl = reinterpret_cast<const T*>(&empty);
+    typename heap_pidl<T>::type pidl = reinterpret_cast<const T*>(&empty);
 
     BOOST_CHECK_THROW(pidl.last_item(), std::logic_error);
 }
@@ -787,16 +786,269 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( last_item_of_empty_pidl, T, pidl_types )
  */
 BOOST_AUTO_TEST_CASE_TEMPLATE( last_item_of_null_pidl, T, pidl_types )
 {
-    heap_pidl<T>::type pidl(NULL);
+    typename heap_pidl<T>::type pidl(NULL);
 
     BOOST_CHECK_THROW(pidl.last_item(), std::logic_error);
 }
 
+/**
+ * Move-construct.
+ * The new basic_pidl must take over the original PIDL's memory without
+ * copying and leave the source NULL.
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE( move_construct, T, pidl_types )
+{
+    typename heap_pidl<T>::type pidl(fake_pidl<T>());
+    const T* raw = pidl.get();
+
+    typename heap_pidl<T>::type moved(boost::move(pidl));
+
+    BOOST_REQUIRE_EQUAL(moved.get(), raw);
+    BOOST_REQUIRE(!pidl);
+}
+
+/**
+ * Move-assign.
+ * The target must take over the original PIDL's memory without copying and
+ * leave the source NULL.
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE( move_assign, T, pidl_types )
+{
+    typename heap_pidl<T>::type pidl(fake_pidl<T>());
+    const T* raw = pidl.get();
+
+    typename heap_pidl<T>::type moved(fake_pidl<T>());
+    moved = boost::move(pidl);
+
+    BOOST_REQUIRE_EQUAL(moved.get(), raw);
+    BOOST_REQUIRE(!pidl);
+}
+
+/**
+ * Reserving space keeps the PIDL's contents.  Reserving for a NULL PIDL
+ * makes it empty.
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE( reserve, T, adult_pidl_types )
+{
+    const T* raw = fake_pidl<T>();
+    typename heap_pidl<T>::type pidl(raw);
+
+    pidl.reserve(1000);
+
+    BOOST_REQUIRE_GE(pidl.capacity(), 1000U);
+    BOOST_REQUIRE(binary_equal_pidls(pidl.get(), raw));
+
+    typename heap_pidl<T>::type null_pidl;
+    null_pidl.reserve(100);
+
+    BOOST_REQUIRE(!!null_pidl);
+    BOOST_REQUIRE(null_pidl.empty());
+}
+
+/**
+ * Appending within the reserved capacity must not reallocate.
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE( append_in_place, T, adult_pidl_types )
+{
+    const T* lhs = fake_pidl<T>();
+    const IDRELATIVE* rhs = fake_pidl<IDRELATIVE>();
+
+    typename heap_pidl<T>::type expected =
+        typename heap_pidl<T>::type(lhs) + rhs;
+
+    typename heap_pidl<T>::type pidl(lhs);
+    pidl.reserve(expected.size());
+    const T* buffer = pidl.get();
+
+    pidl.append(rhs);
+
+    BOOST_REQUIRE_EQUAL(pidl.get(), buffer);
+    BOOST_REQUIRE(binary_equal_pidls(pidl.get(), expected.get()));
+}
+
+/**
+ * Appending a PIDL to itself must work even though the source is
+ * overwritten or reallocated by the append.
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE( append_self, T, adult_pidl_types )
+{
+    typename heap_pidl<T>::type pidl(fake_pidl<T>());
+    typename heap_pidl<T>::type expected = pidl + pidl_cast<hpidl_t>(pidl);
+
+    typename heap_pidl<T>::type grown(pidl);
+    grown.append(static_cast<const IDRELATIVE*>(grown.get()));
+    BOOST_REQUIRE(binary_equal_pidls(grown.get(), expected.get()));
+
+    typename heap_pidl<T>::type reserved(pidl);
+    reserved.reserve(1000);
+    reserved.append(static_cast<const IDRELATIVE*>(reserved.get()));
+    BOOST_REQUIRE(binary_equal_pidls(reserved.get(), expected.get()));
+}
+
+/**
+ * Building a PIDL item by item must only reallocate a logarithmic number of
+ * times.
+ */
+BOOST_AUTO_TEST_CASE( append_amortised_growth )
+{
+    const IDCHILD* item = fake_pidl<IDCHILD>();
+
+    ahpidl_t pidl;
+    size_t reallocations = 0;
+    const size_t depth = 1000;
+    for (size_t i = 0; i < depth; ++i)
+    {
+        size_t capacity = pidl.capacity();
+        pidl += item;
+        if (pidl.capacity() != capacity)
+            ++reallocations;
+    }
+
+    BOOST_REQUIRE_EQUAL(
+        pidl.size(),
+        depth * (raw_pidl::size(item) - sizeof(USHORT)) + sizeof(USHORT));
+    BOOST_REQUIRE_LE(reallocations, 12U);
+}
+
+/**
+ * Joining onto a temporary reuses the temporary's buffer.
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE( join_onto_rvalue, T, adult_pidl_types )
+{
+    const T* lhs = fake_pidl<T>();
+    const IDRELATIVE* rhs = fake_pidl<IDRELATIVE>();
+
+    typename heap_pidl<T>::type expected =
+        typename heap_pidl<T>::type(lhs) + rhs;
+
+    typename heap_pidl<T>::type pidl(lhs);
+    pidl.reserve(expected.size());
+    const T* buffer = pidl.get();
+
+    typename heap_pidl<T>::type joined = boost::move(pidl) + hpidl_t(rhs);
+
+    BOOST_REQUIRE_EQUAL(joined.get(), buffer);
+    BOOST_REQUIRE(binary_equal_pidls(joined.get(), expected.get()));
+    BOOST_REQUIRE(!pidl);
+}
+
+/**
+ * Check a wrapper's remembered measurements against a walk of its PIDL.
+ */
+template<typename T, typename Alloc>
+void check_measurements(const basic_pidl<T, Alloc>& pidl)
+{
+    size_t count = 0;
+    for (const IDRELATIVE* item = pidl.get();
+         item && item->mkid.cb; item = raw_pidl::next(item))
+    {
+        ++count;
+    }
+
+    BOOST_REQUIRE_EQUAL(pidl.size(), ::ILGetSize(pidl.get()));
+    BOOST_REQUIRE_EQUAL(pidl.item_count(), count);
+
+    if (!pidl.empty())
+    {
+        BOOST_REQUIRE(
+            binary_equal_pidls(
+                pidl.last_item().get(), ::ILFindLastID(pidl.get())));
+    }
+}
+
+/**
+ * Item count of NULL, empty, single-item and multi-item PIDLs.
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE( item_count, T, adult_pidl_types )
+{
+    typename heap_pidl<T>::type null_pidl;
+    BOOST_REQUIRE_EQUAL(null_pidl.item_count(), 0U);
+
+    SHITEMID empty = {0, {0}};
+    typename heap_pidl<T>::type empty_pidl(reinterpret_cast<const T*>(&empty));
+    BOOST_REQUIRE_EQUAL(empty_pidl.item_count(), 0U);
+
+    typename heap_pidl<T>::type pidl(fake_pidl<T>());
+    BOOST_REQUIRE_EQUAL(pidl.item_count(), 1U);
+
+    pidl += fake_pidl<IDRELATIVE>();
+    pidl += fake_pidl<IDCHILD>();
+    BOOST_REQUIRE_EQUAL(pidl.item_count(), 3U);
+    check_measurements(pidl);
+}
+
+/**
+ * Measurements stay correct while repeatedly taking the parent of a deep
+ * PIDL all the way up to the empty PIDL.
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE( measurements_follow_parent, T, adult_pidl_types )
+{
+    typename heap_pidl<T>::type pidl(fake_pidl<T>());
+    for (int i = 0; i < 5; ++i)
+        pidl += fake_pidl<IDCHILD>();
+
+    for (size_t count = 6; count > 0; --count)
+    {
+        BOOST_REQUIRE_EQUAL(pidl.item_count(), count);
+        check_measurements(pidl);
+        pidl = pidl.parent();
+    }
+
+    BOOST_REQUIRE(pidl.empty());
+    check_measurements(pidl);
+}
+
+/**
+ * Measurements of PIDLs joined with + and of the PIDLs' parents.
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE( measurements_follow_join, T, pidl_types )
+{
+    typename heap_pidl<T>::type lhs(fake_pidl<T>());
+    hpidl_t rhs = hpidl_t(fake_pidl<IDRELATIVE>()) + fake_pidl<IDCHILD>();
+
+    check_measurements(lhs + rhs);
+    check_measurements(lhs.parent() + rhs);
+    check_measurements(lhs + rhs.parent());
+    check_measurements(lhs + hpidl_t());
+    check_measurements(typename heap_pidl<T>::type() + rhs);
+}
+
+/**
+ * PIDLs given to the wrapper via attach() or out() are measured when the
+ * measurements are needed.  Giving up the PIDL with detach() forgets them.
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE( measurements_of_attached_pidl, T, adult_pidl_types )
+{
+    typedef newdelete_alloc<T> alloc;
+
+    typename heap_pidl<T>::type source(fake_pidl<T>());
+    source += fake_pidl<IDRELATIVE>();
+
+    typename heap_pidl<T>::type pidl(fake_pidl<T>());
+    BOOST_REQUIRE_EQUAL(pidl.item_count(), 1U);
+
+    pidl.attach(raw_pidl::clone<alloc>(source.get()));
+    BOOST_REQUIRE_EQUAL(pidl.item_count(), 2U);
+    check_measurements(pidl);
+
+    *pidl.out() = raw_pidl::clone<alloc>(source.parent().get());
+    BOOST_REQUIRE_EQUAL(pidl.item_count(), 1U);
+    check_measurements(pidl);
+
+    alloc::deallocate(pidl.detach());
+    BOOST_REQUIRE_EQUAL(pidl.size(), 0U);
+    BOOST_REQUIRE_EQUAL(pidl.item_count(), 0U);
+}
+
 
 BOOST_AUTO_TEST_SUITE_END()
+#ifdef _MSC_VER
 #pragma endregion
+#endif
 
+#ifdef _MSC_VER
 #pragma region basic_pidl tests related to pidl types
+#endif
 BOOST_FIXTURE_TEST_SUITE(basic_pidl_type_tests, PidlFixture)
 
 /**
@@ -827,7 +1079,7 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( type_check_no_false_pos, T, adult_pidl_types )
             ::ILCombine(fake_pidl<IDABSOLUTE>(), fake_pidl<IDRELATIVE>())),
         ::ILFree);
 
-    heap_pidl<T>::type pidl(double_pidl.get());
+    typename heap_pidl<T>::type pidl(double_pidl.get());
 }
 
 /**
@@ -907,4 +1159,6 @@ BOOST_AUTO_TEST_CASE( cast_raw_to_wrapped  )
 }
 
 BOOST_AUTO_TEST_SUITE_END()
+#ifdef _MSC_VER
 #pragma endregion
+#endif
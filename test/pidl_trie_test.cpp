@@ -0,0 +1,330 @@
+/**
+    @file
+
+    Tests for the PIDL prefix trie.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#include "pidl_fixtures.hpp" // pidl_fixture
+
+#include <washer/shell/pidl_trie.hpp> // test subject
+
+#include <boost/test/unit_test.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace washer::shell::pidl;
+
+using washer::test::pidl_fixture;
+
+using std::map;
+using std::string;
+using std::vector;
+
+namespace {
+
+    typedef ITEMIDLIST_ABSOLUTE IDABSOLUTE;
+
+    /**
+     * Fixture that builds absolute PIDLs from slash-separated paths.
+     */
+    class trie_fixture : public pidl_fixture
+    {
+    public:
+
+        const IDABSOLUTE* path(const string& text)
+        {
+            vector<string> items;
+            string::size_type start = 0;
+            while (start < text.size())
+            {
+                string::size_type end = text.find('/', start);
+                if (end == string::npos)
+                    end = text.size();
+                items.push_back(text.substr(start, end - start));
+                start = end + 1;
+            }
+
+            return fake_pidl<IDABSOLUTE>(items);
+        }
+    };
+
+    /**
+     * Record every entry visited along with its key as a path.
+     */
+    class collector
+    {
+    public:
+        explicit collector(map<string, int>& seen) : m_seen(&seen) {}
+
+        void operator()(const apidl_view& key, int value) const
+        {
+            string text;
+            for (raw_pidl_iterator it(key.data()), end; it != end; ++it)
+            {
+                if (!text.empty())
+                    text += '/';
+                const char* data =
+                    reinterpret_cast<const char*>((*it)->mkid.abID);
+                text.append(data, (*it)->mkid.cb - sizeof(USHORT));
+            }
+
+            BOOST_CHECK_EQUAL(key.size(), raw_pidl::size(key.data()));
+            (*m_seen)[text] = value;
+        }
+
+    private:
+        map<string, int>* m_seen;
+    };
+}
+
+BOOST_FIXTURE_TEST_SUITE(pidl_trie_tests, trie_fixture)
+
+BOOST_AUTO_TEST_CASE( empty_trie )
+{
+    pidl_trie<int> trie;
+
+    BOOST_CHECK(trie.empty());
+    BOOST_CHECK_EQUAL(trie.size(), 0U);
+    BOOST_CHECK(trie.find(path("a")) == NULL);
+    BOOST_CHECK(trie.longest_prefix(path("a/b")) == NULL);
+    BOOST_CHECK_EQUAL(trie.erase(path("a")), 0U);
+    BOOST_CHECK_EQUAL(trie.erase_under(path("a")), 0U);
+}
+
+/**
+ * Entries are found by exact key only.
+ */
+BOOST_AUTO_TEST_CASE( insert_and_find )
+{
+    pidl_trie<int> trie;
+
+    BOOST_CHECK(trie.insert(path("a/b"), 1));
+    BOOST_CHECK(trie.insert(path("a/c"), 2));
+    BOOST_CHECK(!trie.insert(path("a/b"), 3));
+
+    BOOST_CHECK_EQUAL(trie.size(), 2U);
+    BOOST_REQUIRE(trie.find(path("a/b")));
+    BOOST_CHECK_EQUAL(*trie.find(path("a/b")), 1);
+    BOOST_CHECK_EQUAL(*trie.find(path("a/c")), 2);
+    BOOST_CHECK(trie.find(path("a")) == NULL);
+    BOOST_CHECK(trie.find(path("a/b/c")) == NULL);
+    BOOST_CHECK(trie.find(path("b")) == NULL);
+}
+
+/**
+ * Wrapped PIDLs work as keys too.
+ */
+BOOST_AUTO_TEST_CASE( wrapped_keys )
+{
+    pidl_trie<int> trie;
+    apidl_t key(path("a/b"));
+
+    trie[key] = 4;
+    BOOST_CHECK_EQUAL(*trie.find(key), 4);
+    BOOST_CHECK_EQUAL(*trie.longest_prefix(key + cpidl_t(
+        reinterpret_cast<const ITEMID_CHILD*>(path("c")))), 4);
+    BOOST_CHECK_EQUAL(trie.erase(key), 1U);
+}
+
+/**
+ * operator[] creates a default value when needed.
+ */
+BOOST_AUTO_TEST_CASE( subscript )
+{
+    pidl_trie<int> trie;
+
+    trie[path("a")] += 2;
+    trie[path("a")] += 3;
+
+    BOOST_CHECK_EQUAL(*trie.find(path("a")), 5);
+    BOOST_CHECK_EQUAL(trie.size(), 1U);
+}
+
+/**
+ * The desktop, the empty PIDL, is the root and can have an entry.
+ */
+BOOST_AUTO_TEST_CASE( root_entry )
+{
+    pidl_trie<int> trie;
+    const IDABSOLUTE* desktop = empty_pidl<IDABSOLUTE>();
+
+    BOOST_CHECK(trie.insert(desktop, 7));
+    BOOST_CHECK_EQUAL(*trie.find(desktop), 7);
+
+    size_t matched = 99;
+    BOOST_CHECK_EQUAL(*trie.longest_prefix(path("x/y"), &matched), 7);
+    BOOST_CHECK_EQUAL(matched, 0U);
+}
+
+/**
+ * The longest prefix is the deepest entry on the PIDL's path.
+ */
+BOOST_AUTO_TEST_CASE( longest_prefix )
+{
+    pidl_trie<int> trie;
+    trie.insert(path("a"), 1);
+    trie.insert(path("a/b/c"), 3);
+    trie.insert(path("a/x"), 9);
+
+    size_t matched = 0;
+    BOOST_CHECK_EQUAL(*trie.longest_prefix(path("a/b/c/d/e"), &matched), 3);
+    BOOST_CHECK_EQUAL(matched, 3U);
+
+    BOOST_CHECK_EQUAL(*trie.longest_prefix(path("a/b/c"), &matched), 3);
+    BOOST_CHECK_EQUAL(matched, 3U);
+
+    BOOST_CHECK_EQUAL(*trie.longest_prefix(path("a/b"), &matched), 1);
+    BOOST_CHECK_EQUAL(matched, 1U);
+
+    BOOST_CHECK_EQUAL(*trie.longest_prefix(path("a/y/z"), &matched), 1);
+    BOOST_CHECK(trie.longest_prefix(path("b/a")) == NULL);
+}
+
+/**
+ * Every entry at or under the prefix is visited with its full key.
+ */
+BOOST_AUTO_TEST_CASE( for_each_under )
+{
+    pidl_trie<int> trie;
+    trie.insert(path("a"), 1);
+    trie.insert(path("a/b"), 2);
+    trie.insert(path("a/b/c"), 3);
+    trie.insert(path("a/d"), 4);
+    trie.insert(path("e"), 5);
+
+    map<string, int> seen;
+    trie.for_each_under(path("a/b"), collector(seen));
+
+    BOOST_CHECK_EQUAL(seen.size(), 2U);
+    BOOST_CHECK_EQUAL(seen["a/b"], 2);
+    BOOST_CHECK_EQUAL(seen["a/b/c"], 3);
+
+    seen.clear();
+    trie.for_each_under(empty_pidl<IDABSOLUTE>(), collector(seen));
+    BOOST_CHECK_EQUAL(seen.size(), 5U);
+    BOOST_CHECK_EQUAL(seen["e"], 5);
+
+    seen.clear();
+    trie.for_each_under(path("z"), collector(seen));
+    BOOST_CHECK(seen.empty());
+}
+
+/**
+ * Erasing one entry leaves its descendants and ancestors alone.
+ */
+BOOST_AUTO_TEST_CASE( erase_single )
+{
+    pidl_trie<int> trie;
+    trie.insert(path("a"), 1);
+    trie.insert(path("a/b"), 2);
+    trie.insert(path("a/b/c"), 3);
+
+    BOOST_CHECK_EQUAL(trie.erase(path("a/b")), 1U);
+    BOOST_CHECK_EQUAL(trie.erase(path("a/b")), 0U);
+
+    BOOST_CHECK_EQUAL(trie.size(), 2U);
+    BOOST_CHECK(trie.find(path("a/b")) == NULL);
+    BOOST_CHECK_EQUAL(*trie.find(path("a")), 1);
+    BOOST_CHECK_EQUAL(*trie.find(path("a/b/c")), 3);
+
+    size_t matched = 0;
+    BOOST_CHECK_EQUAL(*trie.longest_prefix(path("a/b/x"), &matched), 1);
+    BOOST_CHECK_EQUAL(matched, 1U);
+}
+
+/**
+ * Erasing under a prefix removes the whole subtree and nothing else.
+ */
+BOOST_AUTO_TEST_CASE( erase_subtree )
+{
+    pidl_trie<int> trie;
+    trie.insert(path("a"), 1);
+    trie.insert(path("a/b"), 2);
+    trie.insert(path("a/b/c"), 3);
+    trie.insert(path("a/b/d/e"), 4);
+    trie.insert(path("a/f"), 5);
+
+    BOOST_CHECK_EQUAL(trie.erase_under(path("a/b")), 3U);
+
+    BOOST_CHECK_EQUAL(trie.size(), 2U);
+    BOOST_CHECK(trie.find(path("a/b")) == NULL);
+    BOOST_CHECK(trie.find(path("a/b/d/e")) == NULL);
+    BOOST_CHECK_EQUAL(*trie.find(path("a")), 1);
+    BOOST_CHECK_EQUAL(*trie.find(path("a/f")), 5);
+
+    // Erasing under a prefix with no entry of its own still works
+    trie.insert(path("x/y/z"), 6);
+    BOOST_CHECK_EQUAL(trie.erase_under(path("x")), 1U);
+    BOOST_CHECK_EQUAL(trie.size(), 2U);
+
+    BOOST_CHECK_EQUAL(trie.erase_under(empty_pidl<IDABSOLUTE>()), 2U);
+    BOOST_CHECK(trie.empty());
+
+    // Still usable after removing everything
+    BOOST_CHECK(trie.insert(path("a"), 1));
+    BOOST_CHECK_EQUAL(*trie.find(path("a")), 1);
+}
+
+/**
+ * The count erase_under() returns stays right as entries come and go
+ * beneath the prefix.
+ */
+BOOST_AUTO_TEST_CASE( erase_subtree_after_changes )
+{
+    pidl_trie<int> trie;
+    trie.insert(path("a"), 1);
+    trie.insert(path("a/b"), 2);
+    trie.insert(path("a/b/c"), 3);
+    trie[path("a/d")] = 4;
+    trie[path("a/d")] = 5;
+    BOOST_CHECK(!trie.insert(path("a/b/c"), 6));
+
+    BOOST_CHECK_EQUAL(trie.erase(path("a/b")), 1U);
+    BOOST_CHECK_EQUAL(trie.erase_under(path("a/d")), 1U);
+    trie.insert(path("a/b/e"), 7);
+
+    BOOST_CHECK_EQUAL(trie.erase_under(path("a/b")), 2U);
+    BOOST_CHECK_EQUAL(trie.size(), 1U);
+    BOOST_CHECK_EQUAL(trie.erase_under(path("a")), 1U);
+    BOOST_CHECK(trie.empty());
+}
+
+BOOST_AUTO_TEST_CASE( clear )
+{
+    pidl_trie<int> trie;
+    trie.insert(path("a/b"), 1);
+    trie.insert(path("c"), 2);
+
+    trie.clear();
+    BOOST_CHECK(trie.empty());
+    BOOST_CHECK(trie.find(path("a/b")) == NULL);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
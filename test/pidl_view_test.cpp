@@ -0,0 +1,302 @@
+/**
+    @file
+
+    Unit tests for PIDL views.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#include "pidl_fixtures.hpp" // pidl_fixture, binary_equal_pidls, heap_pidl
+
+#include <washer/shell/pidl_view.hpp> // test subject
+
+#include <boost/mpl/list.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_case_template.hpp>
+#include <boost/type_traits/is_same.hpp> // is_same
+
+#include <stdexcept> // logic_error, out_of_range
+#include <string>
+#include <vector>
+
+using namespace washer::shell::pidl;
+
+using washer::test::binary_equal_pidls;
+using washer::test::heap_pidl;
+using washer::test::pidl_fixture;
+
+using std::string;
+using std::vector;
+
+namespace {
+
+    typedef ITEMIDLIST_RELATIVE IDRELATIVE;
+    typedef ITEMIDLIST_ABSOLUTE IDABSOLUTE;
+    typedef ITEMID_CHILD IDCHILD;
+
+    typedef boost::mpl::list<IDRELATIVE, IDABSOLUTE, IDCHILD> pidl_types;
+    typedef boost::mpl::list<IDRELATIVE, IDABSOLUTE> adult_pidl_types;
+
+    vector<string> three_items()
+    {
+        vector<string> items;
+        items.push_back("first");
+        items.push_back("second item");
+        items.push_back("third");
+        return items;
+    }
+
+    /**
+     * Does the view point somewhere inside the given PIDL?
+     */
+    template<typename T, typename U>
+    bool points_into(const basic_pidl_view<T>& view, const U* pidl)
+    {
+        const BYTE* start = reinterpret_cast<const BYTE*>(pidl);
+        const BYTE* item = reinterpret_cast<const BYTE*>(view.data());
+        return item >= start && item < start + raw_pidl::size(pidl);
+    }
+}
+
+BOOST_FIXTURE_TEST_SUITE(pidl_view_tests, pidl_fixture)
+
+/**
+ * Default-constructed view is NULL.
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE( create_null, T, pidl_types )
+{
+    basic_pidl_view<T> view;
+    BOOST_CHECK(!view);
+    BOOST_CHECK(view.empty());
+    BOOST_CHECK_EQUAL(view.size(), 0U);
+    BOOST_CHECK_EQUAL(view.item_count(), 0U);
+}
+
+/**
+ * A view of an empty PIDL is empty but not NULL.
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE( create_empty, T, pidl_types )
+{
+    const T* raw = empty_pidl<T>();
+    basic_pidl_view<T> view(raw);
+    BOOST_CHECK(!!view);
+    BOOST_CHECK(view.empty());
+    BOOST_CHECK_EQUAL(view.data(), raw);
+    BOOST_CHECK_EQUAL(view.size(), sizeof(USHORT));
+}
+
+/**
+ * A view of a raw PIDL sees all of it in place.
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE( create_from_raw, T, adult_pidl_types )
+{
+    const T* raw = fake_pidl<T>(three_items());
+    basic_pidl_view<T> view(raw);
+
+    BOOST_CHECK_EQUAL(view.data(), raw);
+    BOOST_CHECK_EQUAL(view.size(), raw_pidl::size(raw));
+    BOOST_CHECK_EQUAL(view.item_count(), 3U);
+    BOOST_CHECK(!view.empty());
+}
+
+/**
+ * A view of a wrapper sees the wrapper's PIDL in place.
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE( create_from_wrapper, T, adult_pidl_types )
+{
+    typename heap_pidl<T>::type pidl(fake_pidl<T>(three_items()));
+    basic_pidl_view<T> view(pidl);
+
+    BOOST_CHECK_EQUAL(view.data(), pidl.get());
+    BOOST_CHECK_EQUAL(view.size(), pidl.size());
+    BOOST_CHECK_EQUAL(view.item_count(), 3U);
+}
+
+/**
+ * Child views can't be made from a multi-item PIDL.
+ */
+BOOST_AUTO_TEST_CASE( create_child_type_check )
+{
+    const IDCHILD* raw = fake_pidl<IDCHILD>("one", "two");
+    BOOST_CHECK_THROW(cpidl_view view(raw), std::invalid_argument);
+}
+
+/**
+ * The parent view sees all but the last item of the original memory and
+ * copies to the same PIDL as basic_pidl::parent.
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE( parent, T, adult_pidl_types )
+{
+    const T* raw = fake_pidl<T>(three_items());
+    typename heap_pidl<T>::type pidl(raw);
+
+    basic_pidl_view<T> parent = basic_pidl_view<T>(raw).parent();
+
+    BOOST_CHECK_EQUAL(parent.data(), raw);
+    BOOST_CHECK_EQUAL(parent.item_count(), 2U);
+    BOOST_CHECK_EQUAL(parent.size(), pidl.parent().size());
+
+    typename heap_pidl<T>::type copy(parent);
+    BOOST_CHECK(binary_equal_pidls(copy.get(), pidl.parent().get()));
+    BOOST_CHECK_EQUAL(copy.item_count(), 2U);
+}
+
+/**
+ * Taking the parent repeatedly reaches an empty, non-NULL view.  The
+ * parent of that is an error.
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE( parent_to_root, T, adult_pidl_types )
+{
+    basic_pidl_view<T> view(fake_pidl<T>(three_items()));
+
+    view = view.parent().parent().parent();
+    BOOST_CHECK(view.empty());
+    BOOST_CHECK(!!view);
+    BOOST_CHECK_EQUAL(view.size(), sizeof(USHORT));
+
+    typename heap_pidl<T>::type copy(view);
+    BOOST_CHECK(copy.empty());
+    BOOST_CHECK(!!copy);
+
+    BOOST_CHECK_THROW(view.parent(), std::logic_error);
+    BOOST_CHECK_THROW(basic_pidl_view<T>().parent(), std::logic_error);
+}
+
+/**
+ * The last item view sees the last item in the original memory.
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE( last, T, pidl_types )
+{
+    const T* raw = fake_pidl<T>("only");
+    if (!boost::is_same<T, IDCHILD>::value)
+        raw = fake_pidl<T>(three_items());
+
+    typename heap_pidl<T>::type pidl(raw);
+    cpidl_view last = basic_pidl_view<T>(raw).last();
+
+    BOOST_CHECK(points_into(last, raw));
+    BOOST_CHECK_EQUAL(last.item_count(), 1U);
+
+    // The last item is terminated by the original PIDL's terminator
+    BOOST_CHECK(binary_equal_pidls(last.data(), pidl.last_item().get()));
+
+    BOOST_CHECK_THROW(
+        basic_pidl_view<T>(empty_pidl<T>()).last(), std::logic_error);
+}
+
+/**
+ * Any prefix joined to the matching suffix recreates the original.
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE( prefix_and_suffix, T, adult_pidl_types )
+{
+    const T* raw = fake_pidl<T>(three_items());
+    basic_pidl_view<T> view(raw);
+
+    for (size_t n = 0; n <= view.item_count(); ++n)
+    {
+        basic_pidl_view<T> prefix = view.prefix(n);
+        pidl_view suffix = view.suffix(view.item_count() - n);
+
+        BOOST_CHECK_EQUAL(prefix.item_count(), n);
+        BOOST_CHECK_EQUAL(suffix.item_count(), view.item_count() - n);
+        BOOST_CHECK_EQUAL(
+            prefix.item_bytes() + suffix.item_bytes(), view.item_bytes());
+        BOOST_CHECK(points_into(suffix, raw));
+
+        typename heap_pidl<T>::type joined =
+            typename heap_pidl<T>::type(prefix) +
+            typename heap_pidl<IDRELATIVE>::type(suffix);
+        BOOST_CHECK(binary_equal_pidls(joined.get(), raw));
+    }
+
+    BOOST_CHECK_THROW(view.prefix(4), std::out_of_range);
+    BOOST_CHECK_THROW(view.suffix(4), std::out_of_range);
+}
+
+/**
+ * Copying a NULL view gives a NULL PIDL.
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE( copy_null, T, pidl_types )
+{
+    typename heap_pidl<T>::type pidl((basic_pidl_view<T>()));
+    BOOST_CHECK(!pidl);
+}
+
+/**
+ * Views of the same items in different memory are equal.  NULL and empty
+ * views are equal.
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE( equality, T, adult_pidl_types )
+{
+    basic_pidl_view<T> lhs(fake_pidl<T>(three_items()));
+    basic_pidl_view<T> rhs(fake_pidl<T>(three_items()));
+
+    BOOST_CHECK_NE(lhs.data(), rhs.data());
+    BOOST_CHECK(lhs == rhs);
+    BOOST_CHECK(!(lhs != rhs));
+    BOOST_CHECK(lhs.parent() == rhs.parent());
+    BOOST_CHECK(lhs.last() == rhs.last());
+    BOOST_CHECK(lhs.last() != lhs.suffix(2));
+
+    BOOST_CHECK(basic_pidl_view<T>() == basic_pidl_view<T>(empty_pidl<T>()));
+    BOOST_CHECK(lhs.prefix(0) == basic_pidl_view<T>());
+}
+
+/**
+ * Views order byte-wise with a prefix ordered before the views that
+ * extend it.
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE( ordering, T, adult_pidl_types )
+{
+    basic_pidl_view<T> view(fake_pidl<T>(three_items()));
+    basic_pidl_view<T> other(fake_pidl<T>("first", "second itex"));
+
+    BOOST_CHECK(view.parent() < view);
+    BOOST_CHECK(!(view < view.parent()));
+    BOOST_CHECK(!(view < view));
+    BOOST_CHECK(basic_pidl_view<T>() < view);
+
+    BOOST_CHECK(view < other);
+    BOOST_CHECK(!(other < view));
+    BOOST_CHECK(compare(view, other) < 0);
+    BOOST_CHECK(compare(other, view) > 0);
+    BOOST_CHECK_EQUAL(compare(view, view), 0);
+}
+
+/**
+ * Child views upcast to relative views.
+ */
+BOOST_AUTO_TEST_CASE( upcast )
+{
+    const IDRELATIVE* raw = fake_pidl<IDRELATIVE>(three_items());
+    cpidl_view last = pidl_view(raw).last();
+    pidl_view relative = last;
+
+    BOOST_CHECK_EQUAL(relative.data(), last.data());
+    BOOST_CHECK(relative == pidl_view(raw).suffix(1));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
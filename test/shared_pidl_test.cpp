@@ -0,0 +1,294 @@
+/**
+    @file
+
+    Unit tests for the reference-counted shared PIDL.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#include "pidl_fixtures.hpp" // pidl_fixture, binary_equal_pidls, heap_pidl
+
+#include <washer/shell/shared_pidl.hpp> // test subject
+
+#include <boost/move/move.hpp> // move
+#include <boost/ref.hpp> // ref
+#include <boost/test/unit_test.hpp>
+#include <boost/thread/thread.hpp> // thread_group
+
+#include <cstring> // memcpy
+#include <vector>
+
+using namespace washer::shell::pidl;
+
+using washer::test::binary_equal_pidls;
+using washer::test::heap_pidl;
+using washer::test::pidl_fixture;
+
+using std::vector;
+
+namespace {
+
+    typedef ITEMIDLIST_ABSOLUTE IDABSOLUTE;
+    typedef ITEMIDLIST_RELATIVE IDRELATIVE;
+    typedef ITEMID_CHILD IDCHILD;
+
+    typedef basic_shared_pidl<
+        IDABSOLUTE, newdelete_alloc<IDABSOLUTE> > shared_ahpidl;
+    typedef basic_shared_pidl<
+        IDCHILD, newdelete_alloc<IDCHILD> > shared_chpidl;
+
+    /**
+     * Copy and destroy shared PIDLs over and over.
+     *
+     * Each worker records mismatches in its own flag, read only once its
+     * thread has been joined.
+     */
+    class copying_worker
+    {
+    public:
+        explicit copying_worker(const shared_ahpidl& pidl)
+            : m_pidl(&pidl), m_mismatch(false) {}
+
+        void operator()()
+        {
+            vector<shared_ahpidl> copies;
+            for (int i = 0; i < 20000; ++i)
+            {
+                copies.push_back(*m_pidl);
+                if (m_pidl->get() != copies.back().get())
+                    m_mismatch = true;
+
+                if (copies.size() == 16)
+                    copies.clear();
+            }
+        }
+
+        bool mismatch() const
+        {
+            return m_mismatch;
+        }
+
+    private:
+        const shared_ahpidl* m_pidl;
+        bool m_mismatch;
+    };
+}
+
+BOOST_FIXTURE_TEST_SUITE(shared_pidl_tests, pidl_fixture)
+
+BOOST_AUTO_TEST_CASE( null )
+{
+    shared_ahpidl pidl;
+
+    BOOST_CHECK(!pidl);
+    BOOST_CHECK(!pidl.get());
+    BOOST_CHECK(pidl.empty());
+    BOOST_CHECK_EQUAL(pidl.size(), 0U);
+    BOOST_CHECK_EQUAL(pidl.use_count(), 0);
+    BOOST_CHECK(!pidl.view().data());
+    BOOST_CHECK(!pidl.to_pidl());
+    BOOST_CHECK(!pidl.mutable_get());
+}
+
+BOOST_AUTO_TEST_CASE( from_raw )
+{
+    const IDABSOLUTE* raw = fake_pidl<IDABSOLUTE>("one", "two");
+    shared_ahpidl pidl(raw);
+
+    BOOST_CHECK(pidl.get() != raw);
+    BOOST_CHECK(binary_equal_pidls(pidl.get(), raw));
+    BOOST_CHECK_EQUAL(pidl.size(), raw_pidl::size(raw));
+    BOOST_CHECK_EQUAL(pidl.item_count(), 2U);
+    BOOST_CHECK(!pidl.empty());
+    BOOST_CHECK(pidl.unique());
+}
+
+BOOST_AUTO_TEST_CASE( from_empty )
+{
+    shared_ahpidl pidl(empty_pidl<IDABSOLUTE>());
+
+    BOOST_CHECK(!!pidl);
+    BOOST_CHECK(pidl.empty());
+    BOOST_CHECK_EQUAL(pidl.size(), sizeof(USHORT));
+    BOOST_CHECK(binary_equal_pidls(pidl.get(), empty_pidl<IDABSOLUTE>()));
+}
+
+BOOST_AUTO_TEST_CASE( from_wrapper_and_back )
+{
+    heap_pidl<IDABSOLUTE>::type wrapper(
+        fake_pidl<IDABSOLUTE>("one", "two"));
+
+    shared_ahpidl pidl = wrapper;
+    BOOST_CHECK(binary_equal_pidls(pidl.get(), wrapper.get()));
+    BOOST_CHECK_EQUAL(pidl.item_count(), 2U);
+
+    heap_pidl<IDABSOLUTE>::type copy = pidl.to_pidl();
+    BOOST_CHECK(copy.get() != pidl.get());
+    BOOST_CHECK(binary_equal_pidls(copy.get(), wrapper.get()));
+    BOOST_CHECK_EQUAL(copy.item_count(), 2U);
+}
+
+BOOST_AUTO_TEST_CASE( from_view )
+{
+    const IDABSOLUTE* raw = fake_pidl<IDABSOLUTE>("one", "two");
+    apidl_view view(raw);
+
+    // A parent view isn't terminated but the copy must be
+    shared_ahpidl pidl(view.parent());
+    BOOST_CHECK(
+        binary_equal_pidls(pidl.get(), fake_pidl<IDABSOLUTE>("one")));
+    BOOST_CHECK_EQUAL(pidl.item_count(), 1U);
+}
+
+BOOST_AUTO_TEST_CASE( upcast_from_child_wrapper )
+{
+    heap_pidl<IDCHILD>::type child(fake_pidl<IDCHILD>("one"));
+    basic_shared_pidl<IDRELATIVE, newdelete_alloc<IDRELATIVE> > pidl =
+        child;
+
+    BOOST_CHECK(binary_equal_pidls(pidl.get(), child.get()));
+}
+
+BOOST_AUTO_TEST_CASE( copy_shares )
+{
+    shared_ahpidl pidl(fake_pidl<IDABSOLUTE>("one"));
+    shared_ahpidl copy(pidl);
+
+    BOOST_CHECK_EQUAL(copy.get(), pidl.get());
+    BOOST_CHECK_EQUAL(pidl.use_count(), 2);
+    BOOST_CHECK(!pidl.unique());
+
+    {
+        shared_ahpidl assigned;
+        assigned = copy;
+        BOOST_CHECK_EQUAL(assigned.get(), pidl.get());
+        BOOST_CHECK_EQUAL(pidl.use_count(), 3);
+    }
+
+    BOOST_CHECK_EQUAL(pidl.use_count(), 2);
+    copy.reset();
+    BOOST_CHECK(!copy);
+    BOOST_CHECK(pidl.unique());
+}
+
+BOOST_AUTO_TEST_CASE( move )
+{
+    shared_ahpidl pidl(fake_pidl<IDABSOLUTE>("one"));
+    const IDABSOLUTE* raw = pidl.get();
+
+    shared_ahpidl moved(boost::move(pidl));
+    BOOST_CHECK(!pidl);
+    BOOST_CHECK_EQUAL(moved.get(), raw);
+    BOOST_CHECK(moved.unique());
+
+    pidl = boost::move(moved);
+    BOOST_CHECK(!moved);
+    BOOST_CHECK_EQUAL(pidl.get(), raw);
+}
+
+/**
+ * Changing a PIDL that shares its block must not affect the other copies.
+ */
+BOOST_AUTO_TEST_CASE( copy_on_write )
+{
+    const IDABSOLUTE* raw = fake_pidl<IDABSOLUTE>("one");
+    shared_ahpidl pidl(raw);
+    shared_ahpidl copy(pidl);
+
+    IDABSOLUTE* writable = copy.mutable_get();
+    BOOST_CHECK(writable != pidl.get());
+    BOOST_CHECK(copy.unique());
+    BOOST_CHECK(pidl.unique());
+
+    reinterpret_cast<BYTE*>(writable)[sizeof(USHORT)] = 'X';
+    BOOST_CHECK(binary_equal_pidls(copy.get(), fake_pidl<IDABSOLUTE>("Xne")));
+    BOOST_CHECK(binary_equal_pidls(pidl.get(), raw));
+}
+
+/**
+ * A PIDL that doesn't share its block is changed in place.
+ */
+BOOST_AUTO_TEST_CASE( write_unique_in_place )
+{
+    shared_ahpidl pidl(fake_pidl<IDABSOLUTE>("one"));
+    const IDABSOLUTE* before = pidl.get();
+
+    BOOST_CHECK_EQUAL(pidl.mutable_get(), before);
+}
+
+BOOST_AUTO_TEST_CASE( append )
+{
+    shared_ahpidl pidl(fake_pidl<IDABSOLUTE>("one"));
+    shared_ahpidl copy(pidl);
+
+    pidl.append(fake_pidl<IDRELATIVE>("two"));
+    BOOST_CHECK(
+        binary_equal_pidls(pidl.get(), fake_pidl<IDABSOLUTE>("one", "two")));
+    BOOST_CHECK_EQUAL(pidl.item_count(), 2U);
+    BOOST_CHECK(binary_equal_pidls(copy.get(), fake_pidl<IDABSOLUTE>("one")));
+    BOOST_CHECK(copy.unique());
+
+    pidl.append(shared_chpidl(fake_pidl<IDCHILD>("three")));
+    BOOST_CHECK_EQUAL(pidl.item_count(), 3U);
+}
+
+BOOST_AUTO_TEST_CASE( child_type_check )
+{
+    BOOST_CHECK_THROW(
+        shared_chpidl(
+            reinterpret_cast<const IDCHILD*>(
+                fake_pidl<IDRELATIVE>("one", "two"))),
+        std::invalid_argument);
+}
+
+/**
+ * Copies of one PIDL made and destroyed on many threads at once must keep
+ * the count straight.
+ */
+BOOST_AUTO_TEST_CASE( concurrent_copies )
+{
+    shared_ahpidl pidl(fake_pidl<IDABSOLUTE>("one", "two"));
+
+    const size_t thread_count = 4;
+    vector<copying_worker> workers(thread_count, copying_worker(pidl));
+
+    boost::thread_group threads;
+    for (size_t t = 0; t < thread_count; ++t)
+    {
+        threads.create_thread(boost::ref(workers[t]));
+    }
+    threads.join_all();
+
+    bool mismatch = false;
+    for (size_t t = 0; t < thread_count; ++t)
+    {
+        mismatch = mismatch || workers[t].mismatch();
+    }
+    BOOST_CHECK(!mismatch);
+    BOOST_CHECK(pidl.unique());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
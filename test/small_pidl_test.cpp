@@ -0,0 +1,508 @@
+/**
+    @file
+
+    Unit tests for basic_small_pidl.
+
+    @if license
+
+    Copyright (C) 2026  Alexander Lamaison <awl03@doc.ic.ac.uk>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    If you modify this Program, or any covered work, by linking or
+    combining it with the OpenSSL project's OpenSSL library (or a
+    modified version of that library), containing parts covered by the
+    terms of the OpenSSL or SSLeay licenses, the licensors of this
+    Program grant you additional permission to convey the resulting work.
+
+    @endif
+*/
+
+#include "pidl_fixtures.hpp" // pidl_fixture, binary_equal_pidls, heap_pidl
+
+#include <washer/shell/small_pidl.hpp> // test subject
+#include <washer/shell/pidl_arena.hpp> // pidl_arena, arena_alloc
+
+#include <boost/mpl/list.hpp>
+#include <boost/shared_ptr.hpp> // shared_ptr
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_case_template.hpp>
+
+#include <stdexcept> // logic_error, invalid_argument
+#include <string>
+
+using namespace washer::shell::pidl;
+
+using washer::test::binary_equal_pidls;
+using washer::test::heap_pidl;
+using washer::test::pidl_fixture;
+
+using boost::shared_ptr;
+
+using std::string;
+
+namespace {
+
+    typedef ITEMIDLIST_RELATIVE IDRELATIVE;
+    typedef ITEMIDLIST_ABSOLUTE IDABSOLUTE;
+    typedef ITEMID_CHILD IDCHILD;
+
+    const size_t capacity = 16;
+
+    /**
+     * Small PIDL with a tiny inline buffer so tests can easily exceed it.
+     */
+    template<typename T>
+    struct small_pidl
+    {
+        typedef basic_small_pidl<T, newdelete_alloc<T>, capacity> type;
+    };
+
+    typedef boost::mpl::list<IDRELATIVE, IDABSOLUTE, IDCHILD> pidl_types;
+    typedef boost::mpl::list<IDRELATIVE, IDCHILD> relative_pidl_types;
+    typedef boost::mpl::list<IDRELATIVE, IDABSOLUTE> adult_pidl_types;
+
+    /**
+     * Item data that fits in the inline buffer with room to spare.
+     */
+    const string short_item = "short";
+
+    /**
+     * Item data that cannot fit in the inline buffer.
+     */
+    const string long_item = "considerably longer than the inline buffer";
+
+    template<typename T>
+    T* raw_join(const T* lhs, const IDRELATIVE* rhs)
+    {
+        return reinterpret_cast<T*>(
+            raw_pidl::combine<newdelete_alloc<IDRELATIVE> >(lhs, rhs));
+    }
+}
+
+BOOST_FIXTURE_TEST_SUITE(small_pidl_tests, pidl_fixture)
+
+/**
+ * Default constructor should result in wrapped PIDL being NULL.
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE( create, T, pidl_types )
+{
+    typename small_pidl<T>::type pidl;
+    BOOST_CHECK(!pidl.get());
+    BOOST_CHECK(!pidl);
+    BOOST_CHECK(pidl.empty());
+    BOOST_CHECK(pidl.is_inline());
+    BOOST_CHECK_EQUAL(pidl.size(), 0U);
+}
+
+/**
+ * A PIDL that fits in the buffer is copied into the wrapper itself.
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE( create_inline, T, pidl_types )
+{
+    const T* raw = fake_pidl<T>(short_item);
+    typename small_pidl<T>::type pidl(raw);
+
+    BOOST_CHECK(pidl.is_inline());
+    BOOST_CHECK(!pidl.empty());
+    BOOST_CHECK_EQUAL(pidl.size(), raw_pidl::size(raw));
+    BOOST_CHECK(binary_equal_pidls(pidl.get(), raw));
+    BOOST_CHECK_NE(pidl.get(), raw);
+}
+
+/**
+ * A PIDL that doesn't fit in the buffer spills to the heap.
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE( create_spilled, T, pidl_types )
+{
+    const T* raw = fake_pidl<T>(long_item);
+    typename small_pidl<T>::type pidl(raw);
+
+    BOOST_CHECK(!pidl.is_inline());
+    BOOST_CHECK_EQUAL(pidl.size(), raw_pidl::size(raw));
+    BOOST_CHECK(binary_equal_pidls(pidl.get(), raw));
+    BOOST_CHECK_NE(pidl.get(), raw);
+}
+
+/**
+ * Initialising with empty PIDL should give a non-NULL but empty PIDL.
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE( create_empty, T, pidl_types )
+{
+    typename small_pidl<T>::type pidl(empty_pidl<T>());
+    BOOST_CHECK(pidl.get());
+    BOOST_CHECK(!!pidl);
+    BOOST_CHECK(pidl.empty());
+    BOOST_CHECK(pidl.is_inline());
+    BOOST_CHECK_EQUAL(pidl.size(), sizeof(USHORT));
+}
+
+/**
+ * Copies must have the same contents at a different address, whether stored
+ * inline or not.
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE( copy_construct, T, pidl_types )
+{
+    typename small_pidl<T>::type small(fake_pidl<T>(short_item));
+    typename small_pidl<T>::type small_copy(small);
+    BOOST_CHECK(small_copy.is_inline());
+    BOOST_CHECK(binary_equal_pidls(small.get(), small_copy.get()));
+    BOOST_CHECK_NE(small.get(), small_copy.get());
+
+    typename small_pidl<T>::type large(fake_pidl<T>(long_item));
+    typename small_pidl<T>::type large_copy(large);
+    BOOST_CHECK(!large_copy.is_inline());
+    BOOST_CHECK(binary_equal_pidls(large.get(), large_copy.get()));
+    BOOST_CHECK_NE(large.get(), large_copy.get());
+}
+
+/**
+ * Assigning over an existing PIDL replaces it, moving between inline and
+ * heap storage as needed.
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE( copy_assign, T, pidl_types )
+{
+    typename small_pidl<T>::type small(fake_pidl<T>(short_item));
+    typename small_pidl<T>::type large(fake_pidl<T>(long_item));
+
+    typename small_pidl<T>::type pidl(small);
+    pidl = large;
+    BOOST_CHECK(!pidl.is_inline());
+    BOOST_CHECK(binary_equal_pidls(pidl.get(), large.get()));
+
+    pidl = small;
+    BOOST_CHECK(pidl.is_inline());
+    BOOST_CHECK(binary_equal_pidls(pidl.get(), small.get()));
+
+    pidl = fake_pidl<T>(long_item);
+    BOOST_CHECK(!pidl.is_inline());
+    BOOST_CHECK(binary_equal_pidls(pidl.get(), large.get()));
+}
+
+/**
+ * Swapping must exchange contents for all combinations of inline, heap and
+ * NULL PIDLs.
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE( swap_storage_kinds, T, pidl_types )
+{
+    const T* short_raw = fake_pidl<T>(short_item);
+    const T* long_raw = fake_pidl<T>(long_item);
+
+    typename small_pidl<T>::type a(short_raw);
+    typename small_pidl<T>::type b(long_raw);
+    typename small_pidl<T>::type null;
+
+    a.swap(b);
+    BOOST_CHECK(binary_equal_pidls(a.get(), long_raw));
+    BOOST_CHECK(binary_equal_pidls(b.get(), short_raw));
+    BOOST_CHECK(!a.is_inline());
+    BOOST_CHECK(b.is_inline());
+
+    swap(a, b);
+    BOOST_CHECK(binary_equal_pidls(a.get(), short_raw));
+    BOOST_CHECK(binary_equal_pidls(b.get(), long_raw));
+
+    const T* other_raw = fake_pidl<T>(string("other"));
+    typename small_pidl<T>::type c(other_raw);
+    a.swap(c);
+    BOOST_CHECK(binary_equal_pidls(c.get(), short_raw));
+    BOOST_CHECK(a.is_inline() && c.is_inline());
+
+    a.swap(null);
+    BOOST_CHECK(!a);
+    BOOST_CHECK_EQUAL(a.size(), 0U);
+    BOOST_CHECK(binary_equal_pidls(null.get(), other_raw));
+    BOOST_CHECK(null.is_inline());
+}
+
+/**
+ * Small PIDLs convert to and from heap-based wrappers by copying.
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE( convert_to_and_from_basic_pidl, T, pidl_types )
+{
+    const T* raw = fake_pidl<T>(short_item);
+
+    typename heap_pidl<T>::type heap(raw);
+    typename small_pidl<T>::type small(heap);
+    BOOST_CHECK(binary_equal_pidls(small.get(), raw));
+    BOOST_CHECK(small.is_inline());
+
+    typename heap_pidl<T>::type back = small;
+    BOOST_CHECK(binary_equal_pidls(back.get(), raw));
+    BOOST_CHECK_NE(back.get(), small.get());
+
+    typename heap_pidl<IDRELATIVE>::type upcast = small;
+    BOOST_CHECK(binary_equal_pidls(upcast.get(), raw));
+}
+
+/**
+ * Copying out gives a separately allocated raw PIDL.
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE( copy_to, T, pidl_types )
+{
+    typename small_pidl<T>::type pidl(fake_pidl<T>(short_item));
+    T* raw;
+
+    pidl.copy_to(raw);
+    shared_ptr<T> scope(raw, newdelete_alloc<T>::deallocate);
+
+    BOOST_CHECK(binary_equal_pidls(pidl.get(), raw));
+    BOOST_CHECK_NE(pidl.get(), raw);
+}
+
+/**
+ * Joining small PIDLs must give the same bytes as raw_pidl::combine.
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE( join, T, relative_pidl_types )
+{
+    const IDRELATIVE* lhs_raw = fake_pidl<IDRELATIVE>(string("a"));
+    const T* short_raw = fake_pidl<T>(string("b"));
+    const T* long_raw = fake_pidl<T>(long_item);
+
+    small_pidl<IDRELATIVE>::type lhs(lhs_raw);
+
+    shared_ptr<IDRELATIVE> expected_short(
+        raw_join(lhs_raw, short_raw), newdelete_alloc<IDRELATIVE>::deallocate);
+    shared_ptr<IDRELATIVE> expected_long(
+        raw_join(lhs_raw, long_raw), newdelete_alloc<IDRELATIVE>::deallocate);
+
+    small_pidl<IDRELATIVE>::type joined =
+        lhs + typename small_pidl<T>::type(short_raw);
+    BOOST_CHECK(joined.is_inline());
+    BOOST_CHECK_EQUAL(joined.size(), raw_pidl::size(expected_short.get()));
+    BOOST_CHECK(binary_equal_pidls(joined.get(), expected_short.get()));
+
+    joined = lhs + long_raw;
+    BOOST_CHECK(!joined.is_inline());
+    BOOST_CHECK(binary_equal_pidls(joined.get(), expected_long.get()));
+
+    joined = lhs + typename heap_pidl<T>::type(short_raw);
+    BOOST_CHECK(binary_equal_pidls(joined.get(), expected_short.get()));
+}
+
+/**
+ * Joining to and from NULL and empty PIDLs follows raw_pidl::combine.
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE( join_null_and_empty, T, relative_pidl_types )
+{
+    const T* raw = fake_pidl<T>(short_item);
+    typename small_pidl<T>::type pidl(raw);
+    typename small_pidl<T>::type null;
+    typename small_pidl<T>::type empty(empty_pidl<T>());
+
+    BOOST_CHECK(!(null + null));
+    BOOST_CHECK(binary_equal_pidls((null + pidl).get(), raw));
+    BOOST_CHECK(binary_equal_pidls((pidl + null).get(), raw));
+    BOOST_CHECK(binary_equal_pidls((empty + pidl).get(), raw));
+    BOOST_CHECK(binary_equal_pidls((pidl + empty).get(), raw));
+    BOOST_CHECK((empty + empty).empty());
+    BOOST_CHECK(!!(empty + empty));
+}
+
+/**
+ * Appending grows the left-hand PIDL.
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE( append, T, adult_pidl_types )
+{
+    const T* lhs_raw = fake_pidl<T>(string("a"));
+    const IDCHILD* rhs_raw = fake_pidl<IDCHILD>(string("b"));
+
+    typename small_pidl<T>::type pidl(lhs_raw);
+    pidl += rhs_raw;
+
+    shared_ptr<T> expected(
+        raw_join(lhs_raw, rhs_raw), newdelete_alloc<IDRELATIVE>::deallocate);
+    BOOST_CHECK(binary_equal_pidls(pidl.get(), expected.get()));
+}
+
+/**
+ * Appending that fits the inline buffer happens in place; appending that
+ * doesn't moves the PIDL to the heap.  Wrappers and the PIDL itself can
+ * be appended too.
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE( append_in_place, T, adult_pidl_types )
+{
+    const T* lhs_raw = fake_pidl<T>(string("a"));
+    const IDCHILD* short_raw = fake_pidl<IDCHILD>(string("b"));
+    const IDCHILD* long_raw = fake_pidl<IDCHILD>(long_item);
+
+    typename small_pidl<T>::type pidl(lhs_raw);
+    const T* storage = pidl.get();
+
+    pidl += typename small_pidl<IDCHILD>::type(short_raw);
+    BOOST_CHECK_EQUAL(pidl.get(), storage);
+    BOOST_CHECK(pidl.is_inline());
+
+    shared_ptr<T> expected(
+        raw_join(lhs_raw, short_raw), newdelete_alloc<IDRELATIVE>::deallocate);
+    BOOST_CHECK(binary_equal_pidls(pidl.get(), expected.get()));
+    BOOST_CHECK_EQUAL(pidl.size(), raw_pidl::size(expected.get()));
+
+    pidl += typename heap_pidl<IDCHILD>::type(long_raw);
+    BOOST_CHECK(!pidl.is_inline());
+
+    expected.reset(
+        raw_join(expected.get(), long_raw),
+        newdelete_alloc<IDRELATIVE>::deallocate);
+    BOOST_CHECK(binary_equal_pidls(pidl.get(), expected.get()));
+    BOOST_CHECK(binary_equal_pidls(pidl.last_item().get(), long_raw));
+}
+
+/**
+ * A relative PIDL can be appended to itself, wherever it is stored.
+ */
+BOOST_AUTO_TEST_CASE( append_to_self )
+{
+    const IDRELATIVE* short_raw = fake_pidl<IDRELATIVE>(string("a"));
+    const IDRELATIVE* long_raw = fake_pidl<IDRELATIVE>(long_item);
+
+    small_pidl<IDRELATIVE>::type inline_pidl(short_raw);
+    inline_pidl += inline_pidl;
+    shared_ptr<IDRELATIVE> expected(
+        raw_join(short_raw, short_raw),
+        newdelete_alloc<IDRELATIVE>::deallocate);
+    BOOST_CHECK(binary_equal_pidls(inline_pidl.get(), expected.get()));
+
+    small_pidl<IDRELATIVE>::type spilled(long_raw);
+    spilled += spilled;
+    expected.reset(
+        raw_join(long_raw, long_raw), newdelete_alloc<IDRELATIVE>::deallocate);
+    BOOST_CHECK(binary_equal_pidls(spilled.get(), expected.get()));
+}
+
+/**
+ * Parent and last item of a multi-item PIDL match those of basic_pidl.
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE( parent_and_last_item, T, adult_pidl_types )
+{
+    const T* raw = fake_pidl<T>(string("first"), long_item);
+    typename small_pidl<T>::type pidl(raw);
+    typename heap_pidl<T>::type heap(raw);
+
+    BOOST_CHECK(
+        binary_equal_pidls(pidl.parent().get(), heap.parent().get()));
+    BOOST_CHECK(pidl.parent().is_inline());
+    BOOST_CHECK(
+        binary_equal_pidls(pidl.last_item().get(), heap.last_item().get()));
+    BOOST_CHECK(!pidl.last_item().is_inline());
+}
+
+/**
+ * Navigating a PIDL built by joining or by taking a parent, whose last
+ * items are recorded differently, still matches basic_pidl.
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE( navigate_derived_pidls, T, adult_pidl_types )
+{
+    const T* raw = fake_pidl<T>(string("first"), string("second"));
+    const IDCHILD* tail = fake_pidl<IDCHILD>(long_item);
+
+    typename small_pidl<T>::type pidl(raw);
+    typename heap_pidl<T>::type heap(raw);
+
+    typename small_pidl<T>::type joined = pidl + tail;
+    typename heap_pidl<T>::type heap_joined = heap + tail;
+    BOOST_CHECK(
+        binary_equal_pidls(
+            joined.last_item().get(), heap_joined.last_item().get()));
+    BOOST_CHECK(
+        binary_equal_pidls(
+            joined.parent().get(), heap_joined.parent().get()));
+
+    typename small_pidl<T>::type parent = joined.parent();
+    BOOST_CHECK(
+        binary_equal_pidls(
+            parent.last_item().get(), heap_joined.parent().last_item().get()));
+    BOOST_CHECK(
+        binary_equal_pidls(
+            parent.parent().get(), heap_joined.parent().parent().get()));
+}
+
+/**
+ * Parent or last item of empty or NULL pidl is non-sensical.  Must throw.
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE( parent_of_empty, T, pidl_types )
+{
+    typename small_pidl<T>::type null;
+    typename small_pidl<T>::type empty(empty_pidl<T>());
+
+    BOOST_CHECK_THROW(null.parent(), std::logic_error);
+    BOOST_CHECK_THROW(empty.parent(), std::logic_error);
+    BOOST_CHECK_THROW(null.last_item(), std::logic_error);
+    BOOST_CHECK_THROW(empty.last_item(), std::logic_error);
+}
+
+/**
+ * PIDLs too big for the buffer spill into the wrapper's allocator instance,
+ * which derived PIDLs and converted copies inherit.
+ */
+BOOST_AUTO_TEST_CASE_TEMPLATE( spill_into_arena, T, adult_pidl_types )
+{
+    typedef basic_small_pidl<T, arena_alloc<T>, capacity> arena_small_pidl;
+
+    pidl_arena arena;
+
+    arena_small_pidl inline_pidl(
+        fake_pidl<T>(short_item), arena_alloc<T>(arena));
+    BOOST_CHECK(inline_pidl.is_inline());
+    BOOST_CHECK_EQUAL(arena.bytes_allocated(), 0U);
+
+    arena_small_pidl pidl(
+        fake_pidl<T>(short_item, long_item), arena_alloc<T>(arena));
+    BOOST_CHECK(!pidl.is_inline());
+    BOOST_CHECK_GT(arena.bytes_allocated(), 0U);
+    BOOST_CHECK(pidl.get_allocator().arena() == &arena);
+
+    BOOST_CHECK(pidl.last_item().get_allocator().arena() == &arena);
+    BOOST_CHECK(pidl.parent().get_allocator().arena() == &arena);
+    BOOST_CHECK((pidl + pidl.last_item()).get_allocator().arena() == &arena);
+
+    basic_pidl<T, arena_alloc<T> > converted = pidl;
+    BOOST_CHECK(converted.get_allocator().arena() == &arena);
+    BOOST_CHECK(binary_equal_pidls(converted.get(), pidl.get()));
+
+    // An allocator-less wrapper cannot spill but still holds small PIDLs
+    arena_small_pidl detached;
+    BOOST_CHECK_THROW(
+        detached = fake_pidl<T>(long_item), std::logic_error);
+    detached = fake_pidl<T>(short_item);
+    BOOST_CHECK(detached.is_inline());
+}
+
+/**
+ * A multi-item PIDL masquerading as a child must be rejected.
+ */
+BOOST_AUTO_TEST_CASE( type_check_catch_violation )
+{
+    const IDCHILD* invalid_child = fake_pidl<IDCHILD>(string("a"), string("b"));
+
+    BOOST_CHECK_THROW(
+        small_pidl<IDCHILD>::type pidl(invalid_child), std::invalid_argument);
+}
+
+/**
+ * Explicit downcasts work with pidl_cast as for basic_pidl.
+ */
+BOOST_AUTO_TEST_CASE( cast )
+{
+    small_pidl<IDRELATIVE>::type rpidl(fake_pidl<IDRELATIVE>(short_item));
+
+    small_pidl<IDABSOLUTE>::type apidl =
+        pidl_cast<small_pidl<IDABSOLUTE>::type>(rpidl);
+    BOOST_CHECK(binary_equal_pidls(apidl.get(), rpidl.get()));
+
+    heap_pidl<IDCHILD>::type cpidl = pidl_cast<heap_pidl<IDCHILD>::type>(rpidl);
+    BOOST_CHECK(binary_equal_pidls(cpidl.get(), rpidl.get()));
+}
+
+BOOST_AUTO_TEST_SUITE_END()